@@ -32,8 +32,12 @@ void *spidpi_create(const char *name, int mode, int loglevel) {
       (struct spidpi_ctx *)calloc(1, sizeof(struct spidpi_ctx));
   assert(ctx);
 
+  ctx->simctrl = VerilatorSimCtrl::FromScope(svGetNameFromScope(svGetScope()));
+  assert(ctx->simctrl);
   ctx->loglevel = loglevel;
   ctx->mon = monitor_spi_init(mode);
+  ctx->tick_stats = sim_stats_dpi_counter("spidpi_tick");
+  ctx->mon_stats = sim_stats_dpi_counter("monitor_spi");
   ctx->tick = 0;
   ctx->msbfirst = 1;
   ctx->nmax = MAX_TRANSACTION;
@@ -94,22 +98,21 @@ void *spidpi_create(const char *name, int mode, int loglevel) {
   return (void *)ctx;
 }
 
-char spidpi_tick(void *ctx_void, const svLogicVecVal *d2p_data) {
-  struct spidpi_ctx *ctx = (struct spidpi_ctx *)ctx_void;
-  assert(ctx);
-  int d2p = d2p_data->aval;
+static char spidpi_tick_internal(struct spidpi_ctx *ctx, int d2p) {
 
   // Will tick at the host clock
   ctx->tick++;
 
 #ifdef CONTROL_TRACE
   if (ctx->tick == 4) {
-    VerilatorSimCtrl::GetInstance().TraceOff();
+    ctx->simctrl->TraceOff();
   }
 #endif
 
+  uint64_t mon_start = sim_stats_timestamp();
   monitor_spi(ctx->mon, ctx->mon_file, ctx->loglevel, ctx->tick, ctx->driving,
               d2p);
+  sim_stats_record(ctx->mon_stats, mon_start);
 
   if (ctx->state == SP_IDLE) {
     int n = read(ctx->host, &(ctx->buf[ctx->nin]), ctx->nmax - ctx->nin);
@@ -127,7 +130,7 @@ char spidpi_tick(void *ctx_void, const svLogicVecVal *d2p_data) {
         ctx->din = 0;
         ctx->state = SP_CSFALL;
 #ifdef CONTROL_TRACE
-        VerilatorSimCtrl::GetInstance().TraceOn();
+        ctx->simctrl->TraceOn();
 #endif
       }
     }
@@ -196,7 +199,7 @@ char spidpi_tick(void *ctx_void, const svLogicVecVal *d2p_data) {
         ctx->state = SP_IDLE;
         break;
       case SP_FINISH:
-        VerilatorSimCtrl::GetInstance().RequestStop(true);
+        ctx->simctrl->RequestStop(true);
         break;
       default:
         ctx->driving = set_sck | (ctx->driving & ~P2D_SCK);
@@ -206,6 +209,16 @@ char spidpi_tick(void *ctx_void, const svLogicVecVal *d2p_data) {
   return ctx->driving;
 }
 
+char spidpi_tick(void *ctx_void, const svLogicVecVal *d2p_data) {
+  struct spidpi_ctx *ctx = (struct spidpi_ctx *)ctx_void;
+  assert(ctx);
+
+  uint64_t start = sim_stats_timestamp();
+  char driving = spidpi_tick_internal(ctx, d2p_data->aval);
+  sim_stats_record(ctx->tick_stats, start);
+  return driving;
+}
+
 void spidpi_close(void *ctx_void) {
   struct spidpi_ctx *ctx = (struct spidpi_ctx *)ctx_void;
   if (!ctx) {
@@ -8,6 +8,10 @@
 #include <limits.h>
 #include <svdpi.h>
 
+#include "sim_stats.h"
+
+class VerilatorSimCtrl;
+
 extern "C" {
 
 #define MAX_TRANSACTION 4
@@ -32,6 +36,10 @@ struct spidpi_ctx {
   char driving;
   int state;
   char buf[MAX_TRANSACTION];
+  // The controller of the simulation containing this instance
+  VerilatorSimCtrl *simctrl;
+  struct sim_stats_counter *tick_stats;
+  struct sim_stats_counter *mon_stats;
 };
 
 // SPI Host States
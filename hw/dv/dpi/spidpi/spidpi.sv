@@ -23,7 +23,8 @@ module spidpi
   input  logic spi_device_sdo_en_i
 
 );
-  import "DPI-C" function
+  // A context import, so spidpi_create() can find its simulation controller
+  import "DPI-C" context function
     chandle spidpi_create(input string name, input int mode, input int loglevel);
 
   import "DPI-C" function
@@ -54,6 +54,9 @@ void *usbdpi_create(const char *name, int loglevel) {
   ctx->hostSt = HS_NEXTFRAME;
   ctx->loglevel = loglevel;
   ctx->mon = monitor_usb_init();
+  ctx->d2h_stats = sim_stats_dpi_counter("usbdpi_device_to_host");
+  ctx->h2d_stats = sim_stats_dpi_counter("usbdpi_host_to_device");
+  ctx->mon_stats = sim_stats_dpi_counter("monitor_usb");
   ctx->baudrate_set_successfully = 0;
 
   char cwd[PATH_MAX];
@@ -87,6 +90,7 @@ const char *decode_usb[] = {"SE0", "0-K", "1-J", "SE1"};
 void usbdpi_device_to_host(void *ctx_void, const svBitVecVal *usb_d2p) {
   struct usbdpi_ctx *ctx = (struct usbdpi_ctx *)ctx_void;
   assert(ctx);
+  uint64_t start = sim_stats_timestamp();
   int d2p = usb_d2p[0];
   int dp, dn;
   int n;
@@ -167,6 +171,7 @@ void usbdpi_device_to_host(void *ctx_void, const svBitVecVal *usb_d2p) {
     ssize_t written = fwrite(obuf, sizeof(char), (size_t)n, ctx->mon_file);
     assert(written == n);
   }
+  sim_stats_record(ctx->d2h_stats, start);
 }
 
 // Note: start points to the PID which is not in the CRC
@@ -684,10 +689,7 @@ int inv_driving(struct usbdpi_ctx *ctx, int d2p) {
   return ctx->driving ^ ((d2p & D2P_TXMODE_SE) ? (P2D_DP | P2D_DN) : P2D_D);
 }
 
-char usbdpi_host_to_device(void *ctx_void, const svBitVecVal *usb_d2p) {
-  struct usbdpi_ctx *ctx = (struct usbdpi_ctx *)ctx_void;
-  assert(ctx);
-  int d2p = usb_d2p[0];
+static char usbdpi_host_to_device_internal(struct usbdpi_ctx *ctx, int d2p) {
   uint32_t last_driving = ctx->driving;
   int force_stat = 0;
   int dat;
@@ -707,9 +709,11 @@ char usbdpi_host_to_device(void *ctx_void, const svBitVecVal *usb_d2p) {
     return ctx->driving;
   }
 
+  uint64_t mon_start = sim_stats_timestamp();
   monitor_usb(ctx->mon, ctx->mon_file, ctx->loglevel, ctx->tick,
               (ctx->state != ST_IDLE) && (ctx->state != ST_GET), ctx->driving,
               d2p, &(ctx->lastrxpid));
+  sim_stats_record(ctx->mon_stats, mon_start);
 
   if (ctx->tick_bits == SENSE_AT) {
     ctx->driving |= P2D_SENSE;
@@ -887,6 +891,16 @@ char usbdpi_host_to_device(void *ctx_void, const svBitVecVal *usb_d2p) {
   return ctx->driving;
 }
 
+char usbdpi_host_to_device(void *ctx_void, const svBitVecVal *usb_d2p) {
+  struct usbdpi_ctx *ctx = (struct usbdpi_ctx *)ctx_void;
+  assert(ctx);
+
+  uint64_t start = sim_stats_timestamp();
+  char driving = usbdpi_host_to_device_internal(ctx, usb_d2p[0]);
+  sim_stats_record(ctx->h2d_stats, start);
+  return driving;
+}
+
 void usbdpi_close(void *ctx_void) {
   struct usbdpi_ctx *ctx = (struct usbdpi_ctx *)ctx_void;
   if (!ctx) {
@@ -12,6 +12,8 @@
 #include <stdio.h>
 #include <svdpi.h>
 
+#include "sim_stats.h"
+
 // How many bits in our frame (1ms on real hardware)
 #define FRAME_INTERVAL 256 * 8
 
@@ -124,6 +126,9 @@ struct usbdpi_ctx {
   int hostSt;
   uint8_t data[SEND_MAX];
   int baudrate_set_successfully;
+  struct sim_stats_counter *d2h_stats;
+  struct sim_stats_counter *h2d_stats;
+  struct sim_stats_counter *mon_stats;
 };
 
 void *usbdpi_create(const char *name, int loglevel);
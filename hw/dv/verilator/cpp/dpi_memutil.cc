@@ -97,6 +97,38 @@ class ElfFile {
     return phdrs;
   }
 
+  // Add the defined function symbols in the file to |symbols|, keyed by
+  // address.
+  void GetFunctionSymbols(std::map<uint32_t, ElfSymbol> &symbols) {
+    Elf_Scn *scn = nullptr;
+    while ((scn = elf_nextscn(ptr_, scn)) != nullptr) {
+      const Elf32_Shdr *shdr = elf32_getshdr(scn);
+      if (!shdr)
+        throw ElfError(path_, elf_errmsg(-1));
+      if (shdr->sh_type != SHT_SYMTAB)
+        continue;
+
+      Elf_Data *data = elf_getdata(scn, nullptr);
+      if (!data)
+        throw ElfError(path_, elf_errmsg(-1));
+
+      const Elf32_Sym *syms = static_cast<const Elf32_Sym *>(data->d_buf);
+      size_t num_syms = data->d_size / sizeof(Elf32_Sym);
+      for (size_t i = 0; i < num_syms; ++i) {
+        const Elf32_Sym &sym = syms[i];
+        if (ELF32_ST_TYPE(sym.st_info) != STT_FUNC ||
+            sym.st_shndx == SHN_UNDEF)
+          continue;
+
+        const char *name = elf_strptr(ptr_, shdr->sh_link, sym.st_name);
+        if (!name)
+          continue;
+
+        symbols[sym.st_value] = {.name = name, .size = sym.st_size};
+      }
+    }
+  }
+
   std::string path_;
   int fd_;
   Elf *ptr_;
@@ -508,6 +540,7 @@ void DpiMemUtil::LoadFileToNamedMem(bool verbose, const std::string &name,
     switch (type) {
       case kMemImageElf:
         WriteElfToMem(m, filepath);
+        AddElfSymbols(filepath);
         break;
       case kMemImageVmem:
         WriteVmemToMem(m, filepath);
@@ -558,6 +591,7 @@ void DpiMemUtil::StageElf(bool verbose, const std::string &path) {
   staging_area_.clear();
 
   ElfFile elf(path);
+  elf.GetFunctionSymbols(elf_symbols_);
 
   size_t file_size;
   const char *file_data = elf_rawfile(elf.ptr_, &file_size);
@@ -624,6 +658,24 @@ const StagedMem &DpiMemUtil::GetMemoryData(const std::string &mem_name) const {
   return (it == staging_area_.end()) ? empty_ : it->second;
 }
 
+std::string DpiMemUtil::GetFunctionName(uint32_t addr) const {
+  auto it = elf_symbols_.upper_bound(addr);
+  if (it == elf_symbols_.begin())
+    return "";
+
+  --it;
+  const ElfSymbol &sym = it->second;
+  if (sym.size && addr - it->first >= sym.size)
+    return "";
+
+  return sym.name;
+}
+
+void DpiMemUtil::AddElfSymbols(const std::string &path) {
+  ElfFile elf(path);
+  elf.GetFunctionSymbols(elf_symbols_);
+}
+
 const MemArea &DpiMemUtil::GetRegionForSegment(const std::string &path,
                                                int seg_idx, uint32_t lma,
                                                uint32_t mem_sz) const {
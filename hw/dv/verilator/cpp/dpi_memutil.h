@@ -32,6 +32,13 @@ struct MemArea {
   MemAreaLoc addr_loc;   // Address location. If !size, location is unknown.
 };
 
+// A function symbol from an ELF file. A size of zero means that the size is
+// unknown (as for hand-written assembly without a .size directive).
+struct ElfSymbol {
+  std::string name;
+  uint32_t size;
+};
+
 // Staged data for a given memory area.
 //
 // This is represented as an ordered list of disjoint segments (as loaded from
@@ -145,6 +152,13 @@ class DpiMemUtil {
    */
   const StagedMem &GetMemoryData(const std::string &mem_name) const;
 
+  /**
+   * Get the name of the function containing |addr|, using the symbol tables
+   * of all the ELF files that have been loaded (or staged) so far. Returns the
+   * empty string if no function symbol contains the address.
+   */
+  std::string GetFunctionName(uint32_t addr) const;
+
  private:
   // Memory area registry
   std::map<std::string, MemArea> name_to_mem_;
@@ -157,6 +171,15 @@ class DpiMemUtil {
   std::map<std::string, StagedMem> staging_area_;
   const StagedMem empty_;
 
+  // Function symbols from loaded ELF files, keyed by address
+  std::map<uint32_t, ElfSymbol> elf_symbols_;
+
+  /**
+   * Add the function symbols from the ELF file at |path| to elf_symbols_.
+   * Raises a std::exception if the file can't be read.
+   */
+  void AddElfSymbols(const std::string &path);
+
   /**
    * Find a region containing for the given segment's addresses.
    * Raises a std::exception if none is found.
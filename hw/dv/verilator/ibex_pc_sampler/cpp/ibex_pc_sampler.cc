@@ -0,0 +1,226 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ibex_pc_sampler.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <getopt.h>
+#include <iostream>
+#include <sstream>
+#include <svdpi.h>
+
+#include "sv_scoped.h"
+
+// Calls that never return (for example, if software switches stacks) would
+// otherwise make the shadow call stack grow without bound.
+static const size_t kMaxStackDepth = 256;
+
+// The sampler that DPI calls from ibex_pc_sampler.sv are routed to. This is
+// null unless profiling was enabled on the command line.
+static IbexPcSampler *active_sampler = nullptr;
+
+// DPI Exports
+extern "C" {
+extern unsigned int ibex_pc_sampler_get_pc();
+}
+
+// DPI Imports
+extern "C" {
+void ibex_pc_sampler_call(unsigned int call_pc, unsigned int ret_addr,
+                          svBit is_trap) {
+  if (active_sampler)
+    active_sampler->OnCall(call_pc, ret_addr, is_trap);
+}
+
+void ibex_pc_sampler_return(unsigned int target, svBit is_mret) {
+  if (active_sampler)
+    active_sampler->OnReturn(target, is_mret);
+}
+}
+
+static void PrintHelp() {
+  std::cout << "Ibex PC sampling profiler:\n\n"
+               "--ibex-pc-samples=FILE\n"
+               "  Sample the Ibex PC and write collapsed stacks (for "
+               "flamegraph.pl) to FILE\n\n"
+               "--ibex-pc-sample-period=N\n"
+               "  Take a sample every N cycles (default: 100)\n\n"
+               "--ibex-pc-sample-stack\n"
+               "  Include the call stack in each sample\n\n";
+}
+
+IbexPcSampler::IbexPcSampler(const DpiMemUtil *mem_util,
+                             const std::string &scope)
+    : mem_util_(mem_util),
+      scope_(scope),
+      period_(100),
+      with_stack_(false),
+      cycles_to_sample_(0) {
+  assert(mem_util);
+}
+
+IbexPcSampler::~IbexPcSampler() {
+  if (active_sampler == this)
+    active_sampler = nullptr;
+}
+
+bool IbexPcSampler::ParseCLIArguments(int argc, char **argv, bool &exit_app) {
+  const struct option long_options[] = {
+      {"ibex-pc-samples", required_argument, nullptr, 'o'},
+      {"ibex-pc-sample-period", required_argument, nullptr, 'p'},
+      {"ibex-pc-sample-stack", no_argument, nullptr, 's'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, no_argument, nullptr, 0}};
+
+  // Reset the command parsing index in-case other utils have already parsed
+  // some arguments
+  optind = 1;
+  while (1) {
+    int c = getopt_long(argc, argv, ":h", long_options, nullptr);
+    if (c == -1) {
+      break;
+    }
+
+    // Disable error reporting by getopt
+    opterr = 0;
+
+    switch (c) {
+      case 0:
+        break;
+      case 'o':
+        out_file_.open(optarg, std::fstream::out);
+        if (!out_file_.is_open()) {
+          std::cerr << "ERROR: Could not open PC sample file: " << optarg
+                    << std::endl;
+          return false;
+        }
+        active_sampler = this;
+        break;
+      case 'p': {
+        char *end;
+        unsigned long period = strtoul(optarg, &end, 0);
+        if (*end != '\0' || period == 0 || period > UINT32_MAX) {
+          std::cerr << "ERROR: Invalid PC sample period: " << optarg
+                    << std::endl;
+          return false;
+        }
+        period_ = period;
+        break;
+      }
+      case 's':
+        with_stack_ = true;
+        break;
+      case 'h':
+        PrintHelp();
+        break;
+      case ':':  // missing argument
+        std::cerr << "ERROR: Missing argument." << std::endl << std::endl;
+        return false;
+      case '?':
+      default:;
+        // Ignore unrecognized options since they might be consumed by
+        // other utils
+    }
+  }
+
+  cycles_to_sample_ = period_;
+  return true;
+}
+
+void IbexPcSampler::OnClock(unsigned long sim_time) {
+  if (!Enabled() || --cycles_to_sample_)
+    return;
+
+  cycles_to_sample_ = period_;
+  TakeSample();
+}
+
+void IbexPcSampler::TakeSample() {
+  uint32_t pc;
+  {
+    SVScoped scoped(scope_);
+    pc = ibex_pc_sampler_get_pc();
+  }
+
+  // Nothing has retired yet (we're still in reset)
+  if (!pc)
+    return;
+
+  std::vector<uint32_t> key;
+  if (with_stack_) {
+    key.reserve(frames_.size() + 1);
+    for (const Frame &frame : frames_) {
+      key.push_back(frame.call_pc);
+    }
+  }
+  key.push_back(pc);
+  ++samples_[key];
+}
+
+void IbexPcSampler::OnCall(uint32_t call_pc, uint32_t ret_addr, bool is_trap) {
+  if (frames_.size() >= kMaxStackDepth)
+    frames_.erase(frames_.begin());
+  frames_.push_back({call_pc, ret_addr, is_trap});
+}
+
+void IbexPcSampler::OnReturn(uint32_t target, bool is_mret) {
+  // Pop back to the frame that returns to target. Searching (rather than just
+  // popping one frame) copes with code that skips frames, such as a trap
+  // handler that returns to the instruction after the one that trapped.
+  for (size_t i = frames_.size(); i > 0; --i) {
+    if (frames_[i - 1].ret_addr == target) {
+      frames_.resize(i - 1);
+      return;
+    }
+  }
+
+  // If there was no match, an MRET still finishes the innermost trap handler.
+  if (is_mret) {
+    for (size_t i = frames_.size(); i > 0; --i) {
+      if (frames_[i - 1].is_trap) {
+        frames_.resize(i - 1);
+        return;
+      }
+    }
+  }
+}
+
+std::string IbexPcSampler::SymbolName(uint32_t addr) const {
+  std::string name = mem_util_->GetFunctionName(addr);
+  if (!name.empty())
+    return name;
+
+  std::ostringstream oss;
+  oss << "0x" << std::hex << addr;
+  return oss.str();
+}
+
+void IbexPcSampler::PostExec() {
+  if (!Enabled())
+    return;
+
+  // Symbolize the samples. Different stacks can have the same names (for
+  // example, with two calls from the same function), so merge them.
+  std::map<std::string, uint64_t> stacks;
+  uint64_t total = 0;
+  for (const auto &pr : samples_) {
+    std::ostringstream oss;
+    bool first = true;
+    for (uint32_t addr : pr.first) {
+      oss << (first ? "" : ";") << SymbolName(addr);
+      first = false;
+    }
+    stacks[oss.str()] += pr.second;
+    total += pr.second;
+  }
+
+  for (const auto &pr : stacks) {
+    out_file_ << pr.first << " " << pr.second << "\n";
+  }
+  out_file_.close();
+
+  std::cout << "Wrote " << total << " Ibex PC samples (one every " << period_
+            << " cycles)." << std::endl;
+}
@@ -0,0 +1,76 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef OPENTITAN_HW_DV_VERILATOR_IBEX_PC_SAMPLER_CPP_IBEX_PC_SAMPLER_H_
+#define OPENTITAN_HW_DV_VERILATOR_IBEX_PC_SAMPLER_CPP_IBEX_PC_SAMPLER_H_
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "dpi_memutil.h"
+#include "sim_ctrl_extension.h"
+
+/**
+ * SimCtrlExtension that samples the PC of an Ibex core every few cycles and
+ * writes a profile of where the core spent its time.
+ *
+ * The core must have an ibex_pc_sampler instance (see
+ * rtl/ibex_pc_sampler.sv) connected to its RVFI port. Samples are symbolized
+ * with the function symbols of the ELF files loaded by |mem_util| and written
+ * in the "collapsed" format used by flamegraph.pl: one line per stack, with
+ * semicolon-separated function names followed by a sample count.
+ *
+ * With --ibex-pc-sample-stack, each sample also includes the shadow call stack
+ * that ibex_pc_sampler maintains from the calls and returns it sees. Trap
+ * handlers appear as called from the instruction that was interrupted.
+ */
+class IbexPcSampler : public SimCtrlExtension {
+ public:
+  /**
+   * Constructor. |scope| is the SystemVerilog scope of the ibex_pc_sampler
+   * instance. |mem_util| is used to symbolize samples and must outlive this
+   * object.
+   */
+  IbexPcSampler(const DpiMemUtil *mem_util, const std::string &scope);
+  ~IbexPcSampler();
+
+  bool ParseCLIArguments(int argc, char **argv, bool &exit_app) override;
+  void OnClock(unsigned long sim_time) override;
+  void PostExec() override;
+
+  // Called (through DPI) when the core retires a call or return, or takes a
+  // trap.
+  void OnCall(uint32_t call_pc, uint32_t ret_addr, bool is_trap);
+  void OnReturn(uint32_t target, bool is_mret);
+
+ private:
+  struct Frame {
+    uint32_t call_pc;
+    uint32_t ret_addr;
+    bool is_trap;
+  };
+
+  const DpiMemUtil *mem_util_;
+  std::string scope_;
+
+  std::ofstream out_file_;
+  unsigned int period_;
+  bool with_stack_;
+
+  unsigned int cycles_to_sample_;
+  std::vector<Frame> frames_;
+
+  // Sample counts, keyed by the call sites on the stack (outermost first),
+  // followed by the sampled PC.
+  std::map<std::vector<uint32_t>, uint64_t> samples_;
+
+  bool Enabled() const { return out_file_.is_open(); }
+  void TakeSample();
+  std::string SymbolName(uint32_t addr) const;
+};
+
+#endif  // OPENTITAN_HW_DV_VERILATOR_IBEX_PC_SAMPLER_CPP_IBEX_PC_SAMPLER_H_
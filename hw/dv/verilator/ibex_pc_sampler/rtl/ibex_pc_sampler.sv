@@ -0,0 +1,80 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Watch the instructions retired by Ibex (on its RVFI port) for the PC
+// sampling profiler in cpp/ibex_pc_sampler.cc.
+//
+// The profiler reads the PC of the most recently retired instruction with
+// ibex_pc_sampler_get_pc(). To maintain a shadow call stack, it is also told
+// about each call, return and trap. Calls and returns are jumps that link
+// through (or return through) x1 or x5, as in the RISC-V calling convention.
+module ibex_pc_sampler (
+  input logic        clk_i,
+  input logic        rst_ni,
+
+  input logic        rvfi_valid,
+  input logic [31:0] rvfi_insn,
+  input logic        rvfi_intr,
+  input logic [ 4:0] rvfi_rs1_addr,
+  input logic [ 4:0] rvfi_rd_addr,
+  input logic [31:0] rvfi_pc_rdata,
+  input logic [31:0] rvfi_pc_wdata
+);
+
+  import "DPI-C" function void ibex_pc_sampler_call(int unsigned call_pc,
+                                                    int unsigned ret_addr,
+                                                    bit          is_trap);
+  import "DPI-C" function void ibex_pc_sampler_return(int unsigned target,
+                                                      bit          is_mret);
+
+  export "DPI-C" function ibex_pc_sampler_get_pc;
+
+  // PC of the last retired instruction and the PC it went to next
+  logic [31:0] last_pc_q, next_pc_q;
+
+  function automatic int unsigned ibex_pc_sampler_get_pc();
+    return last_pc_q;
+  endfunction
+
+  // RVFI gives the raw instruction bits, so compressed instructions are in the
+  // bottom half of rvfi_insn. C.JAL links to x1; C.JR and C.JALR are JALRs
+  // with rs1 in bits 11:7 (which must be nonzero).
+  logic is_compressed, is_jal, is_jalr, is_mret;
+  logic rd_is_link, rs1_is_link;
+
+  assign is_compressed = rvfi_insn[1:0] != 2'b11;
+  assign is_jal  = is_compressed ? (rvfi_insn[15:13] == 3'b001 && rvfi_insn[1:0] == 2'b01) :
+                                   (rvfi_insn[6:0] == 7'h6f);
+  assign is_jalr = is_compressed ? (rvfi_insn[15:13] == 3'b100 && rvfi_insn[6:0] == 7'h02 &&
+                                    rvfi_insn[11:7] != 5'd0) :
+                                   (rvfi_insn[6:0] == 7'h67);
+  assign is_mret = rvfi_insn == 32'h30200073;
+
+  assign rd_is_link  = rvfi_rd_addr == 5'd1 || rvfi_rd_addr == 5'd5;
+  assign rs1_is_link = rvfi_rs1_addr == 5'd1 || rvfi_rs1_addr == 5'd5;
+
+  always_ff @(posedge clk_i or negedge rst_ni) begin
+    if (!rst_ni) begin
+      last_pc_q <= '0;
+      next_pc_q <= '0;
+    end else if (rvfi_valid) begin
+      // The first instruction of a trap handler. Treat the trap like a call
+      // from the last instruction that retired, which will return to mepc.
+      if (rvfi_intr) begin
+        ibex_pc_sampler_call(last_pc_q, next_pc_q, 1'b1);
+      end
+
+      if ((is_jal || is_jalr) && rd_is_link) begin
+        ibex_pc_sampler_call(rvfi_pc_rdata, rvfi_pc_rdata + (is_compressed ? 32'd2 : 32'd4),
+                             1'b0);
+      end else if ((is_jalr && rs1_is_link) || is_mret) begin
+        ibex_pc_sampler_return(rvfi_pc_wdata, is_mret);
+      end
+
+      last_pc_q <= rvfi_pc_rdata;
+      next_pc_q <= rvfi_pc_wdata;
+    end
+  end
+
+endmodule
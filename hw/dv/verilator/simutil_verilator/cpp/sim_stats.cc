@@ -0,0 +1,48 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "sim_stats.h"
+
+#include <deque>
+#include <mutex>
+
+namespace {
+// The DPI counters, in order of creation. A deque never moves its elements, so
+// the pointers we hand out stay valid.
+struct DpiCounterRegistry {
+  std::mutex mutex;
+  std::deque<std::pair<std::string, sim_stats_counter>> counters;
+};
+
+DpiCounterRegistry &GetRegistry() {
+  static DpiCounterRegistry registry;
+  return registry;
+}
+}  // namespace
+
+extern "C" struct sim_stats_counter *sim_stats_dpi_counter(const char *name) {
+  DpiCounterRegistry &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  for (auto &pr : registry.counters) {
+    if (pr.first == name) {
+      return &pr.second;
+    }
+  }
+
+  registry.counters.emplace_back(name, sim_stats_counter{0, 0});
+  return &registry.counters.back().second;
+}
+
+std::vector<std::pair<std::string, const sim_stats_counter *>>
+SimStatsDpiCounters() {
+  DpiCounterRegistry &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  std::vector<std::pair<std::string, const sim_stats_counter *>> ret;
+  for (const auto &pr : registry.counters) {
+    ret.emplace_back(pr.first, &pr.second);
+  }
+  return ret;
+}
@@ -0,0 +1,93 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef OPENTITAN_HW_DV_VERILATOR_SIMUTIL_VERILATOR_CPP_SIM_STATS_H_
+#define OPENTITAN_HW_DV_VERILATOR_SIMUTIL_VERILATOR_CPP_SIM_STATS_H_
+
+//
+// Low-overhead call counters and timers for simulation statistics
+//
+// VerilatorSimCtrl uses these to time the model evaluation, tracing and its
+// extensions. DPI modules can opt in to being timed as well: get a counter
+// once (e.g. when creating the DPI context) with sim_stats_dpi_counter() and
+// then wrap the interesting calls like this:
+//
+//   uint64_t start = sim_stats_timestamp();
+//   do_something();
+//   sim_stats_record(ctx->stats, start);
+//
+// DPI counters are reported by VerilatorSimCtrl at the end of the simulation.
+// This header can be included from C as well as C++.
+//
+
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+/**
+ * Get a timestamp in arbitrary "ticks"
+ *
+ * This reads the CPU's time stamp counter where possible, which takes a few
+ * nanoseconds. Elsewhere, it returns a monotonic time in nanoseconds.
+ * VerilatorSimCtrl converts ticks to seconds by comparing them with wallclock
+ * time over the whole run.
+ */
+static inline uint64_t sim_stats_timestamp(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * The number of calls to something and the total ticks spent in them
+ */
+struct sim_stats_counter {
+  uint64_t calls;
+  uint64_t ticks;
+};
+
+/**
+ * Record a call that started at |start| (a value from sim_stats_timestamp())
+ */
+static inline void sim_stats_record(struct sim_stats_counter *counter,
+                                    uint64_t start) {
+  counter->calls++;
+  counter->ticks += sim_stats_timestamp() - start;
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Get the DPI counter called |name|, creating it if necessary
+ *
+ * Counters live until the end of the process. Modules with several instances
+ * may share a counter by using the same name.
+ */
+struct sim_stats_counter *sim_stats_dpi_counter(const char *name);
+
+#ifdef __cplusplus
+}  // extern "C"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Get all the DPI counters created so far, in order of creation
+ */
+std::vector<std::pair<std::string, const sim_stats_counter *>>
+SimStatsDpiCounters();
+#endif
+
+#endif  // OPENTITAN_HW_DV_VERILATOR_SIMUTIL_VERILATOR_CPP_SIM_STATS_H_
@@ -121,6 +121,9 @@ class VerilatedToplevel {
   virtual void eval() = 0;
   virtual void final() = 0;
   virtual const char *name() const = 0;
+  // The instance name, which is the first component of every scope in the
+  // design (see svGetNameFromScope())
+  virtual const char *scope_name() const = 0;
   virtual void trace(VerilatedTracer &tfp, int levels, int options) = 0;
 
   /**
@@ -140,6 +143,7 @@ class TOPLEVEL_NAME : public VERILATED_TOPLEVEL_NAME, public VerilatedToplevel {
   TOPLEVEL_NAME(const char *name = "TOP")
       : VERILATED_TOPLEVEL_NAME(name), VerilatedToplevel() {}
   const char *name() const { return STR_AND_EXPAND(TOPLEVEL_NAME); }
+  const char *scope_name() const { return VERILATED_TOPLEVEL_NAME::name(); }
   void eval() { VERILATED_TOPLEVEL_NAME::eval(); }
   void final() { VERILATED_TOPLEVEL_NAME::final(); }
   void trace(VerilatedTracer &tfp, int levels, int options = 0) {
@@ -4,10 +4,19 @@
 
 #include "verilator_sim_ctrl.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <cxxabi.h>
+#include <fstream>
 #include <getopt.h>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <signal.h>
+#include <sstream>
 #include <sys/stat.h>
+#include <typeinfo>
 #include <verilated.h>
 
 // This is defined by Verilator and passed through the command line
@@ -20,7 +29,10 @@
  *
  * Called by $time in Verilog, converts to double, to match what SystemC does
  */
-double sc_time_stamp() { return VerilatorSimCtrl::GetInstance().GetTime(); }
+double sc_time_stamp() {
+  VerilatorSimCtrl *simctrl = VerilatorSimCtrl::Current();
+  return simctrl ? simctrl->GetTime() : 0;
+}
 
 #ifdef VL_USER_STOP
 /**
@@ -30,24 +42,111 @@ double sc_time_stamp() { return VerilatorSimCtrl::GetInstance().GetTime(); }
  * shut down the simulation.
  */
 void vl_stop(const char *filename, int linenum, const char *hier) VL_MT_UNSAFE {
-  VerilatorSimCtrl::GetInstance().RequestStop(false);
+  VerilatorSimCtrl *simctrl = VerilatorSimCtrl::FromScope(hier);
+  if (!simctrl) {
+    simctrl = VerilatorSimCtrl::Current();
+  }
+  assert(simctrl && "No simulation to stop.");
+  simctrl->RequestStop(false);
 }
 #endif
 
-VerilatorSimCtrl &VerilatorSimCtrl::GetInstance() {
-  static VerilatorSimCtrl instance;
-  return instance;
+namespace {
+// All controllers in the process, guarded by controllers_mutex
+std::mutex controllers_mutex;
+std::vector<VerilatorSimCtrl *> controllers;
+
+// The only controller in the process, or nullptr if there are none or several.
+// This lets Current() avoid taking controllers_mutex.
+std::atomic<VerilatorSimCtrl *> sole_controller(nullptr);
+
+// The controller running a simulation on this thread
+thread_local VerilatorSimCtrl *thread_controller = nullptr;
+
+void UpdateSoleController() {
+  sole_controller = controllers.size() == 1 ? controllers[0] : nullptr;
+}
+
+/**
+ * Make a controller current on this thread for the lifetime of this object
+ */
+class CurrentControllerScope {
+ public:
+  CurrentControllerScope(VerilatorSimCtrl *simctrl)
+      : prev_(thread_controller) {
+    thread_controller = simctrl;
+  }
+  ~CurrentControllerScope() { thread_controller = prev_; }
+
+ private:
+  VerilatorSimCtrl *prev_;
+};
+}  // namespace
+
+std::atomic<unsigned int> VerilatorSimCtrl::sigint_count_(0);
+std::atomic<unsigned int> VerilatorSimCtrl::sigusr1_count_(0);
+
+VerilatorSimCtrl::VerilatorSimCtrl(VerilatedToplevel *top, CData *sig_clk,
+                                   CData *sig_rst, VerilatorSimCtrlFlags flags)
+    : top_(top),
+      sig_clk_(sig_clk),
+      sig_rst_(sig_rst),
+      flags_(flags),
+      time_(0),
+      tracing_enabled_(false),
+      tracing_enabled_changed_(false),
+      tracing_ever_enabled_(false),
+      tracing_possible_(VM_TRACE),
+      initial_reset_delay_cycles_(2),
+      reset_duration_cycles_(2),
+      request_stop_(false),
+      simulation_success_(true),
+      tracer_(VerilatedTracer()),
+      term_after_cycles_(0),
+      ticks_begin_(0),
+      ticks_end_(0),
+      eval_stats_({0, 0}),
+      trace_stats_({0, 0}),
+      sigint_seen_(sigint_count_),
+      sigusr1_seen_(sigusr1_count_) {
+  assert(top && sig_clk && sig_rst);
+
+  std::lock_guard<std::mutex> lock(controllers_mutex);
+  controllers.push_back(this);
+  UpdateSoleController();
+}
+
+VerilatorSimCtrl::~VerilatorSimCtrl() {
+  std::lock_guard<std::mutex> lock(controllers_mutex);
+  controllers.erase(std::find(controllers.begin(), controllers.end(), this));
+  UpdateSoleController();
 }
 
-void VerilatorSimCtrl::SetTop(VerilatedToplevel *top, CData *sig_clk,
-                              CData *sig_rst, VerilatorSimCtrlFlags flags) {
-  top_ = top;
-  sig_clk_ = sig_clk;
-  sig_rst_ = sig_rst;
-  flags_ = flags;
+VerilatorSimCtrl *VerilatorSimCtrl::FromScope(const char *scope_name) {
+  if (!scope_name) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(controllers_mutex);
+  for (VerilatorSimCtrl *simctrl : controllers) {
+    // The instance name of the top-level is the first component of the scope
+    const char *top_name = simctrl->top_->scope_name();
+    size_t len = strlen(top_name);
+    if (strncmp(scope_name, top_name, len) == 0 &&
+        (scope_name[len] == '\0' || scope_name[len] == '.')) {
+      return simctrl;
+    }
+  }
+  return nullptr;
+}
+
+VerilatorSimCtrl *VerilatorSimCtrl::Current() {
+  return thread_controller ? thread_controller : sole_controller.load();
 }
 
 std::pair<int, bool> VerilatorSimCtrl::Exec(int argc, char **argv) {
+  CurrentControllerScope current(this);
+
   bool exit_app = false;
   bool good_cmdline = ParseCommandArgs(argc, argv, exit_app);
   if (exit_app) {
@@ -64,6 +163,7 @@ bool VerilatorSimCtrl::ParseCommandArgs(int argc, char **argv, bool &exit_app) {
   const struct option long_options[] = {
       {"term-after-cycles", required_argument, nullptr, 'c'},
       {"trace", no_argument, nullptr, 't'},
+      {"stats-json", required_argument, nullptr, 's'},
       {"help", no_argument, nullptr, 'h'},
       {nullptr, no_argument, nullptr, 0}};
 
@@ -91,6 +191,9 @@ bool VerilatorSimCtrl::ParseCommandArgs(int argc, char **argv, bool &exit_app) {
       case 'c':
         term_after_cycles_ = atoi(optarg);
         break;
+      case 's':
+        stats_json_path_ = optarg;
+        break;
       case 'h':
         PrintHelp();
         exit_app = true;
@@ -123,6 +226,8 @@ bool VerilatorSimCtrl::ParseCommandArgs(int argc, char **argv, bool &exit_app) {
 }
 
 void VerilatorSimCtrl::RunSimulation() {
+  CurrentControllerScope current(this);
+
   RegisterSignalHandler();
 
   // Print helper message for tracing
@@ -143,6 +248,10 @@ void VerilatorSimCtrl::RunSimulation() {
   }
   // Print simulation speed info
   PrintStatistics();
+  if (!stats_json_path_.empty() && !WriteStatisticsJson(stats_json_path_)) {
+    std::cerr << "ERROR: Could not write statistics to `" << stats_json_path_
+              << "'." << std::endl;
+  }
   // Print helper message for tracing
   if (TracingEverEnabled()) {
     std::cout << std::endl
@@ -166,47 +275,55 @@ void VerilatorSimCtrl::RequestStop(bool simulation_success) {
 
 void VerilatorSimCtrl::RegisterExtension(SimCtrlExtension *ext) {
   extension_array_.push_back(ext);
+  extension_stats_.push_back({0, 0});
 }
 
-VerilatorSimCtrl::VerilatorSimCtrl()
-    : top_(nullptr),
-      time_(0),
-      tracing_enabled_(false),
-      tracing_enabled_changed_(false),
-      tracing_ever_enabled_(false),
-      tracing_possible_(VM_TRACE),
-      initial_reset_delay_cycles_(2),
-      reset_duration_cycles_(2),
-      request_stop_(false),
-      simulation_success_(true),
-      tracer_(VerilatedTracer()),
-      term_after_cycles_(0) {}
-
 void VerilatorSimCtrl::RegisterSignalHandler() {
-  struct sigaction sigIntHandler;
-
-  sigIntHandler.sa_handler = SignalHandler;
-  sigemptyset(&sigIntHandler.sa_mask);
-  sigIntHandler.sa_flags = 0;
-
-  sigaction(SIGINT, &sigIntHandler, NULL);
-  sigaction(SIGUSR1, &sigIntHandler, NULL);
+  // The handler is shared by all controllers, so only install it once
+  static std::once_flag registered;
+  std::call_once(registered, [] {
+    struct sigaction sigIntHandler;
+
+    sigIntHandler.sa_handler = SignalHandler;
+    sigemptyset(&sigIntHandler.sa_mask);
+    sigIntHandler.sa_flags = 0;
+
+    sigaction(SIGINT, &sigIntHandler, NULL);
+    sigaction(SIGUSR1, &sigIntHandler, NULL);
+  });
 }
 
 void VerilatorSimCtrl::SignalHandler(int sig) {
-  VerilatorSimCtrl &simctrl = VerilatorSimCtrl::GetInstance();
-
+  // Only count the signal here: each controller picks it up from its own main
+  // loop in HandleSignals().
   switch (sig) {
     case SIGINT:
-      simctrl.RequestStop(true);
+      ++sigint_count_;
       break;
     case SIGUSR1:
-      if (simctrl.TracingEnabled()) {
-        simctrl.TraceOff();
+      ++sigusr1_count_;
+      break;
+  }
+}
+
+void VerilatorSimCtrl::HandleSignals() {
+  unsigned int sigint_count = sigint_count_;
+  if (sigint_count != sigint_seen_) {
+    sigint_seen_ = sigint_count;
+    RequestStop(true);
+  }
+
+  unsigned int sigusr1_count = sigusr1_count_;
+  if (sigusr1_count != sigusr1_seen_) {
+    // Each SIGUSR1 toggles tracing
+    if ((sigusr1_count - sigusr1_seen_) & 1) {
+      if (TracingEnabled()) {
+        TraceOff();
       } else {
-        simctrl.TraceOn();
+        TraceOn();
       }
-      break;
+    }
+    sigusr1_seen_ = sigusr1_count;
   }
 }
 
@@ -218,6 +335,9 @@ void VerilatorSimCtrl::PrintHelp() const {
   }
   std::cout << "-c|--term-after-cycles=N\n"
                "  Terminate simulation after N cycles\n\n"
+               "--stats-json=FILE\n"
+               "  Write simulation statistics (including the time breakdown)\n"
+               "  to FILE as JSON\n\n"
                "-h|--help\n"
                "  Show help\n\n"
                "All arguments are passed to the design and can be used "
@@ -244,6 +364,24 @@ bool VerilatorSimCtrl::TraceOff() {
   return tracing_enabled_;
 }
 
+// Get a readable name for an extension from its dynamic type
+static std::string GetExtensionName(const SimCtrlExtension *ext) {
+  const char *mangled = typeid(*ext).name();
+  int status;
+  char *demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+  std::string name(status == 0 ? demangled : mangled);
+  free(demangled);
+  return name;
+}
+
+double VerilatorSimCtrl::TicksToSeconds(uint64_t ticks) const {
+  uint64_t run_ticks = ticks_end_ - ticks_begin_;
+  if (run_ticks == 0) {
+    return 0;
+  }
+  return ticks * (GetExecutionTimeSeconds() / run_ticks);
+}
+
 void VerilatorSimCtrl::PrintStatistics() const {
   double speed_hz = time_ / 2 / (GetExecutionTimeMs() / 1000.0);
   double speed_khz = speed_hz / 1000.0;
@@ -261,6 +399,111 @@ void VerilatorSimCtrl::PrintStatistics() const {
   if (tracing_enabled_ && FileSize(GetTraceFileName(), trace_size_byte)) {
     std::cout << "Trace file size:  " << trace_size_byte << " B" << std::endl;
   }
+
+  // Time breakdown. The remainder ("other") is the main loop itself.
+  uint64_t run_ticks = ticks_end_ - ticks_begin_;
+  if (run_ticks == 0) {
+    return;
+  }
+
+  std::ios old_state(nullptr);
+  old_state.copyfmt(std::cout);
+
+  auto print_line = [&](const std::string &name, uint64_t ticks,
+                        uint64_t calls) {
+    std::cout << "  " << std::left << std::setw(40) << name << std::right
+              << std::fixed << std::setprecision(3) << std::setw(10)
+              << TicksToSeconds(ticks) << " s " << std::setprecision(1)
+              << std::setw(5) << 100.0 * ticks / run_ticks << "%  "
+              << calls << " calls" << std::endl;
+  };
+
+  std::cout << std::endl << "Time breakdown:" << std::endl;
+  uint64_t other_ticks = run_ticks;
+  print_line("eval", eval_stats_.ticks, eval_stats_.calls);
+  print_line("trace", trace_stats_.ticks, trace_stats_.calls);
+  other_ticks -= std::min(other_ticks, eval_stats_.ticks + trace_stats_.ticks);
+  for (size_t i = 0; i < extension_array_.size(); ++i) {
+    const sim_stats_counter &stats = extension_stats_[i];
+    print_line(GetExtensionName(extension_array_[i]) + "::OnClock",
+               stats.ticks, stats.calls);
+    other_ticks -= std::min(other_ticks, stats.ticks);
+  }
+  std::cout << "  " << std::left << std::setw(40) << "other" << std::right
+            << std::fixed << std::setprecision(3) << std::setw(10)
+            << TicksToSeconds(other_ticks) << " s " << std::setprecision(1)
+            << std::setw(5) << 100.0 * other_ticks / run_ticks << "%"
+            << std::endl;
+
+  auto dpi_counters = SimStatsDpiCounters();
+  if (!dpi_counters.empty()) {
+    std::cout << "DPI calls (included in eval):" << std::endl;
+    for (const auto &pr : dpi_counters) {
+      print_line(pr.first, pr.second->ticks, pr.second->calls);
+    }
+  }
+
+  std::cout.copyfmt(old_state);
+}
+
+// Quote a string for JSON. The names we write are identifiers and C++ type
+// names, so only quotes and backslashes need escaping.
+static std::string JsonString(const std::string &str) {
+  std::string ret = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      ret += '\\';
+    }
+    ret += c;
+  }
+  return ret + "\"";
+}
+
+bool VerilatorSimCtrl::WriteStatisticsJson(const std::string &path) const {
+  std::ofstream out(path);
+  if (!out.is_open()) {
+    return false;
+  }
+
+  auto write_counter = [&](const std::string &name,
+                           const sim_stats_counter &stats, bool last) {
+    out << "    " << JsonString(name) << ": {\"calls\": " << stats.calls
+        << ", \"seconds\": " << TicksToSeconds(stats.ticks) << "}"
+        << (last ? "\n" : ",\n");
+  };
+
+  // Runs of short testbenches can take less time than the clock resolution,
+  // which would give an infinite speed. JSON has no infinity, so write null.
+  double run_seconds = GetExecutionTimeSeconds();
+  out << std::setprecision(9);
+  out << "{\n"
+      << "  \"cycles\": " << time_ / 2 << ",\n"
+      << "  \"wallclock_seconds\": " << run_seconds << ",\n"
+      << "  \"cycles_per_second\": ";
+  if (run_seconds > 0) {
+    out << time_ / 2 / run_seconds;
+  } else {
+    out << "null";
+  }
+  out << ",\n"
+      << "  \"stages\": {\n";
+  write_counter("eval", eval_stats_, false);
+  write_counter("trace", trace_stats_, extension_array_.empty());
+  for (size_t i = 0; i < extension_array_.size(); ++i) {
+    write_counter(GetExtensionName(extension_array_[i]) + "::OnClock",
+                  extension_stats_[i], i + 1 == extension_array_.size());
+  }
+  out << "  },\n"
+      << "  \"dpi\": {\n";
+  auto dpi_counters = SimStatsDpiCounters();
+  for (size_t i = 0; i < dpi_counters.size(); ++i) {
+    write_counter(dpi_counters[i].first, *dpi_counters[i].second,
+                  i + 1 == dpi_counters.size());
+  }
+  out << "  }\n"
+      << "}\n";
+
+  return out.good();
 }
 
 const char *VerilatorSimCtrl::GetTraceFileName() const {
@@ -272,7 +515,7 @@ const char *VerilatorSimCtrl::GetTraceFileName() const {
 }
 
 void VerilatorSimCtrl::Run() {
-  assert(top_ && "Use SetTop() first.");
+  CurrentControllerScope current(this);
 
   // We always need to enable this as tracing can be enabled at runtime
   if (tracing_possible_) {
@@ -287,6 +530,7 @@ void VerilatorSimCtrl::Run() {
             << "Simulation running, end by pressing CTRL-c." << std::endl;
 
   time_begin_ = std::chrono::steady_clock::now();
+  ticks_begin_ = sim_stats_timestamp();
   UnsetReset();
   Trace();
 
@@ -306,17 +550,23 @@ void VerilatorSimCtrl::Run() {
 
     // Call all extension on-clock methods
     if (*sig_clk_) {
-      for (auto it = extension_array_.begin(); it != extension_array_.end();
-           ++it) {
-        (*it)->OnClock(time_);
+      for (size_t i = 0; i < extension_array_.size(); ++i) {
+        uint64_t ext_start = sim_stats_timestamp();
+        extension_array_[i]->OnClock(time_);
+        sim_stats_record(&extension_stats_[i], ext_start);
       }
     }
 
+    uint64_t eval_start = sim_stats_timestamp();
     top_->eval();
+    sim_stats_record(&eval_stats_, eval_start);
     time_++;
 
+    uint64_t trace_start = sim_stats_timestamp();
     Trace();
+    sim_stats_record(&trace_stats_, trace_start);
 
+    HandleSignals();
     if (request_stop_) {
       std::cout << "Received stop request, shutting down simulation."
                 << std::endl;
@@ -336,6 +586,7 @@ void VerilatorSimCtrl::Run() {
 
   top_->final();
   time_end_ = std::chrono::steady_clock::now();
+  ticks_end_ = sim_stats_timestamp();
 
   if (TracingEverEnabled()) {
     tracer_.close();
@@ -355,6 +606,10 @@ unsigned int VerilatorSimCtrl::GetExecutionTimeMs() const {
       .count();
 }
 
+double VerilatorSimCtrl::GetExecutionTimeSeconds() const {
+  return std::chrono::duration<double>(time_end_ - time_begin_).count();
+}
+
 void VerilatorSimCtrl::SetReset() {
   if (flags_ & ResetPolarityNegative) {
     *sig_rst_ = 0;
@@ -5,11 +5,13 @@
 #ifndef OPENTITAN_HW_DV_VERILATOR_SIMUTIL_VERILATOR_CPP_VERILATOR_SIM_CTRL_H_
 #define OPENTITAN_HW_DV_VERILATOR_SIMUTIL_VERILATOR_CPP_VERILATOR_SIM_CTRL_H_
 
+#include <atomic>
 #include <chrono>
 #include <string>
 #include <vector>
 
 #include "sim_ctrl_extension.h"
+#include "sim_stats.h"
 #include "verilated_toplevel.h"
 
 enum VerilatorSimCtrlFlags {
@@ -19,32 +21,53 @@ enum VerilatorSimCtrlFlags {
 
 /**
  * Simulation controller for verilated simulations
+ *
+ * Each controller drives one top-level design. A process can contain several
+ * controllers, each with its own top-level, for example to run many small
+ * simulations from one process. Their top-levels must have different instance
+ * names (the name passed to the top-level's constructor, "TOP" by default),
+ * which is how DPI code finds its controller (see FromScope()).
  */
 class VerilatorSimCtrl {
  public:
   /**
-   * Get the simulation controller instance
+   * Constructor
    *
-   * @see SetTop()
+   * @param top      The top-level design, which must outlive this object
+   * @param sig_clk  The top-level clock input
+   * @param sig_rst  The top-level reset input
+   * @param flags    Options, such as the reset polarity
    */
-  static VerilatorSimCtrl &GetInstance();
+  VerilatorSimCtrl(VerilatedToplevel *top, CData *sig_clk, CData *sig_rst,
+                   VerilatorSimCtrlFlags flags = Defaults);
+  ~VerilatorSimCtrl();
 
   VerilatorSimCtrl(VerilatorSimCtrl const &) = delete;
   void operator=(VerilatorSimCtrl const &) = delete;
 
   /**
-   * Set the top-level design
+   * Find the controller of the design containing a SystemVerilog scope
+   *
+   * DPI code can pass the name of its scope, e.g. from
+   * svGetNameFromScope(svGetScope()) in a context import. Returns nullptr if
+   * no controller's top-level instance name matches the start of the scope.
    */
-  void SetTop(VerilatedToplevel *top, CData *sig_clk, CData *sig_rst,
-              VerilatorSimCtrlFlags flags = Defaults);
+  static VerilatorSimCtrl *FromScope(const char *scope_name);
+
+  /**
+   * Get the controller running a simulation on this thread
+   *
+   * If no simulation is running on this thread (e.g. when called from one of
+   * Verilator's worker threads) and the process has just one controller, that
+   * controller is returned. Otherwise, returns nullptr.
+   */
+  static VerilatorSimCtrl *Current();
 
   /**
    * Setup and run the simulation (all in one)
    *
    * Use this function as high-level entry point, suitable for most use cases.
    *
-   * SetTop() must be called before this function.
-   *
    * This function performs the following tasks:
    * 1. Parses a C-style set of command line arguments (see ParseCommandArgs())
    * 2. Runs the simulation (see RunSimulation())
@@ -73,7 +96,8 @@ class VerilatorSimCtrl {
    *
    * This function performs the following tasks:
    * 1. Sets up a signal handler to enable tracing to be turned on/off during
-   *    a run by sending SIGUSR1 to the process
+   *    a run by sending SIGUSR1 to the process. Signals apply to all
+   *    simulations running in the process.
    * 2. Prints some tracer-related helper messages
    * 3. Runs the simulation
    * 4. Prints some further helper messages and statistics once the simulation
@@ -112,6 +136,23 @@ class VerilatorSimCtrl {
    */
   unsigned long GetTime() const { return time_; }
 
+  /**
+   * Enable tracing (if possible)
+   *
+   * Enabling tracing can fail if no tracing support has been compiled into the
+   * simulation.
+   *
+   * @return Is tracing enabled?
+   */
+  bool TraceOn();
+
+  /**
+   * Disable tracing
+   *
+   * @return Is tracing enabled?
+   */
+  bool TraceOff();
+
  private:
   VerilatedToplevel *top_;
   CData *sig_clk_;
@@ -132,17 +173,27 @@ class VerilatorSimCtrl {
   int term_after_cycles_;
   std::vector<SimCtrlExtension *> extension_array_;
 
-  /**
-   * Default constructor
-   *
-   * Use GetInstance() instead.
-   */
-  VerilatorSimCtrl();
+  // Time spent in the main loop, in ticks from sim_stats_timestamp(). The
+  // extension counters are for OnClock() and match up with extension_array_.
+  uint64_t ticks_begin_;
+  uint64_t ticks_end_;
+  sim_stats_counter eval_stats_;
+  sim_stats_counter trace_stats_;
+  std::vector<sim_stats_counter> extension_stats_;
+  std::string stats_json_path_;
+
+  // The number of SIGINT and SIGUSR1 signals the process has received, and the
+  // counts this controller has acted on. Signals are counted by SignalHandler()
+  // and handled from the main loop by HandleSignals().
+  static std::atomic<unsigned int> sigint_count_;
+  static std::atomic<unsigned int> sigusr1_count_;
+  unsigned int sigint_seen_;
+  unsigned int sigusr1_seen_;
 
   /**
    * Register the signal handler
    */
-  void RegisterSignalHandler();
+  static void RegisterSignalHandler();
 
   /**
    * Signal handler callback
@@ -152,26 +203,14 @@ class VerilatorSimCtrl {
   static void SignalHandler(int sig);
 
   /**
-   * Print help how to use this tool
+   * Act on any signals received since the last call
    */
-  void PrintHelp() const;
+  void HandleSignals();
 
   /**
-   * Enable tracing (if possible)
-   *
-   * Enabling tracing can fail if no tracing support has been compiled into the
-   * simulation.
-   *
-   * @return Is tracing enabled?
-   */
-  bool TraceOn();
-
-  /**
-   * Disable tracing
-   *
-   * @return Is tracing enabled?
+   * Print help how to use this tool
    */
-  bool TraceOff();
+  void PrintHelp() const;
 
   /**
    * Is tracing currently enabled?
@@ -192,9 +231,26 @@ class VerilatorSimCtrl {
 
   /**
    * Print statistics about the simulation run
+   *
+   * As well as the simulation speed, this shows how the time was divided
+   * between evaluating the model, tracing and each extension, together with
+   * the time spent in any DPI calls that are counted with sim_stats.h.
    */
   void PrintStatistics() const;
 
+  /**
+   * Write the statistics printed by PrintStatistics() as JSON
+   *
+   * @return true on success
+   */
+  bool WriteStatisticsJson(const std::string &path) const;
+
+  /**
+   * Convert ticks from sim_stats_timestamp() into seconds, calibrating against
+   * the wallclock time of the run.
+   */
+  double TicksToSeconds(uint64_t ticks) const;
+
   /**
    * Get the file name of the trace file
    */
@@ -219,6 +275,12 @@ class VerilatorSimCtrl {
    */
   unsigned int GetExecutionTimeMs() const;
 
+  /**
+   * Get the wallclock execution time in seconds, at the resolution of the
+   * clock
+   */
+  double GetExecutionTimeSeconds() const;
+
   /**
    * Assert the reset signal
    */
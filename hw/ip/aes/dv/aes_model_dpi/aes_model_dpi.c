@@ -118,98 +118,181 @@ void c_dpi_aes_crypt_block(const unsigned char impl_i, const unsigned char op_i,
   return;
 }
 
-void c_dpi_aes_crypt_message(unsigned char impl_i, unsigned char op_i,
-                             const svBitVecVal *mode_i, const svBitVecVal *iv_i,
-                             const svBitVecVal *key_len_i,
-                             const svBitVecVal *key_i,
-                             const svOpenArrayHandle data_i,
-                             svOpenArrayHandle data_o) {
-  // Mask out unused bits as their value is undetermined.
-  const unsigned char impl = impl_i & impl_mask;
-  const unsigned char op = op_i & op_mask;
-  const crypto_mode_t mode = (crypto_mode_t)(*mode_i & mode_mask);
-  if (mode == kCryptoAesNone) {
-    printf(
-        "ERROR: Mode kCryptoAesNone not supported by c_dpi_aes_crypt_message");
-    return;
-  }
-
-  // key_len_i is one-hot encoded.
+/**
+ * State of a message stream, @see c_dpi_aes_stream_new.
+ */
+struct aes_dpi_stream {
+  unsigned char impl;
+  unsigned char op;
+  crypto_mode_t mode;
   int key_len;
+  unsigned char key[32];
+  // C model
+  aes_ctx_t aes_ctx;
+  unsigned char iv[16];
+  // OpenSSL/BoringSSL
+  crypto_stream_t *crypto_stream;
+  // Scratch buffers for moving data from/to the simulator
+  unsigned char *buf_in;
+  unsigned char *buf_out;
+  int buf_len;
+};
+
+/**
+ * Convert a one-hot encoded key length to bytes.
+ */
+static int aes_key_len_get(const svBitVecVal *key_len_i) {
   if ((*key_len_i & key_len_mask) == 0x1) {
-    key_len = 16;
+    return 16;
   } else if ((*key_len_i & key_len_mask) == 0x2) {
-    key_len = 24;
+    return 24;
   } else {  // 0x4
-    key_len = 32;
+    return 32;
   }
+}
 
-  if (impl == 0) {
-    // The C model is currently not supported.
-    printf(
-        "ERROR: c_dpi_aes_crypt_message() currently supports OpenSSL/BoringSSL "
-        "only\n");
-    return;
+/**
+ * Get 1D array of words (4x32bit) from simulator as 16 bytes.
+ */
+static void aes_iv_get(const svBitVecVal *iv_i, unsigned char *iv) {
+  for (int i = 0; i < 4; ++i) {
+    svBitVecVal value = iv_i[i];
+    iv[4 * i + 0] = (unsigned char)(value >> 0);
+    iv[4 * i + 1] = (unsigned char)(value >> 8);
+    iv[4 * i + 2] = (unsigned char)(value >> 16);
+    iv[4 * i + 3] = (unsigned char)(value >> 24);
+  }
+}
+
+void *c_dpi_aes_stream_new(unsigned char impl_i, unsigned char op_i,
+                           const svBitVecVal *mode_i,
+                           const svBitVecVal *key_len_i,
+                           const svBitVecVal *key_i) {
+  const crypto_mode_t mode = (crypto_mode_t)(*mode_i & mode_mask);
+  if (mode == kCryptoAesNone) {
+    printf("ERROR: Mode kCryptoAesNone not supported by c_dpi_aes_stream_new");
+    return NULL;
   }
 
-  // Get key from simulator.
+  struct aes_dpi_stream *stream =
+      (struct aes_dpi_stream *)calloc(1, sizeof(struct aes_dpi_stream));
+  assert(stream);
+
+  // Mask out unused bits as their value is undetermined.
+  stream->impl = impl_i & impl_mask;
+  stream->op = op_i & op_mask;
+  stream->mode = mode;
+  stream->key_len = aes_key_len_get(key_len_i);
   unsigned char *key = aes_key_get(key_i);
+  memcpy(stream->key, key, 32);
+  free(key);
 
-  // Modes other than ECB require an IV from the simulator.
-  unsigned char *iv = (unsigned char *)malloc(16 * sizeof(unsigned char));
-  assert(iv);
-  if (mode != kCryptoAesEcb) {
-    // iv_i is a 1D array of words (4x32bit), but we need 16 bytes.
-    svBitVecVal value;
-    for (int i = 0; i < 4; ++i) {
-      value = iv_i[i];
-      iv[4 * i + 0] = (unsigned char)(value >> 0);
-      iv[4 * i + 1] = (unsigned char)(value >> 8);
-      iv[4 * i + 2] = (unsigned char)(value >> 16);
-      iv[4 * i + 3] = (unsigned char)(value >> 24);
-    }
+  if (stream->impl == 0) {
+    aes_ctx_init(&stream->aes_ctx, stream->key, stream->key_len);
   } else {
-    memset(iv, 0, 16);
+    stream->crypto_stream =
+        crypto_stream_new(stream->key, stream->key_len, mode, stream->op);
+    assert(stream->crypto_stream);
   }
 
-  // Get message length.
-  int data_len = svSize(data_i, 1);
+  return stream;
+}
 
-  // Get input data from simulator.
-  unsigned char *ref_in = aes_data_unpacked_get(data_i);
+void c_dpi_aes_stream_start(void *stream_h, const svBitVecVal *iv_i) {
+  struct aes_dpi_stream *stream = (struct aes_dpi_stream *)stream_h;
+  assert(stream);
 
-  // Allocate output buffer.
-  unsigned char *ref_out =
-      (unsigned char *)malloc(data_len * sizeof(unsigned char));
-  assert(ref_out);
+  // Modes other than ECB require an IV from the simulator.
+  if (stream->mode != kCryptoAesEcb) {
+    aes_iv_get(iv_i, stream->iv);
+  } else {
+    memset(stream->iv, 0, 16);
+  }
 
-  // OpenSSL/BoringSSL
-  if ((int)data_len % 16) {
+  if (stream->impl != 0) {
+    crypto_stream_start(stream->crypto_stream, stream->iv);
+  }
+}
+
+void c_dpi_aes_stream_update(void *stream_h, const svOpenArrayHandle data_i,
+                             svOpenArrayHandle data_o) {
+  struct aes_dpi_stream *stream = (struct aes_dpi_stream *)stream_h;
+  assert(stream);
+
+  int data_len = svSize(data_i, 1);
+  if (data_len % 16) {
     printf(
         "ERROR: Message length must be a multiple of 16 bytes (the block "
         "size).\n");
     return;
   }
 
-  if (impl == 0) {
-    // The C model is currently not supported.
-    printf(
-        "ERROR: c_dpi_aes_crypt_message() currently supports OpenSSL/BoringSSL "
-        "only\n");
-  } else {  // OpenSSL/BoringSSL
-    if (!op) {
-      crypto_encrypt(ref_out, iv, ref_in, data_len, key, key_len, mode);
-    } else {
-      crypto_decrypt(ref_out, iv, ref_in, data_len, key, key_len, mode);
-    }
+  // Grow the scratch buffers as needed, they are kept for the next message.
+  if (data_len > stream->buf_len) {
+    stream->buf_in = (unsigned char *)realloc(stream->buf_in, data_len);
+    stream->buf_out = (unsigned char *)realloc(stream->buf_out, data_len);
+    assert(stream->buf_in && stream->buf_out);
+    stream->buf_len = data_len;
   }
 
-  // Write output data back to simulator, free ref_out.
-  aes_data_unpacked_put(data_o, ref_out);
+  aes_data_unpacked_read(data_i, stream->buf_in, data_len);
 
-  // Free memory.
-  free(iv);
+  if (stream->impl == 0) {
+    aes_ctx_crypt(&stream->aes_ctx, stream->op, stream->mode, stream->iv,
+                  stream->buf_in, data_len, stream->buf_out);
+  } else {
+    crypto_stream_update(stream->crypto_stream, stream->buf_out,
+                         stream->buf_in, data_len);
+  }
+
+  aes_data_unpacked_write(data_o, stream->buf_out, data_len);
+}
+
+void c_dpi_aes_stream_free(void *stream_h) {
+  struct aes_dpi_stream *stream = (struct aes_dpi_stream *)stream_h;
+  if (!stream) {
+    return;
+  }
+  crypto_stream_free(stream->crypto_stream);
+  free(stream->buf_in);
+  free(stream->buf_out);
+  free(stream);
+}
+
+void c_dpi_aes_crypt_message(unsigned char impl_i, unsigned char op_i,
+                             const svBitVecVal *mode_i, const svBitVecVal *iv_i,
+                             const svBitVecVal *key_len_i,
+                             const svBitVecVal *key_i,
+                             const svOpenArrayHandle data_i,
+                             svOpenArrayHandle data_o) {
+  // Consecutive messages often use the same key and mode. Keep the stream of
+  // the last message around so that its key expansion, cipher context and
+  // buffers can be reused.
+  static struct aes_dpi_stream *last_stream = NULL;
+
+  // Mask out unused bits as their value is undetermined.
+  const unsigned char impl = impl_i & impl_mask;
+  const unsigned char op = op_i & op_mask;
+  const crypto_mode_t mode = (crypto_mode_t)(*mode_i & mode_mask);
+  if (mode == kCryptoAesNone) {
+    printf(
+        "ERROR: Mode kCryptoAesNone not supported by c_dpi_aes_crypt_message");
+    return;
+  }
+  const int key_len = aes_key_len_get(key_len_i);
+  unsigned char *key = aes_key_get(key_i);
+
+  if (!last_stream || last_stream->impl != impl || last_stream->op != op ||
+      last_stream->mode != mode || last_stream->key_len != key_len ||
+      memcmp(last_stream->key, key, 32)) {
+    c_dpi_aes_stream_free(last_stream);
+    last_stream = (struct aes_dpi_stream *)c_dpi_aes_stream_new(
+        impl_i, op_i, mode_i, key_len_i, key_i);
+  }
   free(key);
+
+  c_dpi_aes_stream_start(last_stream, iv_i);
+  c_dpi_aes_stream_update(last_stream, data_i, data_o);
 }
 
 void c_dpi_aes_sub_bytes(const unsigned char op_i, const svBitVecVal *data_i,
@@ -342,10 +425,65 @@ void aes_data_put(svBitVecVal *data_o, unsigned char *data) {
   return;
 }
 
+/**
+ * Get the distance in bytes between consecutive elements of an open array, or
+ * 0 if the simulator does not expose the array as contiguous memory.
+ */
+static int aes_data_unpacked_stride(const svOpenArrayHandle data) {
+  if (svSize(data, 1) < 2 || !svGetArrayPtr(data)) {
+    return 0;
+  }
+  return (int)((char *)svGetArrElemPtr1(data, svLow(data, 1) + 1) -
+               (char *)svGetArrElemPtr1(data, svLow(data, 1)));
+}
+
+void aes_data_unpacked_read(const svOpenArrayHandle data_i,
+                            unsigned char *data, int len) {
+  const unsigned char *ptr = (const unsigned char *)svGetArrayPtr(data_i);
+  int stride = aes_data_unpacked_stride(data_i);
+
+  if (stride == 1) {
+    memcpy(data, ptr, len);
+  } else if (stride == sizeof(svBitVecVal)) {
+    // Canonical representation: one svBitVecVal per element.
+    const svBitVecVal *words = (const svBitVecVal *)ptr;
+    for (int i = 0; i < len; i++) {
+      data[i] = (unsigned char)words[i];
+    }
+  } else {
+    svBitVecVal value;
+    for (int i = 0; i < len; i++) {
+      svGetBitArrElem1VecVal(&value, data_i, i);
+      data[i] = (unsigned char)value;
+    }
+  }
+}
+
+void aes_data_unpacked_write(const svOpenArrayHandle data_o,
+                             const unsigned char *data, int len) {
+  unsigned char *ptr = (unsigned char *)svGetArrayPtr(data_o);
+  int stride = aes_data_unpacked_stride(data_o);
+
+  if (stride == 1) {
+    memcpy(ptr, data, len);
+  } else if (stride == sizeof(svBitVecVal)) {
+    // Canonical representation: one svBitVecVal per element.
+    svBitVecVal *words = (svBitVecVal *)ptr;
+    for (int i = 0; i < len; i++) {
+      words[i] = (svBitVecVal)data[i];
+    }
+  } else {
+    svBitVecVal value;
+    for (int i = 0; i < len; i++) {
+      value = (svBitVecVal)data[i];
+      svPutBitArrElem1VecVal(data_o, &value, i);
+    }
+  }
+}
+
 unsigned char *aes_data_unpacked_get(const svOpenArrayHandle data_i) {
   unsigned char *data;
   int len;
-  svBitVecVal value;
 
   // alloc data buffer
   len = svSize(data_i, 1);
@@ -353,27 +491,15 @@ unsigned char *aes_data_unpacked_get(const svOpenArrayHandle data_i) {
   assert(data);
 
   // get data from simulator
-  for (int i = 0; i < len; i++) {
-    svGetBitArrElem1VecVal(&value, data_i, i);
-    data[i] = (unsigned char)value;
-  }
+  aes_data_unpacked_read(data_i, data, len);
 
   return data;
 }
 
 void aes_data_unpacked_put(const svOpenArrayHandle data_o,
                            unsigned char *data) {
-  int len;
-  svBitVecVal value;
-
-  // get size of data buffer
-  len = svSize(data_o, 1);
-
   // write output data to simulation
-  for (int i = 0; i < len; i++) {
-    value = (svBitVecVal)data[i];
-    svPutBitArrElem1VecVal(data_o, &value, i);
-  }
+  aes_data_unpacked_write(data_o, data, svSize(data_o, 1));
 
   // free data
   free(data);
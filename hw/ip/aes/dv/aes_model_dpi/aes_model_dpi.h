@@ -41,7 +41,11 @@ void c_dpi_aes_crypt_block(const unsigned char impl_i, const unsigned char op_i,
                            svBitVecVal *data_o);
 
 /**
- * Perform encryption/decryption of an entire message using OpenSSL/BoringSSL.
+ * Perform encryption/decryption of an entire message.
+ *
+ * The stream of the previous call is kept and reused if the implementation,
+ * operation, mode and key match, which saves the key expansion and cipher
+ * context setup for back-to-back messages.
  *
  * @param  impl_i    Select reference impl.: 0 = C model, 1 = OpenSSL/BoringSSL
  * @param  op_i      Operation: 0 = encrypt, 1 = decrypt
@@ -62,6 +66,57 @@ void c_dpi_aes_crypt_message(unsigned char impl_i, unsigned char op_i,
                              const svOpenArrayHandle data_i,
                              svOpenArrayHandle data_o);
 
+/**
+ * Create a stream for encrypting/decrypting a sequence of messages with the
+ * same implementation, operation, mode and key.
+ *
+ * The key expansion (C model) or cipher context (OpenSSL/BoringSSL) is set up
+ * once here and reused for every message started on the stream.
+ *
+ * @param  impl_i    Select reference impl.: 0 = C model, 1 = OpenSSL/BoringSSL
+ * @param  op_i      Operation: 0 = encrypt, 1 = decrypt
+ * @param  mode_i    Cipher mode: 6'b00_0001 = ECB, 6'00_b0010 = CBC,
+ *                                6'b00_0100 = CFB, 6'b00_1000 = OFB,
+ *                                6'b01_0000 = CTR
+ * @param  key_len_i Key length: 3'b001 = 128b, 3'b010 = 192b, 3'b100 = 256b
+ * @param  key_i     Full input key, 1D array of words (2D packed array in SV)
+ * @return Stream handle, NULL in case of an error
+ */
+void *c_dpi_aes_stream_new(unsigned char impl_i, unsigned char op_i,
+                           const svBitVecVal *mode_i,
+                           const svBitVecVal *key_len_i,
+                           const svBitVecVal *key_i);
+
+/**
+ * Start a new message on a stream.
+ *
+ * @param  stream Stream handle
+ * @param  iv_i   Initialization vector: 1D array of words (2D packed array in
+ *                SV), ignored for ECB
+ */
+void c_dpi_aes_stream_start(void *stream, const svBitVecVal *iv_i);
+
+/**
+ * Encrypt/decrypt the next part of the current message of a stream.
+ *
+ * The chaining state is carried over between calls, so a message can be
+ * processed in several parts.
+ *
+ * @param  stream Stream handle
+ * @param  data_i Input data, 1D byte array (open array in SV), a multiple of
+ *                16 bytes
+ * @param  data_o Output data, 1D byte array (open array in SV)
+ */
+void c_dpi_aes_stream_update(void *stream, const svOpenArrayHandle data_i,
+                             svOpenArrayHandle data_o);
+
+/**
+ * Free a stream.
+ *
+ * @param  stream Stream handle, may be NULL
+ */
+void c_dpi_aes_stream_free(void *stream);
+
 /**
  * Perform sub bytes operation for forward/inverse cipher operation.
  *
@@ -123,6 +178,29 @@ unsigned char *aes_data_get(const svBitVecVal *data_i);
  */
 void aes_data_put(svBitVecVal *data_o, unsigned char *data);
 
+/**
+ * Copy unpacked data from simulation into a buffer.
+ *
+ * The data is copied in bulk if the simulator exposes the array as contiguous
+ * memory, and element by element otherwise.
+ *
+ * @param  data_i Input data from simulation
+ * @param  data   Destination buffer
+ * @param  len    Number of bytes to copy
+ */
+void aes_data_unpacked_read(const svOpenArrayHandle data_i,
+                            unsigned char *data, int len);
+
+/**
+ * Copy a buffer to unpacked data in simulation.
+ *
+ * @param  data_o Output data for simulation
+ * @param  data   Source buffer
+ * @param  len    Number of bytes to copy
+ */
+void aes_data_unpacked_write(const svOpenArrayHandle data_o,
+                             const unsigned char *data, int len);
+
 /**
  * Get unpacked data from simulation.
  *
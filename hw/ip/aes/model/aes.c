@@ -4,120 +4,296 @@
 
 #include <errno.h>
 #include <stdio.h>
-#include <stdlib.h>
 
 #include "aes.h"
 
-int aes_encrypt_block(const unsigned char *plain_text, const unsigned char *key,
-                      const int key_len, unsigned char *cipher_text) {
+// Tables combining SubBytes and MixColumns (encryption) or InvSubBytes and
+// InvMixColumns (decryption) for a byte in row 0 of a column. The tables for
+// rows 1 - 3 are the same, rotated left by 8, 16 and 24 bits.
+static uint32_t enc_table[256];
+static uint32_t dec_table[256];
+static int tables_ready = 0;
+
+static unsigned char aes_mul2(unsigned char in);
+
+static uint32_t rotl32(uint32_t x, int n) {
+  return (x << n) | (x >> (32 - n));
+}
+
+static uint32_t load_column(const unsigned char *in) {
+  return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) |
+         ((uint32_t)in[3] << 24);
+}
+
+static void store_column(unsigned char *out, uint32_t col) {
+  out[0] = col & 0xFF;
+  out[1] = (col >> 8) & 0xFF;
+  out[2] = (col >> 16) & 0xFF;
+  out[3] = (col >> 24) & 0xFF;
+}
+
+static void aes_tables_init(void) {
+  if (tables_ready) {
+    return;
+  }
+  for (int i = 0; i < 256; i++) {
+    // MixColumns row 0 coefficients (output rows 0 - 3): 2, 1, 1, 3
+    unsigned char s = sbox[i];
+    unsigned char s2 = aes_mul2(s);
+    enc_table[i] = (uint32_t)s2 | ((uint32_t)s << 8) | ((uint32_t)s << 16) |
+                   ((uint32_t)(s2 ^ s) << 24);
+
+    // InvMixColumns row 0 coefficients (output rows 0 - 3): e, 9, d, b
+    unsigned char t = inv_sbox[i];
+    unsigned char t2 = aes_mul2(t);
+    unsigned char t4 = aes_mul2(t2);
+    unsigned char t8 = aes_mul2(t4);
+    dec_table[i] = (uint32_t)(t8 ^ t4 ^ t2) | ((uint32_t)(t8 ^ t) << 8) |
+                   ((uint32_t)(t8 ^ t4 ^ t) << 16) |
+                   ((uint32_t)(t8 ^ t2 ^ t) << 24);
+  }
+  tables_ready = 1;
+}
+
+static uint32_t sub_word(uint32_t w) {
+  return (uint32_t)sbox[w & 0xFF] | ((uint32_t)sbox[(w >> 8) & 0xFF] << 8) |
+         ((uint32_t)sbox[(w >> 16) & 0xFF] << 16) |
+         ((uint32_t)sbox[w >> 24] << 24);
+}
+
+// InvMixColumns of a single column
+static uint32_t inv_mix_column(uint32_t w) {
+  // dec_table includes InvSubBytes, undo it by looking up sbox values
+  return dec_table[sbox[w & 0xFF]] ^
+         rotl32(dec_table[sbox[(w >> 8) & 0xFF]], 8) ^
+         rotl32(dec_table[sbox[(w >> 16) & 0xFF]], 16) ^
+         rotl32(dec_table[sbox[w >> 24]], 24);
+}
+
+int aes_ctx_init(aes_ctx_t *ctx, const unsigned char *key, const int key_len) {
   int num_rounds = aes_get_num_rounds(key_len);
   if (num_rounds < 0) {
-    printf("ERROR: aes_get_num_rounds() failed\n");
     return -EINVAL;
   }
+  aes_tables_init();
 
-  unsigned char rcon;
-  unsigned char state[16];
-  unsigned char round_key[16];
-  unsigned char *full_key =
-      (unsigned char *)malloc(key_len * sizeof(unsigned char));
-  if (full_key == NULL) {
-    printf("ERROR: malloc() failed\n");
-    return -ENOMEM;
-  }
+  ctx->key_len = key_len;
+  ctx->num_rounds = num_rounds;
 
-  // init
-  for (int i = 0; i < 16; i++) {
-    state[i] = plain_text[i];
-  }
-  for (int i = 0; i < key_len; i++) {
-    full_key[i] = key[i];
+  // Standard key expansion, see FIPS 197 Section 5.2
+  int num_k = key_len / 4;
+  int num_words = 4 * (num_rounds + 1);
+  uint32_t *w = ctx->enc_round_keys;
+  unsigned char rcon = 0;
+  for (int i = 0; i < num_k; i++) {
+    w[i] = load_column(&key[4 * i]);
   }
-  for (int i = 0; i < 16; i++) {
-    round_key[i] = full_key[i];
+  for (int i = num_k; i < num_words; i++) {
+    uint32_t temp = w[i - 1];
+    if (i % num_k == 0) {
+      aes_rcon_next(&rcon);
+      // RotWord moves byte 1 to byte 0
+      temp = sub_word(rotl32(temp, 24)) ^ rcon;
+    } else if (num_k > 6 && i % num_k == 4) {
+      temp = sub_word(temp);
+    }
+    w[i] = w[i - num_k] ^ temp;
   }
-  rcon = 0;
 
-  // ecnrypt
-  aes_add_round_key(state, round_key);
-  for (int j = 0; j < num_rounds; j++) {
-    aes_sub_bytes(state);
-    aes_shift_rows(state);
-    if (j < (num_rounds - 1)) {
-      aes_mix_columns(state);
+  // Round keys for the Equivalent Inverse Cipher, see FIPS 197 Section 5.3.5
+  uint32_t *dw = ctx->dec_round_keys;
+  for (int rnd = 0; rnd <= num_rounds; rnd++) {
+    for (int c = 0; c < 4; c++) {
+      uint32_t rk = w[4 * (num_rounds - rnd) + c];
+      if (rnd > 0 && rnd < num_rounds) {
+        rk = inv_mix_column(rk);
+      }
+      dw[4 * rnd + c] = rk;
     }
-    aes_key_expand(round_key, full_key, key_len, &rcon, j);
-    aes_add_round_key(state, round_key);
   }
 
-  // finish
-  for (int i = 0; i < 16; i++) {
-    cipher_text[i] = state[i];
+  return 0;
+}
+
+void aes_ctx_encrypt_block(const aes_ctx_t *ctx,
+                           const unsigned char *plain_text,
+                           unsigned char *cipher_text) {
+  const uint32_t *rk = ctx->enc_round_keys;
+  uint32_t s[4], t[4];
+
+  for (int c = 0; c < 4; c++) {
+    s[c] = load_column(&plain_text[4 * c]) ^ rk[c];
   }
 
-  free(full_key);
+  // SubBytes, ShiftRows and MixColumns: row r of output column c comes from
+  // input column c + r
+  for (int rnd = 1; rnd < ctx->num_rounds; rnd++) {
+    rk += 4;
+    for (int c = 0; c < 4; c++) {
+      t[c] = enc_table[s[c] & 0xFF] ^
+             rotl32(enc_table[(s[(c + 1) & 3] >> 8) & 0xFF], 8) ^
+             rotl32(enc_table[(s[(c + 2) & 3] >> 16) & 0xFF], 16) ^
+             rotl32(enc_table[s[(c + 3) & 3] >> 24], 24) ^ rk[c];
+    }
+    for (int c = 0; c < 4; c++) {
+      s[c] = t[c];
+    }
+  }
 
-  return 0;
+  // Final round without MixColumns
+  rk += 4;
+  for (int c = 0; c < 4; c++) {
+    t[c] = ((uint32_t)sbox[s[c] & 0xFF] |
+            ((uint32_t)sbox[(s[(c + 1) & 3] >> 8) & 0xFF] << 8) |
+            ((uint32_t)sbox[(s[(c + 2) & 3] >> 16) & 0xFF] << 16) |
+            ((uint32_t)sbox[s[(c + 3) & 3] >> 24] << 24)) ^
+           rk[c];
+  }
+  for (int c = 0; c < 4; c++) {
+    store_column(&cipher_text[4 * c], t[c]);
+  }
 }
 
-int aes_decrypt_block(const unsigned char *cipher_text,
-                      const unsigned char *key, const int key_len,
-                      unsigned char *plain_text) {
-  int num_rounds = aes_get_num_rounds(key_len);
-  if (num_rounds < 0) {
-    printf("ERROR: aes_get_num_rounds() failed\n");
-    return -EINVAL;
+void aes_ctx_decrypt_block(const aes_ctx_t *ctx,
+                           const unsigned char *cipher_text,
+                           unsigned char *plain_text) {
+  const uint32_t *rk = ctx->dec_round_keys;
+  uint32_t s[4], t[4];
+
+  for (int c = 0; c < 4; c++) {
+    s[c] = load_column(&cipher_text[4 * c]) ^ rk[c];
   }
 
-  unsigned char rcon;
-  unsigned char state[16];
-  unsigned char round_key[16];
-  unsigned char *full_key =
-      (unsigned char *)malloc(key_len * sizeof(unsigned char));
-  if (full_key == NULL) {
-    printf("ERROR: malloc() failed\n");
-    return -ENOMEM;
+  // InvSubBytes, InvShiftRows and InvMixColumns: row r of output column c
+  // comes from input column c - r
+  for (int rnd = 1; rnd < ctx->num_rounds; rnd++) {
+    rk += 4;
+    for (int c = 0; c < 4; c++) {
+      t[c] = dec_table[s[c] & 0xFF] ^
+             rotl32(dec_table[(s[(c + 3) & 3] >> 8) & 0xFF], 8) ^
+             rotl32(dec_table[(s[(c + 2) & 3] >> 16) & 0xFF], 16) ^
+             rotl32(dec_table[s[(c + 1) & 3] >> 24], 24) ^ rk[c];
+    }
+    for (int c = 0; c < 4; c++) {
+      s[c] = t[c];
+    }
   }
 
-  // init
-  for (int i = 0; i < 16; i++) {
-    state[i] = cipher_text[i];
+  // Final round without InvMixColumns
+  rk += 4;
+  for (int c = 0; c < 4; c++) {
+    t[c] = ((uint32_t)inv_sbox[s[c] & 0xFF] |
+            ((uint32_t)inv_sbox[(s[(c + 3) & 3] >> 8) & 0xFF] << 8) |
+            ((uint32_t)inv_sbox[(s[(c + 2) & 3] >> 16) & 0xFF] << 16) |
+            ((uint32_t)inv_sbox[s[(c + 1) & 3] >> 24] << 24)) ^
+           rk[c];
   }
-  for (int i = 0; i < key_len; i++) {
-    full_key[i] = key[i];
+  for (int c = 0; c < 4; c++) {
+    store_column(&plain_text[4 * c], t[c]);
   }
-  for (int i = 0; i < 16; i++) {
-    round_key[i] = full_key[i];
+}
+
+// Increment a 128-bit big-endian counter
+static void aes_ctr_inc(unsigned char *ctr) {
+  for (int i = 15; i >= 0; i--) {
+    if (++ctr[i]) {
+      break;
+    }
   }
-  rcon = 0;
+}
 
-  // get decryption start key
-  for (int j = 0; j < num_rounds; j++) {
-    aes_key_expand(round_key, full_key, key_len, &rcon, j);
+int aes_ctx_crypt(const aes_ctx_t *ctx, const int decrypt,
+                  const crypto_mode_t mode, unsigned char *iv,
+                  const unsigned char *input, const int len,
+                  unsigned char *output) {
+  if (len % 16) {
+    printf("ERROR: len = %i is not a multiple of the block size\n", len);
+    return -EINVAL;
   }
-  rcon = 0;
 
-  // decrypt - using Equivalent Inverse Cipher
-  aes_add_round_key(state, round_key);
-  for (int j = 0; j < num_rounds; j++) {
-    aes_inv_sub_bytes(state);
-    aes_inv_shift_rows(state);
-    if (j < (num_rounds - 1)) {
-      aes_inv_mix_columns(state);
-    }
-    aes_inv_key_expand(round_key, full_key, key_len, &rcon, j);
-    if (j < (num_rounds - 1)) {
-      aes_inv_mix_columns(round_key);
+  unsigned char block[16];
+  for (int offset = 0; offset < len; offset += 16) {
+    const unsigned char *in = &input[offset];
+    unsigned char *out = &output[offset];
+
+    if (mode == kCryptoAesEcb) {
+      if (!decrypt) {
+        aes_ctx_encrypt_block(ctx, in, out);
+      } else {
+        aes_ctx_decrypt_block(ctx, in, out);
+      }
+    } else if (mode == kCryptoAesCbc) {
+      if (!decrypt) {
+        for (int i = 0; i < 16; i++) {
+          block[i] = in[i] ^ iv[i];
+        }
+        aes_ctx_encrypt_block(ctx, block, out);
+        for (int i = 0; i < 16; i++) {
+          iv[i] = out[i];
+        }
+      } else {
+        // keep the cipher text, out may alias in
+        for (int i = 0; i < 16; i++) {
+          block[i] = in[i];
+        }
+        aes_ctx_decrypt_block(ctx, block, out);
+        for (int i = 0; i < 16; i++) {
+          out[i] ^= iv[i];
+          iv[i] = block[i];
+        }
+      }
+    } else if (mode == kCryptoAesCfb) {
+      // the cipher text is fed back in both directions
+      aes_ctx_encrypt_block(ctx, iv, block);
+      for (int i = 0; i < 16; i++) {
+        unsigned char cipher = decrypt ? in[i] : in[i] ^ block[i];
+        out[i] = in[i] ^ block[i];
+        iv[i] = cipher;
+      }
+    } else if (mode == kCryptoAesOfb) {
+      aes_ctx_encrypt_block(ctx, iv, iv);
+      for (int i = 0; i < 16; i++) {
+        out[i] = in[i] ^ iv[i];
+      }
+    } else if (mode == kCryptoAesCtr) {
+      aes_ctx_encrypt_block(ctx, iv, block);
+      aes_ctr_inc(iv);
+      for (int i = 0; i < 16; i++) {
+        out[i] = in[i] ^ block[i];
+      }
+    } else {
+      printf("ERROR: mode = %i not supported\n", mode);
+      return -EINVAL;
     }
-    aes_add_round_key(state, round_key);
   }
 
-  // finish
-  for (int i = 0; i < 16; i++) {
-    plain_text[i] = state[i];
+  return 0;
+}
+
+int aes_encrypt_block(const unsigned char *plain_text, const unsigned char *key,
+                      const int key_len, unsigned char *cipher_text) {
+  aes_ctx_t ctx;
+  if (aes_ctx_init(&ctx, key, key_len)) {
+    printf("ERROR: aes_ctx_init() failed\n");
+    return -EINVAL;
   }
 
-  free(full_key);
+  aes_ctx_encrypt_block(&ctx, plain_text, cipher_text);
+
+  return 0;
+}
+
+int aes_decrypt_block(const unsigned char *cipher_text,
+                      const unsigned char *key, const int key_len,
+                      unsigned char *plain_text) {
+  aes_ctx_t ctx;
+  if (aes_ctx_init(&ctx, key, key_len)) {
+    printf("ERROR: aes_ctx_init() failed\n");
+    return -EINVAL;
+  }
+
+  aes_ctx_decrypt_block(&ctx, cipher_text, plain_text);
+
   return 0;
 }
 
@@ -352,11 +528,7 @@ void aes_key_expand(unsigned char *round_key, unsigned char *key, int key_len,
   //       for key_len == 16, key == round_key
 
   unsigned char temp[4];
-  unsigned char *old_key;
-  old_key = (unsigned char *)malloc(key_len * sizeof(unsigned char));
-  if (!old_key) {
-    printf("ERROR: malloc() failed.");
-  }
+  unsigned char old_key[32];
 
   // copy key to temp
   for (int i = 0; i < key_len; i++) {
@@ -648,8 +820,6 @@ void aes_key_expand(unsigned char *round_key, unsigned char *key, int key_len,
     round_key[i] = key[key_len - 16 + i];
   }
 
-  free(old_key);
-
   return;
 }
 
@@ -663,11 +833,7 @@ void aes_inv_key_expand(unsigned char *round_key, unsigned char *key,
   //       for key_len == 16, key == round_key
 
   unsigned char temp[4];
-  unsigned char *old_key;
-  old_key = (unsigned char *)malloc(key_len * sizeof(unsigned char));
-  if (!old_key) {
-    printf("ERROR: malloc() failed.");
-  }
+  unsigned char old_key[32];
 
   // copy key to temp
   for (int i = 0; i < key_len; i++) {
@@ -951,8 +1117,6 @@ void aes_inv_key_expand(unsigned char *round_key, unsigned char *key,
     round_key[i] = key[i];
   }
 
-  free(old_key);
-
   return;
 }
 
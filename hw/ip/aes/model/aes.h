@@ -5,9 +5,96 @@
 #ifndef AES_H_
 #define AES_H_
 
+#include <stdint.h>
+
+#include "crypto.h"
+
+/**
+ * Maximum number of cipher rounds (AES-256)
+ */
+#define AES_MAX_NUM_ROUNDS 14
+
+/**
+ * AES context holding a fully expanded key
+ *
+ * Initialize with aes_ctx_init() once per key, then encrypt or decrypt any
+ * number of blocks. The round keys are stored as 32-bit column words (byte 0
+ * of the column in the least significant byte).
+ */
+typedef struct aes_ctx {
+  int key_len;
+  int num_rounds;
+  // Round keys for encryption, round 0 first
+  uint32_t enc_round_keys[4 * (AES_MAX_NUM_ROUNDS + 1)];
+  // Round keys for the Equivalent Inverse Cipher, round 0 first
+  uint32_t dec_round_keys[4 * (AES_MAX_NUM_ROUNDS + 1)];
+} aes_ctx_t;
+
+/**
+ * Expand a key into an AES context.
+ *
+ * @param  ctx     Context to initialize
+ * @param  key     Initial encryption key
+ * @param  key_len Key length in bytes (16, 24, 32)
+ * @return 0 on success, -EINVAL for unsupported key lengths
+ */
+int aes_ctx_init(aes_ctx_t *ctx, const unsigned char *key, const int key_len);
+
+/**
+ * Encrypt one data block (16 Bytes) in ECB mode using an expanded key.
+ *
+ * Uses a table-driven implementation that combines SubBytes, ShiftRows and
+ * MixColumns. Use the round-by-round functions below to inspect intermediate
+ * state.
+ *
+ * @param  ctx         Context initialized with aes_ctx_init()
+ * @param  plain_text  Input block to encrypt
+ * @param  cipher_text Encrypted output block, may alias plain_text
+ */
+void aes_ctx_encrypt_block(const aes_ctx_t *ctx,
+                           const unsigned char *plain_text,
+                           unsigned char *cipher_text);
+
+/**
+ * Decrypt one data block (16 Bytes) in ECB mode using an expanded key.
+ *
+ * @param  ctx         Context initialized with aes_ctx_init()
+ * @param  cipher_text Encrypted input block
+ * @param  plain_text  Decrypted output block, may alias cipher_text
+ */
+void aes_ctx_decrypt_block(const aes_ctx_t *ctx,
+                           const unsigned char *cipher_text,
+                           unsigned char *plain_text);
+
+/**
+ * Encrypt or decrypt a message in any cipher mode using an expanded key.
+ *
+ * The chaining value (IV, previous cipher text block or counter) is updated in
+ * place, so a long message can be processed in several calls. For messages
+ * that are a multiple of the block size, the result matches crypto_encrypt()
+ * and crypto_decrypt().
+ *
+ * @param  ctx     Context initialized with aes_ctx_init()
+ * @param  decrypt 0 = encrypt, 1 = decrypt
+ * @param  mode    AES cipher mode @see crypto_mode.
+ * @param  iv      16-byte chaining value, updated for the next call; ignored
+ *                 for ECB
+ * @param  input   Input data
+ * @param  len     Length of input data in bytes, must be a multiple of 16
+ * @param  output  Output data, may alias input
+ * @return 0 on success, -EINVAL otherwise
+ */
+int aes_ctx_crypt(const aes_ctx_t *ctx, const int decrypt,
+                  const crypto_mode_t mode, unsigned char *iv,
+                  const unsigned char *input, const int len,
+                  unsigned char *output);
+
 /**
  * Encrypt one data block (16 Bytes) in ECB mode.
  *
+ * Expands the key on every call, use aes_ctx_init() and
+ * aes_ctx_encrypt_block() to encrypt several blocks with the same key.
+ *
  * @param  plain_text  Input block to enrypt
  * @param  key         Initial encryption key
  * @param  key_len     Key length in bytes (16, 24, 32)
@@ -20,6 +107,9 @@ int aes_encrypt_block(const unsigned char *plain_text, const unsigned char *key,
 /**
  * Decrypt one data block (16 Bytes) in ECB mode.
  *
+ * Expands the key on every call, use aes_ctx_init() and
+ * aes_ctx_decrypt_block() to decrypt several blocks with the same key.
+ *
  * @param  plain_text  Encrypted input block
  * @param  key         Initial encryption key
  * @param  key_len     Key length in bytes (16, 24, 32)
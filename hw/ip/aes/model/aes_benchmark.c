@@ -0,0 +1,162 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "aes.h"
+
+#include "crypto.h"
+
+#define NUM_CHECK_BLOCKS 1000
+#define NUM_BENCH_BLOCKS (1 << 16)
+
+// Round-by-round encryption as used for inspecting intermediate state,
+// including the key expansion for every block.
+static void encrypt_block_rounds(const unsigned char *plain_text,
+                                 const unsigned char *key, const int key_len,
+                                 unsigned char *cipher_text) {
+  int num_rounds = aes_get_num_rounds(key_len);
+  unsigned char rcon = 0;
+  unsigned char full_key[32];
+  unsigned char round_key[16];
+
+  memcpy(cipher_text, plain_text, 16);
+  memcpy(full_key, key, key_len);
+  memcpy(round_key, key, 16);
+
+  aes_add_round_key(cipher_text, round_key);
+  for (int j = 0; j < num_rounds; j++) {
+    aes_sub_bytes(cipher_text);
+    aes_shift_rows(cipher_text);
+    if (j < (num_rounds - 1)) {
+      aes_mix_columns(cipher_text);
+    }
+    aes_key_expand(round_key, full_key, key_len, &rcon, j);
+    aes_add_round_key(cipher_text, round_key);
+  }
+}
+
+static void fill_random(unsigned char *data, int len) {
+  for (int i = 0; i < len; i++) {
+    data[i] = rand() & 0xFF;
+  }
+}
+
+static double seconds_since(const struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+static void print_rate(const char *name, int num_blocks, double secs) {
+  printf("  %-28s %12.0f blocks/s\n", name, num_blocks / secs);
+}
+
+// Check the context API against the round-by-round model for random keys and
+// blocks, in both directions.
+static int check_ctx(const int key_len) {
+  unsigned char key[32];
+  unsigned char in[16], ref[16], out[16];
+  aes_ctx_t ctx;
+
+  for (int i = 0; i < NUM_CHECK_BLOCKS; i++) {
+    fill_random(key, key_len);
+    fill_random(in, 16);
+    if (aes_ctx_init(&ctx, key, key_len)) {
+      return 1;
+    }
+    encrypt_block_rounds(in, key, key_len, ref);
+    aes_ctx_encrypt_block(&ctx, in, out);
+    if (memcmp(ref, out, 16)) {
+      printf("ERROR: encryption mismatch for key length %d\n", key_len);
+      return 1;
+    }
+    aes_ctx_decrypt_block(&ctx, ref, out);
+    if (memcmp(in, out, 16)) {
+      printf("ERROR: decryption mismatch for key length %d\n", key_len);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static int bench(const int key_len) {
+  unsigned char key[32];
+  unsigned char iv[16] = {0};
+  unsigned char *data = (unsigned char *)malloc(16 * NUM_BENCH_BLOCKS);
+  unsigned char *out = (unsigned char *)malloc(16 * NUM_BENCH_BLOCKS);
+  if (data == NULL || out == NULL) {
+    printf("ERROR: malloc() failed\n");
+    free(data);
+    free(out);
+    return 1;
+  }
+  fill_random(key, key_len);
+  fill_random(data, 16 * NUM_BENCH_BLOCKS);
+
+  struct timespec start;
+  aes_ctx_t ctx;
+
+  printf("AES-%d:\n", key_len * 8);
+
+  // The round-by-round model is much slower, time fewer blocks.
+  int num_blocks = NUM_BENCH_BLOCKS / 16;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < num_blocks; i++) {
+    encrypt_block_rounds(&data[16 * i], key, key_len, &out[16 * i]);
+  }
+  print_rate("round-by-round encrypt", num_blocks, seconds_since(&start));
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < NUM_BENCH_BLOCKS; i++) {
+    aes_encrypt_block(&data[16 * i], key, key_len, &out[16 * i]);
+  }
+  print_rate("aes_encrypt_block", NUM_BENCH_BLOCKS, seconds_since(&start));
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  aes_ctx_init(&ctx, key, key_len);
+  for (int i = 0; i < NUM_BENCH_BLOCKS; i++) {
+    aes_ctx_encrypt_block(&ctx, &data[16 * i], &out[16 * i]);
+  }
+  print_rate("aes_ctx_encrypt_block", NUM_BENCH_BLOCKS, seconds_since(&start));
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < NUM_BENCH_BLOCKS; i++) {
+    aes_ctx_decrypt_block(&ctx, &data[16 * i], &out[16 * i]);
+  }
+  print_rate("aes_ctx_decrypt_block", NUM_BENCH_BLOCKS, seconds_since(&start));
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  crypto_encrypt(out, iv, data, 16 * NUM_BENCH_BLOCKS, key, key_len,
+                 kCryptoAesEcb);
+  print_rate("crypto_encrypt (library)", NUM_BENCH_BLOCKS,
+             seconds_since(&start));
+
+  free(data);
+  free(out);
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  srand(0);
+
+  for (int key_len = 16; key_len <= 32; key_len += 8) {
+    if (check_ctx(key_len)) {
+      return 1;
+    }
+  }
+  printf("SUCCESS: Context API matches round-by-round model.\n\n");
+
+  for (int key_len = 16; key_len <= 32; key_len += 8) {
+    if (bench(key_len)) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
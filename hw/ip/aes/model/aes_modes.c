@@ -118,6 +118,70 @@ static int crypto_compare(const unsigned char *cipher_text,
   return 0;
 }
 
+// Checks the C model and a persistent library context. The message is
+// processed in two halves to check that the chaining state carries over.
+static int stream_compare(const unsigned char *cipher_text,
+                          const unsigned char *iv,
+                          const unsigned char *plain_text, int len,
+                          const unsigned char *key, int key_len,
+                          crypto_mode_t mode) {
+  const int half = len / 2;
+  unsigned char chain[16];
+  aes_ctx_t aes_ctx;
+
+  unsigned char *data_out =
+      (unsigned char *)malloc(len * sizeof(unsigned char));
+  if (data_out == NULL) {
+    printf("ERROR: malloc() failed\n");
+    return 1;
+  }
+  if (aes_ctx_init(&aes_ctx, key, key_len)) {
+    return 1;
+  }
+
+  for (int op = 0; op < 2; ++op) {
+    const unsigned char *data_in = op ? cipher_text : plain_text;
+    const unsigned char *expected = op ? plain_text : cipher_text;
+    const char *op_name = op ? "decrypt" : "encrypt";
+
+    // C model
+    memcpy(chain, iv, 16);
+    if (aes_ctx_crypt(&aes_ctx, op, mode, chain, data_in, half, data_out) ||
+        aes_ctx_crypt(&aes_ctx, op, mode, chain, &data_in[half], len - half,
+                      &data_out[half])) {
+      return 1;
+    }
+    if (memcmp(data_out, expected, len)) {
+      printf("ERROR: C model %s output does not match NIST example\n",
+             op_name);
+      return 1;
+    }
+    printf("SUCCESS: C model %s output matches NIST example\n", op_name);
+
+    // Persistent library context
+    crypto_stream_t *stream = crypto_stream_new(key, key_len, mode, op);
+    if (stream == NULL || crypto_stream_start(stream, iv) ||
+        crypto_stream_update(stream, data_out, data_in, half) != half ||
+        crypto_stream_update(stream, &data_out[half], &data_in[half],
+                             len - half) != len - half) {
+      crypto_stream_free(stream);
+      return 1;
+    }
+    crypto_stream_free(stream);
+    if (memcmp(data_out, expected, len)) {
+      printf("ERROR: %s stream %s output does not match NIST example\n",
+             crypto_lib, op_name);
+      return 1;
+    }
+    printf("SUCCESS: %s stream %s output matches NIST example\n", crypto_lib,
+           op_name);
+  }
+
+  free(data_out);
+
+  return 0;
+}
+
 int main(int argc, char *argv[]) {
   const int len = 64;
   int key_len;
@@ -151,6 +215,8 @@ int main(int argc, char *argv[]) {
     }
 
     if (crypto_compare(cipher_text, iv, kAesModesPlainText, len, key, key_len,
+                       mode) ||
+        stream_compare(cipher_text, iv, kAesModesPlainText, len, key, key_len,
                        mode)) {
       return 1;
     }
@@ -181,6 +247,8 @@ int main(int argc, char *argv[]) {
     }
 
     if (crypto_compare(cipher_text, iv, kAesModesPlainText, len, key, key_len,
+                       mode) ||
+        stream_compare(cipher_text, iv, kAesModesPlainText, len, key, key_len,
                        mode)) {
       return 1;
     }
@@ -212,6 +280,8 @@ int main(int argc, char *argv[]) {
     }
 
     if (crypto_compare(cipher_text, iv, kAesModesPlainText, len, key, key_len,
+                       mode) ||
+        stream_compare(cipher_text, iv, kAesModesPlainText, len, key, key_len,
                        mode)) {
       return 1;
     }
@@ -242,6 +312,8 @@ int main(int argc, char *argv[]) {
     }
 
     if (crypto_compare(cipher_text, iv, kAesModesPlainText, len, key, key_len,
+                       mode) ||
+        stream_compare(cipher_text, iv, kAesModesPlainText, len, key, key_len,
                        mode)) {
       return 1;
     }
@@ -272,6 +344,8 @@ int main(int argc, char *argv[]) {
     }
 
     if (crypto_compare(cipher_text, iv, kAesModesPlainText, len, key, key_len,
+                       mode) ||
+        stream_compare(cipher_text, iv, kAesModesPlainText, len, key, key_len,
                        mode)) {
       return 1;
     }
@@ -4,6 +4,8 @@
 
 #include <openssl/conf.h>
 #include <openssl/evp.h>
+#include <stdio.h>
+#include <stdlib.h>
 
 #include "crypto.h"
 
@@ -162,3 +164,75 @@ int crypto_decrypt(unsigned char *output, const unsigned char *iv,
 
   return output_len;
 }
+
+struct crypto_stream {
+  EVP_CIPHER_CTX *ctx;
+  int decrypt;
+};
+
+crypto_stream_t *crypto_stream_new(const unsigned char *key, int key_len,
+                                   crypto_mode_t mode, int decrypt) {
+  crypto_stream_t *stream = (crypto_stream_t *)malloc(sizeof(crypto_stream_t));
+  if (!stream) {
+    printf("ERROR: malloc() failed\n");
+    return NULL;
+  }
+  stream->decrypt = decrypt;
+
+  // Create new cipher context
+  stream->ctx = EVP_CIPHER_CTX_new();
+  if (!stream->ctx) {
+    printf("ERROR: Creation of cipher context failed\n");
+    free(stream);
+    return NULL;
+  }
+
+  // Init context with cipher and key, the IV is set per message
+  const EVP_CIPHER *cipher = crypto_get_EVP_cipher(key_len, mode);
+  int ret = EVP_CipherInit_ex(stream->ctx, cipher, NULL, key, NULL, !decrypt);
+  if (ret != 1) {
+    printf("ERROR: Initialization of cipher context failed\n");
+    crypto_stream_free(stream);
+    return NULL;
+  }
+
+  // Disable padding - It is safe to do so here because we only ever process
+  // multiples of 16 bytes (the block size).
+  EVP_CIPHER_CTX_set_padding(stream->ctx, 0);
+
+  return stream;
+}
+
+int crypto_stream_start(crypto_stream_t *stream, const unsigned char *iv) {
+  // Passing NULL for cipher and key keeps them, and resets the chaining state
+  int ret =
+      EVP_CipherInit_ex(stream->ctx, NULL, NULL, NULL, iv, !stream->decrypt);
+  if (ret != 1) {
+    printf("ERROR: Setting IV of cipher context failed\n");
+    return -1;
+  }
+
+  return 0;
+}
+
+int crypto_stream_update(crypto_stream_t *stream, unsigned char *output,
+                         const unsigned char *input, int input_len) {
+  int output_len;
+
+  int ret =
+      EVP_CipherUpdate(stream->ctx, output, &output_len, input, input_len);
+  if (ret != 1) {
+    printf("ERROR: Cipher operation failed\n");
+    return -1;
+  }
+
+  return output_len;
+}
+
+void crypto_stream_free(crypto_stream_t *stream) {
+  if (!stream) {
+    return;
+  }
+  EVP_CIPHER_CTX_free(stream->ctx);
+  free(stream);
+}
@@ -51,4 +51,53 @@ int crypto_decrypt(unsigned char *output, const unsigned char *iv,
                    const unsigned char *input, int input_len,
                    const unsigned char *key, int key_len, crypto_mode_t mode);
 
+/**
+ * Persistent BoringSSL/OpenSSL cipher context for one key, mode and direction
+ */
+typedef struct crypto_stream crypto_stream_t;
+
+/**
+ * Create a persistent cipher context
+ *
+ * The key is expanded once; use crypto_stream_start() to begin each message
+ * and crypto_stream_update() to process it in one or more chunks.
+ *
+ * @param  key     Encryption key
+ * @param  key_len Encryption key length in bytes (16, 24, 32)
+ * @param  mode    AES cipher mode @see crypto_mode.
+ * @param  decrypt 0 = encrypt, 1 = decrypt
+ * @return Pointer to the context, NULL in case of error
+ */
+crypto_stream_t *crypto_stream_new(const unsigned char *key, int key_len,
+                                   crypto_mode_t mode, int decrypt);
+
+/**
+ * Start a new message, keeping the key
+ *
+ * @param  stream Context created with crypto_stream_new()
+ * @param  iv     16-byte initialization vector
+ * @return 0 on success, -1 in case of error
+ */
+int crypto_stream_start(crypto_stream_t *stream, const unsigned char *iv);
+
+/**
+ * Encrypt/decrypt the next chunk of the current message
+ *
+ * @param  stream    Context created with crypto_stream_new()
+ * @param  output    Output data, must be a multiple of 16 bytes
+ * @param  input     Input data, must be a multiple of 16 bytes
+ * @param  input_len Length of the input data in bytes, must be a multiple
+ *                   of 16
+ * @return Length of the output data in bytes, -1 in case of error
+ */
+int crypto_stream_update(crypto_stream_t *stream, unsigned char *output,
+                         const unsigned char *input, int input_len);
+
+/**
+ * Free a persistent cipher context
+ *
+ * @param  stream Context created with crypto_stream_new(), may be NULL
+ */
+void crypto_stream_free(crypto_stream_t *stream);
+
 #endif  // OPENTITAN_HW_IP_AES_MODEL_CRYPTO_H_
@@ -0,0 +1,295 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+//
+// AES SBox sweep
+//
+// Checks all S-Box implementations instantiated in aes_sbox_lanes against a
+// C++ reference, for every input in both directions and many mask values.
+// aes_sbox_lanes is purely combinational, so no clock is simulated: each
+// eval() computes kNumLanes independent stimuli on all implementations at once.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "Vaes_sbox_lanes.h"
+#include "verilated.h"
+
+// Must match the NumLanes parameter of aes_sbox_lanes.
+static const int kNumLanes = 32;
+static const int kNumImpls = 4;
+// Must match aes_pkg::WidthPRDSBox.
+static const int kWidthPRDSBox = 10;
+// Number of mismatches reported in detail per implementation.
+static const int kMaxReportedMismatches = 10;
+
+static const char *const kImplNames[kNumImpls] = {
+    "LUT", "Canright", "Masked Canright (no reuse)", "Masked Canright"};
+
+static_assert(sizeof(Vaes_sbox_lanes::data_i) == kNumLanes,
+              "kNumLanes does not match the NumLanes parameter");
+
+namespace {
+
+/**
+ * Reference forward and inverse S-Box tables.
+ */
+struct SBoxRef {
+  uint8_t fwd[256];
+  uint8_t inv[256];
+
+  SBoxRef() {
+    for (int x = 0; x < 256; ++x) {
+      // Multiplicative inverse in GF(2^8), 0 maps to 0.
+      uint8_t x_inv = 0;
+      for (int y = 1; y < 256 && x != 0; ++y) {
+        if (GfMul(x, y) == 1) {
+          x_inv = y;
+          break;
+        }
+      }
+      // Affine transformation.
+      uint8_t s = x_inv;
+      for (int i = 1; i < 5; ++i) {
+        s ^= static_cast<uint8_t>((x_inv << i) | (x_inv >> (8 - i)));
+      }
+      s ^= 0x63;
+      fwd[x] = s;
+      inv[s] = x;
+    }
+  }
+
+  static uint8_t GfMul(uint8_t a, uint8_t b) {
+    uint8_t p = 0;
+    while (b) {
+      if (b & 1) {
+        p ^= a;
+      }
+      a = (a << 1) ^ ((a & 0x80) ? 0x1b : 0);
+      b >>= 1;
+    }
+    return p;
+  }
+};
+
+/**
+ * Writes `width` bits of `value` at bit `pos` of a wide Verilator port.
+ */
+void SetBits(uint32_t *port, int pos, int width, uint32_t value) {
+  for (int i = 0; i < width; ++i, ++pos) {
+    uint32_t mask = 1u << (pos % 32);
+    if ((value >> i) & 1) {
+      port[pos / 32] |= mask;
+    } else {
+      port[pos / 32] &= ~mask;
+    }
+  }
+}
+
+uint8_t GetByte(const uint32_t *port, int byte_index) {
+  return port[byte_index / 4] >> (8 * (byte_index % 4));
+}
+
+struct Stimulus {
+  bool inv;
+  uint8_t data;
+  uint8_t in_mask;
+  uint8_t out_mask;
+  uint32_t prd;
+};
+
+class SBoxSweep {
+ public:
+  explicit SBoxSweep(Vaes_sbox_lanes *top) : top_(top) {
+    std::memset(mismatches_, 0, sizeof(mismatches_));
+  }
+
+  /**
+   * Queues a stimulus, evaluating the model once all lanes are filled.
+   */
+  void Add(const Stimulus &stim) {
+    stimuli_[num_pending_++] = stim;
+    if (num_pending_ == kNumLanes) {
+      Flush();
+    }
+  }
+
+  /**
+   * Evaluates any queued stimuli.
+   */
+  void Flush() {
+    if (num_pending_ == 0) {
+      return;
+    }
+    // Unused lanes repeat the first stimulus.
+    for (int l = num_pending_; l < kNumLanes; ++l) {
+      stimuli_[l] = stimuli_[0];
+    }
+
+    uint32_t op = 0;
+    for (int l = 0; l < kNumLanes; ++l) {
+      const Stimulus &stim = stimuli_[l];
+      op |= static_cast<uint32_t>(stim.inv) << l;
+      SetBits(&top_->data_i[0], 8 * l, 8, stim.data);
+      SetBits(&top_->in_mask_i[0], 8 * l, 8, stim.in_mask);
+      SetBits(&top_->out_mask_i[0], 8 * l, 8, stim.out_mask);
+      SetBits(&top_->prd_masking_i[0], kWidthPRDSBox * l, kWidthPRDSBox,
+              stim.prd);
+    }
+    top_->op_i = op;
+    top_->eval();
+
+    for (int l = 0; l < num_pending_; ++l) {
+      const Stimulus &stim = stimuli_[l];
+      uint8_t expected = stim.inv ? ref_.inv[stim.data] : ref_.fwd[stim.data];
+      for (int i = 0; i < kNumImpls; ++i) {
+        uint8_t actual = GetByte(&top_->data_o[0], i * kNumLanes + l);
+        if (actual != expected) {
+          Mismatch(i, stim, expected, actual);
+        }
+      }
+    }
+    num_evals_ += num_pending_;
+    num_pending_ = 0;
+  }
+
+  uint64_t NumEvals() const { return num_evals_; }
+  uint64_t NumMismatches(int impl) const { return mismatches_[impl]; }
+
+ private:
+  void Mismatch(int impl, const Stimulus &stim, uint8_t expected,
+                uint8_t actual) {
+    if (mismatches_[impl]++ < kMaxReportedMismatches) {
+      std::cout << "ERROR: Mismatch in " << kImplNames[impl] << std::hex
+                << ": op = " << (stim.inv ? "CIPH_INV" : "CIPH_FWD")
+                << ", stimulus = 8'h" << +stim.data << ", in_mask = 8'h"
+                << +stim.in_mask << ", out_mask = 8'h" << +stim.out_mask
+                << ", prd = 10'h" << stim.prd << ", expected resp = 8'h"
+                << +expected << ", actual resp = 8'h" << +actual << std::dec
+                << std::endl;
+    }
+  }
+
+  Vaes_sbox_lanes *top_;
+  SBoxRef ref_;
+  Stimulus stimuli_[kNumLanes];
+  int num_pending_ = 0;
+  uint64_t num_evals_ = 0;
+  uint64_t mismatches_[kNumImpls];
+};
+
+void PrintUsage(const char *name) {
+  std::cout << "Usage: " << name << " [options]" << std::endl
+            << std::endl
+            << "  -m, --masks=N         Random mask values per input and "
+               "direction (default 256)"
+            << std::endl
+            << "  -e, --exhaustive      Sweep all input/output mask pairs, "
+               "with random PRD"
+            << std::endl
+            << "  -s, --seed=N          Seed for the mask generator "
+               "(default 1)"
+            << std::endl
+            << "  -h, --help            Show this help" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  unsigned long num_masks = 256;
+  bool exhaustive = false;
+  unsigned long seed = 1;
+
+  const struct option long_options[] = {
+      {"masks", required_argument, nullptr, 'm'},
+      {"exhaustive", no_argument, nullptr, 'e'},
+      {"seed", required_argument, nullptr, 's'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, 0}};
+  int c;
+  while ((c = getopt_long(argc, argv, "m:es:h", long_options, nullptr)) !=
+         -1) {
+    switch (c) {
+      case 'm':
+        num_masks = std::strtoul(optarg, nullptr, 0);
+        break;
+      case 'e':
+        exhaustive = true;
+        break;
+      case 's':
+        seed = std::strtoul(optarg, nullptr, 0);
+        break;
+      case 'h':
+        PrintUsage(argv[0]);
+        return 0;
+      default:
+        PrintUsage(argv[0]);
+        return 1;
+    }
+  }
+
+  Verilated::commandArgs(argc, argv);
+  Vaes_sbox_lanes top;
+  SBoxSweep sweep(&top);
+  std::mt19937 rng(seed);
+
+  std::cout << "Sweep of AES SBox implementations" << std::endl
+            << "=================================" << std::endl
+            << std::endl;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int inv = 0; inv < 2; ++inv) {
+    for (int data = 0; data < 256; ++data) {
+      if (exhaustive) {
+        for (int in_mask = 0; in_mask < 256; ++in_mask) {
+          for (int out_mask = 0; out_mask < 256; ++out_mask) {
+            sweep.Add({inv != 0, static_cast<uint8_t>(data),
+                       static_cast<uint8_t>(in_mask),
+                       static_cast<uint8_t>(out_mask),
+                       static_cast<uint32_t>(rng()) &
+                           ((1u << kWidthPRDSBox) - 1)});
+          }
+        }
+      } else {
+        for (unsigned long i = 0; i < num_masks; ++i) {
+          uint32_t r = rng();
+          sweep.Add({inv != 0, static_cast<uint8_t>(data),
+                     static_cast<uint8_t>(r), static_cast<uint8_t>(r >> 8),
+                     (r >> 16) & ((1u << kWidthPRDSBox) - 1)});
+        }
+      }
+    }
+  }
+  sweep.Flush();
+  std::chrono::duration<double> secs =
+      std::chrono::steady_clock::now() - start;
+
+  bool passed = true;
+  for (int i = 0; i < kNumImpls; ++i) {
+    std::cout << kImplNames[i] << ": " << sweep.NumMismatches(i)
+              << " mismatches" << std::endl;
+    passed &= sweep.NumMismatches(i) == 0;
+  }
+  std::cout << std::endl
+            << sweep.NumEvals() << " stimuli x " << kNumImpls
+            << " implementations in " << secs.count() << " s, "
+            << static_cast<uint64_t>(sweep.NumEvals() * kNumImpls /
+                                     secs.count())
+            << " S-Box evaluations per second" << std::endl;
+
+  top.final();
+
+  if (passed) {
+    std::cout << std::endl
+              << "SUCCESS: Outputs of all S-Box implementations match."
+              << std::endl;
+    return 0;
+  }
+  return 1;
+}
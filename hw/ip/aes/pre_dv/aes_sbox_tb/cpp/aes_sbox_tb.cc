@@ -15,22 +15,24 @@ class AESSBoxTB : public SimCtrlExtension {
   using SimCtrlExtension::SimCtrlExtension;
 
  public:
-  AESSBoxTB(aes_sbox_tb *top);
+  AESSBoxTB(aes_sbox_tb *top, VerilatorSimCtrl *simctrl);
 
   void OnClock(unsigned long sim_time);
 
  private:
   aes_sbox_tb *top_;
+  VerilatorSimCtrl *simctrl_;
 };
 
 // Constructor:
-// - Set up top_ ptr
-AESSBoxTB::AESSBoxTB(aes_sbox_tb *top) : SimCtrlExtension{}, top_(top) {}
+// - Set up top_ and simctrl_ ptrs
+AESSBoxTB::AESSBoxTB(aes_sbox_tb *top, VerilatorSimCtrl *simctrl)
+    : SimCtrlExtension{}, top_(top), simctrl_(simctrl) {}
 
 // Function called once every clock cycle from SimCtrl
 void AESSBoxTB::OnClock(unsigned long sim_time) {
   if (top_->test_done_o) {
-    VerilatorSimCtrl::GetInstance().RequestStop(top_->test_passed_o);
+    simctrl_->RequestStop(top_->test_passed_o);
   }
 }
 
@@ -41,12 +43,11 @@ int main(int argc, char **argv) {
   aes_sbox_tb top;
 
   // Init sim
-  VerilatorSimCtrl &simctrl = VerilatorSimCtrl::GetInstance();
-  simctrl.SetTop(&top, &top.clk_i, &top.rst_ni,
-                 VerilatorSimCtrlFlags::ResetPolarityNegative);
+  VerilatorSimCtrl simctrl(&top, &top.clk_i, &top.rst_ni,
+                           VerilatorSimCtrlFlags::ResetPolarityNegative);
 
   // Create and register VerilatorSimCtrl extension
-  AESSBoxTB aessboxtb(&top);
+  AESSBoxTB aessboxtb(&top, &simctrl);
   simctrl.RegisterExtension(&aessboxtb);
 
   std::cout << "Simulation of AES SBox" << std::endl
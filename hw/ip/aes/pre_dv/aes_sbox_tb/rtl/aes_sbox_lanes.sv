@@ -0,0 +1,64 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+//
+// AES SBox lanes
+//
+// Purely combinational wrapper instantiating every S-Box implementation NumLanes times, so that
+// the C++ sweep harness can evaluate NumLanes independent stimuli per eval(). Masked responses are
+// unmasked before being output.
+
+module aes_sbox_lanes #(
+  parameter int unsigned NumLanes = 32
+) (
+  input  aes_pkg::ciph_op_e [NumLanes-1:0]                            op_i,
+  input  logic              [NumLanes-1:0]                      [7:0] data_i,
+  input  logic              [NumLanes-1:0]                      [7:0] in_mask_i,
+  input  logic              [NumLanes-1:0]                      [7:0] out_mask_i,
+  input  logic              [NumLanes-1:0] [aes_pkg::WidthPRDSBox-1:0] prd_masking_i,
+
+  // Unmasked responses, lane l of implementation i at data_o[i][l]:
+  // 0 = LUT, 1 = Canright, 2 = masked Canright (no mask reuse), 3 = masked Canright
+  output logic [3:0][NumLanes-1:0][7:0] data_o
+);
+
+  for (genvar l = 0; l < NumLanes; l++) begin : gen_lanes
+    logic [7:0] masked_data;
+    logic [7:0] masked_response_noreuse, masked_response;
+
+    assign masked_data = data_i[l] ^ in_mask_i[l];
+
+    aes_sbox_lut aes_sbox_lut (
+      .op_i   ( op_i[l]      ),
+      .data_i ( data_i[l]    ),
+      .data_o ( data_o[0][l] )
+    );
+
+    aes_sbox_canright aes_sbox_canright (
+      .op_i   ( op_i[l]      ),
+      .data_i ( data_i[l]    ),
+      .data_o ( data_o[1][l] )
+    );
+
+    aes_sbox_canright_masked_noreuse aes_sbox_canright_masked_noreuse (
+      .op_i          ( op_i[l]                 ),
+      .data_i        ( masked_data             ),
+      .in_mask_i     ( in_mask_i[l]            ),
+      .out_mask_i    ( out_mask_i[l]           ),
+      .prd_masking_i ( prd_masking_i[l]        ),
+      .data_o        ( masked_response_noreuse )
+    );
+
+    aes_sbox_canright_masked aes_sbox_canright_masked (
+      .op_i       ( op_i[l]         ),
+      .data_i     ( masked_data     ),
+      .in_mask_i  ( in_mask_i[l]    ),
+      .out_mask_i ( out_mask_i[l]   ),
+      .data_o     ( masked_response )
+    );
+
+    assign data_o[2][l] = masked_response_noreuse ^ out_mask_i[l];
+    assign data_o[3][l] = masked_response ^ out_mask_i[l];
+  end
+
+endmodule
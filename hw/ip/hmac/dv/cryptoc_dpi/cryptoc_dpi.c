@@ -4,6 +4,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "hmac.h"
 #include "hmac_wrap.h"
@@ -13,8 +14,91 @@
 
 typedef unsigned long long ull_t;
 
+// Number of bytes staged at a time when a message cannot be hashed directly
+// from SV memory.
+#define UPDATE_CHUNK_LEN 256
+
+/**
+ * Returns non-zero if the simulator stores an unsized array as contiguous
+ * bytes, rather than one svBitVecVal per element.
+ *
+ * This compares the size of the array in bytes with its number of elements,
+ * which works for arrays of any length, including single bytes.
+ */
+static int arr_is_bytes(const svOpenArrayHandle arr) {
+  return svSizeOfArray(arr) == svSize(arr, 1);
+}
+
+/**
+ * Feeds `len` bytes of an unsized SV byte array into a hash context.
+ *
+ * The bytes are hashed in place if the simulator stores the array as
+ * contiguous bytes. Otherwise they are narrowed through a small staging
+ * buffer, so that the message is never copied as a whole.
+ */
+static void hash_update_from_simulator(HASH_CTX *ctx,
+                                       const svOpenArrayHandle msg,
+                                       ull_t len) {
+  const void *arr_ptr;
+  uint8_t chunk[UPDATE_CHUNK_LEN];
+  ull_t i, j, n;
+
+  if (len == 0) {
+    return;
+  }
+
+  arr_ptr = svGetArrayPtr(msg);
+  if (arr_is_bytes(msg)) {
+    HASH_update(ctx, arr_ptr, len);
+    return;
+  }
+
+  for (i = 0; i < len; i += n) {
+    n = len - i < UPDATE_CHUNK_LEN ? len - i : UPDATE_CHUNK_LEN;
+    for (j = 0; j < n; j++) {
+      chunk[j] = ((const svBitVecVal *)arr_ptr)[i + j];
+    }
+    HASH_update(ctx, chunk, n);
+  }
+}
+
+/**
+ * Initializes an HMAC-SHA256 context with a key from SV memory.
+ *
+ * Like the message, the key is used in place if the simulator stores it as
+ * contiguous bytes, and narrowed otherwise.
+ */
+static void hmac_sha256_init_from_simulator(LITE_HMAC_CTX *ctx,
+                                            const svOpenArrayHandle key,
+                                            ull_t key_len) {
+  uint8_t key_arr[key_len > 0 ? key_len : 1];
+  const void *arr_ptr = svGetArrayPtr(key);
+  ull_t i;
+
+  if (key_len > 0 && arr_is_bytes(key)) {
+    HMAC_SHA256_init(ctx, arr_ptr, key_len);
+    return;
+  }
+
+  for (i = 0; i < key_len; i++) {
+    key_arr[i] = ((const svBitVecVal *)arr_ptr)[i];
+  }
+
+  HMAC_SHA256_init(ctx, key_arr, key_len);
+}
+
+/**
+ * Context behind the `chandle`s of the incremental SHA256 / HMAC-SHA256 API.
+ *
+ * Plain SHA256 only uses `ctx.hash`.
+ */
+typedef struct dpi_hash_ctx {
+  int hmac;
+  LITE_HMAC_CTX ctx;
+} dpi_hash_ctx_t;
+
 extern void c_dpi_SHA_hash(const svOpenArrayHandle msg, ull_t len,
-                           uint8_t hash[8]) {
+                           unsigned int hash[8]) {
   unsigned char *arr;
   unsigned int *arr_ptr;
   ull_t i;
@@ -27,38 +111,24 @@ extern void c_dpi_SHA_hash(const svOpenArrayHandle msg, ull_t len,
   }
 
   // compute SHA hash
-  SHA_hash(arr, len, hash);
+  SHA_hash(arr, len, (uint8_t *)hash);
 
   free(arr);
 }
 
 extern void c_dpi_SHA256_hash(const svOpenArrayHandle msg, ull_t len,
-                              uint8_t hash[8]) {
-  unsigned char *arr;
-  unsigned int *arr_ptr;
-  ull_t i;
-
-  if (len > 0) {
-    arr = (unsigned char *)malloc(len * sizeof(unsigned char));
-    arr_ptr = (unsigned int *)svGetArrayPtr(msg);
-
-    for (i = 0; i < len; i++) {
-      arr[i] = arr_ptr[i];
-    }
-
-    // compute SHA256 hash
-    SHA256_hash(arr, len, hash);
+                              unsigned int hash[8]) {
+  LITE_SHA256_CTX ctx;
 
-    free(arr);
-  } else {
-    // compute SHA256 hash when msg is empty
-    SHA256_hash(NULL, len, hash);
-  }
+  // compute SHA256 hash
+  SHA256_init(&ctx);
+  hash_update_from_simulator(&ctx, msg, len);
+  memcpy(hash, SHA256_final(&ctx), SHA256_DIGEST_SIZE);
 }
 
 extern void c_dpi_HMAC_SHA(const svOpenArrayHandle key, ull_t key_len,
                            const svOpenArrayHandle msg, ull_t msg_len,
-                           uint8_t hmac[8]) {
+                           unsigned int hmac[8]) {
   unsigned char *msg_arr;
   unsigned int *msg_arr_ptr;
   unsigned char *key_arr;
@@ -80,7 +150,7 @@ extern void c_dpi_HMAC_SHA(const svOpenArrayHandle key, ull_t key_len,
   }
 
   // compute SHA hash
-  HMAC_SHA(key_arr, key_len, msg_arr, msg_len, hmac);
+  HMAC_SHA(key_arr, key_len, msg_arr, msg_len, (uint8_t *)hmac);
 
   free(msg_arr);
   free(key_arr);
@@ -88,38 +158,65 @@ extern void c_dpi_HMAC_SHA(const svOpenArrayHandle key, ull_t key_len,
 
 extern void c_dpi_HMAC_SHA256(const svOpenArrayHandle key, ull_t key_len,
                               const svOpenArrayHandle msg, ull_t msg_len,
-                              uint8_t hmac[8]) {
-  unsigned char *msg_arr;
-  unsigned int *msg_arr_ptr;
-  unsigned char *key_arr;
-  unsigned int *key_arr_ptr;
-  ull_t i;
+                              unsigned int hmac[8]) {
+  LITE_HMAC_CTX ctx;
 
-  if (msg_len > 0) {
-    msg_arr = (unsigned char *)malloc(msg_len * sizeof(unsigned char));
-    msg_arr_ptr = (unsigned int *)svGetArrayPtr(msg);
+  // compute HMAC SHA256 digest
+  hmac_sha256_init_from_simulator(&ctx, key, key_len);
+  hash_update_from_simulator(&ctx.hash, msg, msg_len);
+  memcpy(hmac, HMAC_final(&ctx), SHA256_DIGEST_SIZE);
+}
 
-    for (i = 0; i < msg_len; i++) {
-      msg_arr[i] = msg_arr_ptr[i];
-    }
-  }
+////////////////////////////////////////
+// Incremental SHA256 and HMAC-SHA256 //
+////////////////////////////////////////
 
-  key_arr = (unsigned char *)malloc(key_len * sizeof(unsigned char));
-  key_arr_ptr = (unsigned int *)svGetArrayPtr(key);
+extern void *c_dpi_SHA256_init(void) {
+  dpi_hash_ctx_t *h = (dpi_hash_ctx_t *)calloc(1, sizeof(dpi_hash_ctx_t));
+  if (h == NULL) {
+    return NULL;
+  }
+  h->hmac = 0;
+  SHA256_init(&h->ctx.hash);
+  return h;
+}
 
-  for (i = 0; i < key_len; i++) {
-    key_arr[i] = key_arr_ptr[i];
+extern void *c_dpi_HMAC_SHA256_init(const svOpenArrayHandle key,
+                                    ull_t key_len) {
+  dpi_hash_ctx_t *h = (dpi_hash_ctx_t *)calloc(1, sizeof(dpi_hash_ctx_t));
+  if (h == NULL) {
+    return NULL;
   }
+  h->hmac = 1;
+  hmac_sha256_init_from_simulator(&h->ctx, key, key_len);
+  return h;
+}
 
-  if (msg_len > 0) {
-    // compute SHA256 hash
-    HMAC_SHA256(key_arr, key_len, msg_arr, msg_len, hmac);
+extern void c_dpi_hash_update(void *handle, const svOpenArrayHandle msg,
+                              ull_t len) {
+  dpi_hash_ctx_t *h = (dpi_hash_ctx_t *)handle;
+  hash_update_from_simulator(&h->ctx.hash, msg, len);
+}
+
+extern void c_dpi_hash_final(void *handle, unsigned int hash[8]) {
+  // Finalize a copy so that the context can keep absorbing; the digest of
+  // every prefix of a message then costs only the new data.
+  dpi_hash_ctx_t copy = *(dpi_hash_ctx_t *)handle;
 
-    free(msg_arr);
+  if (copy.hmac) {
+    memcpy(hash, HMAC_final(&copy.ctx), SHA256_DIGEST_SIZE);
   } else {
-    // compute SHA256 hash when msg is empty
-    HMAC_SHA256(key_arr, key_len, NULL, msg_len, hmac);
+    memcpy(hash, SHA256_final(&copy.ctx.hash), SHA256_DIGEST_SIZE);
   }
+}
 
-  free(key_arr);
+extern void *c_dpi_hash_clone(void *handle) {
+  dpi_hash_ctx_t *h = (dpi_hash_ctx_t *)malloc(sizeof(dpi_hash_ctx_t));
+  if (h == NULL) {
+    return NULL;
+  }
+  *h = *(dpi_hash_ctx_t *)handle;
+  return h;
 }
+
+extern void c_dpi_hash_free(void *handle) { free(handle); }
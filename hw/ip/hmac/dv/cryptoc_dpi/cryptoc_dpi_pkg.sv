@@ -30,6 +30,25 @@ package cryptoc_dpi_pkg;
                                                          input longint unsigned msg_len,
                                                          output int unsigned hmac[8]);
 
+  // Incremental SHA256 / HMAC-SHA256: create a context with one of the *_init functions, feed the
+  // message in any number of updates, and read the digest of everything fed so far with
+  // c_dpi_hash_final, which leaves the context usable. c_dpi_hash_clone saves a copy of a context.
+  import "DPI-C" context function chandle c_dpi_SHA256_init();
+
+  import "DPI-C" context function chandle c_dpi_HMAC_SHA256_init(input bit[7:0] key[],
+                                                                input longint unsigned key_len);
+
+  import "DPI-C" context function void c_dpi_hash_update(input chandle ctx,
+                                                         input bit[7:0] msg[],
+                                                         input longint unsigned len);
+
+  import "DPI-C" context function void c_dpi_hash_final(input chandle ctx,
+                                                        output int unsigned hash[8]);
+
+  import "DPI-C" context function chandle c_dpi_hash_clone(input chandle ctx);
+
+  import "DPI-C" context function void c_dpi_hash_free(input chandle ctx);
+
   // sv wrapper functions
   function automatic void sv_dpi_get_sha_digest(input bit[7:0] msg[],
                                                 output int unsigned hash[8]);
@@ -61,4 +80,16 @@ package cryptoc_dpi_pkg;
     c_dpi_HMAC_SHA256(ckey, ckey.size(), msg, msg.size(), hmac);
   endfunction
 
+  function automatic chandle sv_dpi_hmac_sha256_init(input bit[31:0] key[]);
+    bit [7:0] ckey[];
+    int ckey_size_bytes = $bits(key) / 8;
+    ckey = new[ckey_size_bytes];
+    {>>{ckey}} = key;
+    return c_dpi_HMAC_SHA256_init(ckey, ckey.size());
+  endfunction
+
+  function automatic void sv_dpi_hash_update(input chandle ctx, input bit[7:0] msg[]);
+    c_dpi_hash_update(ctx, msg, msg.size());
+  endfunction
+
 endpackage
@@ -16,6 +16,8 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "sha256_ni.h"
+
 #define ror(value, bits) (((value) >> (bits)) | ((value) << (32 - (bits))))
 #define shr(value, bits) ((value) >> (bits))
 
@@ -32,10 +34,9 @@ static const uint32_t K[64] = {
     0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
     0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
 
-static void SHA256_Transform(LITE_SHA256_CTX *ctx) {
+static void SHA256_Transform_block(uint32_t *state, const uint8_t *p) {
   uint32_t W[64];
   uint32_t A, B, C, D, E, F, G, H;
-  uint8_t *p = ctx->buf;
   int t;
 
   for (t = 0; t < 16; ++t) {
@@ -52,14 +53,14 @@ static void SHA256_Transform(LITE_SHA256_CTX *ctx) {
     W[t] = W[t - 16] + s0 + W[t - 7] + s1;
   }
 
-  A = ctx->state[0];
-  B = ctx->state[1];
-  C = ctx->state[2];
-  D = ctx->state[3];
-  E = ctx->state[4];
-  F = ctx->state[5];
-  G = ctx->state[6];
-  H = ctx->state[7];
+  A = state[0];
+  B = state[1];
+  C = state[2];
+  D = state[3];
+  E = state[4];
+  F = state[5];
+  G = state[6];
+  H = state[7];
 
   for (t = 0; t < 64; t++) {
     uint32_t s0 = ror(A, 2) ^ ror(A, 13) ^ ror(A, 22);
@@ -79,14 +80,36 @@ static void SHA256_Transform(LITE_SHA256_CTX *ctx) {
     A = t1 + t2;
   }
 
-  ctx->state[0] += A;
-  ctx->state[1] += B;
-  ctx->state[2] += C;
-  ctx->state[3] += D;
-  ctx->state[4] += E;
-  ctx->state[5] += F;
-  ctx->state[6] += G;
-  ctx->state[7] += H;
+  state[0] += A;
+  state[1] += B;
+  state[2] += C;
+  state[3] += D;
+  state[4] += E;
+  state[5] += F;
+  state[6] += G;
+  state[7] += H;
+}
+
+// Compresses `num_blocks` 64-byte blocks with the x86 SHA extensions when the
+// host supports them, and with the portable transform otherwise.
+static void SHA256_Transform_blocks(uint32_t *state, const uint8_t *p,
+                                    size_t num_blocks) {
+  static int use_ni = -1;
+  if (use_ni < 0) {
+    use_ni = sha256_ni_available();
+  }
+
+  if (use_ni) {
+    sha256_ni_transform(state, p, num_blocks);
+    return;
+  }
+  for (; num_blocks > 0; --num_blocks, p += 64) {
+    SHA256_Transform_block(state, p);
+  }
+}
+
+static void SHA256_Transform(LITE_SHA256_CTX *ctx) {
+  SHA256_Transform_blocks(ctx->state, ctx->buf, 1);
 }
 
 static const HASH_VTAB SHA256_VTAB = {SHA256_init, SHA256_update, SHA256_final,
@@ -111,13 +134,30 @@ void SHA256_update(LITE_SHA256_CTX *ctx, const void *data, size_t len) {
 
   ctx->count += len;
 
-  while (len--) {
-    ctx->buf[i++] = *p++;
-    if (i == 64) {
-      SHA256_Transform(ctx);
-      i = 0;
+  // Top up a partially filled buffer first.
+  if (i > 0) {
+    size_t fill = 64 - i;
+    if (fill > len) {
+      fill = len;
     }
+    memcpy(ctx->buf + i, p, fill);
+    p += fill;
+    len -= fill;
+    i += fill;
+    if (i < 64) {
+      return;
+    }
+    SHA256_Transform(ctx);
+  }
+
+  // Compress whole blocks straight from the input.
+  if (len >= 64) {
+    SHA256_Transform_blocks(ctx->state, p, len / 64);
+    p += len & ~(size_t)63;
+    len &= 63;
   }
+
+  memcpy(ctx->buf, p, len);
 }
 
 const uint8_t *SHA256_final(LITE_SHA256_CTX *ctx) {
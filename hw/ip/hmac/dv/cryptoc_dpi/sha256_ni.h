@@ -0,0 +1,28 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SHA256_NI_H__
+#define SHA256_NI_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Returns non-zero if the host CPU implements the x86 SHA extensions, in which
+// case sha256_ni_transform() may be used.
+int sha256_ni_available(void);
+
+// Compress `num_blocks` consecutive 64-byte blocks at `data` into the SHA256
+// `state`, using the x86 SHA extensions.
+void sha256_ni_transform(uint32_t state[8], const uint8_t *data,
+                         size_t num_blocks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -7,14 +7,13 @@
 #include <cstdlib>
 #include <cstring>
 #include <list>
+#include <utility>
 
 #include "svdpi.h"
 #include "vendor/kerukuro_digestpp/algorithm/kmac.hpp"
 #include "vendor/kerukuro_digestpp/algorithm/sha3.hpp"
 #include "vendor/kerukuro_digestpp/algorithm/shake.hpp"
 
-extern "C" {
-
 // TODO(udi) might need to implement endian conversion
 
 //////////////////////
@@ -22,36 +21,207 @@ extern "C" {
 //////////////////////
 
 /**
- * Generic function to load an unsized array from SV memory into C memory.
+ * Number of bytes staged at a time when a message cannot be absorbed directly
+ * from SV memory.
  */
-static void load_arr_from_simulator(const svOpenArrayHandle arr,
-                                    uint8_t *array_out, uint64_t array_len) {
-  svBitVecVal val;
+static const uint64_t kAbsorbChunkLen = 256;
+
+/**
+ * Returns the distance in bytes between consecutive elements of an unsized
+ * array, or 0 if the simulator does not expose it as contiguous memory.
+ */
+static intptr_t arr_stride(const svOpenArrayHandle arr) {
+  if (svSize(arr, 1) < 2 || svGetArrayPtr(arr) == nullptr) {
+    return 0;
+  }
+  int low = svLow(arr, 1);
+  return (uint8_t *)svGetArrElemPtr1(arr, low + 1) -
+         (uint8_t *)svGetArrElemPtr1(arr, low);
+}
 
+/**
+ * Loads `array_len` elements of an unsized array from SV memory into C
+ * memory, starting at element `offset`.
+ *
+ * The elements are copied in bulk if the simulator exposes the array as
+ * contiguous memory, and one at a time otherwise.
+ */
+static void load_arr_chunk_from_simulator(const svOpenArrayHandle arr,
+                                          uint64_t offset, uint8_t *array_out,
+                                          uint64_t array_len) {
   if (array_len == 0) {
     return;
   }
 
   uint8_t *arr_ptr = (uint8_t *)svGetArrayPtr(arr);
-  for (int i = 0; i < array_len; i++) {
-    svGetBitArrElem1VecVal(&val, arr, i);
-    array_out[i] = (uint8_t)val;
+  intptr_t stride = arr_stride(arr);
+  if (stride == 1) {
+    memcpy(array_out, arr_ptr + offset, array_len);
+  } else if (stride == sizeof(svBitVecVal)) {
+    // Canonical representation: one svBitVecVal per element.
+    const svBitVecVal *words = (const svBitVecVal *)arr_ptr + offset;
+    for (uint64_t i = 0; i < array_len; ++i) {
+      array_out[i] = (uint8_t)words[i];
+    }
+  } else {
+    svBitVecVal val;
+    for (uint64_t i = 0; i < array_len; ++i) {
+      svGetBitArrElem1VecVal(&val, arr, offset + i);
+      array_out[i] = (uint8_t)val;
+    }
   }
 }
 
+/**
+ * Generic function to load an unsized array from SV memory into C memory.
+ */
+static void load_arr_from_simulator(const svOpenArrayHandle arr,
+                                    uint8_t *array_out, uint64_t array_len) {
+  load_arr_chunk_from_simulator(arr, 0, array_out, array_len);
+}
+
 /**
  * Generic function to write an unsized array from C memory into SV memory.
  */
 static void write_array_to_simulator(const svOpenArrayHandle arr,
                                      uint8_t *data) {
   uint64_t arr_len = svSize(arr, 1);
+  uint8_t *arr_ptr = (uint8_t *)svGetArrayPtr(arr);
+  intptr_t stride = arr_stride(arr);
+
+  if (stride == 1) {
+    memcpy(arr_ptr, data, arr_len);
+  } else if (stride == sizeof(svBitVecVal)) {
+    // Canonical representation: one svBitVecVal per element.
+    svBitVecVal *words = (svBitVecVal *)arr_ptr;
+    for (uint64_t i = 0; i < arr_len; ++i) {
+      words[i] = (svBitVecVal)data[i];
+    }
+  } else {
+    for (uint64_t i = 0; i < arr_len; ++i) {
+      svBitVecVal data_val = (svBitVecVal)data[i];
+      svPutBitArrElem1VecVal(arr, &data_val, i);
+    }
+  }
+}
 
-  for (uint64_t i = 0; i < arr_len; ++i) {
-    svBitVecVal data_val = (svBitVecVal)data[i];
-    svPutBitArrElem1VecVal(arr, &data_val, i);
+/**
+ * Absorbs `msg_len` bytes of an unsized array from SV memory into `hasher`.
+ *
+ * If the simulator exposes the array as contiguous bytes they are absorbed in
+ * place, otherwise they are staged through a small buffer, so a message is
+ * never copied as a whole.
+ */
+template <typename H>
+static void absorb_from_simulator(H &hasher, const svOpenArrayHandle msg,
+                                  uint64_t msg_len) {
+  if (msg_len == 0) {
+    return;
+  }
+
+  if (arr_stride(msg) == 1) {
+    hasher.absorb((const uint8_t *)svGetArrayPtr(msg), msg_len);
+    return;
+  }
+
+  uint8_t chunk[kAbsorbChunkLen];
+  for (uint64_t offset = 0; offset < msg_len; offset += kAbsorbChunkLen) {
+    uint64_t len = msg_len - offset;
+    if (len > kAbsorbChunkLen) {
+      len = kAbsorbChunkLen;
+    }
+    load_arr_chunk_from_simulator(msg, offset, chunk, len);
+    hasher.absorb(chunk, len);
   }
 }
 
+/////////////////////
+// CONTEXT HANDLES //
+/////////////////////
+
+/**
+ * Base class of the contexts behind the `chandle`s returned by the
+ * `c_dpi_*_init()` functions.
+ *
+ * A context lets SV absorb a message chunk by chunk as it becomes available,
+ * and squeeze the output once the message is complete.
+ */
+class digestpp_ctx {
+ public:
+  virtual ~digestpp_ctx() {}
+
+  virtual void absorb(const uint8_t *data, size_t len) = 0;
+
+  /**
+   * Writes `len` bytes of output to `out`, returning false if `len` does not
+   * match the digest size of a fixed-length function.
+   */
+  virtual bool squeeze(uint8_t *out, size_t len) = 0;
+};
+
+/**
+ * Context of a fixed-length hash function (SHA3, non-XOF KMAC).
+ */
+template <typename H>
+class digestpp_hash_ctx : public digestpp_ctx {
+ public:
+  template <typename... Args>
+  explicit digestpp_hash_ctx(size_t digest_len, Args &&... args)
+      : hasher(std::forward<Args>(args)...), digest_len(digest_len) {}
+
+  void absorb(const uint8_t *data, size_t len) override {
+    hasher.absorb(data, len);
+  }
+
+  bool squeeze(uint8_t *out, size_t len) override {
+    if (len != digest_len) {
+      return false;
+    }
+    hasher.digest(out, len);
+    return true;
+  }
+
+  H hasher;
+
+ private:
+  size_t digest_len;
+};
+
+/**
+ * Context of an extendable-output function (SHAKE, cSHAKE, KMAC-XOF).
+ *
+ * Consecutive squeezes continue the output stream.
+ */
+template <typename H>
+class digestpp_xof_ctx : public digestpp_ctx {
+ public:
+  void absorb(const uint8_t *data, size_t len) override {
+    hasher.absorb(data, len);
+  }
+
+  bool squeeze(uint8_t *out, size_t len) override {
+    hasher.squeeze(out, len);
+    return true;
+  }
+
+  H hasher;
+};
+
+/**
+ * Sets up the key and customization string of a KMAC context.
+ */
+template <typename H>
+static void kmac_ctx_setup(H &kmac, const svOpenArrayHandle key,
+                           uint64_t key_len, const char *customization_str) {
+  uint8_t key_arr[key_len];
+  load_arr_from_simulator(key, key_arr, key_len);
+
+  kmac.set_customization(customization_str, strlen(customization_str));
+  kmac.set_key(key_arr, key_len);
+}
+
+extern "C" {
+
 /**
  * Helper function to calculate generic length SHA3 algorithm.
  *
@@ -66,19 +236,11 @@ static void get_sha3_digest(uint64_t sha_len, const svOpenArrayHandle msg,
 
   uint8_t digest_arr[digest_len];
 
-  // Load message from SV memory
-  uint8_t *msg_arr = (uint8_t *)malloc(msg_len * sizeof(uint8_t));
-  load_arr_from_simulator(msg, msg_arr, msg_len);
-
   // Compute the digest
   digestpp::sha3 sha3(sha_len);
-  sha3.absorb(msg_arr, msg_len);
+  absorb_from_simulator(sha3, msg, msg_len);
   sha3.digest(digest_arr, sizeof(digest_arr));
 
-  if (msg_arr != nullptr) {
-    free(msg_arr);
-  }
-
   // Return the digest array so that SV can access it
   write_array_to_simulator(digest, digest_arr);
 }
@@ -120,21 +282,13 @@ extern void c_dpi_sha3_512(const svOpenArrayHandle msg, uint64_t msg_len,
 //////////////
 extern void c_dpi_shake128(const svOpenArrayHandle msg, uint64_t msg_len,
                            uint64_t output_len, svOpenArrayHandle digest) {
-  // Load message from SV memory
-  uint8_t *msg_arr = (uint8_t *)malloc(msg_len * sizeof(uint8_t));
-  load_arr_from_simulator(msg, msg_arr, msg_len);
-
   uint8_t digest_arr[output_len];
 
   // Compute the digest
   digestpp::shake128 shake;
-  shake.absorb(msg_arr, msg_len);
+  absorb_from_simulator(shake, msg, msg_len);
   shake.squeeze(digest_arr, output_len);
 
-  if (msg_arr != nullptr) {
-    free(msg_arr);
-  }
-
   // Return the digest array to SV code
   write_array_to_simulator(digest, digest_arr);
 }
@@ -144,21 +298,13 @@ extern void c_dpi_shake128(const svOpenArrayHandle msg, uint64_t msg_len,
 //////////////
 extern void c_dpi_shake256(const svOpenArrayHandle msg, uint64_t msg_len,
                            uint64_t output_len, svOpenArrayHandle digest) {
-  // Load message from SV memory
-  uint8_t *msg_arr = (uint8_t *)malloc(msg_len * sizeof(uint8_t));
-  load_arr_from_simulator(msg, msg_arr, msg_len);
-
   uint8_t digest_arr[output_len];
 
   // Compute the digest
   digestpp::shake256 shake;
-  shake.absorb(msg_arr, msg_len);
+  absorb_from_simulator(shake, msg, msg_len);
   shake.squeeze(digest_arr, output_len);
 
-  if (msg_arr != nullptr) {
-    free(msg_arr);
-  }
-
   // Return the digest array to SV code
   write_array_to_simulator(digest, digest_arr);
 }
@@ -170,23 +316,15 @@ extern void c_dpi_cshake128(const svOpenArrayHandle msg,
                             const char *function_name,
                             const char *customization_str, uint64_t msg_len,
                             uint64_t output_len, svOpenArrayHandle digest) {
-  // Load message from SV memory
-  uint8_t *msg_arr = (uint8_t *)malloc(msg_len * sizeof(uint8_t));
-  load_arr_from_simulator(msg, msg_arr, msg_len);
-
   uint8_t digest_arr[output_len];
 
   // Compute the digest
   digestpp::cshake128 shake;
   shake.set_function_name(function_name, strlen(function_name));
   shake.set_customization(customization_str, strlen(customization_str));
-  shake.absorb(msg_arr, msg_len);
+  absorb_from_simulator(shake, msg, msg_len);
   shake.squeeze(digest_arr, output_len);
 
-  if (msg_arr != nullptr) {
-    free(msg_arr);
-  }
-
   // Return the digest array to SV code
   write_array_to_simulator(digest, digest_arr);
 }
@@ -198,23 +336,15 @@ extern void c_dpi_cshake256(const svOpenArrayHandle msg,
                             const char *function_name,
                             const char *customization_str, uint64_t msg_len,
                             uint64_t output_len, svOpenArrayHandle digest) {
-  // Load message from SV memory
-  uint8_t *msg_arr = (uint8_t *)malloc(msg_len * sizeof(uint8_t));
-  load_arr_from_simulator(msg, msg_arr, msg_len);
-
   uint8_t digest_arr[output_len];
 
   // Compute the digest
   digestpp::cshake256 shake;
   shake.set_function_name(function_name, strlen(function_name));
   shake.set_customization(customization_str, strlen(customization_str));
-  shake.absorb(msg_arr, msg_len);
+  absorb_from_simulator(shake, msg, msg_len);
   shake.squeeze(digest_arr, output_len);
 
-  if (msg_arr != nullptr) {
-    free(msg_arr);
-  }
-
   // Return the digest array to SV code
   write_array_to_simulator(digest, digest_arr);
 }
@@ -225,15 +355,11 @@ extern void c_dpi_cshake256(const svOpenArrayHandle msg,
 extern void c_dpi_kmac128(const svOpenArrayHandle msg, uint64_t msg_len,
                           const svOpenArrayHandle key, uint64_t key_len,
                           const char *customization_str, uint64_t output_len,
-                          svBitVecVal *digest) {
+                          svOpenArrayHandle digest) {
   uint64_t output_len_bits = output_len * 8;
 
-  // Load message from SV memory
-  uint8_t *msg_arr = (uint8_t *)malloc(msg_len * sizeof(uint8_t));
-  load_arr_from_simulator(msg, msg_arr, msg_len);
-
   // Load key from SV memory
-  uint8_t *key_arr = (uint8_t *)malloc(key_len * sizeof(uint8_t));
+  uint8_t key_arr[key_len];
   load_arr_from_simulator(key, key_arr, key_len);
 
   uint8_t digest_arr[output_len];
@@ -242,17 +368,9 @@ extern void c_dpi_kmac128(const svOpenArrayHandle msg, uint64_t msg_len,
   digestpp::kmac128 kmac(output_len_bits);
   kmac.set_customization(customization_str, strlen(customization_str));
   kmac.set_key(key_arr, key_len);
-  kmac.absorb(msg_arr, msg_len);
+  absorb_from_simulator(kmac, msg, msg_len);
   kmac.digest(digest_arr, sizeof(digest_arr));
 
-  if (msg_arr != nullptr) {
-    free(msg_arr);
-  }
-
-  if (key_arr != nullptr) {
-    free(key_arr);
-  }
-
   // Return the digest array to SV code
   write_array_to_simulator(digest, digest_arr);
 }
@@ -263,13 +381,10 @@ extern void c_dpi_kmac128(const svOpenArrayHandle msg, uint64_t msg_len,
 extern void c_dpi_kmac128_xof(const svOpenArrayHandle msg, uint64_t msg_len,
                               const svOpenArrayHandle key, uint64_t key_len,
                               const char *customization_str,
-                              uint64_t output_len, svBitVecVal *digest) {
-  // Load message from SV memory
-  uint8_t *msg_arr = (uint8_t *)malloc(msg_len * sizeof(uint8_t));
-  load_arr_from_simulator(msg, msg_arr, msg_len);
-
+                              uint64_t output_len,
+                              svOpenArrayHandle digest) {
   // Load key from SV memory
-  uint8_t *key_arr = (uint8_t *)malloc(key_len * sizeof(uint8_t));
+  uint8_t key_arr[key_len];
   load_arr_from_simulator(key, key_arr, key_len);
 
   uint8_t digest_arr[output_len];
@@ -278,17 +393,9 @@ extern void c_dpi_kmac128_xof(const svOpenArrayHandle msg, uint64_t msg_len,
   digestpp::kmac128_xof kmac;
   kmac.set_customization(customization_str, strlen(customization_str));
   kmac.set_key(key_arr, key_len);
-  kmac.absorb(msg_arr, msg_len);
+  absorb_from_simulator(kmac, msg, msg_len);
   kmac.squeeze(digest_arr, sizeof(digest_arr));
 
-  if (msg_arr != nullptr) {
-    free(msg_arr);
-  }
-
-  if (key_arr != nullptr) {
-    free(key_arr);
-  }
-
   // Return the digest array to SV code
   write_array_to_simulator(digest, digest_arr);
 }
@@ -299,15 +406,11 @@ extern void c_dpi_kmac128_xof(const svOpenArrayHandle msg, uint64_t msg_len,
 extern void c_dpi_kmac256(const svOpenArrayHandle msg, uint64_t msg_len,
                           const svOpenArrayHandle key, uint64_t key_len,
                           const char *customization_str, uint64_t output_len,
-                          svBitVecVal *digest) {
+                          svOpenArrayHandle digest) {
   uint64_t output_len_bits = output_len * 8;
 
-  // Load message from SV memory
-  uint8_t *msg_arr = (uint8_t *)malloc(msg_len * sizeof(uint8_t));
-  load_arr_from_simulator(msg, msg_arr, msg_len);
-
   // Load key from SV memory
-  uint8_t *key_arr = (uint8_t *)malloc(key_len * sizeof(uint8_t));
+  uint8_t key_arr[key_len];
   load_arr_from_simulator(key, key_arr, key_len);
 
   uint8_t digest_arr[output_len];
@@ -316,17 +419,9 @@ extern void c_dpi_kmac256(const svOpenArrayHandle msg, uint64_t msg_len,
   digestpp::kmac256 kmac(output_len_bits);
   kmac.set_customization(customization_str, strlen(customization_str));
   kmac.set_key(key_arr, key_len);
-  kmac.absorb(msg_arr, msg_len);
+  absorb_from_simulator(kmac, msg, msg_len);
   kmac.digest(digest_arr, sizeof(digest_arr));
 
-  if (msg_arr != nullptr) {
-    free(msg_arr);
-  }
-
-  if (key_arr != nullptr) {
-    free(key_arr);
-  }
-
   // Return the digest array to SV code
   write_array_to_simulator(digest, digest_arr);
 }
@@ -337,13 +432,10 @@ extern void c_dpi_kmac256(const svOpenArrayHandle msg, uint64_t msg_len,
 extern void c_dpi_kmac256_xof(const svOpenArrayHandle msg, uint64_t msg_len,
                               const svOpenArrayHandle key, uint64_t key_len,
                               const char *customization_str,
-                              uint64_t output_len, svBitVecVal *digest) {
-  // Load message from SV memory
-  uint8_t *msg_arr = (uint8_t *)malloc(msg_len * sizeof(uint8_t));
-  load_arr_from_simulator(msg, msg_arr, msg_len);
-
+                              uint64_t output_len,
+                              svOpenArrayHandle digest) {
   // Load key from SV memory
-  uint8_t *key_arr = (uint8_t *)malloc(key_len * sizeof(uint8_t));
+  uint8_t key_arr[key_len];
   load_arr_from_simulator(key, key_arr, key_len);
 
   uint8_t digest_arr[output_len];
@@ -352,18 +444,142 @@ extern void c_dpi_kmac256_xof(const svOpenArrayHandle msg, uint64_t msg_len,
   digestpp::kmac256_xof kmac;
   kmac.set_customization(customization_str, strlen(customization_str));
   kmac.set_key(key_arr, key_len);
-  kmac.absorb(msg_arr, msg_len);
+  absorb_from_simulator(kmac, msg, msg_len);
   kmac.squeeze(digest_arr, sizeof(digest_arr));
 
-  if (msg_arr != nullptr) {
-    free(msg_arr);
+  // Return the digest array to SV code
+  write_array_to_simulator(digest, digest_arr);
+}
+
+//////////////////////////////
+// INCREMENTAL CONTEXT APIS //
+//////////////////////////////
+
+/**
+ * Creates a SHA3 context, `sha_len` is one of {224, 256, 384, 512}.
+ */
+extern void *c_dpi_sha3_init(uint64_t sha_len) {
+  if (sha_len != 224 && sha_len != 256 && sha_len != 384 && sha_len != 512) {
+    printf("ERROR: c_dpi_sha3_init(): unsupported length %lu\n",
+           (unsigned long)sha_len);
+    return nullptr;
   }
+  return new digestpp_hash_ctx<digestpp::sha3>(sha_len / 8, sha_len);
+}
 
-  if (key_arr != nullptr) {
-    free(key_arr);
+/**
+ * Creates a SHAKE context, `strength` is one of {128, 256}.
+ */
+extern void *c_dpi_shake_init(uint64_t strength) {
+  if (strength == 128) {
+    return new digestpp_xof_ctx<digestpp::shake128>();
+  } else if (strength == 256) {
+    return new digestpp_xof_ctx<digestpp::shake256>();
+  }
+  printf("ERROR: c_dpi_shake_init(): unsupported strength %lu\n",
+         (unsigned long)strength);
+  return nullptr;
+}
+
+/**
+ * Creates a cSHAKE context, `strength` is one of {128, 256}.
+ */
+extern void *c_dpi_cshake_init(uint64_t strength, const char *function_name,
+                               const char *customization_str) {
+  if (strength == 128) {
+    auto *ctx = new digestpp_xof_ctx<digestpp::cshake128>();
+    ctx->hasher.set_function_name(function_name, strlen(function_name));
+    ctx->hasher.set_customization(customization_str,
+                                  strlen(customization_str));
+    return ctx;
+  } else if (strength == 256) {
+    auto *ctx = new digestpp_xof_ctx<digestpp::cshake256>();
+    ctx->hasher.set_function_name(function_name, strlen(function_name));
+    ctx->hasher.set_customization(customization_str,
+                                  strlen(customization_str));
+    return ctx;
+  }
+  printf("ERROR: c_dpi_cshake_init(): unsupported strength %lu\n",
+         (unsigned long)strength);
+  return nullptr;
+}
+
+/**
+ * Creates a KMAC context, `strength` is one of {128, 256}.
+ *
+ * If `xof` is set, `output_len` is ignored and the output can be squeezed in
+ * any number of steps; otherwise `output_len` bytes must be squeezed at once.
+ */
+extern void *c_dpi_kmac_init(uint64_t strength, const svOpenArrayHandle key,
+                             uint64_t key_len, const char *customization_str,
+                             uint64_t output_len, unsigned char xof) {
+  if (strength == 128 && xof) {
+    auto *ctx = new digestpp_xof_ctx<digestpp::kmac128_xof>();
+    kmac_ctx_setup(ctx->hasher, key, key_len, customization_str);
+    return ctx;
+  } else if (strength == 128) {
+    auto *ctx =
+        new digestpp_hash_ctx<digestpp::kmac128>(output_len, output_len * 8);
+    kmac_ctx_setup(ctx->hasher, key, key_len, customization_str);
+    return ctx;
+  } else if (strength == 256 && xof) {
+    auto *ctx = new digestpp_xof_ctx<digestpp::kmac256_xof>();
+    kmac_ctx_setup(ctx->hasher, key, key_len, customization_str);
+    return ctx;
+  } else if (strength == 256) {
+    auto *ctx =
+        new digestpp_hash_ctx<digestpp::kmac256>(output_len, output_len * 8);
+    kmac_ctx_setup(ctx->hasher, key, key_len, customization_str);
+    return ctx;
+  }
+  printf("ERROR: c_dpi_kmac_init(): unsupported strength %lu\n",
+         (unsigned long)strength);
+  return nullptr;
+}
+
+/**
+ * Absorbs the next `msg_len` bytes of a message into a context.
+ */
+extern void c_dpi_digestpp_absorb(void *ctx, const svOpenArrayHandle msg,
+                                  uint64_t msg_len) {
+  digestpp_ctx *digest_ctx = static_cast<digestpp_ctx *>(ctx);
+  if (digest_ctx == nullptr) {
+    printf("ERROR: c_dpi_digestpp_absorb(): null context\n");
+    return;
+  }
+  absorb_from_simulator(*digest_ctx, msg, msg_len);
+}
+
+/**
+ * Squeezes `output_len` bytes of output from a context into `digest`.
+ *
+ * For SHA3 and non-XOF KMAC, `output_len` must be the digest size, and the
+ * context can still absorb more data afterwards.
+ */
+extern void c_dpi_digestpp_squeeze(void *ctx, uint64_t output_len,
+                                   svOpenArrayHandle digest) {
+  digestpp_ctx *digest_ctx = static_cast<digestpp_ctx *>(ctx);
+  if (digest_ctx == nullptr) {
+    printf("ERROR: c_dpi_digestpp_squeeze(): null context\n");
+    return;
+  }
+
+  uint8_t digest_arr[output_len];
+  if (!digest_ctx->squeeze(digest_arr, output_len)) {
+    printf("ERROR: c_dpi_digestpp_squeeze(): %lu bytes is not the digest "
+           "size\n",
+           (unsigned long)output_len);
+    return;
   }
 
   // Return the digest array to SV code
   write_array_to_simulator(digest, digest_arr);
 }
+
+/**
+ * Frees a context created by one of the `c_dpi_*_init()` functions.
+ */
+extern void c_dpi_digestpp_free(void *ctx) {
+  delete static_cast<digestpp_ctx *>(ctx);
+}
 }
@@ -107,4 +107,46 @@ package digestpp_dpi_pkg;
     output bit[7:0]         digest[]
   );
 
+  // Incremental interface: create a context with one of the c_dpi_*_init()
+  // functions, absorb the message in any number of chunks as it becomes
+  // available, squeeze the output, and free the context.
+  import "DPI-C" context function chandle c_dpi_sha3_init(
+    input longint unsigned  sha_len
+  );
+
+  import "DPI-C" context function chandle c_dpi_shake_init(
+    input longint unsigned  strength
+  );
+
+  import "DPI-C" context function chandle c_dpi_cshake_init(
+    input longint unsigned  strength,
+    input string            function_name,
+    input string            customization_str
+  );
+
+  import "DPI-C" context function chandle c_dpi_kmac_init(
+    input longint unsigned  strength,
+    input bit[7:0]          key[],
+    input longint unsigned  key_len,
+    input string            customization_str,
+    input longint unsigned  output_len,
+    input bit               xof
+  );
+
+  import "DPI-C" context function void c_dpi_digestpp_absorb(
+    input chandle           ctx,
+    input bit[7:0]          msg[],
+    input longint unsigned  msg_len
+  );
+
+  import "DPI-C" context function void c_dpi_digestpp_squeeze(
+    input chandle           ctx,
+    input longint unsigned  output_len,
+    output bit[7:0]         digest[]
+  );
+
+  import "DPI-C" context function void c_dpi_digestpp_free(
+    input chandle           ctx
+  );
+
 endpackage
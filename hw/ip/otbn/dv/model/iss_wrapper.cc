@@ -7,7 +7,6 @@
 #include <cassert>
 #include <cstring>
 #include <fcntl.h>
-#include <ftw.h>
 #include <iostream>
 #include <memory>
 #include <regex>
@@ -16,8 +15,6 @@
 #include <sys/stat.h>
 #include <sys/wait.h>
 
-#include "otbn_trace_checker.h"
-
 // Guard class to safely delete C strings
 namespace {
 struct CStrDeleter {
@@ -26,81 +23,6 @@ struct CStrDeleter {
 }  // namespace
 typedef std::unique_ptr<char, CStrDeleter> c_str_ptr;
 
-// Guard class to create (and possibly delete) temporary directories.
-struct TmpDir {
-  std::string path;
-
-  TmpDir() : path(TmpDir::make_tmp_dir()) {}
-  ~TmpDir() { cleanup(); }
-
- private:
-  // A wrapper around mkdtemp that respects TMPDIR
-  static std::string make_tmp_dir() {
-    const char *tmpdir = getenv("TMPDIR");
-    if (!tmpdir)
-      tmpdir = "/tmp";
-
-    std::string tmp_template(tmpdir);
-    tmp_template += "/otbn_XXXXXX";
-
-    if (!mkdtemp(&tmp_template.at(0))) {
-      std::ostringstream oss;
-      oss << ("Cannot create temporary directory for OTBN simulation "
-              "with template ")
-          << tmp_template << ": " << strerror(errno);
-      throw std::runtime_error(oss.str());
-    }
-
-    // The backing string for tmp_template will have been populated by mkdtemp.
-    return tmp_template;
-  }
-
-  // Return true if the OTBN_MODEL_KEEP_TMP environment variable is set to 1.
-  static bool should_keep_tmp() {
-    const char *keep_str = getenv("OTBN_MODEL_KEEP_TMP");
-    if (!keep_str)
-      return false;
-    return (strcmp(keep_str, "1") == 0) ? true : false;
-  }
-
-  // Called by nftw when we're deleting the temporary directory
-  static int ftw_callback(const char *fpath, const struct stat *sb,
-                          int typeflag, struct FTW *ftwbuf) {
-    // The libc remove() function calls unlink or rmdir as necessary. Ignore
-    // any failures: we'll check that we managed to delete the directory when
-    // nftw finishes.
-    remove(fpath);
-
-    // Tell nftw to keep going
-    return 0;
-  }
-
-  // Recursively delete the temporary directory
-  void cleanup() {
-    if (path.empty())
-      return;
-
-    if (TmpDir::should_keep_tmp()) {
-      std::cerr << "Keeping temporary directory at " << path
-                << " because OTBN_MODEL_KEEP_TMP=1.\n";
-      return;
-    }
-
-    // We're not supposed to keep the directory. Try to delete it and its
-    // contents. Ignore any failures: we'll just check whether it's gone
-    // afterwards.
-    nftw(path.c_str(), TmpDir::ftw_callback, 4, FTW_DEPTH | FTW_PHYS);
-
-    // Is there still anything at path? If so, we failed. Print something to
-    // stderr to tell the user what's going on.
-    struct stat statbuf;
-    if (stat(path.c_str(), &statbuf) == 0) {
-      std::cerr << "ERROR: Failed to delete OTBN temporary directory at "
-                << path << ".\n";
-    }
-  }
-};
-
 // Find the top of the OpenTitan repository
 //
 // If REPO_TOP is defined, use that. Otherwise, this will only work if we're
@@ -218,7 +140,7 @@ static uint32_t read_ext_reg(const std::string &reg_name,
   return val;
 }
 
-ISSWrapper::ISSWrapper() : tmpdir(new TmpDir()) {
+ISSWrapper::ISSWrapper() {
   std::string model_path(find_otbn_model());
 
   // We want two pipes: one for writing to the child process, and the other for
@@ -322,17 +244,18 @@ void ISSWrapper::start(uint32_t addr) {
   run_command(oss.str(), nullptr);
 }
 
-std::pair<bool, uint32_t> ISSWrapper::step(bool gen_trace) {
+std::pair<bool, uint32_t> ISSWrapper::step(std::vector<std::string> *trace) {
   std::vector<std::string> lines;
   run_command("step\n", &lines);
-  if (gen_trace) {
-    OtbnTraceChecker::get().OnIssTrace(lines);
-  }
 
   // The busy flag is bit 0 of the STATUS register, so is cleared on this cycle
   // if we see a write that sets the value to an even number.
   bool done = (read_ext_reg("STATUS", lines, 1) & 1) == 0;
   uint32_t err_code = done ? read_ext_reg("ERR_CODE", lines, 0) : 0;
+
+  if (trace) {
+    trace->swap(lines);
+  }
   return std::make_pair(done, err_code);
 }
 
@@ -454,10 +377,6 @@ std::vector<uint32_t> ISSWrapper::get_call_stack() {
   return call_stack;
 }
 
-std::string ISSWrapper::make_tmp_path(const std::string &relative) const {
-  return tmpdir->path + "/" + relative;
-}
-
 bool ISSWrapper::read_child_response(std::vector<std::string> *dst) const {
   char buf[256];
   bool continuation = false;
@@ -0,0 +1,868 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Instruction decoder for the native OTBN ISS.
+//
+// Generated from insns.yml by hw/ip/otbn/util/yaml_to_cpp.py. Do not edit this
+// file by hand: re-run the generator instead (see the regen-insns target in
+// hw/ip/otbn/dv/model/Makefile).
+
+#pragma once
+
+#include <cstdint>
+
+// The sizes of IMEM and DMEM in bytes
+static const uint32_t kOtbnImemSizeBytes = 4096;
+static const uint32_t kOtbnDmemSizeBytes = 4096;
+
+// An ID for each instruction with an encoding. kIllegal is used for words
+// that don't decode as any instruction.
+enum class OtbnInsnId : uint8_t {
+  kAdd,
+  kAddi,
+  kLui,
+  kSub,
+  kSll,
+  kSlli,
+  kSrl,
+  kSrli,
+  kSra,
+  kSrai,
+  kAnd,
+  kAndi,
+  kOr,
+  kOri,
+  kXor,
+  kXori,
+  kLw,
+  kSw,
+  kBeq,
+  kBne,
+  kJal,
+  kJalr,
+  kCsrrs,
+  kCsrrw,
+  kEcall,
+  kLoop,
+  kLoopi,
+  kBnAdd,
+  kBnAddc,
+  kBnAddi,
+  kBnAddm,
+  kBnMulqacc,
+  kBnMulqaccWo,
+  kBnMulqaccSo,
+  kBnSub,
+  kBnSubb,
+  kBnSubi,
+  kBnSubm,
+  kBnAnd,
+  kBnOr,
+  kBnNot,
+  kBnXor,
+  kBnRshi,
+  kBnSel,
+  kBnCmp,
+  kBnCmpb,
+  kBnLid,
+  kBnSid,
+  kBnMov,
+  kBnMovr,
+  kBnWsrr,
+  kBnWsrw,
+  kIllegal
+};
+
+// Static information about an instruction, taken from insns.yml
+struct OtbnInsnInfo {
+  const char *mnemonic;
+  // The number of cycles that the instruction takes
+  unsigned cycles;
+  // False if the instruction can affect control flow (the straight-line
+  // field in insns.yml)
+  bool straight_line;
+};
+
+// Instruction information, indexed by OtbnInsnId
+static const OtbnInsnInfo kOtbnInsnInfo[] = {
+    {"add", 1, true},
+    {"addi", 1, true},
+    {"lui", 1, true},
+    {"sub", 1, true},
+    {"sll", 1, true},
+    {"slli", 1, true},
+    {"srl", 1, true},
+    {"srli", 1, true},
+    {"sra", 1, true},
+    {"srai", 1, true},
+    {"and", 1, true},
+    {"andi", 1, true},
+    {"or", 1, true},
+    {"ori", 1, true},
+    {"xor", 1, true},
+    {"xori", 1, true},
+    {"lw", 2, true},
+    {"sw", 1, true},
+    {"beq", 1, false},
+    {"bne", 1, false},
+    {"jal", 1, false},
+    {"jalr", 1, false},
+    {"csrrs", 1, true},
+    {"csrrw", 1, true},
+    {"ecall", 1, false},
+    {"loop", 1, false},
+    {"loopi", 1, false},
+    {"bn.add", 1, true},
+    {"bn.addc", 1, true},
+    {"bn.addi", 1, true},
+    {"bn.addm", 1, true},
+    {"bn.mulqacc", 1, true},
+    {"bn.mulqacc.wo", 1, true},
+    {"bn.mulqacc.so", 1, true},
+    {"bn.sub", 1, true},
+    {"bn.subb", 1, true},
+    {"bn.subi", 1, true},
+    {"bn.subm", 1, true},
+    {"bn.and", 1, true},
+    {"bn.or", 1, true},
+    {"bn.not", 1, true},
+    {"bn.xor", 1, true},
+    {"bn.rshi", 1, true},
+    {"bn.sel", 1, true},
+    {"bn.cmp", 1, true},
+    {"bn.cmpb", 1, true},
+    {"bn.lid", 2, true},
+    {"bn.sid", 1, true},
+    {"bn.mov", 1, true},
+    {"bn.movr", 1, true},
+    {"bn.wsrr", 1, true},
+    {"bn.wsrw", 1, true},
+    {"illegal", 1, true}};
+
+// Operand values for a decoded instruction. Each field holds the value of the
+// operand with the same name, or zero if the instruction doesn't have such
+// an operand.
+struct OtbnOperands {
+  int32_t grd;
+  int32_t grs1;
+  int32_t grs2;
+  int32_t imm;
+  int32_t shamt;
+  int32_t offset;
+  int32_t csr;
+  int32_t grs;
+  int32_t bodysize;
+  int32_t iterations;
+  int32_t wrd;
+  int32_t wrs1;
+  int32_t wrs2;
+  int32_t shift_type;
+  int32_t shift_bits;
+  int32_t flag_group;
+  int32_t wrs;
+  int32_t zero_acc;
+  int32_t wrs1_qwsel;
+  int32_t wrs2_qwsel;
+  int32_t acc_shift_imm;
+  int32_t wrd_hwsel;
+  int32_t flag;
+  int32_t grs1_inc;
+  int32_t grd_inc;
+  int32_t grs2_inc;
+  int32_t grs_inc;
+  int32_t wsr;
+};
+
+struct OtbnDecodedInsn {
+  OtbnInsnId id;
+  // The raw instruction word
+  uint32_t raw;
+  OtbnOperands ops;
+};
+
+// Decode an instruction word, which is at address pc in IMEM. PC-relative
+// operands are converted to absolute addresses.
+inline OtbnDecodedInsn otbn_decode(uint32_t word, uint32_t pc) {
+  OtbnDecodedInsn ret = {};
+  ret.raw = word;
+
+  if (!(word & 0xfe00704c) && !(~word & 0x00000033)) {
+    ret.id = OtbnInsnId::kAdd;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    ret.ops.grs2 = ((word >> 20) & 0x1f);
+    return ret;
+  }
+
+  if (!(word & 0x0000706c) && !(~word & 0x00000013)) {
+    ret.id = OtbnInsnId::kAddi;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    {
+      int32_t val = ((word >> 20) & 0xfff);
+      val = (val ^ 0x800) - 0x800;
+      ret.ops.imm = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00000048) && !(~word & 0x00000037)) {
+    ret.id = OtbnInsnId::kLui;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    {
+      int32_t val = ((word >> 12) & 0xfffff);
+      ret.ops.imm = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0xbe00704c) && !(~word & 0x40000033)) {
+    ret.id = OtbnInsnId::kSub;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    ret.ops.grs2 = ((word >> 20) & 0x1f);
+    return ret;
+  }
+
+  if (!(word & 0xfe00604c) && !(~word & 0x00001033)) {
+    ret.id = OtbnInsnId::kSll;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    ret.ops.grs2 = ((word >> 20) & 0x1f);
+    return ret;
+  }
+
+  if (!(word & 0xfe00606c) && !(~word & 0x00001013)) {
+    ret.id = OtbnInsnId::kSlli;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    {
+      int32_t val = ((word >> 20) & 0x1f);
+      ret.ops.shamt = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0xfe00204c) && !(~word & 0x00005033)) {
+    ret.id = OtbnInsnId::kSrl;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    ret.ops.grs2 = ((word >> 20) & 0x1f);
+    return ret;
+  }
+
+  if (!(word & 0xfe00206c) && !(~word & 0x00005013)) {
+    ret.id = OtbnInsnId::kSrli;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    {
+      int32_t val = ((word >> 20) & 0x1f);
+      ret.ops.shamt = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0xbe00204c) && !(~word & 0x40005033)) {
+    ret.id = OtbnInsnId::kSra;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    ret.ops.grs2 = ((word >> 20) & 0x1f);
+    return ret;
+  }
+
+  if (!(word & 0xbe00206c) && !(~word & 0x40005013)) {
+    ret.id = OtbnInsnId::kSrai;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    {
+      int32_t val = ((word >> 20) & 0x1f);
+      ret.ops.shamt = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0xfe00004c) && !(~word & 0x00007033)) {
+    ret.id = OtbnInsnId::kAnd;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    ret.ops.grs2 = ((word >> 20) & 0x1f);
+    return ret;
+  }
+
+  if (!(word & 0x0000006c) && !(~word & 0x00007013)) {
+    ret.id = OtbnInsnId::kAndi;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    {
+      int32_t val = ((word >> 20) & 0xfff);
+      val = (val ^ 0x800) - 0x800;
+      ret.ops.imm = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0xfe00104c) && !(~word & 0x00006033)) {
+    ret.id = OtbnInsnId::kOr;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    ret.ops.grs2 = ((word >> 20) & 0x1f);
+    return ret;
+  }
+
+  if (!(word & 0x0000106c) && !(~word & 0x00006013)) {
+    ret.id = OtbnInsnId::kOri;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    {
+      int32_t val = ((word >> 20) & 0xfff);
+      val = (val ^ 0x800) - 0x800;
+      ret.ops.imm = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0xfe00304c) && !(~word & 0x00004033)) {
+    ret.id = OtbnInsnId::kXor;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    ret.ops.grs2 = ((word >> 20) & 0x1f);
+    return ret;
+  }
+
+  if (!(word & 0x0000306c) && !(~word & 0x00004013)) {
+    ret.id = OtbnInsnId::kXori;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    {
+      int32_t val = ((word >> 20) & 0xfff);
+      val = (val ^ 0x800) - 0x800;
+      ret.ops.imm = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x0000507c) && !(~word & 0x00002003)) {
+    ret.id = OtbnInsnId::kLw;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    {
+      int32_t val = ((word >> 20) & 0xfff);
+      val = (val ^ 0x800) - 0x800;
+      ret.ops.offset = val;
+    }
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    return ret;
+  }
+
+  if (!(word & 0x0000505c) && !(~word & 0x00002023)) {
+    ret.id = OtbnInsnId::kSw;
+    ret.ops.grs2 = ((word >> 20) & 0x1f);
+    {
+      int32_t val = (((word >> 25) & 0x7f) << 5) | ((word >> 7) & 0x1f);
+      val = (val ^ 0x800) - 0x800;
+      ret.ops.offset = val;
+    }
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    return ret;
+  }
+
+  if (!(word & 0x0000701c) && !(~word & 0x00000063)) {
+    ret.id = OtbnInsnId::kBeq;
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    ret.ops.grs2 = ((word >> 20) & 0x1f);
+    {
+      int32_t val = (((word >> 31) & 0x1) << 11) | (((word >> 7) & 0x1) << 10) |
+                    (((word >> 25) & 0x3f) << 4) | ((word >> 8) & 0xf);
+      val = (val ^ 0x800) - 0x800;
+      val *= 2;
+      val += (int32_t)pc;
+      ret.ops.offset = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x0000601c) && !(~word & 0x00001063)) {
+    ret.id = OtbnInsnId::kBne;
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    ret.ops.grs2 = ((word >> 20) & 0x1f);
+    {
+      int32_t val = (((word >> 31) & 0x1) << 11) | (((word >> 7) & 0x1) << 10) |
+                    (((word >> 25) & 0x3f) << 4) | ((word >> 8) & 0xf);
+      val = (val ^ 0x800) - 0x800;
+      val *= 2;
+      val += (int32_t)pc;
+      ret.ops.offset = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00000010) && !(~word & 0x0000006f)) {
+    ret.id = OtbnInsnId::kJal;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    {
+      int32_t val = (((word >> 31) & 0x1) << 19) |
+                    (((word >> 12) & 0xff) << 11) |
+                    (((word >> 20) & 0x1) << 10) | ((word >> 21) & 0x3ff);
+      val = (val ^ 0x80000) - 0x80000;
+      val *= 2;
+      val += (int32_t)pc;
+      ret.ops.offset = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00007018) && !(~word & 0x00000067)) {
+    ret.id = OtbnInsnId::kJalr;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    {
+      int32_t val = ((word >> 20) & 0xfff);
+      val = (val ^ 0x800) - 0x800;
+      ret.ops.offset = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x0000500c) && !(~word & 0x00002073)) {
+    ret.id = OtbnInsnId::kCsrrs;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    {
+      int32_t val = ((word >> 20) & 0xfff);
+      ret.ops.csr = val;
+    }
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    return ret;
+  }
+
+  if (!(word & 0x0000600c) && !(~word & 0x00001073)) {
+    ret.id = OtbnInsnId::kCsrrw;
+    ret.ops.grd = ((word >> 7) & 0x1f);
+    {
+      int32_t val = ((word >> 20) & 0xfff);
+      ret.ops.csr = val;
+    }
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    return ret;
+  }
+
+  if (!(word & 0xffffff8c) && !(~word & 0x00000073)) {
+    ret.id = OtbnInsnId::kEcall;
+    return ret;
+  }
+
+  if (!(word & 0x00007004) && !(~word & 0x0000007b)) {
+    ret.id = OtbnInsnId::kLoop;
+    ret.ops.grs = ((word >> 15) & 0x1f);
+    {
+      int32_t val = ((word >> 20) & 0xfff);
+      val += 1;
+      ret.ops.bodysize = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00006004) && !(~word & 0x0000107b)) {
+    ret.id = OtbnInsnId::kLoopi;
+    {
+      int32_t val = (((word >> 15) & 0x1f) << 5) | ((word >> 7) & 0x1f);
+      ret.ops.iterations = val;
+    }
+    {
+      int32_t val = ((word >> 20) & 0xfff);
+      val += 1;
+      ret.ops.bodysize = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00007054) && !(~word & 0x0000002b)) {
+    ret.id = OtbnInsnId::kBnAdd;
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrs1 = ((word >> 15) & 0x1f);
+    ret.ops.wrs2 = ((word >> 20) & 0x1f);
+    ret.ops.shift_type = ((word >> 30) & 0x1);
+    {
+      int32_t val = ((word >> 25) & 0x1f);
+      val *= 8;
+      ret.ops.shift_bits = val;
+    }
+    {
+      int32_t val = ((word >> 31) & 0x1);
+      ret.ops.flag_group = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00005054) && !(~word & 0x0000202b)) {
+    ret.id = OtbnInsnId::kBnAddc;
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrs1 = ((word >> 15) & 0x1f);
+    ret.ops.wrs2 = ((word >> 20) & 0x1f);
+    ret.ops.shift_type = ((word >> 30) & 0x1);
+    {
+      int32_t val = ((word >> 25) & 0x1f);
+      val *= 8;
+      ret.ops.shift_bits = val;
+    }
+    {
+      int32_t val = ((word >> 31) & 0x1);
+      ret.ops.flag_group = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x40003054) && !(~word & 0x0000402b)) {
+    ret.id = OtbnInsnId::kBnAddi;
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrs = ((word >> 15) & 0x1f);
+    {
+      int32_t val = ((word >> 20) & 0x3ff);
+      ret.ops.imm = val;
+    }
+    {
+      int32_t val = ((word >> 31) & 0x1);
+      ret.ops.flag_group = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x40002054) && !(~word & 0x0000502b)) {
+    ret.id = OtbnInsnId::kBnAddm;
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrs1 = ((word >> 15) & 0x1f);
+    ret.ops.wrs2 = ((word >> 20) & 0x1f);
+    return ret;
+  }
+
+  if (!(word & 0x60000044) && !(~word & 0x0000003b)) {
+    ret.id = OtbnInsnId::kBnMulqacc;
+    ret.ops.zero_acc = ((word >> 12) & 0x1);
+    ret.ops.wrs1 = ((word >> 15) & 0x1f);
+    {
+      int32_t val = ((word >> 25) & 0x3);
+      ret.ops.wrs1_qwsel = val;
+    }
+    ret.ops.wrs2 = ((word >> 20) & 0x1f);
+    {
+      int32_t val = ((word >> 27) & 0x3);
+      ret.ops.wrs2_qwsel = val;
+    }
+    {
+      int32_t val = ((word >> 13) & 0x3);
+      val *= 64;
+      ret.ops.acc_shift_imm = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x40000044) && !(~word & 0x2000003b)) {
+    ret.id = OtbnInsnId::kBnMulqaccWo;
+    ret.ops.zero_acc = ((word >> 12) & 0x1);
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrs1 = ((word >> 15) & 0x1f);
+    {
+      int32_t val = ((word >> 25) & 0x3);
+      ret.ops.wrs1_qwsel = val;
+    }
+    ret.ops.wrs2 = ((word >> 20) & 0x1f);
+    {
+      int32_t val = ((word >> 27) & 0x3);
+      ret.ops.wrs2_qwsel = val;
+    }
+    {
+      int32_t val = ((word >> 13) & 0x3);
+      val *= 64;
+      ret.ops.acc_shift_imm = val;
+    }
+    {
+      int32_t val = ((word >> 31) & 0x1);
+      ret.ops.flag_group = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00000044) && !(~word & 0x4000003b)) {
+    ret.id = OtbnInsnId::kBnMulqaccSo;
+    ret.ops.zero_acc = ((word >> 12) & 0x1);
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrd_hwsel = ((word >> 29) & 0x1);
+    ret.ops.wrs1 = ((word >> 15) & 0x1f);
+    {
+      int32_t val = ((word >> 25) & 0x3);
+      ret.ops.wrs1_qwsel = val;
+    }
+    ret.ops.wrs2 = ((word >> 20) & 0x1f);
+    {
+      int32_t val = ((word >> 27) & 0x3);
+      ret.ops.wrs2_qwsel = val;
+    }
+    {
+      int32_t val = ((word >> 13) & 0x3);
+      val *= 64;
+      ret.ops.acc_shift_imm = val;
+    }
+    {
+      int32_t val = ((word >> 31) & 0x1);
+      ret.ops.flag_group = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00006054) && !(~word & 0x0000102b)) {
+    ret.id = OtbnInsnId::kBnSub;
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrs1 = ((word >> 15) & 0x1f);
+    ret.ops.wrs2 = ((word >> 20) & 0x1f);
+    ret.ops.shift_type = ((word >> 30) & 0x1);
+    {
+      int32_t val = ((word >> 25) & 0x1f);
+      val *= 8;
+      ret.ops.shift_bits = val;
+    }
+    {
+      int32_t val = ((word >> 31) & 0x1);
+      ret.ops.flag_group = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00004054) && !(~word & 0x0000302b)) {
+    ret.id = OtbnInsnId::kBnSubb;
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrs1 = ((word >> 15) & 0x1f);
+    ret.ops.wrs2 = ((word >> 20) & 0x1f);
+    ret.ops.shift_type = ((word >> 30) & 0x1);
+    {
+      int32_t val = ((word >> 25) & 0x1f);
+      val *= 8;
+      ret.ops.shift_bits = val;
+    }
+    {
+      int32_t val = ((word >> 31) & 0x1);
+      ret.ops.flag_group = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00003054) && !(~word & 0x4000402b)) {
+    ret.id = OtbnInsnId::kBnSubi;
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrs = ((word >> 15) & 0x1f);
+    {
+      int32_t val = ((word >> 20) & 0x3ff);
+      ret.ops.imm = val;
+    }
+    {
+      int32_t val = ((word >> 31) & 0x1);
+      ret.ops.flag_group = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00002054) && !(~word & 0x4000502b)) {
+    ret.id = OtbnInsnId::kBnSubm;
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrs1 = ((word >> 15) & 0x1f);
+    ret.ops.wrs2 = ((word >> 20) & 0x1f);
+    return ret;
+  }
+
+  if (!(word & 0x00005004) && !(~word & 0x0000207b)) {
+    ret.id = OtbnInsnId::kBnAnd;
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrs1 = ((word >> 15) & 0x1f);
+    ret.ops.wrs2 = ((word >> 20) & 0x1f);
+    ret.ops.shift_type = ((word >> 30) & 0x1);
+    {
+      int32_t val = ((word >> 25) & 0x1f);
+      val *= 8;
+      ret.ops.shift_bits = val;
+    }
+    {
+      int32_t val = ((word >> 31) & 0x1);
+      ret.ops.flag_group = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00003004) && !(~word & 0x0000407b)) {
+    ret.id = OtbnInsnId::kBnOr;
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrs1 = ((word >> 15) & 0x1f);
+    ret.ops.wrs2 = ((word >> 20) & 0x1f);
+    ret.ops.shift_type = ((word >> 30) & 0x1);
+    {
+      int32_t val = ((word >> 25) & 0x1f);
+      val *= 8;
+      ret.ops.shift_bits = val;
+    }
+    {
+      int32_t val = ((word >> 31) & 0x1);
+      ret.ops.flag_group = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00002004) && !(~word & 0x0000507b)) {
+    ret.id = OtbnInsnId::kBnNot;
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrs = ((word >> 20) & 0x1f);
+    ret.ops.shift_type = ((word >> 30) & 0x1);
+    {
+      int32_t val = ((word >> 25) & 0x1f);
+      val *= 8;
+      ret.ops.shift_bits = val;
+    }
+    {
+      int32_t val = ((word >> 31) & 0x1);
+      ret.ops.flag_group = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00001004) && !(~word & 0x0000607b)) {
+    ret.id = OtbnInsnId::kBnXor;
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrs1 = ((word >> 15) & 0x1f);
+    ret.ops.wrs2 = ((word >> 20) & 0x1f);
+    ret.ops.shift_type = ((word >> 30) & 0x1);
+    {
+      int32_t val = ((word >> 25) & 0x1f);
+      val *= 8;
+      ret.ops.shift_bits = val;
+    }
+    {
+      int32_t val = ((word >> 31) & 0x1);
+      ret.ops.flag_group = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00000004) && !(~word & 0x0000307b)) {
+    ret.id = OtbnInsnId::kBnRshi;
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrs1 = ((word >> 15) & 0x1f);
+    ret.ops.wrs2 = ((word >> 20) & 0x1f);
+    {
+      int32_t val = (((word >> 25) & 0x7f) << 1) | ((word >> 14) & 0x1);
+      ret.ops.imm = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00007074) && !(~word & 0x0000000b)) {
+    ret.id = OtbnInsnId::kBnSel;
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrs1 = ((word >> 15) & 0x1f);
+    ret.ops.wrs2 = ((word >> 20) & 0x1f);
+    {
+      int32_t val = ((word >> 31) & 0x1);
+      ret.ops.flag_group = val;
+    }
+    ret.ops.flag = ((word >> 25) & 0x3);
+    return ret;
+  }
+
+  if (!(word & 0x00006074) && !(~word & 0x0000100b)) {
+    ret.id = OtbnInsnId::kBnCmp;
+    ret.ops.wrs1 = ((word >> 15) & 0x1f);
+    ret.ops.wrs2 = ((word >> 20) & 0x1f);
+    ret.ops.shift_type = ((word >> 30) & 0x1);
+    {
+      int32_t val = ((word >> 25) & 0x1f);
+      val *= 8;
+      ret.ops.shift_bits = val;
+    }
+    {
+      int32_t val = ((word >> 31) & 0x1);
+      ret.ops.flag_group = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00004074) && !(~word & 0x0000300b)) {
+    ret.id = OtbnInsnId::kBnCmpb;
+    ret.ops.wrs1 = ((word >> 15) & 0x1f);
+    ret.ops.wrs2 = ((word >> 20) & 0x1f);
+    ret.ops.shift_type = ((word >> 30) & 0x1);
+    {
+      int32_t val = ((word >> 25) & 0x1f);
+      val *= 8;
+      ret.ops.shift_bits = val;
+    }
+    {
+      int32_t val = ((word >> 31) & 0x1);
+      ret.ops.flag_group = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00003074) && !(~word & 0x0000400b)) {
+    ret.id = OtbnInsnId::kBnLid;
+    ret.ops.grd = ((word >> 20) & 0x1f);
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    {
+      int32_t val = (((word >> 9) & 0x7) << 7) | ((word >> 25) & 0x7f);
+      val = (val ^ 0x200) - 0x200;
+      val *= 32;
+      ret.ops.offset = val;
+    }
+    ret.ops.grs1_inc = ((word >> 8) & 0x1);
+    ret.ops.grd_inc = ((word >> 7) & 0x1);
+    return ret;
+  }
+
+  if (!(word & 0x00002074) && !(~word & 0x0000500b)) {
+    ret.id = OtbnInsnId::kBnSid;
+    ret.ops.grs1 = ((word >> 15) & 0x1f);
+    ret.ops.grs2 = ((word >> 20) & 0x1f);
+    {
+      int32_t val = (((word >> 9) & 0x7) << 7) | ((word >> 25) & 0x7f);
+      val = (val ^ 0x200) - 0x200;
+      val *= 32;
+      ret.ops.offset = val;
+    }
+    ret.ops.grs1_inc = ((word >> 8) & 0x1);
+    ret.ops.grs2_inc = ((word >> 7) & 0x1);
+    return ret;
+  }
+
+  if (!(word & 0x80001074) && !(~word & 0x0000600b)) {
+    ret.id = OtbnInsnId::kBnMov;
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    ret.ops.wrs = ((word >> 15) & 0x1f);
+    return ret;
+  }
+
+  if (!(word & 0x00001074) && !(~word & 0x8000600b)) {
+    ret.id = OtbnInsnId::kBnMovr;
+    ret.ops.grd = ((word >> 20) & 0x1f);
+    ret.ops.grs = ((word >> 15) & 0x1f);
+    ret.ops.grd_inc = ((word >> 7) & 0x1);
+    ret.ops.grs_inc = ((word >> 9) & 0x1);
+    return ret;
+  }
+
+  if (!(word & 0x80000074) && !(~word & 0x0000700b)) {
+    ret.id = OtbnInsnId::kBnWsrr;
+    ret.ops.wrd = ((word >> 7) & 0x1f);
+    {
+      int32_t val = ((word >> 20) & 0xff);
+      ret.ops.wsr = val;
+    }
+    return ret;
+  }
+
+  if (!(word & 0x00000074) && !(~word & 0x8000700b)) {
+    ret.id = OtbnInsnId::kBnWsrw;
+    {
+      int32_t val = ((word >> 20) & 0xff);
+      ret.ops.wsr = val;
+    }
+    ret.ops.wrs = ((word >> 15) & 0x1f);
+    return ret;
+  }
+
+  ret.id = OtbnInsnId::kIllegal;
+  return ret;
+}
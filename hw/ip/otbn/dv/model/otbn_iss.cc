@@ -0,0 +1,113 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "otbn_iss.h"
+
+#include <cstring>
+#include <ftw.h>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+
+#include "iss_wrapper.h"
+#include "otbn_lockstep_iss.h"
+#include "otbn_native_iss.h"
+
+// Guard class to create (and possibly delete) temporary directories.
+struct TmpDir {
+  std::string path;
+
+  TmpDir() : path(TmpDir::make_tmp_dir()) {}
+  ~TmpDir() { cleanup(); }
+
+ private:
+  // A wrapper around mkdtemp that respects TMPDIR
+  static std::string make_tmp_dir() {
+    const char *tmpdir = getenv("TMPDIR");
+    if (!tmpdir)
+      tmpdir = "/tmp";
+
+    std::string tmp_template(tmpdir);
+    tmp_template += "/otbn_XXXXXX";
+
+    if (!mkdtemp(&tmp_template.at(0))) {
+      std::ostringstream oss;
+      oss << ("Cannot create temporary directory for OTBN simulation "
+              "with template ")
+          << tmp_template << ": " << strerror(errno);
+      throw std::runtime_error(oss.str());
+    }
+
+    // The backing string for tmp_template will have been populated by mkdtemp.
+    return tmp_template;
+  }
+
+  // Return true if the OTBN_MODEL_KEEP_TMP environment variable is set to 1.
+  static bool should_keep_tmp() {
+    const char *keep_str = getenv("OTBN_MODEL_KEEP_TMP");
+    if (!keep_str)
+      return false;
+    return (strcmp(keep_str, "1") == 0) ? true : false;
+  }
+
+  // Called by nftw when we're deleting the temporary directory
+  static int ftw_callback(const char *fpath, const struct stat *sb,
+                          int typeflag, struct FTW *ftwbuf) {
+    // The libc remove() function calls unlink or rmdir as necessary. Ignore
+    // any failures: we'll check that we managed to delete the directory when
+    // nftw finishes.
+    remove(fpath);
+
+    // Tell nftw to keep going
+    return 0;
+  }
+
+  // Recursively delete the temporary directory
+  void cleanup() {
+    if (path.empty())
+      return;
+
+    if (TmpDir::should_keep_tmp()) {
+      std::cerr << "Keeping temporary directory at " << path
+                << " because OTBN_MODEL_KEEP_TMP=1.\n";
+      return;
+    }
+
+    // We're not supposed to keep the directory. Try to delete it and its
+    // contents. Ignore any failures: we'll just check whether it's gone
+    // afterwards.
+    nftw(path.c_str(), TmpDir::ftw_callback, 4, FTW_DEPTH | FTW_PHYS);
+
+    // Is there still anything at path? If so, we failed. Print something to
+    // stderr to tell the user what's going on.
+    struct stat statbuf;
+    if (stat(path.c_str(), &statbuf) == 0) {
+      std::cerr << "ERROR: Failed to delete OTBN temporary directory at "
+                << path << ".\n";
+    }
+  }
+};
+
+OtbnIss::OtbnIss() : tmpdir(new TmpDir()) {}
+
+OtbnIss::~OtbnIss() {}
+
+std::unique_ptr<OtbnIss> OtbnIss::make(const std::string &engine) {
+  if (engine == "python")
+    return std::unique_ptr<OtbnIss>(new ISSWrapper());
+  if (engine == "native")
+    return std::unique_ptr<OtbnIss>(new OtbnNativeIss());
+  if (engine == "lockstep")
+    return std::unique_ptr<OtbnIss>(new OtbnLockstepIss());
+
+  std::ostringstream oss;
+  oss << "Unknown OTBN ISS engine: `" << engine
+      << "'. Valid engines are python, native and lockstep.";
+  throw std::runtime_error(oss.str());
+}
+
+std::string OtbnIss::make_tmp_path(const std::string &relative) const {
+  return tmpdir->path + "/" + relative;
+}
@@ -0,0 +1,71 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Forward declaration (the implementation is private in otbn_iss.cc)
+struct TmpDir;
+
+// The interface to an OTBN instruction set simulator.
+//
+// There are several implementations. ISSWrapper (iss_wrapper.h) runs the
+// Python model as a subprocess and is the golden reference. OtbnNativeIss
+// (otbn_native_iss.h) is a C++ reimplementation that runs in-process, and
+// OtbnLockstepIss (otbn_lockstep_iss.h) runs both and checks they agree.
+struct OtbnIss {
+  // A 256-bit unsigned integer value, stored in "LSB order". Thus, words[0]
+  // contains the LSB and words[7] contains the MSB.
+  struct u256_t {
+    uint32_t words[256 / 32];
+  };
+
+  OtbnIss();
+  virtual ~OtbnIss();
+
+  // Construct an ISS by engine name: "python" for ISSWrapper, "native" for
+  // OtbnNativeIss or "lockstep" for OtbnLockstepIss. Throws a
+  // std::runtime_error if the name is not known or the ISS can't be started.
+  static std::unique_ptr<OtbnIss> make(const std::string &engine);
+
+  // Load new contents of DMEM / IMEM
+  virtual void load_d(const std::string &path) = 0;
+  virtual void load_i(const std::string &path) = 0;
+
+  // Dump the contents of DMEM to a file
+  virtual void dump_d(const std::string &path) const = 0;
+
+  // Jump to a new address and start running
+  virtual void start(uint32_t addr) = 0;
+
+  // Run simulation for a single cycle. Returns a pair (done, err_code), where
+  // done is true if it is now finished (ECALL or error) and err_code is the
+  // value of ERR_CODE in that case.
+  //
+  // If trace is not null, it is filled with the trace lines for the cycle in
+  // the format that OtbnTraceChecker::OnIssTrace expects.
+  virtual std::pair<bool, uint32_t> step(std::vector<std::string> *trace) = 0;
+
+  // Read contents of the register file
+  virtual void get_regs(std::array<uint32_t, 32> *gprs,
+                        std::array<u256_t, 32> *wdrs) = 0;
+
+  // Read the contents of the call stack
+  virtual std::vector<uint32_t> get_call_stack() = 0;
+
+  // Resolve a path relative to the convenience temporary directory.
+  // relative should be a relative path (it is just appended to the
+  // path of the temporary directory).
+  std::string make_tmp_path(const std::string &relative) const;
+
+ private:
+  // A temporary directory for communicating memory contents
+  std::unique_ptr<TmpDir> tmpdir;
+};
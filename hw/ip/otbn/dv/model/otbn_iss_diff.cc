@@ -0,0 +1,110 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Run a program on the Python and native OTBN models in lock-step
+//
+// Usage: otbn_iss_diff [--start-addr ADDR] [--max-cycles N] IMEM DMEM
+//
+// IMEM and DMEM are flat binary files with the initial contents of the
+// memories (as written by otbn_model.cc). The program runs from ADDR until it
+// finishes (with ECALL or an error) or until it has run for N cycles. Every
+// cycle, the trace output of the two models is compared. At the end of the
+// run, their registers, call stacks and DMEM contents are compared too.
+//
+// Prints "PASS" and exits with status 0 if the models agree. Otherwise, prints
+// the first difference to stderr and exits with status 1. Bad arguments give
+// exit status 2.
+//
+// This is used by dv/otbnsim/lockstep.py, which runs random programs from
+// otbn-rig through it.
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "otbn_lockstep_iss.h"
+
+static void usage(const char *argv0) {
+  std::cerr << "Usage: " << argv0
+            << " [--start-addr ADDR] [--max-cycles N] IMEM DMEM\n";
+}
+
+// Parse a non-negative integer argument (in any base that strtoull accepts)
+static bool parse_uint(const char *str, unsigned long long *dst) {
+  char *end;
+  *dst = strtoull(str, &end, 0);
+  return *str && !*end && *str != '-';
+}
+
+int main(int argc, char **argv) {
+  unsigned long long start_addr = 0;
+  unsigned long long max_cycles = 1000000;
+  const char *paths[2];
+  int num_paths = 0;
+
+  for (int i = 1; i < argc; ++i) {
+    unsigned long long *dst = nullptr;
+    if (strcmp(argv[i], "--start-addr") == 0) {
+      dst = &start_addr;
+    } else if (strcmp(argv[i], "--max-cycles") == 0) {
+      dst = &max_cycles;
+    }
+
+    if (dst) {
+      if (i + 1 == argc || !parse_uint(argv[i + 1], dst)) {
+        usage(argv[0]);
+        return 2;
+      }
+      ++i;
+      continue;
+    }
+
+    if (num_paths == 2) {
+      usage(argv[0]);
+      return 2;
+    }
+    paths[num_paths++] = argv[i];
+  }
+
+  if (num_paths != 2) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  try {
+    OtbnLockstepIss iss;
+    iss.load_i(paths[0]);
+    iss.load_d(paths[1]);
+    iss.start(start_addr);
+
+    unsigned long long cycles = 0;
+    std::pair<bool, uint32_t> ret(false, 0);
+    while (!ret.first && cycles < max_cycles) {
+      ret = iss.step(nullptr);
+      ++cycles;
+    }
+
+    std::array<uint32_t, 32> gprs;
+    std::array<OtbnIss::u256_t, 32> wdrs;
+    iss.get_regs(&gprs, &wdrs);
+    iss.get_call_stack();
+    iss.dump_d(iss.make_tmp_path("dmem_out"));
+
+    std::cout << "PASS: " << cycles << " cycles";
+    if (ret.first) {
+      std::cout << ", ERR_CODE = " << ret.second;
+    } else {
+      std::cout << " (stopped after the cycle limit)";
+    }
+    std::cout << "\n";
+  } catch (const std::runtime_error &err) {
+    std::cerr << "FAIL: " << err.what() << "\n";
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,171 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "otbn_lockstep_iss.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+// Write a trace (one line per entry, indented) to os
+static void dump_trace(std::ostream &os, const char *name,
+                       const std::vector<std::string> &lines) {
+  os << "\n  " << name << " model:";
+  for (const std::string &line : lines) {
+    os << "\n    " << line;
+  }
+}
+
+// Read the whole of a file at path
+static std::vector<char> read_file(const std::string &path) {
+  std::ifstream in(path, std::ios::in | std::ios::binary);
+  if (!in) {
+    std::ostringstream oss;
+    oss << "Cannot open the file '" << path << "'.";
+    throw std::runtime_error(oss.str());
+  }
+  return std::vector<char>(std::istreambuf_iterator<char>(in),
+                           std::istreambuf_iterator<char>());
+}
+
+void OtbnLockstepIss::load_d(const std::string &path) {
+  golden.load_d(path);
+  native.load_d(path);
+}
+
+void OtbnLockstepIss::load_i(const std::string &path) {
+  golden.load_i(path);
+  native.load_i(path);
+}
+
+void OtbnLockstepIss::dump_d(const std::string &path) const {
+  std::string native_path = path + ".native";
+  golden.dump_d(path);
+  native.dump_d(native_path);
+
+  std::vector<char> golden_data = read_file(path);
+  std::vector<char> native_data = read_file(native_path);
+  if (golden_data == native_data)
+    return;
+
+  std::ostringstream oss;
+  oss << "Lock-step mismatch in DMEM contents";
+  if (golden_data.size() != native_data.size()) {
+    oss << ": Python model has " << golden_data.size()
+        << " bytes, but native model has " << native_data.size() << ".";
+    throw std::runtime_error(oss.str());
+  }
+
+  size_t mismatches = 0;
+  oss << std::hex << std::setfill('0');
+  for (size_t i = 0; i < golden_data.size(); ++i) {
+    if (golden_data[i] == native_data[i])
+      continue;
+
+    if (++mismatches > 10) {
+      oss << "\n  (skipping further mismatches...)";
+      break;
+    }
+    oss << "\n  @offset 0x" << std::setw(3) << i << ": python has 0x"
+        << std::setw(2) << (int)(uint8_t)golden_data[i] << "; native has 0x"
+        << std::setw(2) << (int)(uint8_t)native_data[i];
+  }
+  throw std::runtime_error(oss.str());
+}
+
+void OtbnLockstepIss::start(uint32_t addr) {
+  golden.start(addr);
+  native.start(addr);
+}
+
+std::pair<bool, uint32_t> OtbnLockstepIss::step(
+    std::vector<std::string> *trace) {
+  std::vector<std::string> golden_lines, native_lines;
+  std::pair<bool, uint32_t> golden_ret = golden.step(&golden_lines);
+
+  std::pair<bool, uint32_t> native_ret;
+  try {
+    native_ret = native.step(&native_lines);
+  } catch (const std::runtime_error &err) {
+    std::ostringstream oss;
+    oss << "Native model failed at cycle " << cycle_count << ": "
+        << err.what();
+    dump_trace(oss, "Python", golden_lines);
+    throw std::runtime_error(oss.str());
+  }
+
+  if (golden_lines != native_lines || golden_ret != native_ret) {
+    std::ostringstream oss;
+    oss << "Lock-step mismatch at cycle " << cycle_count << ".";
+    dump_trace(oss, "Python", golden_lines);
+    dump_trace(oss, "Native", native_lines);
+    throw std::runtime_error(oss.str());
+  }
+
+  ++cycle_count;
+  if (trace) {
+    trace->swap(golden_lines);
+  }
+  return golden_ret;
+}
+
+void OtbnLockstepIss::get_regs(std::array<uint32_t, 32> *gprs,
+                               std::array<u256_t, 32> *wdrs) {
+  std::array<uint32_t, 32> native_gprs;
+  std::array<u256_t, 32> native_wdrs;
+  golden.get_regs(gprs, wdrs);
+  native.get_regs(&native_gprs, &native_wdrs);
+
+  std::ostringstream oss;
+  oss << std::hex << std::setfill('0');
+  bool good = true;
+  for (int i = 0; i < 32; ++i) {
+    if ((*gprs)[i] != native_gprs[i]) {
+      oss << "\n  x" << std::dec << i << std::hex << ": python has 0x"
+          << std::setw(8) << (*gprs)[i] << "; native has 0x" << std::setw(8)
+          << native_gprs[i];
+      good = false;
+    }
+  }
+  for (int i = 0; i < 32; ++i) {
+    if (memcmp(&(*wdrs)[i], &native_wdrs[i], sizeof(u256_t)) != 0) {
+      oss << "\n  w" << std::dec << i << std::hex << ": python has 0x";
+      for (int j = 7; j >= 0; --j) {
+        oss << std::setw(8) << (*wdrs)[i].words[j];
+      }
+      oss << "; native has 0x";
+      for (int j = 7; j >= 0; --j) {
+        oss << std::setw(8) << native_wdrs[i].words[j];
+      }
+      good = false;
+    }
+  }
+
+  if (!good) {
+    throw std::runtime_error("Lock-step mismatch in registers:" + oss.str());
+  }
+}
+
+std::vector<uint32_t> OtbnLockstepIss::get_call_stack() {
+  std::vector<uint32_t> golden_stack = golden.get_call_stack();
+  std::vector<uint32_t> native_stack = native.get_call_stack();
+  if (golden_stack != native_stack) {
+    std::ostringstream oss;
+    oss << "Lock-step mismatch in call stack:" << std::hex
+        << std::setfill('0');
+    oss << "\n  Python model:";
+    for (uint32_t val : golden_stack) {
+      oss << " 0x" << std::setw(8) << val;
+    }
+    oss << "\n  Native model:";
+    for (uint32_t val : native_stack) {
+      oss << " 0x" << std::setw(8) << val;
+    }
+    throw std::runtime_error(oss.str());
+  }
+  return golden_stack;
+}
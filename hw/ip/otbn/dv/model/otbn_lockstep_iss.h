@@ -0,0 +1,41 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "iss_wrapper.h"
+#include "otbn_iss.h"
+#include "otbn_native_iss.h"
+
+// An ISS that runs the Python model (ISSWrapper) and the native model
+// (OtbnNativeIss) in lock-step.
+//
+// Each cycle, both models are stepped and their trace lines and (done,
+// err_code) results are compared. Register, call stack and DMEM contents are
+// compared when they are read. Any difference causes a std::runtime_error
+// that shows what each model did. Otherwise, this behaves exactly like the
+// Python model, which is the golden reference.
+struct OtbnLockstepIss : public OtbnIss {
+  void load_d(const std::string &path) override;
+  void load_i(const std::string &path) override;
+  void dump_d(const std::string &path) const override;
+  void start(uint32_t addr) override;
+  std::pair<bool, uint32_t> step(std::vector<std::string> *trace) override;
+  void get_regs(std::array<uint32_t, 32> *gprs,
+                std::array<u256_t, 32> *wdrs) override;
+  std::vector<uint32_t> get_call_stack() override;
+
+ private:
+  ISSWrapper golden;
+  OtbnNativeIss native;
+
+  // The number of cycles that we have stepped, for error messages
+  uint64_t cycle_count = 0;
+};
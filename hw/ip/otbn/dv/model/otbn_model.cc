@@ -12,7 +12,7 @@
 #include <string>
 #include <svdpi.h>
 
-#include "iss_wrapper.h"
+#include "otbn_iss.h"
 #include "otbn_trace_checker.h"
 #include "sv_scoped.h"
 
@@ -64,7 +64,7 @@ int otbn_stack_element_peek(int index, svBitVecVal *val) __attribute__((weak));
 //
 // If start_i is true, we start the model at start_addr and then step once (as
 // described above).
-extern "C" unsigned otbn_model_step(ISSWrapper *model, const char *imem_scope,
+extern "C" unsigned otbn_model_step(OtbnIss *model, const char *imem_scope,
                                     unsigned imem_words, const char *dmem_scope,
                                     unsigned dmem_words,
                                     const char *design_scope, svLogic start_i,
@@ -187,20 +187,27 @@ static void load_memory_from_file(const std::string &path, const char *scope,
                  word_size);
 }
 
-extern "C" ISSWrapper *otbn_model_init() {
+// Construct the ISS. The OTBN_MODEL_ENGINE environment variable selects the
+// implementation (see OtbnIss::make). The default is "python", which runs the
+// Python model as a subprocess.
+extern "C" OtbnIss *otbn_model_init() {
+  const char *engine = getenv("OTBN_MODEL_ENGINE");
+  if (!engine)
+    engine = "python";
+
   try {
-    return new ISSWrapper();
+    return OtbnIss::make(engine).release();
   } catch (const std::runtime_error &err) {
-    std::cerr << "Error when constructing ISS wrapper: " << err.what() << "\n";
+    std::cerr << "Error when constructing ISS: " << err.what() << "\n";
     return nullptr;
   }
 }
 
-extern "C" void otbn_model_destroy(ISSWrapper *model) { delete model; }
+extern "C" void otbn_model_destroy(OtbnIss *model) { delete model; }
 
 // Start a new run with the model, writing IMEM/DMEM and jumping to the given
 // start address. Returns 0 on success; -1 on failure.
-static int start_model(ISSWrapper *model, const char *imem_scope,
+static int start_model(OtbnIss *model, const char *imem_scope,
                        unsigned imem_words, const char *dmem_scope,
                        unsigned dmem_words, unsigned start_addr) {
   assert(model);
@@ -234,12 +241,17 @@ static int start_model(ISSWrapper *model, const char *imem_scope,
 // Step once in the model. Returns 1 if the model has finished, 0 if not and -1
 // on failure. If gen_trace is true, pass trace entries to the trace checker.
 // If the model has finished, writes otbn.ERR_CODE to *err_code.
-static int step_model(ISSWrapper *model, bool gen_trace, uint32_t *err_code) {
+static int step_model(OtbnIss *model, bool gen_trace, uint32_t *err_code) {
   assert(model);
   assert(err_code);
 
   try {
-    std::pair<bool, uint32_t> ret = model->step(gen_trace);
+    std::vector<std::string> lines;
+    std::pair<bool, uint32_t> ret = model->step(gen_trace ? &lines : nullptr);
+    if (gen_trace) {
+      OtbnTraceChecker::get().OnIssTrace(lines);
+    }
+
     if (ret.first) {
       *err_code = ret.second;
       return 1;
@@ -254,7 +266,7 @@ static int step_model(ISSWrapper *model, bool gen_trace, uint32_t *err_code) {
 
 // Grab contents of dmem from the model and load it back into the RTL. Returns
 // 0 on success; -1 on failure.
-static int load_dmem(ISSWrapper *model, const char *dmem_scope,
+static int load_dmem(OtbnIss *model, const char *dmem_scope,
                      unsigned dmem_words) {
   assert(model);
   std::string dfname(model->make_tmp_path("dmem_out"));
@@ -271,7 +283,7 @@ static int load_dmem(ISSWrapper *model, const char *dmem_scope,
 // Grab contents of dmem from the model and compare it with the RTL.
 // Prints messages to stderr on failure or mismatch. Returns true on
 // success; false on mismatch. Throws a std::runtime_error on failure.
-static bool check_dmem(ISSWrapper *model, const char *dmem_scope,
+static bool check_dmem(OtbnIss *model, const char *dmem_scope,
                        unsigned dmem_words) {
   assert(model);
 
@@ -388,7 +400,7 @@ static std::vector<T> get_stack(const std::string &stack_scope) {
 // Compare contents of ISS registers with those from the design. Prints
 // messages to stderr on failure or mismatch. Returns true on success; false on
 // mismatch. Throws a std::runtime_error on failure.
-static bool check_regs(ISSWrapper *model, const std::string &design_scope) {
+static bool check_regs(OtbnIss *model, const std::string &design_scope) {
   assert(model);
 
   std::string base_scope =
@@ -398,10 +410,10 @@ static bool check_regs(ISSWrapper *model, const std::string &design_scope) {
       design_scope + ".gen_rf_bignum_ff.u_otbn_rf_bignum.u_snooper";
 
   auto rtl_gprs = get_rtl_regs<uint32_t>(base_scope);
-  auto rtl_wdrs = get_rtl_regs<ISSWrapper::u256_t>(wide_scope);
+  auto rtl_wdrs = get_rtl_regs<OtbnIss::u256_t>(wide_scope);
 
   std::array<uint32_t, 32> iss_gprs;
-  std::array<ISSWrapper::u256_t, 32> iss_wdrs;
+  std::array<OtbnIss::u256_t, 32> iss_wdrs;
   model->get_regs(&iss_gprs, &iss_wdrs);
 
   bool good = true;
@@ -451,8 +463,7 @@ static bool check_regs(ISSWrapper *model, const std::string &design_scope) {
 // Compare contents of ISS call stack with those from the design. Prints
 // messages to stderr on failure or mismatch. Returns true on success; false on
 // mismatch.  Throws a std::runtime_error on failure.
-static bool check_call_stack(ISSWrapper *model,
-                             const std::string &design_scope) {
+static bool check_call_stack(OtbnIss *model, const std::string &design_scope) {
   assert(model);
 
   std::string call_stack_snooper_scope =
@@ -493,7 +504,7 @@ static bool check_call_stack(ISSWrapper *model,
 // Check model against RTL when a run has finished. Prints messages to stderr
 // on failure or mismatch. Returns 1 for a match, 0 for a mismatch, -1 for some
 // other failure.
-int check_model(ISSWrapper *model, const char *dmem_scope, unsigned dmem_words,
+int check_model(OtbnIss *model, const char *dmem_scope, unsigned dmem_words,
                 const char *design_scope) {
   assert(model);
   assert(dmem_words >= 0);
@@ -537,7 +548,7 @@ static void set_err_code(svBitVecVal *dst, uint32_t src) {
   }
 }
 
-extern "C" unsigned otbn_model_step(ISSWrapper *model, const char *imem_scope,
+extern "C" unsigned otbn_model_step(OtbnIss *model, const char *imem_scope,
                                     unsigned imem_words, const char *dmem_scope,
                                     unsigned dmem_words,
                                     const char *design_scope, svLogic start_i,
@@ -0,0 +1,1095 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "otbn_native_iss.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+// Error codes, as written to ERR_CODE (see sim/alert.py in otbnsim)
+#define ERR_CODE_BAD_DATA_ADDR 0x1
+#define ERR_CODE_CALL_STACK 0x3
+#define ERR_CODE_LOOP 0x5
+
+// The depths of the x1 call stack and the loop stack
+#define CALL_STACK_DEPTH 8
+#define LOOP_STACK_DEPTH 8
+
+// The value of the RND WSR. This must match the RTL and the Python model (see
+// RandWSR in sim/wsr.py).
+#define RND_U32 0x99999999U
+
+namespace {
+// Thrown when an instruction does something that causes an alert (the
+// equivalent of the Alert exception in the Python model). The alert is caught
+// in OtbnNativeIss::step, which stops OTBN with the given error code.
+struct Alert {
+  uint32_t err_code;
+};
+
+// Thrown for things that crash the Python model (such as assertion failures
+// or illegal instructions), which aren't architectural errors.
+std::runtime_error model_error(const char *fmt, uint32_t arg) {
+  char buf[128];
+  snprintf(buf, sizeof buf, fmt, arg);
+  return std::runtime_error(buf);
+}
+}  // namespace
+
+// Bit positions of the flags in a flag group
+#define FLAG_C (1U << 0)
+#define FLAG_M (1U << 1)
+#define FLAG_L (1U << 2)
+#define FLAG_Z (1U << 3)
+
+OtbnNativeIss::OtbnNativeIss()
+    : dmem_(kOtbnDmemSizeBytes / 4, 0xdeadbeef),
+      gprs_{},
+      wdrs_{},
+      mod_{},
+      acc_{},
+      flags_{},
+      pc_(0),
+      ext_regs_{},
+      gprs_pending_(0),
+      x1_read_(false),
+      wdrs_pending_(0),
+      mod_pending_(false),
+      acc_pending_(false),
+      flags_pending_(0),
+      pc_next_valid_(false),
+      pc_next_(0),
+      ext_regs_next_{},
+      running_(false),
+      stalled_(false),
+      start_stall_(false),
+      stalls_(0) {}
+
+// Read a whole file at path
+static std::vector<uint8_t> read_file(const std::string &path) {
+  std::ifstream in(path, std::ios::in | std::ios::binary);
+  if (!in) {
+    std::ostringstream oss;
+    oss << "Cannot open the file '" << path << "'.";
+    throw std::runtime_error(oss.str());
+  }
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(in),
+                              std::istreambuf_iterator<char>());
+}
+
+// Read a little-endian 32-bit word
+static uint32_t get_le32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+void OtbnNativeIss::load_d(const std::string &path) {
+  std::vector<uint8_t> data = read_file(path);
+  if (data.size() > kOtbnDmemSizeBytes) {
+    std::ostringstream oss;
+    oss << "Trying to load " << data.size() << " bytes of data, but DMEM is "
+        << "only " << kOtbnDmemSizeBytes << " bytes long.";
+    throw std::runtime_error(oss.str());
+  }
+
+  // The Python model pads the data to a whole number of 256-bit words with
+  // '0' characters (see Dmem.load_le_words). Do the same.
+  data.resize((data.size() + 31) & ~(size_t)31, '0');
+  for (size_t i = 0; i < data.size() / 4; ++i) {
+    dmem_[i] = get_le32(&data[4 * i]);
+  }
+}
+
+void OtbnNativeIss::load_i(const std::string &path) {
+  std::vector<uint8_t> data = read_file(path);
+  if (data.size() % 4) {
+    std::ostringstream oss;
+    oss << "IMEM file '" << path << "' has length " << data.size()
+        << ", which is not a multiple of 4.";
+    throw std::runtime_error(oss.str());
+  }
+
+  program_.clear();
+  for (size_t i = 0; i < data.size() / 4; ++i) {
+    program_.push_back(otbn_decode(get_le32(&data[4 * i]), 4 * i));
+  }
+}
+
+void OtbnNativeIss::dump_d(const std::string &path) const {
+  std::vector<uint8_t> data;
+  for (uint32_t word : dmem_) {
+    for (int i = 0; i < 4; ++i) {
+      data.push_back(word >> (8 * i));
+    }
+  }
+
+  std::ofstream out(path, std::ios::out | std::ios::binary);
+  out.write(reinterpret_cast<const char *>(&data[0]), data.size());
+  if (!out) {
+    std::ostringstream oss;
+    oss << "Cannot write DMEM contents to '" << path << "'.";
+    throw std::runtime_error(oss.str());
+  }
+}
+
+void OtbnNativeIss::start(uint32_t addr) {
+  if (addr & 3) {
+    throw model_error("start address must be word-aligned. Got %#x.", addr);
+  }
+
+  // This matches OTBNState.start: set the busy flag and stall for a cycle
+  // before fetching the first instruction.
+  pc_ = addr;
+  ext_write(kExtStatus, ext_regs_next_[kExtStatus] | 1);
+  running_ = true;
+  start_stall_ = true;
+  stalled_ = true;
+}
+
+std::pair<bool, uint32_t> OtbnNativeIss::step(std::vector<std::string> *trace) {
+  if (trace) {
+    trace->clear();
+  }
+
+  if (!running_) {
+    if (trace) {
+      trace->push_back("STALL");
+    }
+    return std::make_pair(false, 0);
+  }
+
+  const OtbnDecodedInsn *insn = nullptr;
+  uint32_t pc = pc_;
+  std::vector<std::string> lines;
+  std::pair<bool, uint32_t> ret(false, 0);
+
+  try {
+    if (!stalled_) {
+      uint32_t word_pc = pc_ >> 2;
+      if (word_pc >= program_.size()) {
+        std::ostringstream oss;
+        oss << "Trying to execute instruction at address 0x" << std::hex
+            << pc_ << ", but the program is only 0x" << 4 * program_.size()
+            << " bytes long.";
+        throw std::runtime_error(oss.str());
+      }
+      insn = &program_[word_pc];
+
+      const OtbnInsnInfo &info = kOtbnInsnInfo[(unsigned)insn->id];
+      if (info.cycles > 1) {
+        stalls_ += info.cycles - 1;
+      }
+
+      // Check for a control flow instruction at the end of a loop body (see
+      // LoopStack.check_insn). The Python model doesn't treat ECALL as a
+      // control flow instruction here, so we don't either.
+      bool affects_control =
+          !info.straight_line && insn->id != OtbnInsnId::kEcall;
+      if (!loop_stack_.empty() && pc_ + 4 == loop_stack_.back().match_addr &&
+          affects_control) {
+        throw Alert{ERR_CODE_LOOP};
+      }
+
+      execute(*insn);
+
+      // Check the jump destination (see OTBNState.check_jump_dest). Note that
+      // a bad PC is reported as a bad data address, like the Python model.
+      if (pc_next_valid_) {
+        if (pc_next_ < 0) {
+          throw model_error("Negative jump destination at PC %#x.", pc_);
+        }
+        if ((pc_next_ & 3) || pc_next_ >= kOtbnImemSizeBytes) {
+          throw Alert{ERR_CODE_BAD_DATA_ADDR};
+        }
+      }
+
+      // Step the loop stack (see LoopStack.step), which updates it
+      // immediately.
+      if (!loop_stack_.empty() && loop_stack_.back().match_addr == pc_ + 4) {
+        LoopLevel &top = loop_stack_.back();
+        if (!top.restarts_left) {
+          loop_stack_.pop_back();
+        } else {
+          --top.restarts_left;
+          pc_next_valid_ = true;
+          pc_next_ = top.start_addr;
+        }
+      }
+
+      ret = pending_changes(&lines);
+    }
+
+    commit();
+
+  } catch (const Alert &alert) {
+    // Roll back any pending changes and stop with an error. The changes are
+    // then just the updates to the external registers.
+    abort();
+    stop(true, alert.err_code);
+    lines.clear();
+    ret = pending_changes(&lines);
+  }
+
+  if (trace) {
+    char hdr[64];
+    if (insn) {
+      snprintf(hdr, sizeof hdr, "E PC: 0x%08x, insn: 0x%08x", pc, insn->raw);
+    } else {
+      snprintf(hdr, sizeof hdr, "STALL");
+    }
+    trace->push_back(hdr);
+    std::move(lines.begin(), lines.end(), std::back_inserter(*trace));
+  }
+
+  return ret;
+}
+
+void OtbnNativeIss::get_regs(std::array<uint32_t, 32> *gprs,
+                             std::array<u256_t, 32> *wdrs) {
+  assert(gprs && wdrs);
+
+  // The Python model reports x1 as zero (the call stack is read with
+  // get_call_stack).
+  for (int i = 0; i < 32; ++i) {
+    (*gprs)[i] = (i == 1) ? 0 : gprs_[i];
+    for (int j = 0; j < 8; ++j) {
+      (*wdrs)[i].words[j] = wdrs_[i].limbs[j / 2] >> (32 * (j % 2));
+    }
+  }
+}
+
+std::vector<uint32_t> OtbnNativeIss::get_call_stack() { return call_stack_; }
+
+// Add a and b, with carry in, writing the result to dst. Returns the carry
+// out.
+static bool add_wide(const uint64_t *a, const uint64_t *b, bool carry,
+                     uint64_t *dst) {
+  for (int i = 0; i < 4; ++i) {
+    unsigned __int128 sum = (unsigned __int128)a[i] + b[i] + carry;
+    dst[i] = (uint64_t)sum;
+    carry = (sum >> 64) != 0;
+  }
+  return carry;
+}
+
+// Subtract b from a, with borrow in, writing the result to dst. Returns the
+// borrow out.
+static bool sub_wide(const uint64_t *a, const uint64_t *b, bool borrow,
+                     uint64_t *dst) {
+  for (int i = 0; i < 4; ++i) {
+    unsigned __int128 diff = (unsigned __int128)a[i] - b[i] - borrow;
+    dst[i] = (uint64_t)diff;
+    borrow = (diff >> 64) != 0;
+  }
+  return borrow;
+}
+
+// Shift the num_limbs-limb value at src right by shift bits, writing the
+// bottom 4 limbs of the result to dst.
+static void shr_limbs(const uint64_t *src, unsigned num_limbs, unsigned shift,
+                      uint64_t *dst) {
+  unsigned limb_shift = shift / 64, bit_shift = shift % 64;
+  for (unsigned i = 0; i < 4; ++i) {
+    unsigned lo_idx = i + limb_shift;
+    uint64_t lo = lo_idx < num_limbs ? src[lo_idx] : 0;
+    uint64_t hi = lo_idx + 1 < num_limbs ? src[lo_idx + 1] : 0;
+    dst[i] = bit_shift ? (lo >> bit_shift) | (hi << (64 - bit_shift)) : lo;
+  }
+}
+
+// Shift the 256-bit value at src left by shift bits (truncating), writing the
+// result to dst.
+static void shl_limbs(const uint64_t *src, unsigned shift, uint64_t *dst) {
+  unsigned limb_shift = shift / 64, bit_shift = shift % 64;
+  for (unsigned i = 0; i < 4; ++i) {
+    uint64_t cur = i >= limb_shift ? src[i - limb_shift] : 0;
+    uint64_t prev = i >= limb_shift + 1 ? src[i - limb_shift - 1] : 0;
+    dst[i] = bit_shift ? (cur << bit_shift) | (prev >> (64 - bit_shift)) : cur;
+  }
+}
+
+static bool is_zero(const uint64_t *a, unsigned num_limbs) {
+  for (unsigned i = 0; i < num_limbs; ++i) {
+    if (a[i])
+      return false;
+  }
+  return true;
+}
+
+// Return true if a < b
+static bool less_than(const uint64_t *a, const uint64_t *b) {
+  for (int i = 3; i >= 0; --i) {
+    if (a[i] != b[i])
+      return a[i] < b[i];
+  }
+  return false;
+}
+
+// Compute the flags for a result (see FlagReg.mlz_for_result)
+static unsigned mlz_flags(bool carry, const uint64_t *result) {
+  return (carry ? FLAG_C : 0) | ((result[3] >> 63) ? FLAG_M : 0) |
+         ((result[0] & 1) ? FLAG_L : 0) | (is_zero(result, 4) ? FLAG_Z : 0);
+}
+
+void OtbnNativeIss::execute(const OtbnDecodedInsn &insn) {
+  const OtbnOperands &op = insn.ops;
+
+  switch (insn.id) {
+    case OtbnInsnId::kAdd:
+      write_gpr(op.grd, read_gpr(op.grs1) + read_gpr(op.grs2));
+      break;
+
+    case OtbnInsnId::kAddi:
+      write_gpr(op.grd, read_gpr(op.grs1) + (uint32_t)op.imm);
+      break;
+
+    case OtbnInsnId::kLui:
+      write_gpr(op.grd, (uint32_t)op.imm << 12);
+      break;
+
+    case OtbnInsnId::kSub:
+      write_gpr(op.grd, read_gpr(op.grs1) - read_gpr(op.grs2));
+      break;
+
+    case OtbnInsnId::kSll: {
+      uint32_t val1 = read_gpr(op.grs1);
+      write_gpr(op.grd, val1 << (read_gpr(op.grs2) & 0x1f));
+      break;
+    }
+
+    case OtbnInsnId::kSlli:
+      write_gpr(op.grd, read_gpr(op.grs1) << op.shamt);
+      break;
+
+    case OtbnInsnId::kSrl: {
+      uint32_t val1 = read_gpr(op.grs1);
+      write_gpr(op.grd, val1 >> (read_gpr(op.grs2) & 0x1f));
+      break;
+    }
+
+    case OtbnInsnId::kSrli:
+      write_gpr(op.grd, read_gpr(op.grs1) >> op.shamt);
+      break;
+
+    case OtbnInsnId::kSra: {
+      int32_t val1 = (int32_t)read_gpr(op.grs1);
+      write_gpr(op.grd, (uint32_t)(val1 >> (read_gpr(op.grs2) & 0x1f)));
+      break;
+    }
+
+    case OtbnInsnId::kSrai:
+      write_gpr(op.grd, (uint32_t)((int32_t)read_gpr(op.grs1) >> op.shamt));
+      break;
+
+    case OtbnInsnId::kAnd: {
+      uint32_t val1 = read_gpr(op.grs1);
+      write_gpr(op.grd, val1 & read_gpr(op.grs2));
+      break;
+    }
+
+    case OtbnInsnId::kAndi:
+      write_gpr(op.grd, read_gpr(op.grs1) & (uint32_t)op.imm);
+      break;
+
+    case OtbnInsnId::kOr: {
+      uint32_t val1 = read_gpr(op.grs1);
+      write_gpr(op.grd, val1 | read_gpr(op.grs2));
+      break;
+    }
+
+    case OtbnInsnId::kOri:
+      write_gpr(op.grd, read_gpr(op.grs1) | (uint32_t)op.imm);
+      break;
+
+    case OtbnInsnId::kXor: {
+      uint32_t val1 = read_gpr(op.grs1);
+      write_gpr(op.grd, val1 ^ read_gpr(op.grs2));
+      break;
+    }
+
+    case OtbnInsnId::kXori:
+      write_gpr(op.grd, read_gpr(op.grs1) ^ (uint32_t)op.imm);
+      break;
+
+    case OtbnInsnId::kLw: {
+      uint32_t addr = read_gpr(op.grs1) + (uint32_t)op.offset;
+      write_gpr(op.grd, load_u32(addr));
+      break;
+    }
+
+    case OtbnInsnId::kSw: {
+      uint32_t addr = read_gpr(op.grs1) + (uint32_t)op.offset;
+      store_u32(addr, read_gpr(op.grs2));
+      break;
+    }
+
+    case OtbnInsnId::kBeq:
+    case OtbnInsnId::kBne: {
+      uint32_t val1 = read_gpr(op.grs1);
+      uint32_t val2 = read_gpr(op.grs2);
+      if ((val1 == val2) == (insn.id == OtbnInsnId::kBeq)) {
+        pc_next_valid_ = true;
+        pc_next_ = op.offset;
+      }
+      break;
+    }
+
+    case OtbnInsnId::kJal:
+      write_gpr(op.grd, pc_ + 4);
+      pc_next_valid_ = true;
+      pc_next_ = op.offset;
+      break;
+
+    case OtbnInsnId::kJalr: {
+      uint32_t val1 = read_gpr(op.grs1);
+      write_gpr(op.grd, pc_ + 4);
+      pc_next_valid_ = true;
+      pc_next_ = (uint32_t)(val1 + (uint32_t)op.offset);
+      break;
+    }
+
+    case OtbnInsnId::kCsrrs: {
+      uint32_t old_val = read_csr(op.csr);
+      uint32_t bits_to_set = read_gpr(op.grs1);
+      write_gpr(op.grd, old_val);
+      write_csr(op.csr, old_val | bits_to_set);
+      break;
+    }
+
+    case OtbnInsnId::kCsrrw: {
+      uint32_t new_val = read_gpr(op.grs1);
+      if (op.grd != 0) {
+        write_gpr(op.grd, read_csr(op.csr));
+      }
+      write_csr(op.csr, new_val);
+      break;
+    }
+
+    case OtbnInsnId::kEcall:
+      stop(false, 0);
+      break;
+
+    case OtbnInsnId::kLoop: {
+      uint32_t num_iters = read_gpr(op.grs);
+      if (num_iters == 0) {
+        throw Alert{ERR_CODE_LOOP};
+      }
+      loop_start(num_iters, op.bodysize);
+      break;
+    }
+
+    case OtbnInsnId::kLoopi:
+      loop_start(op.iterations, op.bodysize);
+      break;
+
+    case OtbnInsnId::kBnAdd:
+    case OtbnInsnId::kBnAddc:
+    case OtbnInsnId::kBnSub:
+    case OtbnInsnId::kBnSubb:
+    case OtbnInsnId::kBnCmp:
+    case OtbnInsnId::kBnCmpb: {
+      Wide b_shifted, result;
+      if (op.shift_type == 0) {
+        shl_limbs(wdrs_[op.wrs2].limbs, op.shift_bits, b_shifted.limbs);
+      } else {
+        shr_limbs(wdrs_[op.wrs2].limbs, 4, op.shift_bits, b_shifted.limbs);
+      }
+
+      bool carry_in = (insn.id == OtbnInsnId::kBnAddc ||
+                       insn.id == OtbnInsnId::kBnSubb ||
+                       insn.id == OtbnInsnId::kBnCmpb) &&
+                      (flags_[op.flag_group] & FLAG_C);
+      bool is_add =
+          insn.id == OtbnInsnId::kBnAdd || insn.id == OtbnInsnId::kBnAddc;
+      bool carry_out =
+          is_add ? add_wide(wdrs_[op.wrs1].limbs, b_shifted.limbs, carry_in,
+                            result.limbs)
+                 : sub_wide(wdrs_[op.wrs1].limbs, b_shifted.limbs, carry_in,
+                            result.limbs);
+
+      if (insn.id != OtbnInsnId::kBnCmp && insn.id != OtbnInsnId::kBnCmpb) {
+        write_wdr(op.wrd, result);
+      }
+      set_flags(op.flag_group, mlz_flags(carry_out, result.limbs));
+      break;
+    }
+
+    case OtbnInsnId::kBnAddi:
+    case OtbnInsnId::kBnSubi: {
+      Wide imm = {{(uint64_t)op.imm, 0, 0, 0}}, result;
+      bool carry_out =
+          insn.id == OtbnInsnId::kBnAddi
+              ? add_wide(wdrs_[op.wrs].limbs, imm.limbs, false, result.limbs)
+              : sub_wide(wdrs_[op.wrs].limbs, imm.limbs, false, result.limbs);
+      write_wdr(op.wrd, result);
+      set_flags(op.flag_group, mlz_flags(carry_out, result.limbs));
+      break;
+    }
+
+    case OtbnInsnId::kBnAddm: {
+      // If the (257-bit) sum is at least MOD, subtract MOD.
+      Wide result;
+      bool carry = add_wide(wdrs_[op.wrs1].limbs, wdrs_[op.wrs2].limbs, false,
+                            result.limbs);
+      if (carry || !less_than(result.limbs, mod_.limbs)) {
+        sub_wide(result.limbs, mod_.limbs, false, result.limbs);
+      }
+      write_wdr(op.wrd, result);
+      break;
+    }
+
+    case OtbnInsnId::kBnSubm: {
+      // If the difference is negative, add MOD.
+      Wide result;
+      bool borrow = sub_wide(wdrs_[op.wrs1].limbs, wdrs_[op.wrs2].limbs,
+                             false, result.limbs);
+      if (borrow) {
+        add_wide(result.limbs, mod_.limbs, false, result.limbs);
+      }
+      write_wdr(op.wrd, result);
+      break;
+    }
+
+    case OtbnInsnId::kBnMulqacc:
+    case OtbnInsnId::kBnMulqaccWo:
+    case OtbnInsnId::kBnMulqaccSo: {
+      unsigned __int128 product =
+          (unsigned __int128)wdrs_[op.wrs1].limbs[op.wrs1_qwsel] *
+          wdrs_[op.wrs2].limbs[op.wrs2_qwsel];
+
+      // acc_shift_imm is a multiple of 64, so the shifted product lines up
+      // with the limbs.
+      Wide shifted = {}, acc;
+      unsigned limb = op.acc_shift_imm / 64;
+      shifted.limbs[limb] = (uint64_t)product;
+      if (limb < 3) {
+        shifted.limbs[limb + 1] = (uint64_t)(product >> 64);
+      }
+      if (op.zero_acc) {
+        acc = shifted;
+      } else {
+        add_wide(acc_.limbs, shifted.limbs, false, acc.limbs);
+      }
+
+      if (insn.id == OtbnInsnId::kBnMulqacc) {
+        write_wsr(2, acc);
+        break;
+      }
+
+      if (insn.id == OtbnInsnId::kBnMulqaccWo) {
+        write_wdr(op.wrd, acc);
+        write_wsr(2, acc);
+        set_flags(op.flag_group,
+                  (flags_[op.flag_group] & FLAG_C) | mlz_flags(false, acc.limbs));
+        break;
+      }
+
+      // bn.mulqacc.so writes the bottom half of the result to a half of wrd
+      // and shifts the accumulator down.
+      uint64_t lo[2] = {acc.limbs[0], acc.limbs[1]};
+      Wide hi = {{acc.limbs[2], acc.limbs[3], 0, 0}};
+      Wide wrd_val = wdrs_[op.wrd];
+      wrd_val.limbs[2 * op.wrd_hwsel] = lo[0];
+      wrd_val.limbs[2 * op.wrd_hwsel + 1] = lo[1];
+      write_wdr(op.wrd, wrd_val);
+      write_wsr(2, hi);
+
+      unsigned old_flags = flags_[op.flag_group];
+      unsigned new_flags = old_flags & FLAG_C;
+      if (op.wrd_hwsel) {
+        new_flags |= (lo[1] >> 63) ? FLAG_M : 0;
+        new_flags |= old_flags & FLAG_L;
+        new_flags |= ((old_flags & FLAG_Z) && is_zero(lo, 2)) ? FLAG_Z : 0;
+      } else {
+        new_flags |= old_flags & FLAG_M;
+        new_flags |= (lo[0] & 1) ? FLAG_L : 0;
+        new_flags |= is_zero(lo, 2) ? FLAG_Z : 0;
+      }
+      set_flags(op.flag_group, new_flags);
+      break;
+    }
+
+    case OtbnInsnId::kBnAnd:
+    case OtbnInsnId::kBnOr:
+    case OtbnInsnId::kBnNot:
+    case OtbnInsnId::kBnXor: {
+      // bn.not has a single source, called wrs
+      unsigned shifted_reg = insn.id == OtbnInsnId::kBnNot ? op.wrs : op.wrs2;
+      Wide shifted, result;
+      if (op.shift_type == 0) {
+        shl_limbs(wdrs_[shifted_reg].limbs, op.shift_bits, shifted.limbs);
+      } else {
+        shr_limbs(wdrs_[shifted_reg].limbs, 4, op.shift_bits, shifted.limbs);
+      }
+
+      const uint64_t *a = wdrs_[op.wrs1].limbs;
+      for (int i = 0; i < 4; ++i) {
+        switch (insn.id) {
+          case OtbnInsnId::kBnAnd:
+            result.limbs[i] = a[i] & shifted.limbs[i];
+            break;
+          case OtbnInsnId::kBnOr:
+            result.limbs[i] = a[i] | shifted.limbs[i];
+            break;
+          case OtbnInsnId::kBnNot:
+            result.limbs[i] = ~shifted.limbs[i];
+            break;
+          default:
+            result.limbs[i] = a[i] ^ shifted.limbs[i];
+            break;
+        }
+      }
+      write_wdr(op.wrd, result);
+      set_flags(op.flag_group,
+                (flags_[op.flag_group] & FLAG_C) | mlz_flags(false, result.limbs));
+      break;
+    }
+
+    case OtbnInsnId::kBnRshi: {
+      // Concatenate wrs1 (at the top) and wrs2, then shift right.
+      uint64_t concat[8];
+      std::copy_n(wdrs_[op.wrs2].limbs, 4, concat);
+      std::copy_n(wdrs_[op.wrs1].limbs, 4, concat + 4);
+      Wide result;
+      shr_limbs(concat, 8, op.imm, result.limbs);
+      write_wdr(op.wrd, result);
+      break;
+    }
+
+    case OtbnInsnId::kBnSel: {
+      bool flag_is_set = (flags_[op.flag_group] >> op.flag) & 1;
+      write_wdr(op.wrd, wdrs_[flag_is_set ? op.wrs1 : op.wrs2]);
+      break;
+    }
+
+    case OtbnInsnId::kBnLid: {
+      uint32_t grs1_val = read_gpr(op.grs1);
+      uint32_t addr = grs1_val + (uint32_t)op.offset;
+      uint32_t grd_val = read_gpr(op.grd);
+
+      write_wdr(grd_val & 0x1f, load_u256(addr));
+      if (op.grd_inc) {
+        write_gpr(op.grd, (grd_val + 1) & 0x1f);
+      }
+      if (op.grs1_inc) {
+        write_gpr(op.grs1, grs1_val + 32);
+      }
+      break;
+    }
+
+    case OtbnInsnId::kBnSid: {
+      uint32_t grs1_val = read_gpr(op.grs1);
+      uint32_t addr = grs1_val + (uint32_t)op.offset;
+      uint32_t grs2_val = read_gpr(op.grs2);
+
+      store_u256(addr, wdrs_[grs2_val & 0x1f]);
+      if (op.grs1_inc) {
+        write_gpr(op.grs1, grs1_val + 32);
+      }
+      if (op.grs2_inc) {
+        write_gpr(op.grs2, (grs2_val + 1) & 0x1f);
+      }
+      break;
+    }
+
+    case OtbnInsnId::kBnMov:
+      write_wdr(op.wrd, wdrs_[op.wrs]);
+      break;
+
+    case OtbnInsnId::kBnMovr: {
+      uint32_t grd_val = read_gpr(op.grd);
+      uint32_t grs_val = read_gpr(op.grs);
+
+      write_wdr(grd_val & 0x1f, wdrs_[grs_val & 0x1f]);
+      if (op.grd_inc) {
+        write_gpr(op.grd, (grd_val + 1) & 0x1f);
+      }
+      if (op.grs_inc) {
+        write_gpr(op.grs, (grs_val + 1) & 0x1f);
+      }
+      break;
+    }
+
+    case OtbnInsnId::kBnWsrr:
+      write_wdr(op.wrd, read_wsr(op.wsr));
+      break;
+
+    case OtbnInsnId::kBnWsrw:
+      write_wsr(op.wsr, wdrs_[op.wrs]);
+      break;
+
+    case OtbnInsnId::kIllegal:
+      throw model_error("Illegal instruction: encoding %#010x.", insn.raw);
+  }
+}
+
+// Format a 256-bit value for the trace, as in Trace.hex_value
+static std::string wide_hex(const uint64_t *limbs) {
+  char buf[8 * 9 + 3];
+  char *p = buf + sprintf(buf, "0x");
+  for (int i = 7; i >= 0; --i) {
+    uint32_t word = limbs[i / 2] >> (32 * (i % 2));
+    p += sprintf(p, i ? "%08x_" : "%08x", word);
+  }
+  return buf;
+}
+
+std::pair<bool, uint32_t> OtbnNativeIss::pending_changes(
+    std::vector<std::string> *trace) const {
+  static const char *const ext_names[] = {"INTR_STATE", "STATUS", "ERR_CODE"};
+
+  // The busy flag is bit 0 of STATUS, so OTBN is done if the last write to
+  // STATUS clears it. ERR_CODE is only interesting in that case.
+  bool done = false;
+  uint32_t err_code = 0;
+  for (const ExtRegChange &change : ext_changes_) {
+    if (change.reg == kExtStatus) {
+      done = !(change.new_value & 1);
+    } else if (change.reg == kExtErrCode) {
+      err_code = change.new_value;
+    }
+  }
+  if (!done) {
+    err_code = 0;
+  }
+
+  if (!trace) {
+    return std::make_pair(done, err_code);
+  }
+
+  // Generate trace lines in the same order as OTBNState.changes. PC and DMEM
+  // changes don't appear in the trace.
+  char buf[128];
+  for (unsigned i = 0; i < 32; ++i) {
+    if ((gprs_pending_ >> i) & 1) {
+      snprintf(buf, sizeof buf, "> x%02u: 0x%08x", i, gprs_next_[i]);
+      trace->push_back(buf);
+    }
+  }
+  for (const ExtRegChange &change : ext_changes_) {
+    snprintf(buf, sizeof buf, "! otbn.%s: 0x%08x", ext_names[change.reg],
+             change.new_value);
+    trace->push_back(buf);
+  }
+  if (mod_pending_) {
+    trace->push_back("> MOD: " + wide_hex(mod_next_.limbs));
+  }
+  if (acc_pending_) {
+    trace->push_back("> ACC: " + wide_hex(acc_next_.limbs));
+  }
+  for (unsigned fg = 0; fg < 2; ++fg) {
+    if ((flags_pending_ >> fg) & 1) {
+      unsigned flags = flags_next_[fg];
+      snprintf(buf, sizeof buf, "> FLAGS%u: {C: %d, M: %d, L: %d, Z: %d}", fg,
+               !!(flags & FLAG_C), !!(flags & FLAG_M), !!(flags & FLAG_L),
+               !!(flags & FLAG_Z));
+      trace->push_back(buf);
+    }
+  }
+  for (unsigned i = 0; i < 32; ++i) {
+    if ((wdrs_pending_ >> i) & 1) {
+      snprintf(buf, sizeof buf, "> w%02u: ", i);
+      trace->push_back(buf + wide_hex(wdrs_next_[i].limbs));
+    }
+  }
+
+  return std::make_pair(done, err_code);
+}
+
+void OtbnNativeIss::commit() {
+  // This follows OTBNState.commit. If the instruction we just ran stalled us,
+  // stalls_ will be positive but stalled_ will be false.
+  if (stalls_ > 0) {
+    stalled_ = true;
+    --stalls_;
+  } else {
+    stalled_ = false;
+  }
+
+  // At the end of the stall cycle at the start of a run, commit the external
+  // registers (so the start flag becomes visible), but don't advance the PC.
+  if (start_stall_) {
+    start_stall_ = false;
+    std::copy_n(ext_regs_next_, kNumExtRegs, ext_regs_);
+    ext_changes_.clear();
+    return;
+  }
+
+  // If we're stalled, we only commit when we finish our stall cycles.
+  if (stalled_) {
+    return;
+  }
+
+  // A read of x1 pops the call stack and a write pushes to it.
+  if (x1_read_) {
+    assert(!call_stack_.empty());
+    call_stack_.pop_back();
+    x1_read_ = false;
+  }
+  if (gprs_pending_ & 2) {
+    if (call_stack_.size() == CALL_STACK_DEPTH) {
+      throw Alert{ERR_CODE_CALL_STACK};
+    }
+    call_stack_.push_back(gprs_next_[1]);
+  }
+  for (unsigned i = 2; i < 32; ++i) {
+    if ((gprs_pending_ >> i) & 1) {
+      gprs_[i] = gprs_next_[i];
+    }
+  }
+  gprs_pending_ = 0;
+
+  pc_ = pc_next_valid_ ? (uint32_t)pc_next_ : pc_ + 4;
+  pc_next_valid_ = false;
+
+  for (const DmemStore &store : dmem_stores_) {
+    if (store.is_wide) {
+      for (unsigned i = 0; i < 8; ++i) {
+        dmem_[store.addr / 4 + i] = store.value.limbs[i / 2] >> (32 * (i % 2));
+      }
+    } else {
+      dmem_[store.addr / 4] = (uint32_t)store.value.limbs[0];
+    }
+  }
+  dmem_stores_.clear();
+
+  if (!ext_changes_.empty()) {
+    std::copy_n(ext_regs_next_, kNumExtRegs, ext_regs_);
+    ext_changes_.clear();
+  }
+
+  if (mod_pending_) {
+    mod_ = mod_next_;
+    mod_pending_ = false;
+  }
+  if (acc_pending_) {
+    acc_ = acc_next_;
+    acc_pending_ = false;
+  }
+
+  for (unsigned fg = 0; fg < 2; ++fg) {
+    if ((flags_pending_ >> fg) & 1) {
+      flags_[fg] = flags_next_[fg];
+    }
+  }
+  flags_pending_ = 0;
+
+  for (unsigned i = 0; i < 32; ++i) {
+    if ((wdrs_pending_ >> i) & 1) {
+      wdrs_[i] = wdrs_next_[i];
+    }
+  }
+  wdrs_pending_ = 0;
+}
+
+void OtbnNativeIss::abort() {
+  // If stalls_ is positive, the faulting instruction caused the stalls.
+  stalls_ = 0;
+
+  gprs_pending_ = 0;
+  x1_read_ = false;
+  pc_next_valid_ = false;
+  dmem_stores_.clear();
+  std::copy_n(ext_regs_, kNumExtRegs, ext_regs_next_);
+  ext_changes_.clear();
+  mod_pending_ = false;
+  acc_pending_ = false;
+  flags_pending_ = 0;
+  wdrs_pending_ = 0;
+}
+
+void OtbnNativeIss::stop(bool has_err, uint32_t err_code) {
+  // Set INTR_STATE.done and clear STATUS.busy
+  ext_write(kExtIntrState, ext_regs_next_[kExtIntrState] | 1);
+  ext_write(kExtStatus, ext_regs_next_[kExtStatus] & ~1U);
+  if (has_err) {
+    ext_write(kExtErrCode, err_code);
+  }
+  running_ = false;
+}
+
+uint32_t OtbnNativeIss::read_gpr(unsigned idx) {
+  assert(idx < 32);
+  if (idx == 0) {
+    return 0;
+  }
+  if (idx == 1) {
+    if (call_stack_.empty()) {
+      throw Alert{ERR_CODE_CALL_STACK};
+    }
+    x1_read_ = true;
+    return call_stack_.back();
+  }
+  return gprs_[idx];
+}
+
+void OtbnNativeIss::write_gpr(unsigned idx, uint32_t value) {
+  assert(idx < 32);
+  // Writes to x0 are ignored (and don't appear in the trace)
+  if (idx == 0) {
+    return;
+  }
+  gprs_next_[idx] = value;
+  gprs_pending_ |= 1U << idx;
+}
+
+void OtbnNativeIss::write_wdr(unsigned idx, const Wide &value) {
+  assert(idx < 32);
+  wdrs_next_[idx] = value;
+  wdrs_pending_ |= 1U << idx;
+}
+
+void OtbnNativeIss::set_flags(unsigned group, unsigned flags) {
+  assert(group < 2);
+  flags_next_[group] = flags;
+  flags_pending_ |= 1U << group;
+}
+
+uint32_t OtbnNativeIss::read_csr(uint32_t idx) const {
+  unsigned all_flags = (flags_[1] << 4) | flags_[0];
+
+  if (0x7c0 <= idx && idx <= 0x7c1) {
+    // FG0/FG1
+    return (all_flags >> (4 * (idx - 0x7c0))) & 0xf;
+  }
+  if (idx == 0x7c8) {
+    // FLAGS
+    return all_flags;
+  }
+  if (0x7d0 <= idx && idx <= 0x7d7) {
+    // MOD0 .. MOD7
+    unsigned mod_n = idx - 0x7d0;
+    return mod_.limbs[mod_n / 2] >> (32 * (mod_n % 2));
+  }
+  if (idx == 0xfc0) {
+    // RND
+    return RND_U32;
+  }
+  throw model_error("Unknown CSR index: %#x", idx);
+}
+
+void OtbnNativeIss::write_csr(uint32_t idx, uint32_t value) {
+  if (0x7c0 <= idx && idx <= 0x7c1) {
+    // FG0/FG1. Like the Python model, this writes both flag groups.
+    unsigned all_flags = (flags_[1] << 4) | flags_[0];
+    unsigned shift = 4 * (idx - 0x7c0);
+    all_flags = (all_flags & ~(0xfU << shift)) | ((value & 0xf) << shift);
+    set_flags(0, all_flags & 0xf);
+    set_flags(1, (all_flags >> 4) & 0xf);
+    return;
+  }
+  if (idx == 0x7c8) {
+    // FLAGS
+    set_flags(0, value & 0xf);
+    set_flags(1, (value >> 4) & 0xf);
+    return;
+  }
+  if (0x7d0 <= idx && idx <= 0x7d7) {
+    // MOD0 .. MOD7 (read, modify, write)
+    unsigned mod_n = idx - 0x7d0;
+    Wide new_mod = mod_;
+    uint64_t &limb = new_mod.limbs[mod_n / 2];
+    unsigned shift = 32 * (mod_n % 2);
+    limb = (limb & ~((uint64_t)0xffffffff << shift)) | ((uint64_t)value << shift);
+    write_wsr(0, new_mod);
+    return;
+  }
+  if (idx == 0xfc0) {
+    // RND (writes are ignored)
+    return;
+  }
+  throw model_error("Unknown CSR index: %#x", idx);
+}
+
+OtbnNativeIss::Wide OtbnNativeIss::read_wsr(uint32_t idx) const {
+  switch (idx) {
+    case 0:
+      return mod_;
+    case 1: {
+      uint64_t rnd64 = ((uint64_t)RND_U32 << 32) | RND_U32;
+      return Wide{{rnd64, rnd64, rnd64, rnd64}};
+    }
+    case 2:
+      return acc_;
+    default:
+      throw model_error("Unknown WSR index: %u", idx);
+  }
+}
+
+void OtbnNativeIss::write_wsr(uint32_t idx, const Wide &value) {
+  switch (idx) {
+    case 0:
+      mod_next_ = value;
+      mod_pending_ = true;
+      break;
+    case 1:
+      // RND (writes are ignored)
+      break;
+    case 2:
+      acc_next_ = value;
+      acc_pending_ = true;
+      break;
+    default:
+      throw model_error("Unknown WSR index: %u", idx);
+  }
+}
+
+uint32_t OtbnNativeIss::load_u32(uint32_t addr) const {
+  if ((addr & 3) || (uint64_t)addr + 3 >= kOtbnDmemSizeBytes) {
+    throw Alert{ERR_CODE_BAD_DATA_ADDR};
+  }
+  return dmem_[addr / 4];
+}
+
+void OtbnNativeIss::store_u32(uint32_t addr, uint32_t value) {
+  if ((addr & 3) || (uint64_t)addr + 3 >= kOtbnDmemSizeBytes) {
+    throw Alert{ERR_CODE_BAD_DATA_ADDR};
+  }
+  dmem_stores_.push_back(DmemStore{addr, false, Wide{{value, 0, 0, 0}}});
+}
+
+OtbnNativeIss::Wide OtbnNativeIss::load_u256(uint32_t addr) const {
+  if ((addr & 31) || addr >= kOtbnDmemSizeBytes) {
+    throw Alert{ERR_CODE_BAD_DATA_ADDR};
+  }
+  Wide ret;
+  for (unsigned i = 0; i < 4; ++i) {
+    ret.limbs[i] = ((uint64_t)dmem_[addr / 4 + 2 * i + 1] << 32) |
+                   dmem_[addr / 4 + 2 * i];
+  }
+  return ret;
+}
+
+void OtbnNativeIss::store_u256(uint32_t addr, const Wide &value) {
+  if ((addr & 31) || addr >= kOtbnDmemSizeBytes) {
+    throw Alert{ERR_CODE_BAD_DATA_ADDR};
+  }
+  dmem_stores_.push_back(DmemStore{addr, true, value});
+}
+
+void OtbnNativeIss::loop_start(uint32_t iterations, uint32_t bodysize) {
+  // The Python model asserts that these are positive (bodysize is encoded with
+  // an offset of one, but LOOPI can have zero iterations).
+  if (!iterations || !bodysize) {
+    throw model_error("Bad LOOP/LOOPI at PC %#x.", pc_);
+  }
+  if (loop_stack_.size() == LOOP_STACK_DEPTH) {
+    throw Alert{ERR_CODE_LOOP};
+  }
+
+  uint32_t start_addr = pc_ + 4;
+  loop_stack_.push_back(LoopLevel{start_addr, start_addr + 4 * bodysize,
+                                  iterations, iterations - 1});
+}
+
+void OtbnNativeIss::ext_write(ExtReg reg, uint32_t new_value) {
+  ext_regs_next_[reg] = new_value;
+  ext_changes_.push_back(ExtRegChange{reg, new_value});
+}
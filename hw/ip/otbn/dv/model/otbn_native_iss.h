@@ -0,0 +1,137 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "otbn_insns.h"
+#include "otbn_iss.h"
+
+// An OTBN ISS that runs in-process.
+//
+// Instructions are decoded with the decoder that util/yaml_to_cpp.py generates
+// from insns.yml (otbn_insns.h). The Python model in dv/otbnsim is the golden
+// reference and this class follows it cycle for cycle: it models the same
+// stall cycles, stages register and memory writes until the end of the
+// instruction in the same way and generates the same trace lines as
+// stepped.py. OtbnLockstepIss runs the two together to check that they agree.
+class OtbnNativeIss : public OtbnIss {
+ public:
+  OtbnNativeIss();
+
+  void load_d(const std::string &path) override;
+  void load_i(const std::string &path) override;
+  void dump_d(const std::string &path) const override;
+  void start(uint32_t addr) override;
+  std::pair<bool, uint32_t> step(std::vector<std::string> *trace) override;
+  void get_regs(std::array<uint32_t, 32> *gprs,
+                std::array<u256_t, 32> *wdrs) override;
+  std::vector<uint32_t> get_call_stack() override;
+
+ private:
+  // A 256-bit value, stored as 64-bit limbs with the least significant first
+  struct Wide {
+    uint64_t limbs[4];
+  };
+
+  // A level of the loop stack (see LoopLevel in otbnsim/sim/state.py)
+  struct LoopLevel {
+    uint32_t start_addr;
+    uint32_t match_addr;
+    uint32_t loop_count;
+    uint32_t restarts_left;
+  };
+
+  // A pending store to DMEM
+  struct DmemStore {
+    uint32_t addr;
+    bool is_wide;
+    Wide value;
+  };
+
+  // The external registers that OTBN writes
+  enum ExtReg { kExtIntrState, kExtStatus, kExtErrCode, kNumExtRegs };
+
+  // A pending write to an external register, with the value it will have
+  // afterwards
+  struct ExtRegChange {
+    ExtReg reg;
+    uint32_t new_value;
+  };
+
+  // Execute a decoded instruction, staging its changes. Throws an Alert (see
+  // otbn_native_iss.cc) if the instruction faults.
+  void execute(const OtbnDecodedInsn &insn);
+
+  // Append the trace lines for all pending changes to trace (which may be
+  // null) and get the (done, err_code) pair they imply.
+  std::pair<bool, uint32_t> pending_changes(
+      std::vector<std::string> *trace) const;
+
+  void commit();
+  void abort();
+  void stop(bool has_err, uint32_t err_code);
+
+  uint32_t read_gpr(unsigned idx);
+  void write_gpr(unsigned idx, uint32_t value);
+  void write_wdr(unsigned idx, const Wide &value);
+  void set_flags(unsigned group, unsigned flags);
+  uint32_t read_csr(uint32_t idx) const;
+  void write_csr(uint32_t idx, uint32_t value);
+  Wide read_wsr(uint32_t idx) const;
+  void write_wsr(uint32_t idx, const Wide &value);
+
+  uint32_t load_u32(uint32_t addr) const;
+  void store_u32(uint32_t addr, uint32_t value);
+  Wide load_u256(uint32_t addr) const;
+  void store_u256(uint32_t addr, const Wide &value);
+
+  void loop_start(uint32_t iterations, uint32_t bodysize);
+  void ext_write(ExtReg reg, uint32_t new_value);
+
+  std::vector<OtbnDecodedInsn> program_;
+  std::vector<uint32_t> dmem_;
+
+  // Architectural state. gprs_[1] is unused: x1 is the call stack.
+  uint32_t gprs_[32];
+  std::vector<uint32_t> call_stack_;
+  Wide wdrs_[32];
+  Wide mod_;
+  Wide acc_;
+  // Flags for each group, as in the FG0/FG1 CSRs (bit 0 is C, then M, L, Z)
+  unsigned flags_[2];
+  uint32_t pc_;
+  std::vector<LoopLevel> loop_stack_;
+  uint32_t ext_regs_[kNumExtRegs];
+
+  // Pending changes, committed at the end of the instruction. Bit i of
+  // gprs_pending_ and wdrs_pending_ is set if register i has been written.
+  uint32_t gprs_pending_;
+  uint32_t gprs_next_[32];
+  bool x1_read_;
+  uint32_t wdrs_pending_;
+  Wide wdrs_next_[32];
+  bool mod_pending_;
+  Wide mod_next_;
+  bool acc_pending_;
+  Wide acc_next_;
+  unsigned flags_pending_;
+  unsigned flags_next_[2];
+  bool pc_next_valid_;
+  int64_t pc_next_;
+  std::vector<DmemStore> dmem_stores_;
+  uint32_t ext_regs_next_[kNumExtRegs];
+  std::vector<ExtRegChange> ext_changes_;
+
+  // Run state (see OTBNState in otbnsim/sim/state.py)
+  bool running_;
+  bool stalled_;
+  bool start_stall_;
+  unsigned stalls_;
+};
@@ -0,0 +1,297 @@
+#!/usr/bin/env python3
+# Copyright lowRISC contributors.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+
+'''Run the OTBN code snippets on the ISS and compare cycle counts
+
+Every assembly file in the code snippets directory is assembled and linked
+with otbn-as and otbn-ld, then run from address zero until ECALL or an error.
+A snippet fails if it stops with a non-zero ERR_CODE, unless that error is what
+it tests. Files with nothing to run from address zero, like libraries, are
+skipped; libraries are benchmarked through the snippets that link them.
+The snippets are run in parallel worker processes. The execution statistics
+of each run (see sim/stats.py) are written to a JSON report and compared with
+a checked-in baseline. An increase of cycles, instructions or stalls beyond the
+given tolerance is a regression, and makes the script return a non-zero exit
+code.
+
+After a change that is expected to affect the counts, update the baseline
+with --update-baseline.
+
+'''
+
+import argparse
+import json
+import multiprocessing
+import os
+import subprocess
+import sys
+import tempfile
+from typing import Dict, List, Optional, Tuple
+
+from sim.alert import ERR_CODE_BAD_DATA_ADDR, ERR_CODE_NO_ERROR
+from sim.elf import load_elf
+from sim.sim import OTBNSim
+from sim.stats import ExecutionStats
+
+_OTBN_DIR = os.path.normpath(os.path.join(os.path.dirname(__file__),
+                                          '../..'))
+_UTIL_DIR = os.path.join(_OTBN_DIR, 'util')
+_SNIPPETS_DIR = os.path.normpath(os.path.join(_OTBN_DIR,
+                                              '../../../sw/otbn/code-snippets'))
+
+# Libraries that snippets must be linked with. This must match the
+# dependencies in rules.mk and meson.build of the code snippets.
+_SNIPPET_LIBS = {
+    'rsa_1024_dec_test': ['modexp'],
+    'rsa_1024_enc_test': ['modexp'],
+    'p256_curve_point_test': ['p256'],
+    'p256_scalar_mult_test': ['p256'],
+    'p256_ecdsa_sign_test': ['p256'],
+    'p256_ecdsa_verify_test': ['p256'],
+}
+
+# Files with no code to run from address zero, and why
+_NOT_RUNNABLE = {
+    'barrett384': 'library',
+    'karatsuba': 'library',
+    'modexp': 'library',
+    'p256': 'library',
+    'pseudo-ops': 'assembler syntax examples',
+    'rsa': 'entry points for the host, which also supplies the inputs',
+}
+
+# The ERR_CODE that snippets stop with, if it isn't ERR_CODE_NO_ERROR.
+_EXPECTED_ERR_CODES = {
+    'err_test': ERR_CODE_BAD_DATA_ADDR,
+}
+
+# Counters that must not increase beyond the tolerance. The other counters of
+# ExecutionStats are reported if they change, but never fail the comparison.
+_CHECKED_COUNTERS = ['cycles', 'insns', 'stalls']
+_REPORTED_COUNTERS = _CHECKED_COUNTERS + ['loops', 'loop_iterations']
+
+# The result of running a snippet: (name, error message, statistics)
+_Result = Tuple[str, Optional[str], Dict[str, object]]
+
+
+def find_snippets(snippets_dir: str) -> List[Tuple[str, List[str]]]:
+    '''Find all snippets in snippets_dir
+
+    Returns (name, sources) pairs, where sources is the list of assembly files
+    that make up the snippet (starting with the snippet itself).
+
+    '''
+    ret = []
+    for filename in sorted(os.listdir(snippets_dir)):
+        name, ext = os.path.splitext(filename)
+        if ext != '.s' or name in _NOT_RUNNABLE:
+            continue
+        sources = [os.path.join(snippets_dir, lib + '.s')
+                   for lib in [name] + _SNIPPET_LIBS.get(name, [])]
+        ret.append((name, sources))
+    return ret
+
+
+def build_snippet(name: str, sources: List[str], work_dir: str) -> str:
+    '''Assemble and link a snippet in work_dir
+
+    Returns the path to the resulting ELF.
+
+    '''
+    otbn_as = os.path.join(_UTIL_DIR, 'otbn-as')
+    otbn_ld = os.path.join(_UTIL_DIR, 'otbn-ld')
+
+    obj_paths = []
+    for idx, src_path in enumerate(sources):
+        obj_path = os.path.join(work_dir, '{}.{}.o'.format(name, idx))
+        subprocess.run([otbn_as, '-o', obj_path, src_path],
+                       check=True, stdout=subprocess.PIPE,
+                       stderr=subprocess.STDOUT, universal_newlines=True)
+        obj_paths.append(obj_path)
+
+    elf_path = os.path.join(work_dir, name + '.elf')
+    subprocess.run([otbn_ld, '-o', elf_path] + obj_paths,
+                   check=True, stdout=subprocess.PIPE,
+                   stderr=subprocess.STDOUT, universal_newlines=True)
+    return elf_path
+
+
+def run_snippet(job: Tuple[str, List[str], str]) -> _Result:
+    '''Build and run a snippet (run in a worker process)'''
+    name, sources, work_dir = job
+    try:
+        elf_path = build_snippet(name, sources, work_dir)
+    except subprocess.CalledProcessError as err:
+        return (name, 'Failed to build: {}'.format(err.output.strip()), {})
+
+    sim = OTBNSim()
+    sim.stats = ExecutionStats()
+    load_elf(sim, elf_path)
+
+    sim.state.pc = 0
+    sim.state.start()
+    try:
+        sim.run(verbose=False)
+    except RuntimeError as err:
+        return (name, 'Failed to run: {}'.format(err), {})
+
+    # The ERR_CODE write when stopping is only staged.
+    sim.state.ext_regs.commit()
+    err_code = sim.state.ext_regs.read('ERR_CODE', True)
+    expected = _EXPECTED_ERR_CODES.get(name, ERR_CODE_NO_ERROR)
+    if err_code != expected:
+        return (name,
+                'Stopped with ERR_CODE {:#x} (expected {:#x})'
+                .format(err_code, expected), {})
+
+    return (name, None, sim.stats.to_dict())
+
+
+def compare(report: Dict[str, Dict[str, object]],
+            baseline: Dict[str, Dict[str, int]],
+            tolerance: float) -> int:
+    '''Compare a report with the baseline, printing any differences
+
+    Returns the number of regressions.
+
+    '''
+    regressions = 0
+    for name, stats in sorted(report.items()):
+        base = baseline.get(name)
+        if base is None:
+            print('{}: not in baseline'.format(name))
+            continue
+
+        for counter in _REPORTED_COUNTERS:
+            new_val = stats[counter]
+            old_val = base.get(counter)
+            assert isinstance(new_val, int)
+            if old_val is None or new_val == old_val:
+                continue
+
+            regressed = (counter in _CHECKED_COUNTERS and
+                         new_val > old_val * (1 + tolerance / 100))
+            if regressed:
+                regressions += 1
+
+            change = 100 * (new_val - old_val) / old_val if old_val else 0
+            print('{}: {} {} -> {} ({:+.2f}%){}'
+                  .format(name, counter, old_val, new_val, change,
+                          ' REGRESSION' if regressed else ''))
+
+    for name in sorted(baseline.keys() - report.keys()):
+        print('{}: in baseline, but not run'.format(name))
+
+    return regressions
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--snippets-dir', default=_SNIPPETS_DIR,
+                        help='Directory with the snippets to run '
+                             '(default: %(default)s)')
+    parser.add_argument('--baseline',
+                        help='JSON file with the baseline counts (default: '
+                             'benchmark_baseline.json in the snippets '
+                             'directory)')
+    parser.add_argument('--update-baseline', action='store_true',
+                        help='Write the counts to the baseline instead of '
+                             'comparing with it')
+    parser.add_argument('-o', '--output',
+                        help='Write a JSON report with the full statistics '
+                             'to this file')
+    parser.add_argument('-j', '--jobs', type=int,
+                        default=multiprocessing.cpu_count(),
+                        help='Number of worker processes (default: '
+                             '%(default)s)')
+    parser.add_argument('-t', '--tolerance', type=float, default=0.0,
+                        help='Allowed increase of the checked counters, in '
+                             'percent (default: %(default)s)')
+    parser.add_argument('snippets', nargs='*',
+                        help='Only run these snippets (default: all)')
+
+    args = parser.parse_args()
+
+    baseline_path = args.baseline
+    if baseline_path is None:
+        baseline_path = os.path.join(args.snippets_dir,
+                                     'benchmark_baseline.json')
+
+    snippets = find_snippets(args.snippets_dir)
+    if args.snippets:
+        unknown = set(args.snippets) - {name for name, _ in snippets}
+        if unknown:
+            sys.stderr.write('Unknown snippets: {}.\n'
+                             .format(', '.join(sorted(unknown))))
+            return 1
+        snippets = [(name, sources) for name, sources in snippets
+                    if name in args.snippets]
+
+    report = {}  # type: Dict[str, Dict[str, object]]
+    failures = 0
+    with tempfile.TemporaryDirectory(prefix='otbn-bench-') as work_dir:
+        jobs = [(name, sources, work_dir) for name, sources in snippets]
+        with multiprocessing.Pool(max(1, args.jobs)) as pool:
+            for name, error, stats in pool.imap_unordered(run_snippet, jobs):
+                if error is not None:
+                    sys.stderr.write('{}: {}\n'.format(name, error))
+                    failures += 1
+                    continue
+                report[name] = stats
+
+    if args.output is not None:
+        try:
+            with open(args.output, 'w') as out_file:
+                json.dump(report, out_file, indent=2, sort_keys=True)
+                out_file.write('\n')
+        except OSError as err:
+            sys.stderr.write('Failed to write report to {!r}: {}.\n'
+                             .format(args.output, err))
+            return 1
+
+    try:
+        with open(baseline_path) as base_file:
+            baseline = json.load(base_file)
+    except FileNotFoundError:
+        baseline = {}
+    except (OSError, ValueError) as err:
+        sys.stderr.write('Failed to read baseline from {!r}: {}.\n'
+                         .format(baseline_path, err))
+        return 1
+
+    if args.update_baseline:
+        if failures:
+            sys.stderr.write('Not updating the baseline: {} snippets failed.\n'
+                             .format(failures))
+            return 1
+        # Only the snippets that we ran are updated, so running a subset of
+        # the snippets keeps the counts of the others.
+        for name, stats in report.items():
+            baseline[name] = {counter: stats[counter]
+                              for counter in _REPORTED_COUNTERS}
+        try:
+            with open(baseline_path, 'w') as base_file:
+                json.dump(baseline, base_file, indent=2, sort_keys=True)
+                base_file.write('\n')
+        except OSError as err:
+            sys.stderr.write('Failed to write baseline to {!r}: {}.\n'
+                             .format(baseline_path, err))
+            return 1
+        print('Updated {} snippets in {}.'.format(len(report), baseline_path))
+        return 0
+
+    # If we only ran some of the snippets, don't complain about the others.
+    if args.snippets:
+        baseline = {name: counts for name, counts in baseline.items()
+                    if name in args.snippets}
+
+    regressions = compare(report, baseline, args.tolerance)
+    print('{} snippets run, {} failed, {} regressions.'
+          .format(len(snippets), failures, regressions))
+    return 1 if failures or regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,817 @@
+#!/usr/bin/env python3
+# Copyright lowRISC contributors.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+
+'''Run random programs on the OTBN RTL and ISS, guided by coverage
+
+Each program is generated by otbn-rig, assembled and linked with otbn-as and
+otbn-ld and then run on:
+
+  - the ISS (in this process), to see which instructions and encodings it
+    exercises, and
+
+  - the standalone RTL simulation (Votbn_top_sim, built with fusesoc as
+    described in the OTBN README). This runs the ISS alongside the RTL and
+    compares their traces with OtbnTraceChecker on every cycle, failing on any
+    mismatch.
+
+Programs are built and run in a pool of worker processes that share nothing
+but the files they write, so throughput grows with the number of cores.
+
+Coverage is measured in "bins". Each instruction has a bin for being executed
+at all and bins for interesting operand values (x0, x1 or another GPR; each
+value of an enum or option operand; zero, minimum, maximum or some other
+immediate). Every --feedback-interval programs, the driver writes a new weights
+file for otbn-rig gen, which makes instructions with more uncovered bins more
+likely to be picked.
+
+Failures are grouped by a signature (the kind of error, the instruction where
+the trace first diverged and the registers that disagree). Only the first
+program with a given signature is kept. At the end of the run, each kept
+program is minimized by replacing as many instructions as possible with NOPs
+while keeping the same signature. Programs that covered a new bin are saved as
+a corpus, which is reduced at the end to a small subset with the same
+coverage.
+
+The output directory ends up with:
+
+  corpus/       The reduced corpus (one otbn-rig JSON file per seed) and
+                index.json, listing the bins that each program covers.
+  failures/     A directory per failure signature, with the original program,
+                the minimized program (min.json and min.s) and the simulation
+                log.
+  report.json   Summary statistics and the list of uncovered bins.
+
+Returns a non-zero exit code if any program failed.
+
+'''
+
+import argparse
+import copy
+import glob
+import json
+import multiprocessing
+import os
+import re
+import shutil
+import subprocess
+import sys
+import time
+from concurrent.futures import (FIRST_COMPLETED, Future, ProcessPoolExecutor,
+                                wait)
+from typing import Callable, Dict, List, Optional, Set, Tuple
+
+from sim.decode import IllegalInsn
+from sim.elf import load_elf
+from sim.isa import OTBNInsn
+from sim.sim import OTBNSim
+from sim.stats import ExecutionStats
+from sim.trace import Trace
+
+# Importing sim puts the OTBN util directory on sys.path, so these imports
+# must come afterwards.
+from shared.insn_yaml import Insn, load_insns_yaml
+from shared.operand import (EnumOperandType, ImmOperandType,
+                            OptionOperandType, RegOperandType)
+
+_OTBN_DIR = os.path.normpath(os.path.join(os.path.dirname(__file__),
+                                          '../..'))
+_UTIL_DIR = os.path.join(_OTBN_DIR, 'util')
+_REPO_TOP = os.path.normpath(os.path.join(_OTBN_DIR, '../../..'))
+_DEFAULT_RTL_SIM = os.path.join(_REPO_TOP,
+                                'build/lowrisc_ip_otbn_top_sim_0.1/'
+                                'sim-verilator/Votbn_top_sim')
+_DEFAULT_OUT_DIR = os.path.join(_REPO_TOP, 'build-bin/otbn/fuzz')
+
+# The snippet generators (other than StraightLineInsn) whose weights follow
+# the coverage of the instructions they generate.
+_GEN_MNEMONICS = {
+    'Branch': ['beq', 'bne'],
+    'Jump': ['jal', 'jalr'],
+}
+
+# The otbn-rig JSON for "addi x0, x0, 0", used when minimizing failures
+_NOP = ['addi', [0, 0, 0], None]
+
+# The result of running a program: (seed, status, signature, covered bins,
+# instruction counts). status is 'pass', 'fail' or 'build-error'. signature is
+# the failure signature (or the build error) and is None if status is 'pass'.
+# The instruction counts are keyed by mnemonic.
+_Result = Tuple[int, str, Optional[str], List[str], Dict[str, int]]
+
+
+def _imm_bins(op_type: ImmOperandType) -> List[str]:
+    rng = op_type.get_doc_range()
+    if rng is None:
+        return []
+
+    lo, hi = rng
+    ret = []
+    if lo <= 0 <= hi:
+        ret.append('zero')
+    if lo != 0:
+        ret.append('min')
+    if hi != 0:
+        ret.append('max')
+    if hi - lo + 1 > len(ret):
+        ret.append('other')
+    return ret
+
+
+def _imm_bin(op_type: ImmOperandType, op_val: int, pc: int) -> Optional[str]:
+    rng = op_type.get_doc_range()
+    if rng is None:
+        return None
+
+    lo, hi = rng
+    rel_val = op_val - pc if op_type.pc_rel else op_val
+    if rel_val == 0:
+        return 'zero'
+    if rel_val == lo:
+        return 'min'
+    if rel_val == hi:
+        return 'max'
+    return 'other'
+
+
+def _gpr_bin(op_val: int) -> str:
+    return 'x0' if op_val == 0 else 'x1' if op_val == 1 else 'xN'
+
+
+def insn_bins(insn: Insn) -> List[str]:
+    '''Return all the coverage bins for an instruction'''
+    ret = [insn.mnemonic]
+    for operand in insn.operands:
+        op_type = operand.op_type
+        pfx = '{}:{}='.format(insn.mnemonic, operand.name)
+        if isinstance(op_type, RegOperandType):
+            if op_type.reg_type == 'gpr':
+                ret += [pfx + b for b in ['x0', 'x1', 'xN']]
+        elif isinstance(op_type, EnumOperandType):
+            ret += [pfx + item for item in op_type.items]
+        elif isinstance(op_type, OptionOperandType):
+            ret += [pfx + '0', pfx + '1']
+        elif isinstance(op_type, ImmOperandType):
+            ret += [pfx + b for b in _imm_bins(op_type)]
+    return ret
+
+
+def executed_bins(insn: OTBNInsn, pc: int) -> List[str]:
+    '''Return the coverage bins hit by executing insn at pc'''
+    mnemonic = insn.insn.mnemonic
+    ret = [mnemonic]
+    for operand in insn.insn.operands:
+        op_type = operand.op_type
+        op_val = insn.op_vals.get(operand.name)
+        if op_val is None:
+            continue
+
+        pfx = '{}:{}='.format(mnemonic, operand.name)
+        if isinstance(op_type, RegOperandType):
+            if op_type.reg_type == 'gpr':
+                ret.append(pfx + _gpr_bin(op_val))
+        elif isinstance(op_type, EnumOperandType):
+            if 0 <= op_val < len(op_type.items):
+                ret.append(pfx + op_type.items[op_val])
+        elif isinstance(op_type, OptionOperandType):
+            ret.append(pfx + str(op_val))
+        elif isinstance(op_type, ImmOperandType):
+            imm_bin = _imm_bin(op_type, op_val, pc)
+            if imm_bin is not None:
+                ret.append(pfx + imm_bin)
+    return ret
+
+
+def all_bins() -> Dict[str, List[str]]:
+    '''Return the coverage bins for each instruction, keyed by mnemonic'''
+    ret = {}
+    for insn in load_insns_yaml().insns:
+        # Pseudo-ops have no encoding of their own, so never get executed
+        if insn.encoding is None:
+            continue
+        ret[insn.mnemonic] = insn_bins(insn)
+    return ret
+
+
+class InsnCoverage(ExecutionStats):
+    '''Execution statistics that also track coverage bins
+
+    The bins for each instruction in the program are computed up front
+    (they depend on its address if it has a PC-relative immediate), so
+    recording a cycle is just a set update.
+
+    '''
+    def __init__(self, program: List[OTBNInsn]) -> None:
+        super().__init__()
+        self.covered = set()  # type: Set[str]
+        self._bins = {}  # type: Dict[int, List[str]]
+        for idx, insn in enumerate(program):
+            if not isinstance(insn, IllegalInsn):
+                self._bins[id(insn)] = executed_bins(insn, 4 * idx)
+
+    def record(self,
+               pc: int,
+               insn: Optional[OTBNInsn],
+               changes: List[Trace]) -> None:
+        super().record(pc, insn, changes)
+        if insn is not None:
+            self.covered.update(self._bins.get(id(insn), []))
+
+
+def make_weights(bins: Dict[str, List[str]],
+                 covered: Set[str],
+                 insn_counts: Dict[str, int],
+                 boost: float) -> Dict[str, Dict[str, float]]:
+    '''Make otbn-rig weights that favour instructions with uncovered bins
+
+    Each instruction gets a weight of 1 + boost * (fraction of its bins that
+    haven't been covered). Some bins can't be hit by the generator at all (it
+    never uses x1 as a load address, for example), so the boost fades as the
+    instruction gets executed without covering them: it halves after 100
+    executions per bin. The Branch and Jump generators get the mean weight of
+    the instructions they generate.
+
+    '''
+    insns = {}
+    for mnemonic, insn_bins in bins.items():
+        missing = sum(1 for b in insn_bins if b not in covered)
+        runs_per_bin = insn_counts.get(mnemonic, 0) / len(insn_bins)
+        fade = 1 / (1 + runs_per_bin / 100)
+        insns[mnemonic] = 1 + boost * fade * missing / len(insn_bins)
+
+    gens = {}
+    for gen, mnemonics in _GEN_MNEMONICS.items():
+        weights = [insns[m] for m in mnemonics if m in insns]
+        if weights:
+            gens[gen] = sum(weights) / len(weights)
+
+    return {'gens': gens, 'insns': insns}
+
+
+def _run(cmd: List[str]) -> None:
+    '''Run a build command, raising CalledProcessError on failure'''
+    subprocess.run(cmd, check=True, stdout=subprocess.PIPE,
+                   stderr=subprocess.STDOUT, universal_newlines=True)
+
+
+def build_program(json_path: str) -> str:
+    '''Assemble and link the otbn-rig snippets at json_path
+
+    The output files are written next to the JSON file, with the same base
+    name. Returns the path to the ELF file.
+
+    '''
+    otbn_rig = os.path.join(_UTIL_DIR, 'otbn-rig')
+    otbn_as = os.path.join(_UTIL_DIR, 'otbn-as')
+    otbn_ld = os.path.join(_UTIL_DIR, 'otbn-ld')
+
+    base = os.path.splitext(json_path)[0]
+    _run([otbn_rig, 'asm', '-o', base, json_path])
+    _run([otbn_as, '-o', base + '.o', base + '.s'])
+    _run([otbn_ld, '-o', base + '.elf', '-T', base + '.ld', base + '.o'])
+    return base + '.elf'
+
+
+def run_iss(elf_path: str,
+            max_cycles: int) -> Tuple[List[OTBNInsn], InsnCoverage,
+                                      Optional[str]]:
+    '''Run a program on the ISS, collecting coverage
+
+    Returns (program, coverage, error). program is the decoded program,
+    coverage has the bins that were hit and error is None on success or a
+    message if the ISS failed or didn't finish.
+
+    '''
+    sim = OTBNSim()
+    load_elf(sim, elf_path)
+    coverage = InsnCoverage(sim.program)
+    sim.stats = coverage
+
+    sim.state.pc = 0
+    sim.state.start()
+    error = None
+    try:
+        while sim.state.running and coverage.cycles < max_cycles:
+            sim.step(verbose=False)
+    except RuntimeError as err:
+        error = 'ISS error: {}'.format(err)
+
+    if error is None and sim.state.running:
+        error = 'ISS still running after {} cycles'.format(max_cycles)
+
+    return (sim.program, coverage, error)
+
+
+def run_rtl(rtl_sim: str, elf_path: str, timeout: int) -> Optional[str]:
+    '''Run a program on the RTL simulation
+
+    Returns None if the simulation passed. Otherwise, returns its output (or a
+    message if it timed out).
+
+    '''
+    try:
+        proc = subprocess.run([rtl_sim, '--load-elf=' + elf_path],
+                              stdout=subprocess.PIPE,
+                              stderr=subprocess.STDOUT,
+                              universal_newlines=True,
+                              timeout=timeout)
+    except subprocess.TimeoutExpired:
+        return 'Simulation timed out after {} seconds'.format(timeout)
+
+    if proc.returncode == 0:
+        return None
+
+    return '{}\nSimulation exited with code {}\n'.format(proc.stdout,
+                                                         proc.returncode)
+
+
+def _normalize(line: str) -> str:
+    '''Replace numbers in a line of output with N
+
+    Register names (like x3) are kept, so this keeps what went wrong but drops
+    the values, addresses and times that are specific to a single run.
+
+    '''
+    return re.sub(r'\b(0x[0-9a-fA-F_]+|[0-9]+)\b', 'N', line.strip())
+
+
+def _parse_trace_entry(lines: List[str]) -> Tuple[Optional[int],
+                                                  Dict[str, str]]:
+    '''Parse a trace entry as printed by OtbnTraceChecker
+
+    Returns (pc, writes), where pc is the PC from the header (None if it
+    can't be found) and writes maps each written location to its value.
+
+    '''
+    pc = None
+    writes = {}
+    for line in lines:
+        line = line.strip()
+        match = re.match(r'[ES] PC: (0x[0-9a-f]+)', line)
+        if match:
+            pc = int(match.group(1), 16)
+            continue
+        if line.startswith('>'):
+            dest, _, value = line[1:].partition(':')
+            writes[dest.strip()] = value.strip()
+    return (pc, writes)
+
+
+def failure_signature(output: str, program: List[OTBNInsn]) -> str:
+    '''Compute a signature for a failing RTL simulation
+
+    This is the first error line (normalized) and, for a trace mismatch, the
+    mnemonic of the instruction where the traces diverged and the locations
+    with different writes.
+
+    '''
+    lines = output.split('\n')
+    err_idx = None
+    for idx, line in enumerate(lines):
+        if re.search(r'ERROR|Error|RTL computed|timed out', line):
+            err_idx = idx
+            break
+
+    if err_idx is None:
+        return _normalize(lines[-2] if len(lines) > 1 else output)
+
+    signature = _normalize(lines[err_idx])
+
+    # If this is a trace mismatch, the RTL and ISS entries follow
+    if 'Mismatch between RTL and ISS trace' in lines[err_idx]:
+        rtl_lines = []  # type: List[str]
+        iss_lines = []  # type: List[str]
+        cur = None  # type: Optional[List[str]]
+        for line in lines[err_idx + 1:]:
+            if not line.startswith('  '):
+                break
+            if 'RTL entry is:' in line:
+                cur = rtl_lines
+            elif 'ISS entry is:' in line:
+                cur = iss_lines
+            elif cur is not None:
+                cur.append(line)
+
+        rtl_pc, rtl_writes = _parse_trace_entry(rtl_lines)
+        _, iss_writes = _parse_trace_entry(iss_lines)
+
+        mnemonic = '?'
+        if rtl_pc is not None and 0 <= rtl_pc >> 2 < len(program):
+            mnemonic = program[rtl_pc >> 2].insn.mnemonic
+
+        diffs = sorted(dest for dest in rtl_writes.keys() | iss_writes.keys()
+                       if rtl_writes.get(dest) != iss_writes.get(dest))
+        signature += ' @{} [{}]'.format(mnemonic, ', '.join(diffs))
+
+    return signature
+
+
+def evaluate(json_path: str,
+             args: argparse.Namespace) -> Tuple[str, Optional[str],
+                                                Optional[InsnCoverage], str]:
+    '''Build and run a program on the ISS and RTL
+
+    Returns (status, signature, coverage, log). See _Result for status and
+    signature. coverage is from the ISS run (None if the program didn't build)
+    and log is the output of the failing step (empty on success).
+
+    '''
+    try:
+        elf_path = build_program(json_path)
+    except subprocess.CalledProcessError as err:
+        return ('build-error', _normalize(err.output.strip()), None,
+                err.output)
+
+    program, coverage, iss_err = run_iss(elf_path, args.max_cycles)
+    if iss_err is not None:
+        return ('fail', _normalize(iss_err), coverage, iss_err)
+
+    rtl_out = run_rtl(args.rtl_sim, elf_path, args.timeout)
+    if rtl_out is not None:
+        return ('fail', failure_signature(rtl_out, program), coverage,
+                rtl_out)
+
+    return ('pass', None, coverage, '')
+
+
+def fuzz_one(job: Tuple[int, str, argparse.Namespace]) -> _Result:
+    '''Generate, build and run a single program (run in a worker process)'''
+    seed, weights_path, args = job
+    otbn_rig = os.path.join(_UTIL_DIR, 'otbn-rig')
+
+    json_path = os.path.join(args.work_dir, '{}.json'.format(seed))
+    try:
+        _run([otbn_rig, 'gen', '--seed', str(seed), '--size', str(args.size),
+              '--weights', weights_path, '-o', json_path])
+    except subprocess.CalledProcessError as err:
+        return (seed, 'build-error', _normalize(err.output.strip()), [], {})
+
+    status, signature, coverage, log = evaluate(json_path, args)
+    if log:
+        with open(os.path.join(args.work_dir, '{}.log'.format(seed)),
+                  'w') as log_file:
+            log_file.write(log)
+
+    if coverage is None:
+        return (seed, status, signature, [], {})
+
+    return (seed, status, signature,
+            sorted(coverage.covered), coverage.insn_histo)
+
+
+def _nop_slots(node: object) -> List[Tuple[List[object], int]]:
+    '''Find the instructions in otbn-rig JSON that could be replaced by NOPs
+
+    These are the instructions in straight-line snippets ('PS'), other than
+    ECALL (which ends the program) and existing NOPs. Returns a list of (list,
+    index) pairs, in a fixed order.
+
+    '''
+    ret = []  # type: List[Tuple[List[object], int]]
+    if not isinstance(node, list):
+        return ret
+
+    if len(node) == 3 and node[0] == 'PS' and isinstance(node[2], list):
+        for idx, insn in enumerate(node[2]):
+            if insn != _NOP and isinstance(insn, list) and insn[0] != 'ecall':
+                ret.append((node[2], idx))
+        return ret
+
+    for child in node:
+        ret += _nop_slots(child)
+    return ret
+
+
+def minimize(data: object,
+             check: Callable[[object], bool],
+             budget: int) -> object:
+    '''Replace as many instructions as possible in data with NOPs
+
+    check is called with candidate programs and should return True if the
+    candidate still fails in the same way. This is a simple version of delta
+    debugging: try to replace chunks of instructions, halving the chunk size
+    whenever no chunk can be replaced. Stops after budget calls to check.
+
+    '''
+    tests = 0
+    chunk = max(1, len(_nop_slots(data)) // 2)
+    while tests < budget:
+        progress = False
+        start = 0
+        while start < len(_nop_slots(data)) and tests < budget:
+            candidate = copy.deepcopy(data)
+            for insns, idx in _nop_slots(candidate)[start:start + chunk]:
+                insns[idx] = _NOP
+
+            tests += 1
+            if check(candidate):
+                data = candidate
+                progress = True
+            else:
+                start += chunk
+
+        if not progress:
+            if chunk == 1:
+                break
+            chunk //= 2
+
+    return data
+
+
+def minimize_failure(job: Tuple[str, str, argparse.Namespace]) -> int:
+    '''Minimize a failing program (run in a worker process)
+
+    Writes min.json and min.s in the failure's directory. Returns the number of
+    instructions that couldn't be replaced by NOPs.
+
+    '''
+    fail_dir, signature, args = job
+    with open(os.path.join(fail_dir, 'orig.json')) as orig_file:
+        orig = json.load(orig_file)
+
+    cand_path = os.path.join(fail_dir, 'cand.json')
+
+    def check(candidate: object) -> bool:
+        with open(cand_path, 'w') as cand_file:
+            json.dump(candidate, cand_file)
+        status, cand_sig, _, _ = evaluate(cand_path, args)
+        return status == 'fail' and cand_sig == signature
+
+    min_data = minimize(orig, check, args.minimize_budget)
+
+    min_path = os.path.join(fail_dir, 'min.json')
+    with open(min_path, 'w') as min_file:
+        json.dump(min_data, min_file)
+    _run([os.path.join(_UTIL_DIR, 'otbn-rig'), 'asm',
+          '-o', os.path.join(fail_dir, 'min'), min_path])
+
+    for path in glob.glob(os.path.join(fail_dir, 'cand.*')):
+        os.remove(path)
+
+    return len(_nop_slots(min_data))
+
+
+def reduce_corpus(corpus: Dict[int, Set[str]]) -> Dict[int, Set[str]]:
+    '''Pick a subset of the corpus with the same coverage
+
+    This is the usual greedy approximation to set cover: repeatedly pick the
+    program that covers the most bins that aren't covered yet.
+
+    '''
+    uncovered = set().union(*corpus.values())  # type: Set[str]
+    ret = {}
+    while uncovered:
+        seed = max(corpus, key=lambda s: (len(corpus[s] & uncovered), -s))
+        ret[seed] = corpus[seed]
+        uncovered -= corpus[seed]
+    return ret
+
+
+class Farm:
+    '''The state of a fuzzing run, held by the parent process'''
+    def __init__(self, args: argparse.Namespace) -> None:
+        self.args = args
+        self.bins = all_bins()
+        self.num_bins = sum(len(b) for b in self.bins.values())
+
+        self.covered = set()  # type: Set[str]
+        self.insn_counts = {}  # type: Dict[str, int]
+        self.corpus = {}  # type: Dict[int, Set[str]]
+        self.failures = {}  # type: Dict[str, List[int]]
+        self.failure_status = {}  # type: Dict[str, str]
+        self.counts = {}  # type: Dict[str, int]
+
+        self.weights_idx = 0
+        self.weights_path = ''
+        self.write_weights()
+
+    def write_weights(self) -> None:
+        '''Write a new weights file based on the current coverage
+
+        We write a new file each time (rather than overwriting the old one) so
+        that a worker never sees a partially written file.
+
+        '''
+        weights = make_weights(self.bins, self.covered, self.insn_counts,
+                               self.args.boost)
+        path = os.path.join(self.args.weights_dir,
+                            '{:04}.json'.format(self.weights_idx))
+        with open(path, 'w') as weights_file:
+            json.dump(weights, weights_file, indent=2, sort_keys=True)
+        self.weights_idx += 1
+        self.weights_path = path
+
+    def take_result(self, result: _Result) -> None:
+        '''Merge the result of running a program'''
+        seed, status, signature, covered, insn_counts = result
+        self.counts[status] = self.counts.get(status, 0) + 1
+        for mnemonic, count in insn_counts.items():
+            self.insn_counts[mnemonic] = (self.insn_counts.get(mnemonic, 0) +
+                                          count)
+        work_files = glob.glob(os.path.join(self.args.work_dir,
+                                            '{}.*'.format(seed)))
+
+        # Failing programs count towards coverage (otherwise we'd keep
+        # boosting whatever instruction makes them fail) but only passing
+        # programs go into the corpus.
+        new_bins = set(covered) - self.covered
+        self.covered |= new_bins
+        if new_bins and status == 'pass':
+            self.corpus[seed] = set(covered)
+            shutil.copy(os.path.join(self.args.work_dir,
+                                     '{}.json'.format(seed)),
+                        os.path.join(self.args.corpus_dir,
+                                     '{}.json'.format(seed)))
+
+        if status != 'pass':
+            assert signature is not None
+            seeds = self.failures.setdefault(signature, [])
+            seeds.append(seed)
+            if len(seeds) == 1:
+                self.failure_status[signature] = status
+                self._keep_failure(signature, seed, status)
+
+        for path in work_files:
+            os.remove(path)
+
+    def _keep_failure(self, signature: str, seed: int, status: str) -> None:
+        '''Copy the files for the first failure with a signature'''
+        fail_dir = self.failure_dir(signature)
+        os.makedirs(fail_dir, exist_ok=True)
+        base = os.path.join(self.args.work_dir, str(seed))
+        for ext in ['.json', '.log']:
+            if os.path.exists(base + ext):
+                shutil.copy(base + ext, os.path.join(fail_dir, 'orig' + ext))
+
+        print('Seed {}: new {}: {}'.format(seed, status, signature))
+
+    def failure_dir(self, signature: str) -> str:
+        idx = list(self.failures.keys()).index(signature)
+        return os.path.join(self.args.failures_dir, '{:03}'.format(idx))
+
+    def coverage_str(self) -> str:
+        return ('{}/{} bins ({:.1f}%)'
+                .format(len(self.covered), self.num_bins,
+                        100 * len(self.covered) / self.num_bins))
+
+
+def run_farm(farm: Farm, pool: ProcessPoolExecutor) -> int:
+    '''Run programs until we hit the count or time limit
+
+    Returns the number of programs run.
+
+    '''
+    args = farm.args
+    start_time = time.monotonic()
+
+    # Keep two jobs per worker in flight, so that workers don't sit idle while
+    # we merge results.
+    max_pending = 2 * args.jobs
+
+    pending = set()  # type: Set[Future[_Result]]
+    next_seed = args.seed
+    since_feedback = 0
+    done_count = 0
+
+    while True:
+        out_of_time = (args.duration is not None and
+                       time.monotonic() - start_time > args.duration)
+        while (len(pending) < max_pending and
+               next_seed < args.seed + args.count and
+               not out_of_time):
+            job = (next_seed, farm.weights_path, args)
+            pending.add(pool.submit(fuzz_one, job))
+            next_seed += 1
+
+        if not pending:
+            break
+
+        done, pending = wait(pending, return_when=FIRST_COMPLETED)
+        for future in done:
+            farm.take_result(future.result())
+            done_count += 1
+            since_feedback += 1
+
+        if since_feedback >= args.feedback_interval:
+            farm.write_weights()
+            since_feedback = 0
+            print('{} programs run, {} failure signatures, coverage: {}'
+                  .format(done_count, len(farm.failures),
+                          farm.coverage_str()))
+
+    return done_count
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--count', type=int, default=1000,
+                        help='Number of programs to run (default: '
+                             '%(default)s)')
+    parser.add_argument('--duration', type=float,
+                        help='Stop submitting programs after this many '
+                             'seconds')
+    parser.add_argument('--seed', type=int, default=0,
+                        help='Seed for the first program (default: '
+                             '%(default)s)')
+    parser.add_argument('--size', type=int, default=100,
+                        help='Max number of instructions in each program '
+                             '(default: %(default)s)')
+    parser.add_argument('-j', '--jobs', type=int,
+                        default=multiprocessing.cpu_count(),
+                        help='Number of worker processes (default: '
+                             '%(default)s)')
+    parser.add_argument('--rtl-sim', default=_DEFAULT_RTL_SIM,
+                        help='Path to the Votbn_top_sim binary (default: '
+                             '%(default)s)')
+    parser.add_argument('--timeout', type=int, default=60,
+                        help='Timeout for each RTL simulation, in seconds '
+                             '(default: %(default)s)')
+    parser.add_argument('--max-cycles', type=int, default=100000,
+                        help='Cycle limit for each program on the ISS '
+                             '(default: %(default)s)')
+    parser.add_argument('--feedback-interval', type=int, default=50,
+                        help='Number of programs between updates to the '
+                             'generator weights (default: %(default)s)')
+    parser.add_argument('--boost', type=float, default=4.0,
+                        help='Extra weight for an instruction with no '
+                             'covered bins (default: %(default)s)')
+    parser.add_argument('--minimize-budget', type=int, default=200,
+                        help='Max number of runs when minimizing each '
+                             'failure (default: %(default)s)')
+    parser.add_argument('-o', '--output-dir', default=_DEFAULT_OUT_DIR,
+                        help='Output directory (default: %(default)s)')
+
+    args = parser.parse_args()
+
+    if not os.path.exists(args.rtl_sim):
+        sys.stderr.write('No RTL simulation at {!r}. Build it with fusesoc '
+                         '(see the OTBN README).\n'.format(args.rtl_sim))
+        return 1
+
+    args.work_dir = os.path.join(args.output_dir, 'work')
+    args.weights_dir = os.path.join(args.output_dir, 'weights')
+    args.corpus_dir = os.path.join(args.output_dir, 'corpus')
+    args.failures_dir = os.path.join(args.output_dir, 'failures')
+    for path in [args.work_dir, args.weights_dir,
+                 args.corpus_dir, args.failures_dir]:
+        os.makedirs(path, exist_ok=True)
+
+    farm = Farm(args)
+    with ProcessPoolExecutor(max_workers=args.jobs) as pool:
+        count = run_farm(farm, pool)
+
+        # Minimize one program for each failure signature. There's nothing to
+        # minimize for programs that didn't build.
+        to_minimize = [sig for sig, status in farm.failure_status.items()
+                       if status == 'fail']
+        jobs = [(farm.failure_dir(sig), sig, args) for sig in to_minimize]
+        min_sizes = dict(zip(to_minimize, pool.map(minimize_failure, jobs)))
+
+    # Reduce the corpus, deleting the programs that we don't need
+    reduced = reduce_corpus(farm.corpus)
+    for seed in farm.corpus.keys() - reduced.keys():
+        os.remove(os.path.join(args.corpus_dir, '{}.json'.format(seed)))
+    with open(os.path.join(args.corpus_dir, 'index.json'), 'w') as idx_file:
+        json.dump({seed: sorted(covered)
+                   for seed, covered in sorted(reduced.items())},
+                  idx_file, indent=2)
+
+    failures = []
+    for sig, seeds in farm.failures.items():
+        min_size = min_sizes.get(sig)
+        failures.append({'signature': sig,
+                         'status': farm.failure_status[sig],
+                         'dir': farm.failure_dir(sig),
+                         'seeds': seeds,
+                         'min_insns': min_size})
+        min_str = ('' if min_size is None
+                   else ', minimized to {} instructions'.format(min_size))
+        print('{}: {} (seen {} times{})'
+              .format(farm.failure_dir(sig), sig, len(seeds), min_str))
+
+    uncovered = sorted(b for bins in farm.bins.values() for b in bins
+                       if b not in farm.covered)
+    report = {
+        'programs': count,
+        'status_counts': farm.counts,
+        'covered_bins': len(farm.covered),
+        'total_bins': farm.num_bins,
+        'corpus_size': len(reduced),
+        'failures': failures,
+        'uncovered_bins': uncovered
+    }
+    with open(os.path.join(args.output_dir, 'report.json'), 'w') as rpt_file:
+        json.dump(report, rpt_file, indent=2)
+
+    shutil.rmtree(args.work_dir)
+
+    print('{} programs run, {} failed ({} signatures). Coverage: {}. '
+          'Corpus reduced to {} programs.'
+          .format(count, count - farm.counts.get('pass', 0),
+                  len(farm.failures), farm.coverage_str(), len(reduced)))
+    return 1 if farm.failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
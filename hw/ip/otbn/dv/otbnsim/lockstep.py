@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+# Copyright lowRISC contributors.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+
+'''Run random programs on the Python and native OTBN models in lock-step
+
+Each program is generated by otbn-rig (with seeds counting up from --seed),
+assembled and linked with otbn-as and otbn-ld and then flattened to IMEM and
+DMEM images. These are passed to the otbn_iss_diff driver (built by the
+Makefile in dv/model), which runs the program on both models, comparing their
+traces on every cycle and their final state at the end.
+
+Returns a non-zero exit code if the models disagree on any program. The
+generated files for a failing seed are kept in the output directory (if one
+was given with -o) so that the failure can be reproduced by running the driver
+on them by hand.
+
+'''
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+from typing import List, Optional
+
+from sim.elf import read_elf
+
+_OTBN_DIR = os.path.normpath(os.path.join(os.path.dirname(__file__),
+                                          '../..'))
+_UTIL_DIR = os.path.join(_OTBN_DIR, 'util')
+_REPO_TOP = os.path.normpath(os.path.join(_OTBN_DIR, '../../..'))
+_DEFAULT_DRIVER = os.path.join(_REPO_TOP,
+                               'build-bin/otbn/model/otbn_iss_diff')
+
+
+def _run(cmd: List[str]) -> None:
+    '''Run a build command, raising CalledProcessError on failure'''
+    subprocess.run(cmd, check=True, stdout=subprocess.PIPE,
+                   stderr=subprocess.STDOUT, universal_newlines=True)
+
+
+def build_program(seed: int, size: int, start_addr: int,
+                  work_dir: str) -> str:
+    '''Generate and build a random program, writing flat memory images
+
+    Returns the base path of the output files: the IMEM image is at
+    base + '.imem' and the DMEM image is at base + '.dmem'.
+
+    '''
+    otbn_rig = os.path.join(_UTIL_DIR, 'otbn-rig')
+    otbn_as = os.path.join(_UTIL_DIR, 'otbn-as')
+    otbn_ld = os.path.join(_UTIL_DIR, 'otbn-ld')
+
+    base = os.path.join(work_dir, str(seed))
+    _run([otbn_rig, 'gen', '--seed', str(seed), '--size', str(size),
+          '--start-addr', str(start_addr), '-o', base + '.json'])
+    _run([otbn_rig, 'asm', '-o', base, base + '.json'])
+    _run([otbn_as, '-o', base + '.o', base + '.s'])
+    _run([otbn_ld, '-o', base + '.elf', '-T', base + '.ld', base + '.o'])
+
+    imem_bytes, dmem_bytes = read_elf(base + '.elf')
+    with open(base + '.imem', 'wb') as imem_file:
+        imem_file.write(imem_bytes)
+    with open(base + '.dmem', 'wb') as dmem_file:
+        dmem_file.write(dmem_bytes)
+
+    return base
+
+
+def run_seed(seed: int, args: argparse.Namespace, work_dir: str) -> bool:
+    '''Build and run a single program. Returns True if the models agree'''
+    try:
+        base = build_program(seed, args.size, args.start_addr, work_dir)
+    except subprocess.CalledProcessError as err:
+        print('Seed {}: failed to build: {}'.format(seed, err.output.strip()))
+        return False
+    except RuntimeError as err:
+        print('Seed {}: failed to read ELF: {}'.format(seed, err))
+        return False
+
+    cmd = [args.driver,
+           '--start-addr', str(args.start_addr),
+           '--max-cycles', str(args.max_cycles),
+           base + '.imem', base + '.dmem']
+    proc = subprocess.run(cmd, stdout=subprocess.PIPE,
+                          stderr=subprocess.STDOUT, universal_newlines=True)
+    if proc.returncode != 0:
+        print('Seed {}: models disagree (ran {})\n{}'
+              .format(seed, ' '.join(cmd), proc.stdout.strip()))
+        return False
+
+    if args.verbose:
+        print('Seed {}: {}'.format(seed, proc.stdout.strip()))
+    return True
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--count', type=int, default=10,
+                        help='Number of programs to run (default: '
+                             '%(default)s)')
+    parser.add_argument('--seed', type=int, default=0,
+                        help='Seed for the first program (default: '
+                             '%(default)s)')
+    parser.add_argument('--size', type=int, default=100,
+                        help='Max number of instructions in each program '
+                             '(default: %(default)s)')
+    parser.add_argument('--start-addr', type=int, default=0,
+                        help='Start address (default: %(default)s)')
+    parser.add_argument('--max-cycles', type=int, default=100000,
+                        help='Cycle limit for each program (default: '
+                             '%(default)s)')
+    parser.add_argument('--driver', default=_DEFAULT_DRIVER,
+                        help='Path to the otbn_iss_diff driver (default: '
+                             '%(default)s)')
+    parser.add_argument('-o', '--output-dir',
+                        help='Directory for the generated files. If not '
+                             'given, a temporary directory is used and '
+                             'deleted afterwards.')
+    parser.add_argument('-v', '--verbose', action='store_true',
+                        help='Print a line for each passing program')
+
+    args = parser.parse_args()
+
+    if not os.path.exists(args.driver):
+        sys.stderr.write('No lock-step driver at {!r}. Build it with make in '
+                         'hw/ip/otbn/dv/model.\n'.format(args.driver))
+        return 1
+
+    tmp_dir = None  # type: Optional[tempfile.TemporaryDirectory[str]]
+    if args.output_dir is None:
+        tmp_dir = tempfile.TemporaryDirectory(prefix='otbn-lockstep-')
+        work_dir = tmp_dir.name
+    else:
+        os.makedirs(args.output_dir, exist_ok=True)
+        work_dir = args.output_dir
+
+    try:
+        failures = 0
+        for seed in range(args.seed, args.seed + args.count):
+            if not run_seed(seed, args, work_dir):
+                failures += 1
+    finally:
+        if tmp_dir is not None:
+            tmp_dir.cleanup()
+
+    print('{} programs run, {} failed.'.format(args.count, failures))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
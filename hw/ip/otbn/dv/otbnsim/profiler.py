@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+# Copyright lowRISC contributors.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+
+'''Profile an OTBN program and report where the cycles go
+
+By default, this runs the given ELF file on the ISS with a Profiler attached
+(see sim/profile.py). To report on an RTL simulation instead, pass the profile
+written by Votbn_top_sim's --otbn-profile-file option with --rtl-profile. In
+both cases, addresses are symbolized with the code symbols in the ELF file.
+
+The report lists the functions with the most cycles (both in total and in the
+function itself, excluding its callees), the hardware loops with the most
+cycles and the hottest instructions. With --collapsed, the script also writes
+the stacks in the "collapsed" format used by flamegraph.pl and speedscope.
+Each line is a list of frames, separated by semicolons, followed by a cycle
+count. Hardware loops appear as frames called loop@<location>, where location
+is the address of the LOOP or LOOPI instruction.
+
+'''
+
+import argparse
+import bisect
+import sys
+from typing import Dict, List, Optional, TextIO, Tuple
+
+from sim.elf import load_elf, read_symbols
+from sim.isa import OTBNInsn
+from sim.profile import Frame, Profile, Profiler
+from sim.sim import OTBNSim
+
+
+class Symbolizer:
+    '''Turns addresses into names of the form symbol+offset'''
+    def __init__(self, symbols: List[Tuple[int, str]]) -> None:
+        self._addrs = [addr for addr, _ in symbols]
+        self._names = [name for _, name in symbols]
+
+    def name(self, addr: int) -> str:
+        idx = bisect.bisect_right(self._addrs, addr) - 1
+        if idx < 0:
+            return '{:#x}'.format(addr)
+
+        offset = addr - self._addrs[idx]
+        if offset == 0:
+            return self._names[idx]
+        return '{}+{:#x}'.format(self._names[idx], offset)
+
+    def frame_name(self, frame: Frame) -> str:
+        kind, addr = frame
+        return ('loop@' if kind == 'L' else '') + self.name(addr)
+
+
+def write_collapsed(profile: Profile,
+                    sym: Symbolizer,
+                    out_file: TextIO) -> None:
+    '''Write the stacks of a profile in collapsed format'''
+    # Different stacks might have the same names (if a function is entered
+    # at two different addresses that symbolize the same way), so merge them.
+    merged = {}  # type: Dict[str, int]
+    for stack, cycles in profile.stacks.items():
+        key = ';'.join(sym.frame_name(frame) for frame in stack)
+        merged[key] = merged.get(key, 0) + cycles
+
+    for key, cycles in sorted(merged.items()):
+        out_file.write('{} {}\n'.format(key, cycles))
+
+
+def _pct(count: int, total: int) -> str:
+    return '{:5.1f}%'.format(100 * count / total if total else 0)
+
+
+def report(profile: Profile,
+           sym: Symbolizer,
+           program: Optional[List[OTBNInsn]],
+           top: int) -> None:
+    '''Print a report of the profile to stdout'''
+    cycles = profile.total(0)
+    print('{} cycles: {} instructions, {} stall cycles.\n'
+          .format(cycles, profile.total(2), profile.total(1)))
+
+    # Per function totals. A function's total cycles are the cycles with the
+    # function anywhere on the stack (counted once, even for recursion). Its
+    # self cycles are the cycles where it is the innermost function.
+    fn_total = {}  # type: Dict[int, int]
+    fn_self = {}  # type: Dict[int, int]
+    loop_total = {}  # type: Dict[int, int]
+    for stack, count in profile.stacks.items():
+        fns = [addr for kind, addr in stack if kind == 'F']
+        loops = [addr for kind, addr in stack if kind == 'L']
+        for addr in set(fns):
+            fn_total[addr] = fn_total.get(addr, 0) + count
+        for addr in set(loops):
+            loop_total[addr] = loop_total.get(addr, 0) + count
+        if fns:
+            fn_self[fns[-1]] = fn_self.get(fns[-1], 0) + count
+
+    print('Functions (by total cycles):')
+    print('{:>10} {:>6} {:>10} {:>6}  {}'
+          .format('total', '', 'self', '', 'function'))
+    for addr, total in sorted(fn_total.items(),
+                              key=lambda pr: -pr[1])[:top]:
+        self_cycles = fn_self.get(addr, 0)
+        print('{:>10} {} {:>10} {}  {}'
+              .format(total, _pct(total, cycles),
+                      self_cycles, _pct(self_cycles, cycles),
+                      sym.name(addr)))
+
+    if loop_total:
+        print('\nHardware loops (by total cycles):')
+        print('{:>10} {:>6} {:>8} {:>10} {:>10}  {}'
+              .format('total', '', 'entries', 'iterations', 'cyc/iter',
+                      'loop'))
+        for addr, total in sorted(loop_total.items(),
+                                  key=lambda pr: -pr[1])[:top]:
+            entries, iterations = profile.loops.get(addr, [0, 0])
+            per_iter = total / iterations if iterations else 0
+            print('{:>10} {} {:>8} {:>10} {:>10.1f}  {}'
+                  .format(total, _pct(total, cycles), entries, iterations,
+                          per_iter, sym.name(addr)))
+
+    print('\nInstructions (by cycles):')
+    print('{:>10} {:>6} {:>8} {:>10}  {:10}  {}'
+          .format('cycles', '', 'stalls', 'count', 'pc', 'location'))
+    hot_pcs = sorted(profile.pcs.items(), key=lambda pr: -pr[1][0])[:top]
+    for pc, (pc_cycles, stalls, insns) in hot_pcs:
+        disasm = ''
+        if program is not None and 0 <= pc >> 2 < len(program):
+            disasm = '  ' + program[pc >> 2].disassemble(pc)
+        print('{:>10} {} {:>8} {:>10}  {:#010x}  {}{}'
+              .format(pc_cycles, _pct(pc_cycles, cycles), stalls, insns, pc,
+                      sym.name(pc), disasm))
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser()
+    parser.add_argument('elf',
+                        help='The ELF file for the program (used for symbols '
+                             'and, unless --rtl-profile is given, to run on '
+                             'the ISS)')
+    parser.add_argument('--rtl-profile',
+                        help='Report on this profile (written by '
+                             'Votbn_top_sim --otbn-profile-file) rather than '
+                             'running the ISS')
+    parser.add_argument('--save-profile',
+                        help='Write the raw profile from the ISS run to this '
+                             'file')
+    parser.add_argument('--collapsed',
+                        help='Write collapsed stacks to this file')
+    parser.add_argument('--top', type=int, default=20,
+                        help='Number of entries in each table (default: '
+                             '%(default)s)')
+
+    args = parser.parse_args()
+
+    try:
+        sym = Symbolizer(read_symbols(args.elf))
+    except (OSError, RuntimeError) as err:
+        sys.stderr.write('Failed to read symbols from {!r}: {}\n'
+                         .format(args.elf, err))
+        return 1
+
+    program = None
+    if args.rtl_profile is not None:
+        try:
+            with open(args.rtl_profile) as prof_file:
+                profile = Profile.read(prof_file)
+        except (OSError, ValueError) as err:
+            sys.stderr.write('Failed to read profile from {!r}: {}\n'
+                             .format(args.rtl_profile, err))
+            return 1
+    else:
+        sim = OTBNSim()
+        profiler = Profiler()
+        sim.stats = profiler
+        load_elf(sim, args.elf)
+
+        sim.state.pc = 0
+        sim.state.start()
+        sim.run(verbose=False)
+
+        profile = profiler.profile
+        program = sim.program
+
+        if args.save_profile is not None:
+            with open(args.save_profile, 'w') as prof_file:
+                profile.write(prof_file)
+
+    if args.collapsed is not None:
+        with open(args.collapsed, 'w') as out_file:
+            write_collapsed(profile, sym, out_file)
+
+    report(profile, sym, program, args.top)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
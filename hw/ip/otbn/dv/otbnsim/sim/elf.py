@@ -6,7 +6,9 @@
 
 from typing import List, Tuple
 
+from elftools.elf.constants import SH_FLAGS  # type: ignore
 from elftools.elf.elffile import ELFFile  # type: ignore
+from elftools.elf.sections import SymbolTableSection  # type: ignore
 
 from shared.mem_layout import get_memory_layout
 
@@ -116,8 +118,14 @@ def _get_elf_segments(path: str,
     return (imem_segments, dmem_segments)
 
 
-def load_elf(sim: OTBNSim, path: str) -> None:
-    '''Load contents of ELF file at path'''
+def read_elf(path: str) -> Tuple[bytes, bytes]:
+    '''Read the ELF file at path and flatten it to IMEM and DMEM contents
+
+    Returns a pair (imem_bytes, dmem_bytes). Each is at most as long as the
+    corresponding memory and starts at its base address. Gaps between segments
+    are filled with zeroes.
+
+    '''
     mems = get_memory_layout()
     imem_desc = mems['IMEM']
     dmem_desc = mems['DMEM']
@@ -133,7 +141,44 @@ def load_elf(sim: OTBNSim, path: str) -> None:
                            'not a multiple of 4.'
                            .format(path, len(imem_bytes)))
 
+    return (imem_bytes, dmem_bytes)
+
+
+def load_elf(sim: OTBNSim, path: str) -> None:
+    '''Load contents of ELF file at path'''
+    imem_bytes, dmem_bytes = read_elf(path)
     imem_insns = decode_bytes(imem_bytes)
 
     sim.load_program(imem_insns)
     sim.load_data(dmem_bytes)
+
+
+def read_symbols(path: str) -> List[Tuple[int, str]]:
+    '''Read the code symbols from the ELF file at path
+
+    Returns a list of pairs (addr, name), sorted by address, for the symbols
+    defined in executable sections. Assembler-local labels (starting with .L)
+    are skipped.
+
+    '''
+    ret = []
+    with open(path, 'rb') as handle:
+        elf_file = ELFFile(handle)
+        for section in elf_file.iter_sections():
+            if not isinstance(section, SymbolTableSection):
+                continue
+
+            for symbol in section.iter_symbols():
+                shndx = symbol['st_shndx']
+                if not (symbol.name and isinstance(shndx, int)):
+                    continue
+                if symbol.name.startswith('.L'):
+                    continue
+
+                sym_section = elf_file.get_section(shndx)
+                if not sym_section['sh_flags'] & SH_FLAGS.SHF_EXECINSTR:
+                    continue
+
+                ret.append((symbol['st_value'], symbol.name))
+
+    return sorted(set(ret))
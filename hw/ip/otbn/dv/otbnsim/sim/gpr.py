@@ -52,6 +52,10 @@ class CallStackReg(Reg):
         super().write_unsigned(uval, backdoor)
 
     def commit(self) -> None:
+        # Most instructions don't touch x1, so check for that first.
+        if not self.saw_read and self._next_uval is None:
+            return
+
         if self.saw_read:
             assert self.stack
             self.stack.pop()
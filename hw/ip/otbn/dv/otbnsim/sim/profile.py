@@ -0,0 +1,198 @@
+# Copyright lowRISC contributors.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+
+'''Cycle profiles of OTBN programs
+
+A Profile holds cycle, stall and instruction counts per PC, cycle counts per
+stack and entry and iteration counts per hardware loop. A stack is a tuple of
+frames, outermost first. A frame is either a function, given by its entry
+address, or a hardware loop, given by the address of its LOOP or LOOPI
+instruction.
+
+Profiles are collected by a Profiler, attached to the ISS as its stats object,
+or by the ProfileTraceListener from the RTL trace (in dv/tracer/cpp). Both
+write the same text format, so profiles from either source can be symbolized
+and reported by the same script (dv/otbnsim/profiler.py). The format has one
+record per line:
+
+    pc <addr> <cycles> <stalls> <insns>
+    loop <addr> <entries> <iterations>
+    stack <frames> <cycles>
+
+where addresses are hex numbers with a 0x prefix and frames is a list of
+frames, separated by semicolons. A function frame is written F:<addr> and a
+loop frame is written L:<addr>. Lines starting with # are comments.
+
+Calls are recognised as JAL or JALR instructions that write x1 and returns as
+JALR instructions that jump to x1 and write x0. The called function is the
+address of the next instruction that runs.
+
+'''
+
+from typing import Dict, List, Optional, TextIO, Tuple
+
+from .isa import OTBNInsn
+from .state import TraceLoopIteration, TraceLoopStart
+from .stats import ExecutionStats
+from .trace import Trace
+
+# A frame is a pair (kind, addr), where kind is 'F' for a function or 'L' for a
+# hardware loop.
+Frame = Tuple[str, int]
+Stack = Tuple[Frame, ...]
+
+
+class Profile:
+    '''Counts from a profiled run'''
+    def __init__(self) -> None:
+        # Maps PC to [cycles, stalls, insns]
+        self.pcs = {}  # type: Dict[int, List[int]]
+        # Maps the address of a loop instruction to [entries, iterations]
+        self.loops = {}  # type: Dict[int, List[int]]
+        # Maps a stack to the number of cycles spent with that stack
+        self.stacks = {}  # type: Dict[Stack, int]
+
+    def total(self, idx: int) -> int:
+        '''Sum the given PC count (0: cycles, 1: stalls, 2: insns)'''
+        return sum(counts[idx] for counts in self.pcs.values())
+
+    def write(self, out_file: TextIO) -> None:
+        '''Write the profile in the text format described above'''
+        out_file.write('# OTBN profile\n')
+        for pc, (cycles, stalls, insns) in sorted(self.pcs.items()):
+            out_file.write('pc {:#010x} {} {} {}\n'
+                           .format(pc, cycles, stalls, insns))
+        for addr, (entries, iterations) in sorted(self.loops.items()):
+            out_file.write('loop {:#010x} {} {}\n'
+                           .format(addr, entries, iterations))
+        for stack, cycles in sorted(self.stacks.items()):
+            frames = ';'.join('{}:{:#010x}'.format(kind, addr)
+                              for kind, addr in stack)
+            out_file.write('stack {} {}\n'.format(frames, cycles))
+
+    @staticmethod
+    def _read_frame(frame: str) -> Frame:
+        kind, _, addr = frame.partition(':')
+        if kind not in ['F', 'L']:
+            raise ValueError('bad frame {!r}.'.format(frame))
+        return (kind, int(addr, 16))
+
+    @staticmethod
+    def read(in_file: TextIO) -> 'Profile':
+        '''Read a profile in the text format described above
+
+        Raises a ValueError if the file is malformed.
+
+        '''
+        profile = Profile()
+        for line_idx, line in enumerate(in_file):
+            fields = line.split()
+            if not fields or fields[0].startswith('#'):
+                continue
+
+            try:
+                if fields[0] == 'pc' and len(fields) == 5:
+                    profile.pcs[int(fields[1], 16)] = \
+                        [int(f) for f in fields[2:]]
+                elif fields[0] == 'loop' and len(fields) == 4:
+                    profile.loops[int(fields[1], 16)] = \
+                        [int(f) for f in fields[2:]]
+                elif fields[0] == 'stack' and len(fields) == 3:
+                    stack = tuple(Profile._read_frame(frame)
+                                  for frame in fields[1].split(';'))
+                    profile.stacks[stack] = int(fields[2])
+                else:
+                    raise ValueError('unknown record {!r}.'
+                                     .format(line.strip()))
+            except ValueError as err:
+                raise ValueError('Line {}: {}'
+                                 .format(line_idx + 1, err)) from None
+
+        return profile
+
+
+class Profiler(ExecutionStats):
+    '''Execution statistics that also collect a Profile
+
+    Hardware loops are tracked with the loop trace entries from the ISS (see
+    LoopStack in state.py). A loop frame is pushed after its LOOP or LOOPI
+    instruction and popped after its last iteration, so those cycles count
+    towards the enclosing frame and the loop, respectively.
+
+    '''
+    def __init__(self) -> None:
+        super().__init__()
+        self.profile = Profile()
+
+        # Entry addresses of the functions on the call stack
+        self._calls = []  # type: List[int]
+        # Pairs (loop insn address, call depth) for the active loops
+        self._loops = []  # type: List[Tuple[int, int]]
+        self._stack = None  # type: Optional[Stack]
+        self._call_pending = False
+
+    def _get_stack(self) -> Stack:
+        if self._stack is None:
+            frames = []  # type: List[Frame]
+            for depth, entry in enumerate(self._calls):
+                frames.append(('F', entry))
+                frames += [('L', addr) for addr, loop_depth in self._loops
+                           if loop_depth == depth + 1]
+            self._stack = tuple(frames)
+        return self._stack
+
+    def record(self,
+               pc: int,
+               insn: Optional[OTBNInsn],
+               changes: List[Trace]) -> None:
+        super().record(pc, insn, changes)
+
+        # The first cycle of a run or of a called function tells us the
+        # function's entry address.
+        if not self._calls or self._call_pending:
+            self._calls.append(pc)
+            self._call_pending = False
+            self._stack = None
+
+        counts = self.profile.pcs.setdefault(pc, [0, 0, 0])
+        counts[0] += 1
+        if insn is None:
+            counts[1] += 1
+        else:
+            counts[2] += 1
+
+        stack = self._get_stack()
+        self.profile.stacks[stack] = self.profile.stacks.get(stack, 0) + 1
+
+        if insn is None:
+            return
+
+        for change in changes:
+            if isinstance(change, TraceLoopStart):
+                self._loops.append((pc, len(self._calls)))
+                self.profile.loops.setdefault(pc, [0, 0])[0] += 1
+                self._stack = None
+            elif isinstance(change, TraceLoopIteration):
+                if self._loops:
+                    addr, _ = self._loops[-1]
+                    self.profile.loops[addr][1] += 1
+                    if change.iteration == change.total:
+                        self._loops.pop()
+                        self._stack = None
+
+        mnemonic = insn.insn.mnemonic
+        if mnemonic in ['jal', 'jalr'] and insn.op_vals.get('grd') == 1:
+            self._call_pending = True
+        elif (mnemonic == 'jalr' and insn.op_vals.get('grs1') == 1 and
+              insn.op_vals.get('grd') == 0):
+            if len(self._calls) > 1:
+                self._calls.pop()
+                self._loops = [(addr, depth) for addr, depth in self._loops
+                               if depth <= len(self._calls)]
+                self._stack = None
+        elif mnemonic == 'ecall':
+            # The end of an operation: the next one starts afresh.
+            self._calls = []
+            self._loops = []
+            self._stack = None
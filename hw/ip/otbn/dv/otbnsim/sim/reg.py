@@ -112,6 +112,8 @@ class RegFile:
         return ret
 
     def commit(self) -> None:
+        if not self._pending_writes:
+            return
         for idx in self._pending_writes:
             assert 0 <= idx < len(self._registers)
             self._registers[idx].commit()
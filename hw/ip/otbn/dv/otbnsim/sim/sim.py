@@ -2,11 +2,12 @@
 # Licensed under the Apache License, Version 2.0, see LICENSE for details.
 # SPDX-License-Identifier: Apache-2.0
 
-from typing import List, Optional, Tuple
+from typing import Dict, List, Optional, Tuple
 
 from .alert import Alert
 from .isa import OTBNInsn
 from .state import OTBNState
+from .stats import ExecutionStats
 from .trace import Trace
 
 
@@ -14,19 +15,33 @@ class OTBNSim:
     def __init__(self) -> None:
         self.state = OTBNState()
         self.program = []  # type: List[OTBNInsn]
+        self.stats = None  # type: Optional[ExecutionStats]
+
+        # A cache of basic blocks for the fast run loop, keyed by start
+        # address (see _get_block)
+        self._blocks = {}  # type: Dict[int, List[OTBNInsn]]
 
     def load_program(self, program: List[OTBNInsn]) -> None:
         self.program = program.copy()
+        self._blocks = {}
 
     def load_data(self, data: bytes) -> None:
         self.state.dmem.load_le_words(data)
 
-    def run(self, verbose: bool) -> int:
+    def run(self, verbose: bool, fast: bool = True) -> int:
         '''Run until ECALL.
 
         Return the number of cycles taken.
 
+        If fast is true and nothing needs to see the changes made by each
+        instruction (verbose is false and no stats object is attached), this
+        uses a faster loop that runs a basic block at a time and doesn't
+        generate any trace. The resulting state and cycle count are the same.
+
         '''
+        if fast and not verbose and self.stats is None:
+            return self._run_fast()
+
         insn_count = 0
         while self.state.running:
             self.step(verbose)
@@ -34,6 +49,85 @@ class OTBNSim:
 
         return insn_count
 
+    def _get_block(self, pc: int) -> List[OTBNInsn]:
+        '''Get the basic block starting at pc
+
+        A basic block is a run of instructions that ends with the first
+        instruction that might affect control flow (or at the end of the
+        program). If pc is beyond the end of the program, the block is empty.
+
+        Loops can still end in the middle of a block, so the caller must check
+        for that. The result is memoized.
+
+        '''
+        block = self._blocks.get(pc)
+        if block is None:
+            block = []
+            for insn in self.program[pc >> 2:]:
+                block.append(insn)
+                if insn.affects_control:
+                    break
+            self._blocks[pc] = block
+        return block
+
+    def _run_fast(self) -> int:
+        '''Run until ECALL without generating a trace
+
+        This is equivalent to calling step() until we stop, but avoids most of
+        its per-cycle overhead. Instructions are fetched a basic block at a
+        time, nobody asks for the changes that each instruction makes (so they
+        aren't collected) and the stall cycles of an instruction are counted
+        rather than stepped through.
+
+        Return the number of cycles taken.
+
+        '''
+        state = self.state
+        cycles = 0
+
+        # If we're stalled (as we are at the start of a run), step through the
+        # stall cycles in the usual way.
+        while state.running and state.stalled:
+            self.step(verbose=False)
+            cycles += 1
+
+        while state.running:
+            block = self._get_block(state.pc)
+            if not block:
+                # We're trying to fetch from beyond the end of the program. Let
+                # step() generate the error, which it raises as a RuntimeError.
+                self.step(verbose=False)
+                raise RuntimeError('Fetch from {:#x}, beyond the end of the '
+                                   'program, did not stop the model.'
+                                   .format(int(state.pc)))
+
+            for insn in block:
+                pc = state.pc
+                cycles += 1
+                try:
+                    state.pre_insn(insn.affects_control)
+                    insn.execute(state)
+                    state.post_insn()
+
+                    # Any stall cycles happen before the instruction commits.
+                    # Count them, rather than going around the loop.
+                    cycles += insn.insn.cycles - 1
+
+                    state.commit()
+                except Alert as alert:
+                    # As in step(), roll back the instruction and stop with an
+                    # error.
+                    state.abort()
+                    state.stop(alert.error_code())
+                    break
+
+                # Stop at the end of the block or if we've stopped running
+                # (ECALL) or jumped back to the start of a loop.
+                if not state.running or state.pc != pc + 4:
+                    break
+
+        return cycles
+
     def step(self, verbose: bool) -> Tuple[Optional[OTBNInsn], List[Trace]]:
         '''Run a single instruction.
 
@@ -89,6 +183,9 @@ class OTBNSim:
             self.state.stop(alert.error_code())
             changes = self.state.changes()
 
+        if self.stats is not None:
+            self.stats.record(pc_before, insn, changes)
+
         if verbose:
             disasm = ('(stall)' if insn is None
                       else insn.disassemble(pc_before))
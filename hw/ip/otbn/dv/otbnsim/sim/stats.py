@@ -0,0 +1,61 @@
+# Copyright lowRISC contributors.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+
+from typing import Dict, List, Optional
+
+from .isa import OTBNInsn
+from .state import TraceLoopIteration, TraceLoopStart
+from .trace import Trace
+
+
+class ExecutionStats:
+    '''Execution statistics of a run of the simulator
+
+    An object of this class can be attached to an OTBNSim as its stats
+    attribute, which makes OTBNSim.step() call record() for every cycle.
+
+    '''
+    def __init__(self) -> None:
+        self.cycles = 0
+        self.insns = 0
+        self.stalls = 0
+        self.loops = 0
+        self.loop_iterations = 0
+        self.insn_histo = {}  # type: Dict[str, int]
+
+    def record(self,
+               pc: int,
+               insn: Optional[OTBNInsn],
+               changes: List[Trace]) -> None:
+        '''Record a single cycle
+
+        pc is the PC at the start of the cycle. insn is the instruction that
+        was executed, or None if the cycle was a stall. changes is the list of
+        changes returned by OTBNSim.step().
+
+        '''
+        self.cycles += 1
+        if insn is None:
+            self.stalls += 1
+        else:
+            self.insns += 1
+            mnemonic = insn.insn.mnemonic
+            self.insn_histo[mnemonic] = self.insn_histo.get(mnemonic, 0) + 1
+
+        for change in changes:
+            if isinstance(change, TraceLoopStart):
+                self.loops += 1
+            elif isinstance(change, TraceLoopIteration):
+                self.loop_iterations += 1
+
+    def to_dict(self) -> Dict[str, object]:
+        '''Return the statistics as a dictionary (e.g. for JSON output)'''
+        return {
+            'cycles': self.cycles,
+            'insns': self.insns,
+            'stalls': self.stalls,
+            'loops': self.loops,
+            'loop_iterations': self.loop_iterations,
+            'insn_histo': dict(sorted(self.insn_histo.items()))
+        }
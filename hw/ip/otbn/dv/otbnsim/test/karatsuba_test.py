@@ -0,0 +1,117 @@
+# Copyright lowRISC contributors.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+
+'''Check the Karatsuba kernels in karatsuba.s against Python big integers
+
+Each test assembles a small driver, which calls one of the kernels on
+operands placed at fixed DMEM addresses, together with karatsuba.s from the
+code snippets. The DMEM contents after the run are compared with the product
+computed in Python.
+
+'''
+
+import os
+import py
+import random
+import subprocess
+from typing import Any, List, Tuple
+
+_OTBN_DIR = os.path.join(os.path.dirname(__file__), '../../..')
+_UTIL_DIR = os.path.join(_OTBN_DIR, 'util')
+_SIM_DIR = os.path.join(os.path.dirname(__file__), '..')
+_SNIPPETS_DIR = os.path.join(_OTBN_DIR, '../../../sw/otbn/code-snippets')
+
+# DMEM addresses of the operands and the result, as used by the driver.
+_DPTR_A = 0
+_DPTR_B = 128
+_DPTR_R = 256
+
+# (routine, operand bits, is squaring)
+_KERNELS = [
+    ('mul512', 512, False),
+    ('sqr512', 512, True),
+    ('mul1024', 1024, False),
+    ('sqr1024', 1024, True),
+]
+
+_NUM_RANDOM = 6
+
+
+def _words(value: int, num_bytes: int) -> str:
+    '''Format value as little-endian .word directives'''
+    data = value.to_bytes(num_bytes, 'little')
+    return '\n'.join('  .word 0x{:08x}'.format(
+                         int.from_bytes(data[i:i + 4], 'little'))
+                     for i in range(0, num_bytes, 4))
+
+
+def _driver(routine: str, a: int, b: int) -> str:
+    '''Return a program calling routine on operands a and b'''
+    return '\n'.join([
+        '.text',
+        '  li x10, {}'.format(_DPTR_A),
+        '  li x11, {}'.format(_DPTR_B),
+        '  li x12, {}'.format(_DPTR_R),
+        '  jal x1, {}'.format(routine),
+        '  ecall',
+        '.data',
+        _words(a, _DPTR_B - _DPTR_A),
+        _words(b, _DPTR_R - _DPTR_B),
+        _words(0, 256),
+        ''
+    ])
+
+
+def _operands() -> List[Tuple[str, int, int]]:
+    '''Return (name, a, b) triples with edge cases and random operands'''
+    rnd = random.Random(0x6b617261)
+    ret = []
+    for routine, bits, square in _KERNELS:
+        top = (1 << bits) - 1
+        half = (1 << (bits // 2)) - 1
+        pairs = [(0, 0), (top, top), (top, 1), (half, top ^ half),
+                 (top ^ half, top ^ half)]
+        pairs += [(rnd.getrandbits(bits), rnd.getrandbits(bits))
+                  for _ in range(_NUM_RANDOM)]
+        for a, b in pairs:
+            ret.append((routine, a, a if square else b))
+    return ret
+
+
+def test_karatsuba(tmpdir: py.path.local,
+                   routine: str, a: int, b: int) -> None:
+    work_dir = str(tmpdir)
+    driver_path = os.path.join(work_dir, 'driver.s')
+    with open(driver_path, 'w') as driver_file:
+        driver_file.write(_driver(routine, a, b))
+
+    otbn_as = os.path.join(_UTIL_DIR, 'otbn-as')
+    otbn_ld = os.path.join(_UTIL_DIR, 'otbn-ld')
+    objs = []
+    for asm_path in [driver_path,
+                     os.path.join(_SNIPPETS_DIR, 'karatsuba.s')]:
+        obj_path = os.path.join(
+            work_dir,
+            os.path.splitext(os.path.basename(asm_path))[0] + '.o')
+        subprocess.run([otbn_as, '-o', obj_path, asm_path], check=True)
+        objs.append(obj_path)
+    elf_path = os.path.join(work_dir, 'tst')
+    subprocess.run([otbn_ld, '-o', elf_path] + objs, check=True)
+
+    dmem_path = os.path.join(work_dir, 'dmem')
+    standalone_py = os.path.join(_SIM_DIR, 'standalone.py')
+    subprocess.run([standalone_py, '--dmem-dump', dmem_path, elf_path],
+                   check=True)
+
+    with open(dmem_path, 'rb') as dmem_file:
+        dmem = dmem_file.read()
+    num_bytes = 2 * (_DPTR_B - _DPTR_A)
+    result = int.from_bytes(dmem[_DPTR_R:_DPTR_R + num_bytes], 'little')
+
+    assert result == a * b
+
+
+def pytest_generate_tests(metafunc: Any) -> None:
+    if metafunc.function is test_karatsuba:
+        metafunc.parametrize("routine,a,b", _operands())
@@ -0,0 +1,177 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <cassert>
+#include <cstdio>
+#include <iomanip>
+#include <ios>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "profile_trace_listener.h"
+
+// Instruction encodings needed to spot calls, returns and hardware loops
+static const uint32_t kOpcodeJal = 0x6f;
+static const uint32_t kOpcodeJalr = 0x67;
+static const uint32_t kOpcodeLoop = 0x7b;
+static const uint32_t kInsnEcall = 0x73;
+
+static std::string HexAddr(uint32_t addr) {
+  std::ostringstream oss;
+  oss << "0x" << std::hex << std::setw(8) << std::setfill('0') << addr;
+  return oss.str();
+}
+
+ProfileTraceListener::ProfileTraceListener(const std::string &profile_filename)
+    : profile_file_(profile_filename, std::fstream::out) {
+  if (!profile_file_.is_open()) {
+    std::ostringstream oss;
+    oss << "Could not open profile file: " << profile_filename;
+    throw std::runtime_error(oss.str());
+  }
+}
+
+ProfileTraceListener::~ProfileTraceListener() { WriteProfile(); }
+
+const std::string &ProfileTraceListener::GetStack() {
+  if (stack_.empty()) {
+    std::ostringstream oss;
+    for (size_t depth = 0; depth < calls_.size(); ++depth) {
+      oss << (depth ? ";" : "") << "F:" << HexAddr(calls_[depth]);
+      for (const ActiveLoop &loop : active_loops_) {
+        if (loop.depth == depth + 1) {
+          oss << ";L:" << HexAddr(loop.addr);
+        }
+      }
+    }
+    stack_ = oss.str();
+  }
+  return stack_;
+}
+
+void ProfileTraceListener::ResolveLoopEnds(uint32_t pc) {
+  // If the last instruction ran the end of a loop body, we find out whether
+  // the loop finished by seeing whether we jumped back to its start. When an
+  // inner loop finishes at the end of an outer loop's body, the outer loop has
+  // also reached the end of an iteration.
+  while (!active_loops_.empty() && active_loops_.back().at_end) {
+    ActiveLoop &loop = active_loops_.back();
+    if (pc == loop.addr + 4) {
+      loop.at_end = false;
+      return;
+    }
+
+    uint32_t end_addr = loop.end_addr;
+    active_loops_.pop_back();
+    stack_.clear();
+
+    if (!active_loops_.empty() && active_loops_.back().end_addr == end_addr) {
+      ActiveLoop &outer = active_loops_.back();
+      outer.at_end = true;
+      ++loops_[outer.addr].iterations;
+    }
+  }
+}
+
+void ProfileTraceListener::UpdateStacks(uint32_t pc, uint32_t insn) {
+  uint32_t opcode = insn & 0x7f;
+  uint32_t rd = (insn >> 7) & 0x1f;
+  uint32_t funct3 = (insn >> 12) & 0x7;
+  uint32_t rs1 = (insn >> 15) & 0x1f;
+
+  if (opcode == kOpcodeLoop && funct3 <= 1) {
+    // LOOP or LOOPI: the body size is stored minus one in bits 31:20.
+    uint32_t bodysize = (insn >> 20) + 1;
+    active_loops_.push_back({pc, pc + 4 * bodysize, calls_.size(), false});
+    ++loops_[pc].entries;
+    stack_.clear();
+  } else if (!active_loops_.empty() && !active_loops_.back().at_end &&
+             active_loops_.back().depth == calls_.size() &&
+             pc == active_loops_.back().end_addr) {
+    ActiveLoop &loop = active_loops_.back();
+    loop.at_end = true;
+    ++loops_[loop.addr].iterations;
+  }
+
+  if ((opcode == kOpcodeJal || opcode == kOpcodeJalr) && rd == 1) {
+    call_pending_ = true;
+  } else if (opcode == kOpcodeJalr && rs1 == 1 && rd == 0) {
+    if (calls_.size() > 1) {
+      calls_.pop_back();
+      while (!active_loops_.empty() &&
+             active_loops_.back().depth > calls_.size()) {
+        active_loops_.pop_back();
+      }
+      stack_.clear();
+    }
+  } else if (insn == kInsnEcall) {
+    // The end of an operation: the next one starts afresh.
+    calls_.clear();
+    active_loops_.clear();
+    stack_.clear();
+  }
+}
+
+void ProfileTraceListener::AcceptTraceString(const std::string &trace,
+                                             unsigned int cycle_count) {
+  auto trace_lines = SplitTraceLines(trace);
+  if (trace_lines.empty()) {
+    return;
+  }
+
+  const std::string &line = trace_lines[0];
+  if (line.size() < 2 || (line[0] != 'E' && line[0] != 'S')) {
+    return;
+  }
+
+  unsigned int pc, insn;
+  if (std::sscanf(line.c_str() + 1, " PC: 0x%x, insn: 0x%x", &pc, &insn) !=
+      2) {
+    return;
+  }
+
+  bool stall = line[0] == 'S';
+
+  ResolveLoopEnds(pc);
+
+  // The first cycle of a run or of a called function tells us the function's
+  // entry address.
+  if (calls_.empty() || call_pending_) {
+    calls_.push_back(pc);
+    call_pending_ = false;
+    stack_.clear();
+  }
+
+  PcCounts &counts = pcs_[pc];
+  ++counts.cycles;
+  if (stall) {
+    ++counts.stalls;
+  } else {
+    ++counts.insns;
+  }
+
+  ++stacks_[GetStack()];
+
+  if (!stall) {
+    UpdateStacks(pc, insn);
+  }
+}
+
+void ProfileTraceListener::WriteProfile() {
+  assert(profile_file_.is_open());
+
+  profile_file_ << "# OTBN profile\n";
+  for (const auto &pr : pcs_) {
+    profile_file_ << "pc " << HexAddr(pr.first) << " " << pr.second.cycles
+                  << " " << pr.second.stalls << " " << pr.second.insns << "\n";
+  }
+  for (const auto &pr : loops_) {
+    profile_file_ << "loop " << HexAddr(pr.first) << " " << pr.second.entries
+                  << " " << pr.second.iterations << "\n";
+  }
+  for (const auto &pr : stacks_) {
+    profile_file_ << "stack " << pr.first << " " << pr.second << "\n";
+  }
+}
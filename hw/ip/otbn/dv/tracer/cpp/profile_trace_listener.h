@@ -0,0 +1,81 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef OPENTITAN_HW_IP_OTBN_DV_TRACER_CPP_PROFILE_TRACE_LISTENER_H_
+#define OPENTITAN_HW_IP_OTBN_DV_TRACER_CPP_PROFILE_TRACE_LISTENER_H_
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "otbn_trace_listener.h"
+
+/**
+ * An OtbnTraceListener that collects a cycle profile of the program that is
+ * running and writes it to a file when destroyed.
+ *
+ * It only looks at the first line of each trace output, which should be an 'E'
+ * or 'S' (execute or stall) line giving the PC and instruction bits. Each such
+ * line counts as a cycle for its PC and for the current stack of functions and
+ * hardware loops. Calls, returns and loops are found by decoding the
+ * instruction bits, in the same way as the Profiler class in the Python ISS
+ * (dv/otbnsim/sim/profile.py). That file also describes the output format,
+ * which can be read by dv/otbnsim/profiler.py.
+ */
+class ProfileTraceListener : public OtbnTraceListener {
+ private:
+  struct PcCounts {
+    uint64_t cycles = 0;
+    uint64_t stalls = 0;
+    uint64_t insns = 0;
+  };
+
+  struct LoopCounts {
+    uint64_t entries = 0;
+    uint64_t iterations = 0;
+  };
+
+  struct ActiveLoop {
+    uint32_t addr;
+    uint32_t end_addr;
+    // Number of functions on the call stack when the loop started
+    size_t depth;
+    // True if we just ran the last instruction of the loop body and don't yet
+    // know whether there is another iteration.
+    bool at_end;
+  };
+
+  std::ofstream profile_file_;
+
+  std::map<uint32_t, PcCounts> pcs_;
+  std::map<uint32_t, LoopCounts> loops_;
+  std::map<std::string, uint64_t> stacks_;
+
+  // Entry addresses of the functions on the call stack
+  std::vector<uint32_t> calls_;
+  std::vector<ActiveLoop> active_loops_;
+  bool call_pending_ = false;
+
+  // The stack in output format. Empty if it needs recomputing.
+  std::string stack_;
+
+  const std::string &GetStack();
+  void ResolveLoopEnds(uint32_t pc);
+  void UpdateStacks(uint32_t pc, uint32_t insn);
+  void WriteProfile();
+
+ public:
+  /**
+   * Constructor that takes a filename to write the profile to. It throws
+   * std::runtime_error if the file cannot be opened.
+   */
+  ProfileTraceListener(const std::string &profile_filename);
+  ~ProfileTraceListener();
+  void AcceptTraceString(const std::string &trace,
+                         unsigned int cycle_count) override;
+};
+
+#endif  // OPENTITAN_HW_IP_OTBN_DV_TRACER_CPP_PROFILE_TRACE_LISTENER_H_
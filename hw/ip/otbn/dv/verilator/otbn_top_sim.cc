@@ -14,6 +14,7 @@
 #include "otbn_memutil.h"
 #include "otbn_trace_checker.h"
 #include "otbn_trace_source.h"
+#include "profile_trace_listener.h"
 #include "verilated_toplevel.h"
 #include "verilator_memutil.h"
 #include "verilator_sim_ctrl.h"
@@ -26,13 +27,15 @@ extern unsigned int otbn_bignum_reg_get(int index, int quarter);
 }
 
 /**
- * SimCtrlExtension that adds a '--otbn-trace-file' command line option. If set
- * it sets up a LogTraceListener that will dump out the trace to the given log
- * file
+ * SimCtrlExtension that adds '--otbn-trace-file' and '--otbn-profile-file'
+ * command line options. If set, they set up a LogTraceListener that will dump
+ * out the trace to the given log file and a ProfileTraceListener that will
+ * write a cycle profile to the given file, respectively.
  */
 class OtbnTraceUtil : public SimCtrlExtension {
  private:
   std::unique_ptr<LogTraceListener> log_trace_listener_;
+  std::unique_ptr<ProfileTraceListener> profile_trace_listener_;
 
   bool SetupTraceLog(const std::string &log_filename) {
     try {
@@ -48,16 +51,35 @@ class OtbnTraceUtil : public SimCtrlExtension {
     return false;
   }
 
+  bool SetupProfile(const std::string &profile_filename) {
+    try {
+      profile_trace_listener_ =
+          std::make_unique<ProfileTraceListener>(profile_filename);
+      OtbnTraceSource::get().AddListener(profile_trace_listener_.get());
+      return true;
+    } catch (const std::runtime_error &err) {
+      std::cerr << "ERROR: Failed to set up profile: " << err.what()
+                << std::endl;
+      return false;
+    }
+
+    return false;
+  }
+
   void PrintHelp() {
     std::cout << "Trace log utilities:\n\n"
                  "--otbn-trace-file=FILE\n"
-                 "  Write OTBN trace log to FILE\n\n";
+                 "  Write OTBN trace log to FILE\n\n"
+                 "--otbn-profile-file=FILE\n"
+                 "  Write OTBN cycle profile to FILE (see "
+                 "hw/ip/otbn/dv/otbnsim/profiler.py)\n\n";
   }
 
  public:
   virtual bool ParseCLIArguments(int argc, char **argv, bool &exit_app) {
     const struct option long_options[] = {
         {"otbn-trace-file", required_argument, nullptr, 'l'},
+        {"otbn-profile-file", required_argument, nullptr, 'p'},
         {"help", no_argument, nullptr, 'h'},
         {nullptr, no_argument, nullptr, 0}};
 
@@ -74,7 +96,15 @@ class OtbnTraceUtil : public SimCtrlExtension {
         case 0:
           break;
         case 'l':
-          return SetupTraceLog(optarg);
+          if (!SetupTraceLog(optarg)) {
+            return false;
+          }
+          break;
+        case 'p':
+          if (!SetupProfile(optarg)) {
+            return false;
+          }
+          break;
         case 'h':
           PrintHelp();
           break;
@@ -87,6 +117,8 @@ class OtbnTraceUtil : public SimCtrlExtension {
   ~OtbnTraceUtil() {
     if (log_trace_listener_)
       OtbnTraceSource::get().RemoveListener(log_trace_listener_.get());
+    if (profile_trace_listener_)
+      OtbnTraceSource::get().RemoveListener(profile_trace_listener_.get());
   }
 };
 
@@ -96,9 +128,8 @@ int main(int argc, char **argv) {
   VerilatorMemUtil memutil(new OtbnMemUtil("TOP.otbn_top_sim"));
   OtbnTraceUtil traceutil;
 
-  VerilatorSimCtrl &simctrl = VerilatorSimCtrl::GetInstance();
-  simctrl.SetTop(&top, &top.IO_CLK, &top.IO_RST_N,
-                 VerilatorSimCtrlFlags::ResetPolarityNegative);
+  VerilatorSimCtrl simctrl(&top, &top.IO_CLK, &top.IO_RST_N,
+                           VerilatorSimCtrlFlags::ResetPolarityNegative);
   simctrl.RegisterExtension(&memutil);
   simctrl.RegisterExtension(&traceutil);
 
@@ -0,0 +1,70 @@
+# Copyright lowRISC contributors.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+
+from typing import Dict
+
+
+class GenWeights:
+    '''Multipliers for the weights used when picking what to generate
+
+    gens maps the class name of a snippet generator (like 'Branch') to a
+    multiplier for its default weight in SnippetGens. insns maps an instruction
+    mnemonic to a multiplier for the weight with which StraightLineInsn picks
+    that instruction. Anything that isn't listed has a multiplier of 1.
+
+    These are used to steer generation towards parts of the instruction set
+    that haven't been exercised much (see the fuzzing driver in dv/otbnsim).
+
+    '''
+    def __init__(self,
+                 gens: Dict[str, float],
+                 insns: Dict[str, float]) -> None:
+        self.gens = gens
+        self.insns = insns
+
+    def gen_weight(self, name: str) -> float:
+        return self.gens.get(name, 1.0)
+
+    def insn_weight(self, mnemonic: str) -> float:
+        return self.insns.get(mnemonic, 1.0)
+
+    @staticmethod
+    def _read_dict(what: str, parsed: object) -> Dict[str, float]:
+        if not isinstance(parsed, dict):
+            raise ValueError('{} is not a dictionary.'.format(what))
+
+        ret = {}
+        for key, value in parsed.items():
+            if not isinstance(value, (int, float)):
+                raise ValueError('The {} weight for {!r} is not a number.'
+                                 .format(what, key))
+            # Weights must be strictly positive. A zero weight for ECALL or
+            # ADDI (which always succeed) could make generation get stuck.
+            if value <= 0:
+                raise ValueError('The {} weight for {!r} is {}, but weights '
+                                 'must be positive.'
+                                 .format(what, key, value))
+            ret[key] = float(value)
+
+        return ret
+
+    @staticmethod
+    def read(parsed: object) -> 'GenWeights':
+        '''Read weights as parsed from json
+
+        The expected format is a dictionary with optional keys 'gens' and
+        'insns', each of which maps names to positive numbers.
+
+        '''
+        if not isinstance(parsed, dict):
+            raise ValueError('Weights are not a dictionary.')
+
+        unknown = set(parsed.keys()) - {'gens', 'insns'}
+        if unknown:
+            raise ValueError('Unknown keys in weights: {}.'
+                             .format(', '.join(sorted(unknown))))
+
+        gens = GenWeights._read_dict('gens', parsed.get('gens', {}))
+        insns = GenWeights._read_dict('insns', parsed.get('insns', {}))
+        return GenWeights(gens, insns)
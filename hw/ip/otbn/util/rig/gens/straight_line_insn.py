@@ -9,6 +9,7 @@ from shared.insn_yaml import Insn, InsnsFile
 from shared.lsu_desc import LSUDesc
 from shared.operand import ImmOperandType, OptionOperandType, RegOperandType
 
+from ..gen_weights import GenWeights
 from ..program import ProgInsn, Program
 from ..model import Model
 from ..snippet import ProgSnippet
@@ -31,6 +32,12 @@ class StraightLineInsn(SnippetGen):
 
             self.insns.append(insn)
 
+        self.weights = [1.0] * len(self.insns)
+
+    def apply_weights(self, weights: GenWeights) -> None:
+        self.weights = [weights.insn_weight(insn.mnemonic)
+                        for insn in self.insns]
+
     def gen(self,
             cont: GenCont,
             model: Model,
@@ -45,10 +52,9 @@ class StraightLineInsn(SnippetGen):
         if program.get_insn_space_at(model.pc) <= 1:
             return None
 
-        # Pick a (YAML) instruction at random. We'll probably do some clever
-        # weighting here later on but, for now, we'll pick uniformly at the
-        # start.
-        weights = [1.0] * len(self.insns)
+        # Pick a (YAML) instruction at random. These weights are uniform unless
+        # apply_weights has been called.
+        weights = list(self.weights)
 
         prog_insn = None
         while prog_insn is None:
@@ -2,11 +2,12 @@
 # Licensed under the Apache License, Version 2.0, see LICENSE for details.
 # SPDX-License-Identifier: Apache-2.0
 
-from typing import Tuple
+from typing import Optional, Tuple
 
 from shared.insn_yaml import InsnsFile
 from shared.mem_layout import get_memory_layout
 
+from .gen_weights import GenWeights
 from .init_data import InitData
 from .program import Program
 from .model import Model
@@ -16,12 +17,14 @@ from .snippet import Snippet
 
 def gen_program(start_addr: int,
                 fuel: int,
-                insns_file: InsnsFile) -> Tuple[InitData, Snippet]:
+                insns_file: InsnsFile,
+                weights: Optional[GenWeights]) -> Tuple[InitData, Snippet]:
     '''Generate a random program for OTBN
 
     start_addr is the reset address (the value that should be programmed into
     the START_ADDR register). fuel gives a rough upper bound for the number of
-    instructions that will be executed by the generated program.
+    instructions that will be executed by the generated program. If weights is
+    not None, it is used to bias the choice of snippets and instructions.
 
     Returns (init_data, snippets, program). init_data is a dict mapping (4-byte
     aligned) address to u32s that should be loaded into data memory before
@@ -50,7 +53,7 @@ def gen_program(start_addr: int,
     for addr in init_data.keys():
         model.touch_mem('dmem', addr, 4)
 
-    ret = SnippetGens(insns_file).gens(model, program, True)
+    ret = SnippetGens(insns_file, weights).gens(model, program, True)
     assert ret is not None
     snippet, _ = ret
 
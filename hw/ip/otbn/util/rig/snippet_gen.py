@@ -13,6 +13,7 @@ from typing import Callable, Optional, Tuple
 
 from shared.insn_yaml import Insn, InsnsFile
 
+from .gen_weights import GenWeights
 from .program import Program
 from .model import Model
 from .snippet import Snippet
@@ -82,6 +83,16 @@ class SnippetGen:
         '''
         return 1.0
 
+    def apply_weights(self, weights: GenWeights) -> None:
+        '''Apply any weights that affect choices inside this generator
+
+        This is called once, after construction, if the generator is being
+        used with a non-default set of weights. The default implementation
+        does nothing.
+
+        '''
+        pass
+
     def _get_named_insn(self, insns_file: InsnsFile, mnemonic: str) -> Insn:
         '''Get an instruction from insns_file by mnemonic
 
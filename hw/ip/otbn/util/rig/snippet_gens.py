@@ -7,6 +7,7 @@ from typing import List, Optional, Tuple
 
 from shared.insn_yaml import InsnsFile
 
+from .gen_weights import GenWeights
 from .program import Program
 from .model import Model
 from .snippet import SeqSnippet, Snippet
@@ -27,10 +28,16 @@ class SnippetGens:
         (StraightLineInsn, 1.0)
     ]
 
-    def __init__(self, insns_file: InsnsFile) -> None:
+    def __init__(self,
+                 insns_file: InsnsFile,
+                 weights: Optional[GenWeights] = None) -> None:
         self.generators = []  # type: List[Tuple[SnippetGen, float]]
         for cls, weight in SnippetGens._WEIGHTED_CLASSES:
-            self.generators.append((cls(insns_file), weight))
+            generator = cls(insns_file)
+            if weights is not None:
+                weight *= weights.gen_weight(cls.__name__)
+                generator.apply_weights(weights)
+            self.generators.append((generator, weight))
 
     def gen(self,
             model: Model,
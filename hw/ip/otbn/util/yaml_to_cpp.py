@@ -0,0 +1,258 @@
+#!/usr/bin/env python3
+# Copyright lowRISC contributors.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+
+'''Generate a C++ instruction decoder for the instructions in insns.yml
+
+The generated header is used by the native OTBN ISS (in dv/model). It defines
+an ID for each instruction that has an encoding, a table with the mnemonic,
+cycle count and control flow behaviour of each instruction, and an inline
+function that decodes an instruction word (extracting its operand
+fields and converting them to operand values in the same way as
+OperandType.enc_val_to_op_val).
+
+The instructions are listed in the order they appear in insns.yml, which is
+also the order in which the Python ISS tries to match them.
+
+'''
+
+import argparse
+import sys
+from typing import Dict, List, TextIO
+
+from shared.insn_yaml import Insn, InsnsFile, load_file
+from shared.mem_layout import get_memory_layout
+from shared.operand import ImmOperandType
+
+_HEADER = '''\
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Instruction decoder for the native OTBN ISS.
+//
+// Generated from {src} by hw/ip/otbn/util/yaml_to_cpp.py. Do not edit this
+// file by hand: re-run the generator instead (see the regen-insns target in
+// hw/ip/otbn/dv/model/Makefile).
+
+#pragma once
+
+#include <cstdint>
+
+'''
+
+
+def insn_id(insn: Insn) -> str:
+    '''Return the name of the enum value for insn ("bn.addc" -> kBnAddc)'''
+    parts = insn.mnemonic.replace('.', '_').split('_')
+    return 'k' + ''.join(part.capitalize() for part in parts)
+
+
+def operand_names(insns: List[Insn]) -> List[str]:
+    '''Return the names of all operands of insns, in order of appearance'''
+    names = []  # type: List[str]
+    for insn in insns:
+        for operand in insn.operands:
+            if operand.name not in names:
+                names.append(operand.name)
+    return names
+
+
+def wrap_or(prefix: str, parts: List[str], suffix: str) -> str:
+    '''Render prefix, then parts joined with '|', then suffix
+
+    Lines are wrapped to fit in 80 columns, aligning continuation lines with
+    the first part.
+
+    '''
+    indent = ' ' * len(prefix)
+    lines = [prefix + parts[0]]
+    for part in parts[1:]:
+        if len(lines[-1]) + len(part) + len(' |' + suffix) + 1 > 80:
+            lines[-1] += ' |'
+            lines.append(indent + part)
+        else:
+            lines[-1] += ' | ' + part
+    return '\n'.join(lines) + suffix + '\n'
+
+
+def render_field_expr(insn: Insn, field_name: str) -> List[str]:
+    '''Return C++ expressions that extract an encoded operand from word
+
+    The encoded value is the bitwise OR of the returned expressions.
+
+    '''
+    assert insn.encoding is not None
+    bits = insn.encoding.fields[field_name].scheme_field.bits
+
+    # This matches BitRanges.decode: the first range holds the most
+    # significant bits of the value.
+    parts = []
+    bits_left = bits.width
+    for msb, lsb in bits.ranges:
+        width = msb - lsb + 1
+        bits_left -= width
+        part = '((word >> {}) & {:#x})'.format(lsb, (1 << width) - 1)
+        if bits_left:
+            part = '({} << {})'.format(part, bits_left)
+        parts.append(part)
+    assert bits_left == 0
+
+    return parts
+
+
+def render_operand(insn: Insn, field_name: str, op_name: str) -> str:
+    '''Render the code that decodes a single operand of insn'''
+    op_type = insn.name_to_operand[op_name].op_type
+    parts = render_field_expr(insn, field_name)
+
+    # Register, enum and option operands are represented by their encoded
+    # values. Immediates might need sign-extending, offsetting, shifting and
+    # making PC-relative (see ImmOperandType.enc_val_to_op_val).
+    if not isinstance(op_type, ImmOperandType):
+        return wrap_or('    ret.ops.{} = '.format(op_name), parts, ';')
+
+    assert op_type.width is not None
+    lines = ['    {\n', wrap_or('      int32_t val = ', parts, ';')]
+    if op_type.signed:
+        lines.append('      val = (val ^ {0:#x}) - {0:#x};\n'
+                     .format(1 << (op_type.width - 1)))
+    if op_type.enc_offset:
+        lines.append('      val += {};\n'.format(op_type.enc_offset))
+    if op_type.shift:
+        lines.append('      val *= {};\n'.format(1 << op_type.shift))
+    if op_type.pc_rel:
+        lines.append('      val += (int32_t)pc;\n')
+    lines.append('      ret.ops.{} = val;\n    }}\n'.format(op_name))
+    return ''.join(lines)
+
+
+def render_decode(insn: Insn) -> str:
+    '''Render the part of otbn_decode() that matches insn'''
+    assert insn.encoding is not None
+    m0, m1 = insn.encoding.get_masks()
+
+    # Encoding.get_masks sets bits that are 'x' in both masks (see
+    # sim/decode.py), so take a difference.
+    zeros = m0 & ~m1
+    ones = m1 & ~m0
+
+    parts = ['  if (!(word & {:#010x}) && !(~word & {:#010x})) {{\n'
+             .format(zeros, ones),
+             '    ret.id = OtbnInsnId::{};\n'.format(insn_id(insn))]
+
+    op_fields = {}  # type: Dict[str, str]
+    for field_name, field in insn.encoding.fields.items():
+        if isinstance(field.value, str):
+            op_fields[field.value] = field_name
+
+    for operand in insn.operands:
+        parts.append(render_operand(insn, op_fields[operand.name],
+                                    operand.name))
+
+    parts.append('    return ret;\n  }\n')
+    return ''.join(parts)
+
+
+def render_header(insns_file: InsnsFile, src: str, out: TextIO) -> None:
+    '''Write the C++ header for insns_file to out'''
+    insns = [insn for insn in insns_file.insns if insn.encoding is not None]
+
+    mems = get_memory_layout()
+    _, imem_size = mems['IMEM']
+    _, dmem_size = mems['DMEM']
+
+    out.write(_HEADER.format(src=src))
+
+    out.write('// The sizes of IMEM and DMEM in bytes\n'
+              'static const uint32_t kOtbnImemSizeBytes = {};\n'
+              'static const uint32_t kOtbnDmemSizeBytes = {};\n\n'
+              .format(imem_size, dmem_size))
+
+    out.write('// An ID for each instruction with an encoding. kIllegal is '
+              'used for words\n'
+              "// that don't decode as any instruction.\n"
+              'enum class OtbnInsnId : uint8_t {\n')
+    for insn in insns:
+        out.write('  {},\n'.format(insn_id(insn)))
+    out.write('  kIllegal\n};\n\n')
+
+    out.write('// Static information about an instruction, taken from '
+              'insns.yml\n'
+              'struct OtbnInsnInfo {\n'
+              '  const char *mnemonic;\n'
+              '  // The number of cycles that the instruction takes\n'
+              '  unsigned cycles;\n'
+              '  // False if the instruction can affect control flow '
+              '(the straight-line\n'
+              '  // field in insns.yml)\n'
+              '  bool straight_line;\n'
+              '};\n\n')
+
+    out.write('// Instruction information, indexed by OtbnInsnId\n'
+              'static const OtbnInsnInfo kOtbnInsnInfo[] = {\n')
+    for insn in insns:
+        out.write('    {{"{}", {}, {}}},\n'
+                  .format(insn.mnemonic, insn.cycles,
+                          'true' if insn.straight_line else 'false'))
+    out.write('    {"illegal", 1, true}};\n\n')
+
+    out.write('// Operand values for a decoded instruction. Each field '
+              'holds the value of the\n'
+              '// operand with the same name, or zero if the instruction '
+              "doesn't have such\n"
+              '// an operand.\n'
+              'struct OtbnOperands {\n')
+    for name in operand_names(insns):
+        out.write('  int32_t {};\n'.format(name))
+    out.write('};\n\n')
+
+    out.write('struct OtbnDecodedInsn {\n'
+              '  OtbnInsnId id;\n'
+              '  // The raw instruction word\n'
+              '  uint32_t raw;\n'
+              '  OtbnOperands ops;\n'
+              '};\n\n')
+
+    out.write('// Decode an instruction word, which is at address pc in '
+              'IMEM. PC-relative\n'
+              '// operands are converted to absolute addresses.\n'
+              'inline OtbnDecodedInsn otbn_decode(uint32_t word, '
+              'uint32_t pc) {\n'
+              '  OtbnDecodedInsn ret = {};\n'
+              '  ret.raw = word;\n\n')
+    for insn in insns:
+        out.write(render_decode(insn))
+        out.write('\n')
+    out.write('  ret.id = OtbnInsnId::kIllegal;\n'
+              '  return ret;\n'
+              '}\n')
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser()
+    parser.add_argument('yaml_file')
+    parser.add_argument('out_file')
+
+    args = parser.parse_args()
+
+    try:
+        insns = load_file(args.yaml_file)
+    except RuntimeError as err:
+        print(err, file=sys.stderr)
+        return 1
+
+    try:
+        with open(args.out_file, 'w') as out:
+            render_header(insns, 'insns.yml', out)
+    except OSError as err:
+        print('Failed to write output file {!r}: {}.'
+              .format(args.out_file, err), file=sys.stderr)
+        return 1
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -10,6 +10,7 @@ extern "C" {
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "prince_fast.h"
 #include "prince_ref.h"
 #include "svdpi.h"
 
@@ -28,6 +29,42 @@ extern uint64_t c_dpi_prince_decrypt(const uint64_t ciphertext,
                                old_key_schedule);
 }
 
+/**
+ * Encrypts or decrypts every element of `data_i` into `data_o` under one key.
+ *
+ * The key is expanded once per call, and the blocks are processed with the
+ * table-driven implementation in prince_fast.h.
+ */
+extern void c_dpi_prince_crypt_batch(const svOpenArrayHandle data_i,
+                                     const uint64_t key0, const uint64_t key1,
+                                     int decrypt, int num_half_rounds,
+                                     int old_key_schedule,
+                                     svOpenArrayHandle data_o) {
+  prince_fast_key_t key;
+  if (prince_fast_key_init(&key, key0, key1, decrypt, num_half_rounds,
+                           old_key_schedule)) {
+    printf("ERROR: c_dpi_prince_crypt_batch: unsupported number of "
+           "half-rounds %d\n",
+           num_half_rounds);
+    return;
+  }
+
+  const int num_blocks = svSize(data_i, 1);
+  if (svSize(data_o, 1) != num_blocks) {
+    printf("ERROR: c_dpi_prince_crypt_batch: input and output sizes differ\n");
+    return;
+  }
+
+  const prince_fast_tables_t *tables = prince_fast_tables();
+  const int low_i = svLow(data_i, 1);
+  const int low_o = svLow(data_o, 1);
+  for (int i = 0; i < num_blocks; i++) {
+    const uint64_t *in = (const uint64_t *)svGetArrElemPtr1(data_i, low_i + i);
+    uint64_t *out = (uint64_t *)svGetArrElemPtr1(data_o, low_o + i);
+    *out = prince_fast_crypt(tables, &key, *in);
+  }
+}
+
 #ifdef _cplusplus
 }
 #endif
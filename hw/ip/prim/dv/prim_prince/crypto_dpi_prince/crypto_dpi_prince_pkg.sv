@@ -27,6 +27,19 @@ package crypto_dpi_prince_pkg;
     input int unsigned      new_key_schedule
   );
 
+  // Encrypts (decrypt = 0) or decrypts (decrypt = 1) all of data_i under one key, much faster
+  // than one c_dpi_prince_encrypt / c_dpi_prince_decrypt call per block. data_o must have the
+  // same size as data_i.
+  import "DPI-C" context function void c_dpi_prince_crypt_batch(
+    input longint unsigned  data_i[],
+    input longint unsigned  key0,
+    input longint unsigned  key1,
+    input int unsigned      decrypt,
+    input int unsigned      num_half_rounds,
+    input int unsigned      old_key_schedule,
+    output longint unsigned data_o[]
+  );
+
   //////////////////////////////////////////////////////
   // SV wrapper functions to be used by the testbench //
   //////////////////////////////////////////////////////
@@ -0,0 +1,171 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+/*
+ * Table-driven implementation of the PRINCE block cipher, for evaluating many
+ * blocks under the same key.
+ *
+ * The layers of `prince_core(...)` in prince_ref.h are merged into byte-indexed
+ * lookup tables. This works because each S-layer acts on nibbles and every
+ * other layer is linear:
+ *
+ *    - A forward half-round M(S(x)) is the XOR of FS[j][byte j of x] over the
+ *      8 bytes j of the state.
+ *    - The middle round's M'(S(x)) is looked up the same way.
+ *    - An inverse half-round S^-1(M^-1(x ^ k)) is carried as its input to
+ *      S^-1: with z the previous such value, the next one is
+ *      M^-1(S^-1(z) ^ k) = IS(z) ^ M^-1(k). M^-1(k) is precomputed per key.
+ *
+ * The tables are generated once from the reference layers in prince_ref.h,
+ * and the per-key values by `prince_fast_key_init(...)`, so a block costs 8
+ * lookups per half-round. The results are identical to
+ * `prince_enc_dec_uint64(...)`.
+ */
+
+#ifndef OPENTITAN_HW_IP_PRIM_DV_PRIM_PRINCE_CRYPTO_DPI_PRINCE_PRINCE_FAST_H_
+#define OPENTITAN_HW_IP_PRIM_DV_PRIM_PRINCE_CRYPTO_DPI_PRINCE_PRINCE_FAST_H_
+
+#include <stdint.h>
+
+#include "prince_ref.h"
+
+/**
+ * Maximum number of half-rounds supported by the round constants.
+ */
+#define PRINCE_FAST_MAX_HALF_ROUNDS 5
+
+typedef struct prince_fast_tables {
+  // M(S(x)) and M'(S(x)) contributions of each byte of x.
+  uint64_t fs[8][256];
+  uint64_t mps[8][256];
+  // M^-1(S^-1(x)) contributions of each byte of x.
+  uint64_t is[8][256];
+  // S^-1 on both nibbles of a byte.
+  uint8_t s_inv[256];
+} prince_fast_tables_t;
+
+/**
+ * Expanded key for one direction and number of half-rounds.
+ */
+typedef struct prince_fast_key {
+  int num_half_rounds;
+  // Whitening keys.
+  uint64_t k0;
+  uint64_t k0_prime;
+  // Round keys XORed with the round constants, first half.
+  uint64_t fwd_keys[PRINCE_FAST_MAX_HALF_ROUNDS + 1];
+  // Round keys XORed with the round constants, through M^-1, second half.
+  uint64_t inv_keys[PRINCE_FAST_MAX_HALF_ROUNDS];
+  // Last round key XORed with the round constant.
+  uint64_t out_key;
+} prince_fast_key_t;
+
+/**
+ * Applies the S-layer to a byte.
+ */
+static uint8_t prince_fast_sbox8(unsigned int byte) {
+  return (uint8_t)((prince_sbox(byte >> 4) << 4) | prince_sbox(byte));
+}
+
+/**
+ * Returns the lookup tables, which are built on the first call.
+ */
+static const prince_fast_tables_t *prince_fast_tables(void) {
+  static prince_fast_tables_t tables;
+  static int initialized = 0;
+
+  if (!initialized) {
+    for (unsigned int b = 0; b < 256; b++) {
+      const uint64_t s_out = prince_fast_sbox8(b);
+      const uint64_t s_inv_out =
+          (prince_sbox_inv(b >> 4) << 4) | prince_sbox_inv(b);
+      tables.s_inv[b] = (uint8_t)s_inv_out;
+      for (unsigned int j = 0; j < 8; j++) {
+        tables.fs[j][b] = prince_m_layer(s_out << (8 * j));
+        tables.mps[j][b] = prince_m_prime_layer(s_out << (8 * j));
+        tables.is[j][b] = prince_m_inv_layer(s_inv_out << (8 * j));
+      }
+    }
+    initialized = 1;
+  }
+
+  return &tables;
+}
+
+/**
+ * XORs together the table entries selected by the bytes of `x`.
+ */
+static uint64_t prince_fast_lookup(const uint64_t table[8][256], uint64_t x) {
+  return table[0][x & 0xff] ^ table[1][(x >> 8) & 0xff] ^
+         table[2][(x >> 16) & 0xff] ^ table[3][(x >> 24) & 0xff] ^
+         table[4][(x >> 32) & 0xff] ^ table[5][(x >> 40) & 0xff] ^
+         table[6][(x >> 48) & 0xff] ^ table[7][x >> 56];
+}
+
+/**
+ * Expands a key, mirroring the key handling of `prince_enc_dec_uint64(...)`.
+ *
+ * Returns 0 on success, or -1 if `num_half_rounds` is out of range.
+ */
+static int prince_fast_key_init(prince_fast_key_t *key, const uint64_t enc_k0,
+                                const uint64_t enc_k1, int decrypt,
+                                int num_half_rounds, int old_key_schedule) {
+  if (num_half_rounds < 0 || num_half_rounds > PRINCE_FAST_MAX_HALF_ROUNDS) {
+    return -1;
+  }
+
+  const uint64_t prince_alpha = UINT64_C(0xc0ac29b7c97c50dd);
+  const uint64_t k1 = enc_k1 ^ (decrypt ? prince_alpha : 0);
+  const uint64_t k0_new =
+      (old_key_schedule) ? k1 : enc_k0 ^ (decrypt ? prince_alpha : 0);
+  const uint64_t enc_k0_prime = prince_k0_to_k0_prime(enc_k0);
+
+  key->num_half_rounds = num_half_rounds;
+  key->k0 = decrypt ? enc_k0_prime : enc_k0;
+  key->k0_prime = decrypt ? enc_k0 : enc_k0_prime;
+
+  key->fwd_keys[0] = k1 ^ prince_round_constant(0);
+  for (int round = 1; round <= num_half_rounds; round++) {
+    key->fwd_keys[round] =
+        ((round % 2 == 1) ? k0_new : k1) ^ prince_round_constant(round);
+  }
+  for (int round = 1; round <= num_half_rounds; round++) {
+    const unsigned int constant_idx = 10 - num_half_rounds + round;
+    const uint64_t round_key =
+        (((num_half_rounds + round + 1) % 2 == 1) ? k0_new : k1) ^
+        prince_round_constant(constant_idx);
+    key->inv_keys[round - 1] = prince_m_inv_layer(round_key);
+  }
+  key->out_key = k1 ^ prince_round_constant(11);
+
+  return 0;
+}
+
+/**
+ * Encrypts or decrypts one block with an expanded key.
+ */
+static uint64_t prince_fast_crypt(const prince_fast_tables_t *tables,
+                                  const prince_fast_key_t *key,
+                                  const uint64_t input) {
+  uint64_t state = input ^ key->k0 ^ key->fwd_keys[0];
+  for (int round = 1; round <= key->num_half_rounds; round++) {
+    state = prince_fast_lookup(tables->fs, state) ^ key->fwd_keys[round];
+  }
+
+  // Middle round up to, but excluding, the final S^-1, which is merged into
+  // the inverse half-rounds.
+  state = prince_fast_lookup(tables->mps, state);
+  for (int round = 0; round < key->num_half_rounds; round++) {
+    state = prince_fast_lookup(tables->is, state) ^ key->inv_keys[round];
+  }
+
+  uint64_t s_inv_out = 0;
+  for (unsigned int j = 0; j < 8; j++) {
+    s_inv_out |= (uint64_t)tables->s_inv[(state >> (8 * j)) & 0xff] << (8 * j);
+  }
+
+  return s_inv_out ^ key->out_key ^ key->k0_prime;
+}
+
+#endif  // OPENTITAN_HW_IP_PRIM_DV_PRIM_PRINCE_CRYPTO_DPI_PRINCE_PRINCE_FAST_H_
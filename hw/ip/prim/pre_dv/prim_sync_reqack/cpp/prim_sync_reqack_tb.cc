@@ -15,23 +15,25 @@ class PrimSyncReqAckTB : public SimCtrlExtension {
   using SimCtrlExtension::SimCtrlExtension;
 
  public:
-  PrimSyncReqAckTB(prim_sync_reqack_tb *top);
+  PrimSyncReqAckTB(prim_sync_reqack_tb *top, VerilatorSimCtrl *simctrl);
 
   void OnClock(unsigned long sim_time);
 
  private:
   prim_sync_reqack_tb *top_;
+  VerilatorSimCtrl *simctrl_;
 };
 
 // Constructor:
-// - Set up top_ ptr
-PrimSyncReqAckTB::PrimSyncReqAckTB(prim_sync_reqack_tb *top)
-    : SimCtrlExtension{}, top_(top) {}
+// - Set up top_ and simctrl_ ptrs
+PrimSyncReqAckTB::PrimSyncReqAckTB(prim_sync_reqack_tb *top,
+                                   VerilatorSimCtrl *simctrl)
+    : SimCtrlExtension{}, top_(top), simctrl_(simctrl) {}
 
 // Function called once every clock cycle from SimCtrl
 void PrimSyncReqAckTB::OnClock(unsigned long sim_time) {
   if (top_->test_done_o) {
-    VerilatorSimCtrl::GetInstance().RequestStop(top_->test_passed_o);
+    simctrl_->RequestStop(top_->test_passed_o);
   }
 }
 
@@ -42,12 +44,11 @@ int main(int argc, char **argv) {
   prim_sync_reqack_tb top;
 
   // Init sim
-  VerilatorSimCtrl &simctrl = VerilatorSimCtrl::GetInstance();
-  simctrl.SetTop(&top, &top.clk_i, &top.rst_ni,
-                 VerilatorSimCtrlFlags::ResetPolarityNegative);
+  VerilatorSimCtrl simctrl(&top, &top.clk_i, &top.rst_ni,
+                           VerilatorSimCtrlFlags::ResetPolarityNegative);
 
   // Create and register VerilatorSimCtrl extension
-  PrimSyncReqAckTB primsyncreqacktb(&top);
+  PrimSyncReqAckTB primsyncreqacktb(&top, &simctrl);
   simctrl.RegisterExtension(&primsyncreqacktb);
 
   std::cout << "Simulation of REQ/ACK Synchronizer primitive" << std::endl
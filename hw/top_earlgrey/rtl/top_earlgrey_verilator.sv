@@ -278,6 +278,35 @@ module top_earlgrey_verilator (
     end
   end
 
+  // PC sampling profiler for Ibex (enabled with --ibex-pc-samples, see
+  // hw/dv/verilator/ibex_pc_sampler). This needs the RVFI port: without it, the
+  // sampler never sees an instruction retire.
+`ifdef RVFI
+  ibex_pc_sampler u_ibex_pc_sampler (
+    .clk_i         (`RV_CORE_IBEX.clk_i),
+    .rst_ni        (`RV_CORE_IBEX.rst_ni),
+    .rvfi_valid    (`RV_CORE_IBEX.rvfi_valid),
+    .rvfi_insn     (`RV_CORE_IBEX.rvfi_insn),
+    .rvfi_intr     (`RV_CORE_IBEX.rvfi_intr),
+    .rvfi_rs1_addr (`RV_CORE_IBEX.rvfi_rs1_addr),
+    .rvfi_rd_addr  (`RV_CORE_IBEX.rvfi_rd_addr),
+    .rvfi_pc_rdata (`RV_CORE_IBEX.rvfi_pc_rdata),
+    .rvfi_pc_wdata (`RV_CORE_IBEX.rvfi_pc_wdata)
+  );
+`else
+  ibex_pc_sampler u_ibex_pc_sampler (
+    .clk_i,
+    .rst_ni,
+    .rvfi_valid    (1'b0),
+    .rvfi_insn     ('0),
+    .rvfi_intr     (1'b0),
+    .rvfi_rs1_addr ('0),
+    .rvfi_rd_addr  ('0),
+    .rvfi_pc_rdata ('0),
+    .rvfi_pc_wdata ('0)
+  );
+`endif
+
   `undef RV_CORE_IBEX
   `undef SIM_SRAM_IF
 
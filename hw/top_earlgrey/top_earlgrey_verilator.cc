@@ -4,6 +4,7 @@
 
 #include <iostream>
 
+#include "ibex_pc_sampler.h"
 #include "verilated_toplevel.h"
 #include "verilator_memutil.h"
 #include "verilator_sim_ctrl.h"
@@ -11,9 +12,8 @@
 int main(int argc, char **argv) {
   top_earlgrey_verilator top;
   VerilatorMemUtil memutil;
-  VerilatorSimCtrl &simctrl = VerilatorSimCtrl::GetInstance();
-  simctrl.SetTop(&top, &top.clk_i, &top.rst_ni,
-                 VerilatorSimCtrlFlags::ResetPolarityNegative);
+  VerilatorSimCtrl simctrl(&top, &top.clk_i, &top.rst_ni,
+                           VerilatorSimCtrlFlags::ResetPolarityNegative);
 
   memutil.RegisterMemoryArea(
       "rom",
@@ -31,6 +31,10 @@ int main(int argc, char **argv) {
        "generic.u_impl_generic"),
       64, nullptr);
   simctrl.RegisterExtension(&memutil);
+
+  IbexPcSampler pc_sampler(memutil.GetUnderlying(),
+                           "TOP.top_earlgrey_verilator.u_ibex_pc_sampler");
+  simctrl.RegisterExtension(&pc_sampler);
   simctrl.SetInitialResetDelay(100);
 
   std::cout << "Simulation of OpenTitan Earl Grey" << std::endl
@@ -11,9 +11,8 @@
 int main(int argc, char **argv) {
   top_englishbreakfast_verilator top;
   VerilatorMemUtil memutil;
-  VerilatorSimCtrl &simctrl = VerilatorSimCtrl::GetInstance();
-  simctrl.SetTop(&top, &top.clk_i, &top.rst_ni,
-                 VerilatorSimCtrlFlags::ResetPolarityNegative);
+  VerilatorSimCtrl simctrl(&top, &top.clk_i, &top.rst_ni,
+                           VerilatorSimCtrlFlags::ResetPolarityNegative);
 
   memutil.RegisterMemoryArea("rom",
                              "TOP.top_englishbreakfast_verilator.top_"
@@ -5,10 +5,15 @@
 
 #include "flash_ctrl_regs.h"  // Generated.
 #include "hw/top_earlgrey/sw/autogen/top_earlgrey.h"
+#include "sw/device/lib/irq.h"
 
 #define FLASH_CTRL0_BASE_ADDR TOP_EARLGREY_FLASH_CTRL_BASE_ADDR
 #define PROGRAM_RESOLUTION_WORDS \
   (FLASH_CTRL_PARAM_REGBUSPGMRESBYTES / sizeof(uint32_t))
+// Depth of the program and read FIFOs, see `FifoDepth` in flash_ctrl_pkg.sv.
+#define FIFO_DEPTH_WORDS 16
+// Program FIFO level at which the queue is refilled.
+#define QUEUE_PROG_LVL 4
 
 #define REG32(add) *((volatile uint32_t *)(add))
 #define SETBIT(val, bit) (val | 1 << bit)
@@ -157,9 +162,19 @@ int flash_read(uint32_t addr, part_type_t part, uint32_t size, uint32_t *data) {
       (size - 1) << FLASH_CTRL_CONTROL_NUM_OFFSET |
       0x1 << FLASH_CTRL_CONTROL_START_BIT;
   for (uint32_t i = 0; i < size;) {
-    if (((REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_STATUS_REG_OFFSET) >>
-          FLASH_CTRL_STATUS_RD_EMPTY_BIT) &
-         0x1) == 0) {
+    uint32_t status =
+        REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_STATUS_REG_OFFSET);
+    if ((status >> FLASH_CTRL_STATUS_RD_FULL_BIT) & 0x1) {
+      // A full FIFO can be drained without checking status for every word.
+      uint32_t burst = size - i;
+      if (burst > FIFO_DEPTH_WORDS) {
+        burst = FIFO_DEPTH_WORDS;
+      }
+      for (uint32_t j = 0; j < burst; ++j) {
+        *data++ = REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_RD_FIFO_REG_OFFSET);
+      }
+      i += burst;
+    } else if (((status >> FLASH_CTRL_STATUS_RD_EMPTY_BIT) & 0x1) == 0) {
       *data++ = REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_RD_FIFO_REG_OFFSET);
       i++;
     }
@@ -168,6 +183,249 @@ int flash_read(uint32_t addr, part_type_t part, uint32_t size, uint32_t *data) {
   return get_clr_err();
 }
 
+void flash_read_mapped(uint32_t addr, uint32_t size, uint32_t *data) {
+  const volatile uint32_t *p = (const volatile uint32_t *)addr;
+  for (; size >= 8; size -= 8) {
+    uint32_t w0 = p[0];
+    uint32_t w1 = p[1];
+    uint32_t w2 = p[2];
+    uint32_t w3 = p[3];
+    uint32_t w4 = p[4];
+    uint32_t w5 = p[5];
+    uint32_t w6 = p[6];
+    uint32_t w7 = p[7];
+    data[0] = w0;
+    data[1] = w1;
+    data[2] = w2;
+    data[3] = w3;
+    data[4] = w4;
+    data[5] = w5;
+    data[6] = w6;
+    data[7] = w7;
+    p += 8;
+    data += 8;
+  }
+  while (size-- > 0) {
+    *data++ = *p++;
+  }
+}
+
+typedef struct flash_queue_op {
+  flash_op_t op;
+  uint32_t addr;
+  part_type_t part;
+  const uint32_t *data;
+  uint32_t size;
+} flash_queue_op_t;
+
+/* Operations waiting to be issued; `ops[head]` is the one in flight. */
+static struct {
+  flash_queue_op_t ops[FLASH_QUEUE_DEPTH];
+  uint32_t head;
+  uint32_t count;
+  /* True while an operation has been started and not yet acknowledged. */
+  bool busy;
+  /* Words of the current program window not yet pushed into the FIFO. */
+  const uint32_t *pending_data;
+  uint32_t pending_words;
+  /* Words of the current program operation already covered by a window. */
+  uint32_t op_words_done;
+  uint32_t err;
+  /* True if `flash_queue_service()` is called from the IRQ handler. */
+  bool irq_en;
+} volatile queue;
+
+static void queue_prog_fifo_push(uint32_t max_words) {
+  uint32_t words = queue.pending_words;
+  if (words > max_words) {
+    words = max_words;
+  }
+  const uint32_t *data = queue.pending_data;
+  for (uint32_t i = 0; i < words; ++i) {
+    REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_PROG_FIFO_REG_OFFSET) = data[i];
+  }
+  queue.pending_data = data + words;
+  queue.pending_words -= words;
+}
+
+/* Start the next program window or erase of the operation at the head. */
+static void queue_issue(void) {
+  const volatile flash_queue_op_t *op = &queue.ops[queue.head];
+  if (op->op == FLASH_ERASE) {
+    REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_ADDR_REG_OFFSET) = op->addr;
+    REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_CONTROL_REG_OFFSET) =
+        FLASH_ERASE << FLASH_CTRL_CONTROL_OP_OFFSET |
+        FLASH_PAGE_ERASE << FLASH_CTRL_CONTROL_ERASE_SEL_BIT |
+        op->part << FLASH_CTRL_CONTROL_PARTITION_SEL_BIT |
+        0x1 << FLASH_CTRL_CONTROL_START_BIT;
+    queue.busy = true;
+    return;
+  }
+
+  uint32_t addr = op->addr + queue.op_words_done * sizeof(uint32_t);
+  uint32_t words = PROGRAM_RESOLUTION_WORDS -
+                   (addr / sizeof(uint32_t)) % PROGRAM_RESOLUTION_WORDS;
+  if (words > op->size - queue.op_words_done) {
+    words = op->size - queue.op_words_done;
+  }
+  REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_ADDR_REG_OFFSET) = addr;
+  REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_CONTROL_REG_OFFSET) =
+      (FLASH_PROG << FLASH_CTRL_CONTROL_OP_OFFSET |
+       op->part << FLASH_CTRL_CONTROL_PARTITION_SEL_BIT |
+       (words - 1) << FLASH_CTRL_CONTROL_NUM_OFFSET |
+       0x1 << FLASH_CTRL_CONTROL_START_BIT);
+  queue.pending_data = op->data + queue.op_words_done;
+  queue.pending_words = words;
+  queue.op_words_done += words;
+  queue.busy = true;
+  queue_prog_fifo_push(FIFO_DEPTH_WORDS);
+  // Filling the FIFO may have passed the watermark on the way up; only a drain
+  // back to the watermark should trigger a refill.
+  REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_INTR_STATE_REG_OFFSET) =
+      0x1 << FLASH_CTRL_INTR_STATE_PROG_LVL_BIT;
+}
+
+static int queue_push(const flash_queue_op_t *op) {
+  // The queue is shared with `flash_queue_service()` in the IRQ handler.
+  bool irq_en = irq_global_disable();
+  int ret = -1;
+  if (queue.count < FLASH_QUEUE_DEPTH) {
+    queue.ops[(queue.head + queue.count) % FLASH_QUEUE_DEPTH] = *op;
+    ++queue.count;
+    if (!queue.busy) {
+      queue.op_words_done = 0;
+      queue_issue();
+    }
+    ret = 0;
+  }
+  irq_global_ctrl(irq_en);
+  return ret;
+}
+
+void flash_queue_irq_ctrl(bool en) {
+  uint32_t fifo_lvl =
+      REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_FIFO_LVL_REG_OFFSET);
+  fifo_lvl &=
+      ~(FLASH_CTRL_FIFO_LVL_PROG_MASK << FLASH_CTRL_FIFO_LVL_PROG_OFFSET);
+  fifo_lvl |= QUEUE_PROG_LVL << FLASH_CTRL_FIFO_LVL_PROG_OFFSET;
+  REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_FIFO_LVL_REG_OFFSET) = fifo_lvl;
+
+  uint32_t irqs = 0x1 << FLASH_CTRL_INTR_ENABLE_PROG_EMPTY_BIT |
+                  0x1 << FLASH_CTRL_INTR_ENABLE_PROG_LVL_BIT |
+                  0x1 << FLASH_CTRL_INTR_ENABLE_OP_DONE_BIT |
+                  0x1 << FLASH_CTRL_INTR_ENABLE_OP_ERROR_BIT;
+  if (en) {
+    // Drop events from before the queue took over, so that they don't fire as
+    // soon as they are enabled.
+    REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_INTR_STATE_REG_OFFSET) = irqs;
+  }
+  uint32_t enable =
+      REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_INTR_ENABLE_REG_OFFSET);
+  REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_INTR_ENABLE_REG_OFFSET) =
+      en ? (enable | irqs) : (enable & ~irqs);
+  queue.irq_en = en;
+}
+
+int flash_queue_write(uint32_t addr, part_type_t part, const uint32_t *data,
+                      uint32_t size) {
+  if (size == 0) {
+    return 0;
+  }
+  return queue_push(&(flash_queue_op_t){
+      .op = FLASH_PROG,
+      .addr = addr,
+      .part = part,
+      .data = data,
+      .size = size,
+  });
+}
+
+int flash_queue_page_erase(uint32_t addr, part_type_t part) {
+  return queue_push(&(flash_queue_op_t){
+      .op = FLASH_ERASE,
+      .addr = addr,
+      .part = part,
+  });
+}
+
+/* Body of `flash_queue_service()`, called with interrupts masked. */
+static void queue_service(void) {
+  if (!queue.busy) {
+    // Nothing is in flight, so there is nothing to refill or retire; just
+    // acknowledge whatever fired.
+    REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_INTR_STATE_REG_OFFSET) =
+        0x1 << FLASH_CTRL_INTR_STATE_PROG_EMPTY_BIT |
+        0x1 << FLASH_CTRL_INTR_STATE_PROG_LVL_BIT |
+        0x1 << FLASH_CTRL_INTR_STATE_OP_DONE_BIT;
+    queue.err |= get_clr_err();
+    return;
+  }
+
+  uint32_t fifo_irqs =
+      REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_INTR_STATE_REG_OFFSET) &
+      (0x1 << FLASH_CTRL_INTR_STATE_PROG_LVL_BIT |
+       0x1 << FLASH_CTRL_INTR_STATE_PROG_EMPTY_BIT);
+  if (queue.pending_words > 0) {
+    if ((REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_STATUS_REG_OFFSET) >>
+         FLASH_CTRL_STATUS_PROG_EMPTY_BIT) &
+        0x1) {
+      queue_prog_fifo_push(FIFO_DEPTH_WORDS);
+    } else if (fifo_irqs & (0x1 << FLASH_CTRL_INTR_STATE_PROG_LVL_BIT)) {
+      uint32_t prog_lvl =
+          (REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_FIFO_LVL_REG_OFFSET) >>
+           FLASH_CTRL_FIFO_LVL_PROG_OFFSET) &
+          FLASH_CTRL_FIFO_LVL_PROG_MASK;
+      if (prog_lvl < FIFO_DEPTH_WORDS) {
+        queue_prog_fifo_push(FIFO_DEPTH_WORDS - prog_lvl);
+      }
+    }
+  }
+  // Acknowledge after refilling, so that passing the watermark on the way up
+  // is not mistaken for a drain.
+  REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_INTR_STATE_REG_OFFSET) = fifo_irqs;
+
+  if ((REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_OP_STATUS_REG_OFFSET) &
+       (1 << FLASH_CTRL_OP_STATUS_DONE_BIT)) == 0) {
+    return;
+  }
+  REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_OP_STATUS_REG_OFFSET) = 0;
+  REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_INTR_STATE_REG_OFFSET) =
+      0x1 << FLASH_CTRL_INTR_STATE_OP_DONE_BIT;
+  queue.err |= get_clr_err();
+  queue.busy = false;
+
+  const volatile flash_queue_op_t *op = &queue.ops[queue.head];
+  if (op->op == FLASH_ERASE || queue.op_words_done == op->size) {
+    queue.head = (queue.head + 1) % FLASH_QUEUE_DEPTH;
+    --queue.count;
+    queue.op_words_done = 0;
+  }
+  if (queue.count > 0) {
+    queue_issue();
+  }
+}
+
+void flash_queue_service(void) {
+  bool irq_en = irq_global_disable();
+  queue_service();
+  irq_global_ctrl(irq_en);
+}
+
+bool flash_queue_idle(void) { return queue.count == 0; }
+
+int flash_queue_wait(void) {
+  while (!flash_queue_idle()) {
+    if (!queue.irq_en) {
+      flash_queue_service();
+    }
+  }
+  bool irq_en = irq_global_disable();
+  int err = queue.err;
+  queue.err = 0;
+  irq_global_ctrl(irq_en);
+  return err;
+}
+
 void flash_cfg_bank_erase(bank_index_t bank, bool erase_en) {
   REG32(FLASH_CTRL0_BASE_ADDR + FLASH_CTRL_MP_BANK_CFG_REG_OFFSET) =
       (erase_en) ? SETBIT(REG32(FLASH_CTRL0_BASE_ADDR +
@@ -91,6 +91,86 @@ int flash_write(uint32_t addr, part_type_t part, const uint32_t *data,
  */
 int flash_read(uint32_t addr, part_type_t part, uint32_t size, uint32_t *data);
 
+/**
+ * Read `size` 4B words through the memory-mapped flash window and write result
+ * to `data`.
+ *
+ * Unlike `flash_read()`, this does not go through the controller read FIFO and
+ * is only able to access the data partition. Words are read in bursts of eight
+ * to keep the bus busy. Memory protection violations are reported as load
+ * access faults rather than through the return value.
+ *
+ * @param addr Read start address, 32bit aligned.
+ * @param size Number of 4B words to read.
+ * @param[out] data Output buffer.
+ */
+void flash_read_mapped(uint32_t addr, uint32_t size, uint32_t *data);
+
+/**
+ * Maximum number of operations that can be pending in the flash queue.
+ */
+#define FLASH_QUEUE_DEPTH 8
+
+/**
+ * Enable / disable interrupt driven servicing of the flash queue.
+ *
+ * When enabled, the program FIFO watermark, operation done and operation error
+ * interrupts are enabled at the flash controller, and the platform external
+ * IRQ handler is expected to call `flash_queue_service()` for any of them.
+ * When disabled, `flash_queue_wait()` services the queue by polling.
+ *
+ * @param en Interrupt enable.
+ */
+void flash_queue_irq_ctrl(bool en);
+
+/**
+ * Queue a program of `size` 4B words from `data` at `addr`.
+ *
+ * The operation is split into program windows exactly like `flash_write()`,
+ * but returns as soon as the operation is queued. The next window is started
+ * from `flash_queue_service()` as soon as the previous one completes, so the
+ * CPU is free while the flash is being programmed. `data` must remain valid
+ * until the queue drains.
+ *
+ * @param addr Flash address 32bit aligned.
+ * @param part Flash parittion to access.
+ * @param data Data to write.
+ * @param size Number of 4B words to write from `data` buffer.
+ * @return Non zero if the queue is full.
+ */
+int flash_queue_write(uint32_t addr, part_type_t part, const uint32_t *data,
+                      uint32_t size);
+
+/**
+ * Queue an erase of the page containing `addr`.
+ *
+ * @param addr Address within the page to erase.
+ * @param part Flash parittion to access.
+ * @return Non zero if the queue is full.
+ */
+int flash_queue_page_erase(uint32_t addr, part_type_t part);
+
+/**
+ * Advance the flash queue.
+ *
+ * Refills the program FIFO, acknowledges completed operations and starts the
+ * next queued one. Safe to call at any time; it is a no-op when there is
+ * nothing to do.
+ */
+void flash_queue_service(void);
+
+/**
+ * Returns true if no queued operation is in flight or pending.
+ */
+bool flash_queue_idle(void);
+
+/**
+ * Block until the flash queue drains.
+ *
+ * @return Non zero if any operation completed since the last call failed.
+ */
+int flash_queue_wait(void);
+
 /**
  * Configure bank erase enable
  */
@@ -30,6 +30,12 @@ void irq_global_ctrl(bool en) {
   }
 }
 
+bool irq_global_disable(void) {
+  uint32_t mstatus;
+  asm volatile("csrrci %0, mstatus, 0x8" : "=r"(mstatus) : :);
+  return (mstatus & 0x8) != 0;
+}
+
 void irq_external_ctrl(bool en) {
   const uint32_t value = 1 << IRQ_EXT_ENABLE_OFFSET;
   if (en) {
@@ -20,6 +20,13 @@ void irq_set_vector_offset(uintptr_t address);
  */
 void irq_global_ctrl(bool en);
 
+/**
+ * Disable ibex global interrupts, returning whether they were enabled
+ *
+ * Pass the result to `irq_global_ctrl()` to end the critical section.
+ */
+bool irq_global_disable(void);
+
 /**
  * Enable / disable ibex external interrupts
  */
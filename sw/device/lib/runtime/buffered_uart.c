@@ -0,0 +1,184 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "sw/device/lib/runtime/buffered_uart.h"
+
+#include "sw/device/lib/base/memory.h"
+#include "sw/device/lib/irq.h"
+#include "sw/device/lib/runtime/log.h"
+
+// The ring is shared with the TX watermark handler, so every access outside of
+// it happens with interrupts masked, between `irq_global_disable()` and
+// `irq_global_ctrl()`.
+
+/**
+ * Moves bytes from the ring into the UART, up to ring index `end` or until the
+ * TX FIFO is full, whichever comes first.
+ */
+static void ring_drain(buffered_uart_t *bu, size_t end) {
+  while (end != bu->tail) {
+    size_t start = bu->tail & (bu->size - 1);
+    size_t len = end - bu->tail;
+    if (len > bu->size - start) {
+      len = bu->size - start;
+    }
+    size_t written = 0;
+    if (dif_uart_bytes_send(bu->uart, (const uint8_t *)bu->buf + start, len,
+                            &written) != kDifUartOk) {
+      break;
+    }
+    bu->tail += written;
+    if (written < len) {
+      // TX FIFO is full.
+      break;
+    }
+  }
+}
+
+/**
+ * Copies `len` bytes into the ring, which must have room for them.
+ */
+static void ring_push(buffered_uart_t *bu, const char *buf, size_t len) {
+  size_t start = bu->head & (bu->size - 1);
+  size_t first = bu->size - start;
+  if (first > len) {
+    first = len;
+  }
+  memcpy(bu->buf + start, buf, first);
+  memcpy(bu->buf, buf + first, len - first);
+  bu->head += len;
+}
+
+static size_t buffered_uart_sink_write(void *data, const char *buf,
+                                       size_t len) {
+  buffered_uart_t *bu = (buffered_uart_t *)data;
+  bool irq_en = irq_global_disable();
+
+  // If the ring was empty, nothing is queued in the TX FIFO that would raise a
+  // watermark interrupt, so the FIFO needs to be primed from here. Otherwise
+  // the previous drain stopped on a full FIFO, and the interrupt will follow.
+  bool was_empty = bu->head == bu->tail;
+
+  size_t written = 0;
+  while (written < len) {
+    size_t room = bu->size - (bu->head - bu->tail);
+    size_t chunk = len - written;
+    if (chunk > room) {
+      switch (bu->overflow) {
+        case kBufferedUartOverflowBlock:
+          if (room == 0) {
+            ring_drain(bu, bu->head);
+            continue;
+          }
+          chunk = room;
+          break;
+        case kBufferedUartOverflowDrop:
+          bu->dropped += chunk - room;
+          len = written + room;
+          chunk = room;
+          break;
+        case kBufferedUartOverflowDropOldest: {
+          size_t evict = chunk - room;
+          if (chunk > bu->size) {
+            // Only the tail end of this write can survive.
+            bu->dropped += chunk - bu->size;
+            written += chunk - bu->size;
+            chunk = bu->size;
+            evict = bu->head - bu->tail;
+          }
+          bu->tail += evict;
+          bu->dropped += evict;
+          break;
+        }
+      }
+    }
+    ring_push(bu, buf + written, chunk);
+    written += chunk;
+  }
+
+  if (was_empty) {
+    ring_drain(bu, bu->head);
+  }
+
+  irq_global_ctrl(irq_en);
+  return written;
+}
+
+bool buffered_uart_init(const dif_uart_t *uart, char *buf, size_t len,
+                        buffered_uart_overflow_t overflow,
+                        buffered_uart_t *buffered_uart) {
+  if (uart == NULL || buf == NULL || buffered_uart == NULL || len == 0 ||
+      (len & (len - 1)) != 0) {
+    return false;
+  }
+
+  *buffered_uart = (buffered_uart_t){
+      .uart = uart,
+      .buf = buf,
+      .size = len,
+      .head = 0,
+      .tail = 0,
+      .overflow = overflow,
+      .dropped = 0,
+  };
+
+  // Refill once the FIFO is half empty, which leaves the rest of the FIFO as
+  // slack for interrupt latency.
+  if (dif_uart_watermark_tx_set(uart, kDifUartWatermarkByte16) != kDifUartOk) {
+    return false;
+  }
+  return dif_uart_irq_set_enabled(uart, kDifUartIrqTxWatermark,
+                                  kDifUartToggleEnabled) == kDifUartOk;
+}
+
+buffer_sink_t buffered_uart_sink(buffered_uart_t *buffered_uart) {
+  return (buffer_sink_t){
+      .data = buffered_uart, .sink = &buffered_uart_sink_write,
+  };
+}
+
+static void buffered_uart_flush_hook(void *data) {
+  buffered_uart_flush((buffered_uart_t *)data);
+}
+
+void buffered_uart_stdout(buffered_uart_t *buffered_uart) {
+  base_set_stdout(buffered_uart_sink(buffered_uart));
+  base_log_set_flush_hook(&buffered_uart_flush_hook, buffered_uart);
+}
+
+void buffered_uart_irq_service(buffered_uart_t *buffered_uart) {
+  // Acknowledge first: if the FIFO drains below the watermark again while
+  // refilling, that edge must not be lost.
+  // Note that, due to a GCC bug, we cannot use the standard `(void) expr`
+  // syntax to drop this value on the ground.
+  // See https://gcc.gnu.org/bugzilla/show_bug.cgi?id=25509
+  if (dif_uart_irq_acknowledge(buffered_uart->uart, kDifUartIrqTxWatermark)) {
+  }
+  ring_drain(buffered_uart, buffered_uart->head);
+}
+
+void buffered_uart_flush(buffered_uart_t *buffered_uart) {
+  bool irq_en = irq_global_disable();
+
+  // Send all but the last byte through the FIFO, and the last one polled,
+  // which waits for the UART to go idle.
+  while (buffered_uart->head - buffered_uart->tail > 1) {
+    ring_drain(buffered_uart, buffered_uart->head - 1);
+  }
+  if (buffered_uart->head != buffered_uart->tail) {
+    char last = buffered_uart->buf[buffered_uart->tail &
+                                   (buffered_uart->size - 1)];
+    ++buffered_uart->tail;
+    if (dif_uart_byte_send_polled(buffered_uart->uart, (uint8_t)last)) {
+    }
+  } else {
+    size_t available = 0;
+    while (dif_uart_tx_bytes_available(buffered_uart->uart, &available) ==
+               kDifUartOk &&
+           available < kDifUartFifoSizeBytes) {
+    }
+  }
+
+  irq_global_ctrl(irq_en);
+}
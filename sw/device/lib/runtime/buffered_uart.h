@@ -0,0 +1,129 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef OPENTITAN_SW_DEVICE_LIB_RUNTIME_BUFFERED_UART_H_
+#define OPENTITAN_SW_DEVICE_LIB_RUNTIME_BUFFERED_UART_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sw/device/lib/dif/dif_uart.h"
+#include "sw/device/lib/runtime/print.h"
+
+/**
+ * @file
+ * @brief Interrupt-driven, RAM-buffered UART output.
+ *
+ * `base_uart_stdout()` writes every byte with `dif_uart_byte_send_polled()`,
+ * which stalls the CPU for the full serialization time of each byte. The sink
+ * provided here instead copies bytes into a RAM ring buffer, and the ring is
+ * drained into the UART TX FIFO from the TX watermark interrupt.
+ *
+ * The interrupt is routed by the application: its external IRQ handler must
+ * call `buffered_uart_irq_service()` when the UART TX watermark interrupt is
+ * claimed at the PLIC.
+ */
+
+/**
+ * What to do when the ring buffer is full.
+ */
+typedef enum buffered_uart_overflow {
+  /**
+   * Spin, draining the ring into the UART by polling, until there is room.
+   * No output is lost.
+   */
+  kBufferedUartOverflowBlock = 0,
+  /**
+   * Discard the bytes that do not fit.
+   */
+  kBufferedUartOverflowDrop,
+  /**
+   * Discard the oldest buffered bytes to make room for the new ones.
+   */
+  kBufferedUartOverflowDropOldest,
+} buffered_uart_overflow_t;
+
+/**
+ * State of a buffered UART.
+ *
+ * Fields are implementation details; use the functions below.
+ */
+typedef struct buffered_uart {
+  const dif_uart_t *uart;
+  char *buf;
+  /**
+   * Size of `buf`; always a power of two.
+   */
+  size_t size;
+  /**
+   * Free-running producer and consumer indices into `buf`.
+   */
+  volatile size_t head;
+  volatile size_t tail;
+  buffered_uart_overflow_t overflow;
+  /**
+   * Number of bytes discarded due to overflow.
+   */
+  volatile uint32_t dropped;
+} buffered_uart_t;
+
+/**
+ * Initializes a buffered UART.
+ *
+ * `uart` must already be configured. This sets its TX watermark and enables
+ * the TX watermark interrupt; routing the interrupt through the PLIC is left to
+ * the caller.
+ *
+ * @param uart A configured UART handle, with static storage duration.
+ * @param buf Backing storage for the ring, with static storage duration.
+ * @param len Size of `buf`, in bytes; must be a power of two.
+ * @param overflow Policy to apply when `buf` is full.
+ * @param[out] buffered_uart Out param for the initialized state.
+ * @return Whether the parameters were valid and the UART was configured.
+ */
+bool buffered_uart_init(const dif_uart_t *uart, char *buf, size_t len,
+                        buffered_uart_overflow_t overflow,
+                        buffered_uart_t *buffered_uart);
+
+/**
+ * Returns a sink writing to `buffered_uart`.
+ *
+ * @param buffered_uart An initialized buffered UART.
+ * @return A sink that buffers its input.
+ */
+buffer_sink_t buffered_uart_sink(buffered_uart_t *buffered_uart);
+
+/**
+ * Configures `buffered_uart` as stdout for `print.h`, and registers
+ * `buffered_uart_flush()` as the log flush hook, so that `LOG_FATAL` and test
+ * completion drain pending output.
+ *
+ * @param buffered_uart An initialized buffered UART, with static storage
+ *        duration.
+ */
+void buffered_uart_stdout(buffered_uart_t *buffered_uart);
+
+/**
+ * Refills the UART TX FIFO from the ring.
+ *
+ * Must be called from the external IRQ handler when the UART TX watermark
+ * interrupt is claimed. Acknowledges the interrupt at the UART; completing it
+ * at the PLIC is left to the caller.
+ *
+ * @param buffered_uart An initialized buffered UART.
+ */
+void buffered_uart_irq_service(buffered_uart_t *buffered_uart);
+
+/**
+ * Drains the ring by polling, and waits for the UART to finish sending it.
+ *
+ * This does not rely on interrupts, and is safe to call with interrupts
+ * globally disabled, e.g. on the way to `abort()`.
+ *
+ * @param buffered_uart An initialized buffered UART.
+ */
+void buffered_uart_flush(buffered_uart_t *buffered_uart);
+
+#endif  // OPENTITAN_SW_DEVICE_LIB_RUNTIME_BUFFERED_UART_H_
@@ -36,6 +36,24 @@ static const char *stringify_severity(log_severity_t severity) {
   }
 }
 
+log_mode_t base_log_mode = kLogModeText;
+
+void base_log_set_mode(log_mode_t mode) { base_log_mode = mode; }
+
+static void (*log_flush_hook)(void *data) = NULL;
+static void *log_flush_hook_data = NULL;
+
+void base_log_set_flush_hook(void (*flush)(void *data), void *data) {
+  log_flush_hook = flush;
+  log_flush_hook_data = data;
+}
+
+void base_log_flush(void) {
+  if (log_flush_hook != NULL) {
+    log_flush_hook(log_flush_hook_data);
+  }
+}
+
 /**
  * Logs `log` and the values that follow to stdout.
  *
@@ -67,6 +85,10 @@ void base_log_internal_core(log_fields_t log, ...) {
   va_end(args);
 
   base_printf("\r\n");
+
+  if (log.severity == kLogSeverityFatal) {
+    base_log_flush();
+  }
 }
 
 /**
@@ -90,3 +112,66 @@ void base_log_internal_dv(const log_fields_t *log, uint32_t nargs, ...) {
   }
   va_end(args);
 }
+
+/**
+ * Start of the `.logs.fields` section, defined by the linker script.
+ */
+extern const char _dv_log_offset[];
+
+/**
+ * Appends `value` to `buf` as an unsigned LEB128 varint.
+ *
+ * @param buf the buffer to write to, with room for at least 5 bytes.
+ * @param value the value to encode.
+ * @return the number of bytes written.
+ */
+static size_t write_varint(uint8_t *buf, uint32_t value) {
+  size_t len = 0;
+  while (value >= 0x80) {
+    buf[len++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  buf[len++] = (uint8_t)value;
+  return len;
+}
+
+/**
+ * Logs `log` and the values that follow to stdout as a binary record, which
+ * avoids any string formatting on the device.
+ *
+ * See `kLogModeTokenized` for the record layout.
+ *
+ * @param severity the severity of the log, which is also part of `log`.
+ * @param log a pointer to log data to log. Like in DV mode, the pointed-to
+ *        data is not present at runtime; only its address is used.
+ * @param nargs the number of arguments passed to the format string.
+ * @param ... format parameters matching the format string.
+ */
+void base_log_internal_tokenized(log_severity_t severity,
+                                 const log_fields_t *log, uint32_t nargs,
+                                 ...) {
+  // Large enough for the marker, the log ID and a handful of arguments; longer
+  // records are sent in several chunks.
+  uint8_t record[32];
+  size_t len = 0;
+  record[len++] = LOG_TOKENIZED_MARKER;
+  len += write_varint(record + len,
+                      (uintptr_t)log - (uintptr_t)_dv_log_offset);
+
+  va_list args;
+  va_start(args, nargs);
+  for (int i = 0; i < nargs; ++i) {
+    if (len > sizeof(record) - 5) {
+      base_printf("%z", len, (const char *)record);
+      len = 0;
+    }
+    len += write_varint(record + len, va_arg(args, uint32_t));
+  }
+  va_end(args);
+
+  base_printf("%z", len, (const char *)record);
+
+  if (severity == kLogSeverityFatal) {
+    base_log_flush();
+  }
+}
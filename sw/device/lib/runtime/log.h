@@ -35,6 +35,11 @@
  * devices, like Verilator, logs are printed using whatever `stdout` is set to
  * in print.h. DV testbenches may use an alternative, more efficient mechanism.
  *
+ * Core devices may also switch to tokenized logging with `base_log_set_mode()`,
+ * which writes compact binary records to `stdout` instead of formatted text.
+ * The records are decoded on the host against the ELF file by
+ * util/device_sw_utils/decode_sw_logs.py.
+ *
  * In DV mode, some format specifiers may be unsupported, such as %s.
  */
 
@@ -87,8 +92,68 @@ typedef struct log_fields {
   const char *format;
 } log_fields_t;
 
+/**
+ * Log output modes for core (non-DV) devices.
+ */
+typedef enum log_mode {
+  /**
+   * Format each log line on the device and print it to `stdout`.
+   */
+  kLogModeText = 0,
+  /**
+   * Print each log line to `stdout` as a binary record, consisting of a marker
+   * byte, the offset of its `log_fields_t` in the `.logs.fields` section, and
+   * its arguments, all as unsigned LEB128 varints.
+   *
+   * Like in DV mode, %s and %z arguments can only be decoded when they point to
+   * constant strings.
+   */
+  kLogModeTokenized = 1,
+} log_mode_t;
+
+/**
+ * Marker byte that starts a tokenized log record.
+ *
+ * This is outside of the ASCII range, so that records can be told apart from
+ * text printed by other means.
+ */
+#define LOG_TOKENIZED_MARKER 0xa5
+
+/**
+ * Sets the log output mode for core devices.
+ *
+ * This has no effect on DV testbenches, which always bypass the UART.
+ *
+ * @param mode the mode to use for subsequent log lines.
+ */
+void base_log_set_mode(log_mode_t mode);
+
+/**
+ * Sets a hook that drains any output buffered by the stdout sink.
+ *
+ * The hook is called after every `LOG_FATAL` line, and by `base_log_flush()`.
+ * Passing `NULL` removes the hook.
+ *
+ * @param flush the function to call, or `NULL`.
+ * @param data the argument to pass to `flush`.
+ */
+void base_log_set_flush_hook(void (*flush)(void *data), void *data);
+
+/**
+ * Drains any output buffered by the stdout sink, if a flush hook is set.
+ *
+ * This must be called before any action that stops execution, so that pending
+ * log lines are not lost.
+ */
+void base_log_flush(void);
+
 // Internal functions exposed only for access by macros. Their
 // real doxygen can be found in log.c.
+/**
+ * Implementation detail; use `base_log_set_mode()`.
+ */
+extern log_mode_t base_log_mode;
+
 /**
  * Implementation detail.
  */
@@ -97,6 +162,11 @@ void base_log_internal_core(log_fields_t log, ...);
  * Implementation detail.
  */
 void base_log_internal_dv(const log_fields_t *log, uint32_t nargs, ...);
+/**
+ * Implementation detail.
+ */
+void base_log_internal_tokenized(log_severity_t severity,
+                                 const log_fields_t *log, uint32_t nargs, ...);
 
 /**
  * Basic logging macro that all other logging macros delegate to.
@@ -108,25 +178,29 @@ void base_log_internal_dv(const log_fields_t *log, uint32_t nargs, ...);
  *               string literal.
  * @param ... format parameters matching the format string.
  */
-#define LOG(severity, format, ...)                               \
-  do {                                                           \
-    if (kDeviceLogBypassUartAddress != 0) {                      \
-      /* clang-format off */                                     \
-      /* Put DV-only log constants in .logs.* sections, which
-       * the linker will dutifully discard.
-       * Unfortunately, clang-format really mangles these
-       * declarations, so we format them manually. */            \
-      __attribute__((section(".logs.fields")))                   \
-      static const log_fields_t kLogFields =                     \
-          LOG_MAKE_FIELDS_(severity, format, ##__VA_ARGS__);     \
-      base_log_internal_dv(&kLogFields,                          \
+#define LOG(severity, format, ...)                                     \
+  do {                                                                 \
+    /* clang-format off */                                             \
+    /* Put log constants only referenced by address in .logs.*
+     * sections, which the linker will dutifully discard.
+     * Unfortunately, clang-format really mangles these
+     * declarations, so we format them manually. */                    \
+    __attribute__((section(".logs.fields")))                           \
+    static const log_fields_t kLogFields =                             \
+        LOG_MAKE_FIELDS_(severity, format, ##__VA_ARGS__);             \
+    if (kDeviceLogBypassUartAddress != 0) {                            \
+      base_log_internal_dv(&kLogFields,                                \
+                           GET_NUM_VARIABLE_ARGS(format, ##__VA_ARGS__), \
+                           ##__VA_ARGS__);                             \
+    } else if (base_log_mode == kLogModeTokenized) {                   \
+      base_log_internal_tokenized(severity, &kLogFields,               \
                            GET_NUM_VARIABLE_ARGS(format, ##__VA_ARGS__), \
-                           ##__VA_ARGS__); /* clang-format on */ \
-    } else {                                                     \
-      log_fields_t log_fields =                                  \
-          LOG_MAKE_FIELDS_(severity, format, ##__VA_ARGS__);     \
-      base_log_internal_core(log_fields, ##__VA_ARGS__);         \
-    }                                                            \
+                           ##__VA_ARGS__); /* clang-format on */       \
+    } else {                                                           \
+      log_fields_t log_fields =                                        \
+          LOG_MAKE_FIELDS_(severity, format, ##__VA_ARGS__);           \
+      base_log_internal_core(log_fields, ##__VA_ARGS__);               \
+    }                                                                  \
   } while (false)
 
 /**
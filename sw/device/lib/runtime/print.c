@@ -45,6 +45,19 @@ static const char kErrorNul[17] = "%<unexpected nul>";
 static const char kUnknownSpec[15] = "%<unknown spec>";
 static const char kErrorTooWide[12] = "%<bad width>";
 
+// Pairs of decimal digits, indexed by twice the value of the pair.
+static const char kDecimalPairs[200] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
 static size_t base_dev_null(void *data, const char *buf, size_t len) {
   return len;
 }
@@ -129,23 +142,69 @@ size_t base_fprintf(buffer_sink_t out, const char *format, ...) {
   return bytes_left;
 }
 
+/**
+ * Coalesces the fragments produced while formatting into as few calls to the
+ * underlying sink as possible.
+ *
+ * Sinks like the UART have a high per-call cost, so rather than calling the
+ * sink for every literal run and every converted number, fragments are
+ * collected here and passed on when the buffer fills up or formatting ends.
+ */
+typedef struct print_staging {
+  buffer_sink_t out;
+  /**
+   * Total number of bytes the sink reported as written.
+   */
+  size_t bytes_written;
+  size_t len;
+  char buf[64];
+} print_staging_t;
+
+/**
+ * Passes the contents of `staging` on to the sink.
+ */
+static void staging_flush(print_staging_t *staging) {
+  if (staging->len > 0) {
+    staging->bytes_written +=
+        staging->out.sink(staging->out.data, staging->buf, staging->len);
+    staging->len = 0;
+  }
+}
+
+/**
+ * Appends `len` bytes from `buf` to `staging`.
+ *
+ * Buffers that do not fit are passed on to the sink directly, after the
+ * already staged bytes.
+ */
+static void staging_write(print_staging_t *staging, const char *buf,
+                          size_t len) {
+  if (len > sizeof(staging->buf) - staging->len) {
+    staging_flush(staging);
+    if (len > sizeof(staging->buf)) {
+      staging->bytes_written += staging->out.sink(staging->out.data, buf, len);
+      return;
+    }
+  }
+  memcpy(staging->buf + staging->len, buf, len);
+  staging->len += len;
+}
+
 /**
  * Consumes characters from `format` until a '%' or NUL is reached. All
  * characters seen before that are then sinked into `out`.
  *
- * @param out the sink to write bytes to.
+ * @param out the staging buffer to write bytes to.
  * @param format a pointer to the format string to consume a prefix of.
- * @param[out] bytes_written out param for the number of bytes writen to `out`.
  * @return true if an unprocessed '%' was found.
  */
-static bool consume_until_percent(buffer_sink_t out, const char **format,
-                                  size_t *bytes_written) {
+static bool consume_until_percent(print_staging_t *out, const char **format) {
   size_t text_len = 0;
   while (true) {
     char c = (*format)[text_len];
     if (c == '\0' || c == kPercent) {
       if (text_len > 0) {
-        *bytes_written += out.sink(out.data, *format, text_len);
+        staging_write(out, *format, text_len);
       }
       *format += text_len;
       return c != '\0';
@@ -166,13 +225,12 @@ typedef struct format_specifier {
  * Consumes characters from `format` until a complete format specifier is
  * parsed. See the documentation in `print.h` for full syntax.
  *
- * @param out the sink to write bytes to.
+ * @param out the staging buffer to write bytes to.
  * @param format a pointer to the format string to consume a prefix of.
  * @param[out] spec out param for the specifier.
  * @return whether the parse succeeded.
  */
-static bool consume_format_specifier(buffer_sink_t out, const char **format,
-                                     size_t *bytes_written,
+static bool consume_format_specifier(print_staging_t *out, const char **format,
                                      format_specifier_t *spec) {
   *spec = (format_specifier_t){0};
 
@@ -187,7 +245,7 @@ static bool consume_format_specifier(buffer_sink_t out, const char **format,
   while (true) {
     char c = (*format)[spec_len];
     if (c == '\0') {
-      *bytes_written += out.sink(out.data, kErrorNul, sizeof(kErrorNul));
+      staging_write(out, kErrorNul, sizeof(kErrorNul));
       return false;
     }
     if (c < '0' || c > '9') {
@@ -200,7 +258,7 @@ static bool consume_format_specifier(buffer_sink_t out, const char **format,
   }
 
   if ((spec->width == 0 && has_width) || spec->width > 32) {
-    *bytes_written += out.sink(out.data, kErrorTooWide, sizeof(kErrorTooWide));
+    staging_write(out, kErrorTooWide, sizeof(kErrorTooWide));
     return false;
   }
 
@@ -212,28 +270,50 @@ static bool consume_format_specifier(buffer_sink_t out, const char **format,
 /**
  * Write the digits of `value` onto `out`.
  *
- * @param out the sink to write bytes to.
+ * Power-of-two bases are converted with shifts and masks, and base 10 two
+ * digits at a time from a lookup table, so that no division by a variable is
+ * needed; RV32IMC has no fast divider.
+ *
+ * @param out the staging buffer to write bytes to.
  * @param value the value to "stringify".
  * @param width the minimum width to print; going below will result in writing
  *        out zeroes.
- * @param base the base to express `value` in.
+ * @param base the base to express `value` in; one of 2, 8, 10 or 16.
  * @param glyphs an array of characters to use as the digits of a number, which
  *        should be at least ast long as `base`.
- * @return the number of bytes written.
  */
-static size_t write_digits(buffer_sink_t out, uint32_t value, uint32_t width,
-                           uint32_t base, const char *glyphs) {
+static void write_digits(print_staging_t *out, uint32_t value, uint32_t width,
+                         uint32_t base, const char *glyphs) {
   // All allocations are done relative to a buffer that could hold the longest
   // textual representation of a number: ~0x0 in base 2, i.e., 32 ones.
   static const int kWordBits = sizeof(uint32_t) * 8;
   char buffer[kWordBits];
 
   size_t len = 0;
-  while (value > 0) {
-    uint32_t digit = value % base;
-    value /= base;
-    buffer[kWordBits - 1 - len] = glyphs[digit];
-    ++len;
+  if (base == 10) {
+    while (value >= 100) {
+      uint32_t pair = (value % 100) * 2;
+      value /= 100;
+      buffer[kWordBits - 1 - len] = kDecimalPairs[pair + 1];
+      buffer[kWordBits - 2 - len] = kDecimalPairs[pair];
+      len += 2;
+    }
+    if (value >= 10) {
+      buffer[kWordBits - 1 - len] = kDecimalPairs[value * 2 + 1];
+      buffer[kWordBits - 2 - len] = kDecimalPairs[value * 2];
+      len += 2;
+    } else if (value > 0) {
+      buffer[kWordBits - 1 - len] = glyphs[value];
+      ++len;
+    }
+  } else {
+    uint32_t shift = base == 16 ? 4 : base == 8 ? 3 : 1;
+    uint32_t mask = base - 1;
+    while (value > 0) {
+      buffer[kWordBits - 1 - len] = glyphs[value & mask];
+      value >>= shift;
+      ++len;
+    }
   }
   width = width == 0 ? 1 : width;
   width = width > kWordBits ? kWordBits : width;
@@ -241,7 +321,7 @@ static size_t write_digits(buffer_sink_t out, uint32_t value, uint32_t width,
     buffer[kWordBits - len - 1] = '0';
     ++len;
   }
-  return out.sink(out.data, buffer + (kWordBits - len), len);
+  staging_write(out, buffer + (kWordBits - len), len);
 }
 
 /**
@@ -250,24 +330,23 @@ static size_t write_digits(buffer_sink_t out, uint32_t value, uint32_t width,
  * This function assumes that `spec` accurately describes the next entry in
  * `args`.
  *
- * @param out the sink to write bytes to.
+ * @param out the staging buffer to write bytes to.
  * @param spec the specifier to use for stringifying.
- * @param[out] bytes_written out param for the number of bytes writen to `out`.
  * @param va_list the list to pull an entry from.
  */
-static void process_specifier(buffer_sink_t out, format_specifier_t spec,
-                              size_t *bytes_written, va_list *args) {
+static void process_specifier(print_staging_t *out, format_specifier_t spec,
+                              va_list *args) {
   // Switch on the specifier. At this point, we assert that there is
   // an initialized value of correct type in the VA list; if it is
   // missing, the caller has caused UB.
   switch (spec.type) {
     case kPercent: {
-      *bytes_written += out.sink(out.data, "%", 1);
+      staging_write(out, "%", 1);
       break;
     }
     case kCharacter: {
       char value = (char)va_arg(*args, uint32_t);
-      *bytes_written += out.sink(out.data, &value, 1);
+      staging_write(out, &value, 1);
       break;
     }
     case kString: {
@@ -276,28 +355,28 @@ static void process_specifier(buffer_sink_t out, format_specifier_t spec,
       while (value[len] != '\0') {
         ++len;
       }
-      *bytes_written += out.sink(out.data, value, len);
+      staging_write(out, value, len);
       break;
     }
     case kSizedStr: {
       size_t len = va_arg(*args, size_t);
       char *value = va_arg(*args, char *);
-      *bytes_written += out.sink(out.data, value, len);
+      staging_write(out, value, len);
       break;
     }
     case kSignedDec1:
     case kSignedDec2: {
       uint32_t value = va_arg(*args, uint32_t);
       if (((int32_t)value) < 0) {
-        *bytes_written += out.sink(out.data, "-", 1);
+        staging_write(out, "-", 1);
         value = -value;
       }
-      *bytes_written += write_digits(out, value, spec.width, 10, kDigitsLow);
+      write_digits(out, value, spec.width, 10, kDigitsLow);
       break;
     }
     case kUnsignedOct: {
       uint32_t value = va_arg(*args, uint32_t);
-      *bytes_written += write_digits(out, value, spec.width, 8, kDigitsLow);
+      write_digits(out, value, spec.width, 8, kDigitsLow);
       break;
     }
     case kPointer: {
@@ -307,36 +386,35 @@ static void process_specifier(buffer_sink_t out, format_specifier_t spec,
       // different architecutres the null pointer prints as
       // - rv32imc: 0x00000000 (four bytes, eight nybbles).
       // - amd64:   0x0000000000000000 (eight bytes, sixteen nybbles).
-      *bytes_written += out.sink(out.data, "0x", 2);
+      staging_write(out, "0x", 2);
       uintptr_t value = va_arg(*args, uintptr_t);
-      *bytes_written +=
-          write_digits(out, value, sizeof(uintptr_t) * 2, 16, kDigitsLow);
+      write_digits(out, value, sizeof(uintptr_t) * 2, 16, kDigitsLow);
       break;
     }
     case kSvHexLow:
     case kUnsignedHexLow: {
       uint32_t value = va_arg(*args, uint32_t);
-      *bytes_written += write_digits(out, value, spec.width, 16, kDigitsLow);
+      write_digits(out, value, spec.width, 16, kDigitsLow);
       break;
     }
     case kSvHexHigh:
     case kUnsignedHexHigh: {
       uint32_t value = va_arg(*args, uint32_t);
-      *bytes_written += write_digits(out, value, spec.width, 16, kDigitsHigh);
+      write_digits(out, value, spec.width, 16, kDigitsHigh);
       break;
     }
     case kUnsignedDec: {
       uint32_t value = va_arg(*args, uint32_t);
-      *bytes_written += write_digits(out, value, spec.width, 10, kDigitsLow);
+      write_digits(out, value, spec.width, 10, kDigitsLow);
       break;
     }
     case kSvBinary: {
       uint32_t value = va_arg(*args, uint32_t);
-      *bytes_written += write_digits(out, value, spec.width, 2, kDigitsLow);
+      write_digits(out, value, spec.width, 2, kDigitsLow);
       break;
     }
     default: {
-      *bytes_written += out.sink(out.data, kUnknownSpec, sizeof(kUnknownSpec));
+      staging_write(out, kUnknownSpec, sizeof(kUnknownSpec));
     }
   }
 }
@@ -353,19 +431,22 @@ size_t base_vfprintf(buffer_sink_t out, const char *format, va_list args) {
   va_list args_copy;
   va_copy(args_copy, args);
 
-  size_t bytes_written = 0;
+  print_staging_t staging = {
+      .out = out, .bytes_written = 0, .len = 0,
+  };
   while (format[0] != '\0') {
-    if (!consume_until_percent(out, &format, &bytes_written)) {
+    if (!consume_until_percent(&staging, &format)) {
       break;
     }
     format_specifier_t spec;
-    if (!consume_format_specifier(out, &format, &bytes_written, &spec)) {
+    if (!consume_format_specifier(&staging, &format, &spec)) {
       break;
     }
 
-    process_specifier(out, spec, &bytes_written, &args_copy);
+    process_specifier(&staging, spec, &args_copy);
   }
+  staging_flush(&staging);
 
   va_end(args_copy);
-  return bytes_written;
+  return staging.bytes_written;
 }
@@ -0,0 +1,309 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "sw/device/lib/testing/reg_model.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace reg_model {
+namespace {
+// Values in Device::reg_index_ for words that aren't registers.
+constexpr int kUnmapped = -1;
+constexpr int kWindow = -2;
+
+/**
+ * The devices that are mapped, sorted by base address.
+ */
+std::vector<Device *> &MappedDevices() {
+  static std::vector<Device *> devices;
+  return devices;
+}
+
+// The device of the last access. Consecutive accesses usually go to the same
+// device, so this saves a search.
+Device *last_device = nullptr;
+
+[[noreturn]] void Fatal(const DeviceInfo &info, ptrdiff_t offset,
+                        const char *msg) {
+  fprintf(stderr, "reg_model: %s at offset 0x%tx of %s\n", msg, offset,
+          info.name.c_str());
+  abort();
+}
+}  // namespace
+
+Device::Device(const DeviceInfo &info, uintptr_t base_addr)
+    : info_(info), base_addr_(base_addr), intr_state_(-1), intr_test_(-1) {
+  uint32_t size_words = 0;
+  for (const RegInfo &reg : info_.regs) {
+    size_words = std::max<uint32_t>(size_words, reg.offset / 4 + 1);
+  }
+  for (const WindowInfo &win : info_.windows) {
+    size_words =
+        std::max<uint32_t>(size_words, (win.offset + win.size_bytes) / 4);
+  }
+
+  reg_index_.assign(size_words, kUnmapped);
+  window_words_.assign(size_words, 0);
+  for (const WindowInfo &win : info_.windows) {
+    std::fill(reg_index_.begin() + win.offset / 4,
+              reg_index_.begin() + (win.offset + win.size_bytes) / 4, kWindow);
+  }
+
+  regs_.resize(info_.regs.size());
+  for (size_t i = 0; i < info_.regs.size(); ++i) {
+    const RegInfo &reg = info_.regs[i];
+    regs_[i].info = &reg;
+    // Registers that share an address (`sameaddr`) can't be told apart by
+    // software, so only the first one is modeled.
+    if (reg_index_[reg.offset / 4] == kUnmapped) {
+      reg_index_[reg.offset / 4] = static_cast<int>(i);
+    }
+  }
+
+  for (RegState &reg : regs_) {
+    reg.regwen = -1;
+    if (!reg.info->regwen.empty()) {
+      reg.regwen = reg_index_[RegOffset(reg.info->regwen) / 4];
+    }
+    if (reg.info->name == "INTR_STATE") {
+      intr_state_ = reg_index_[reg.info->offset / 4];
+    } else if (reg.info->name == "INTR_TEST") {
+      intr_test_ = reg_index_[reg.info->offset / 4];
+    }
+  }
+
+  Reset();
+
+  std::vector<Device *> &devices = MappedDevices();
+  auto it = std::lower_bound(
+      devices.begin(), devices.end(), this, [](Device *a, Device *b) {
+        return a->base_addr_ < b->base_addr_;
+      });
+  if ((it != devices.end() && (*it)->base_addr_ < base_addr_ + size_bytes()) ||
+      (it != devices.begin() &&
+       (*(it - 1))->base_addr_ + (*(it - 1))->size_bytes() > base_addr_)) {
+    Fatal(info_, 0, "Address range overlaps another device");
+  }
+  devices.insert(it, this);
+}
+
+Device::~Device() {
+  std::vector<Device *> &devices = MappedDevices();
+  devices.erase(std::find(devices.begin(), devices.end(), this));
+  if (last_device == this) {
+    last_device = nullptr;
+  }
+}
+
+void Device::Reset() {
+  for (RegState &reg : regs_) {
+    reg.value = reg.info->reset_value;
+    reg.fifo.clear();
+  }
+  std::fill(window_words_.begin(), window_words_.end(), 0);
+}
+
+Device::RegState *Device::Lookup(ptrdiff_t offset, const char *access) {
+  return const_cast<RegState *>(
+      static_cast<const Device *>(this)->Lookup(offset, access));
+}
+
+const Device::RegState *Device::Lookup(ptrdiff_t offset,
+                                       const char *access) const {
+  if (offset < 0 || offset % 4 != 0 ||
+      static_cast<size_t>(offset / 4) >= reg_index_.size()) {
+    Fatal(info_, offset, access);
+  }
+  int index = reg_index_[offset / 4];
+  if (index == kUnmapped) {
+    Fatal(info_, offset, access);
+  }
+  return index == kWindow ? nullptr : &regs_[index];
+}
+
+uint32_t Device::Read32(ptrdiff_t offset) {
+  RegState *reg = Lookup(offset, "Unmapped read");
+  if (reg == nullptr) {
+    return window_words_[offset / 4];
+  }
+
+  if (reg->read_hook) {
+    reg->read_hook(*this);
+  }
+  if (reg->info->read_fifo && !reg->fifo.empty()) {
+    reg->value = reg->fifo.front();
+    reg->fifo.pop_front();
+  }
+  uint32_t value = reg->value & reg->info->read_mask;
+  reg->value &= ~reg->info->rc_mask;
+  return value;
+}
+
+void Device::Write(ptrdiff_t offset, uint32_t value, uint32_t byte_mask) {
+  RegState *reg = Lookup(offset, "Unmapped write");
+  if (reg == nullptr) {
+    uint32_t &word = window_words_[offset / 4];
+    word = (word & ~byte_mask) | (value & byte_mask);
+    return;
+  }
+
+  // Writes to locked registers are ignored.
+  if (reg->regwen >= 0 && (regs_[reg->regwen].value & 1) == 0) {
+    return;
+  }
+
+  const RegInfo &info = *reg->info;
+  uint32_t write_mask = info.write_mask & byte_mask;
+  uint32_t new_value = (reg->value & ~write_mask) | (value & write_mask);
+  new_value &= ~(value & info.w1c_mask & byte_mask);
+  new_value |= value & info.w1s_mask & byte_mask;
+  new_value &= ~(~value & info.w0c_mask & byte_mask);
+  reg->value = new_value;
+
+  if (info.write_fifo) {
+    reg->fifo.push_back(value & write_mask);
+  }
+  if (reg - regs_.data() == intr_test_ && intr_state_ >= 0) {
+    regs_[intr_state_].value |= value & write_mask;
+  }
+  if (reg->write_hook) {
+    reg->write_hook(*this, value);
+  }
+}
+
+void Device::Write32(ptrdiff_t offset, uint32_t value) {
+  Write(offset, value, UINT32_MAX);
+}
+
+uint8_t Device::Read8(ptrdiff_t offset) {
+  uint32_t shift = (offset % 4) * 8;
+  return static_cast<uint8_t>(Read32(offset - offset % 4) >> shift);
+}
+
+void Device::Write8(ptrdiff_t offset, uint8_t value) {
+  uint32_t shift = (offset % 4) * 8;
+  Write(offset - offset % 4, static_cast<uint32_t>(value) << shift,
+        UINT32_C(0xff) << shift);
+}
+
+uint32_t Device::Peek(ptrdiff_t offset) const {
+  const RegState *reg = Lookup(offset, "Unmapped peek");
+  return reg == nullptr ? window_words_[offset / 4] : reg->value;
+}
+
+void Device::Poke(ptrdiff_t offset, uint32_t value) {
+  RegState *reg = Lookup(offset, "Unmapped poke");
+  if (reg == nullptr) {
+    window_words_[offset / 4] = value;
+  } else {
+    reg->value = value;
+  }
+}
+
+std::deque<uint32_t> &Device::Fifo(ptrdiff_t offset) {
+  RegState *reg = Lookup(offset, "No register");
+  if (reg == nullptr) {
+    Fatal(info_, offset, "No FIFO in window");
+  }
+  return reg->fifo;
+}
+
+void Device::OnWrite(ptrdiff_t offset, WriteHook hook) {
+  RegState *reg = Lookup(offset, "No register");
+  if (reg == nullptr) {
+    Fatal(info_, offset, "No hooks in window");
+  }
+  reg->write_hook = std::move(hook);
+}
+
+void Device::OnRead(ptrdiff_t offset, ReadHook hook) {
+  RegState *reg = Lookup(offset, "No register");
+  if (reg == nullptr) {
+    Fatal(info_, offset, "No hooks in window");
+  }
+  reg->read_hook = std::move(hook);
+}
+
+uint32_t Device::RegOffset(const std::string &name) const {
+  for (const RegInfo &reg : info_.regs) {
+    if (reg.name == name) {
+      return reg.offset;
+    }
+  }
+  fprintf(stderr, "reg_model: No register %s in %s\n", name.c_str(),
+          info_.name.c_str());
+  abort();
+}
+
+Device *Device::FromAddr(uintptr_t addr, ptrdiff_t *offset) {
+  Device *dev = last_device;
+  if (dev == nullptr || addr < dev->base_addr_ ||
+      addr - dev->base_addr_ >= dev->size_bytes()) {
+    std::vector<Device *> &devices = MappedDevices();
+    auto it = std::upper_bound(
+        devices.begin(), devices.end(), addr,
+        [](uintptr_t a, Device *d) { return a < d->base_addr_; });
+    if (it == devices.begin()) {
+      return nullptr;
+    }
+    dev = *(it - 1);
+    if (addr - dev->base_addr_ >= dev->size_bytes()) {
+      return nullptr;
+    }
+    last_device = dev;
+  }
+  *offset = static_cast<ptrdiff_t>(addr - dev->base_addr_);
+  return dev;
+}
+
+namespace {
+Device &DeviceAt(mmio_region_t base, ptrdiff_t offset, ptrdiff_t *dev_offset) {
+  uintptr_t addr = reinterpret_cast<uintptr_t>(base.mock) + offset;
+  Device *dev = Device::FromAddr(addr, dev_offset);
+  if (dev == nullptr) {
+    fprintf(stderr, "reg_model: No device at address 0x%jx\n",
+            static_cast<uintmax_t>(addr));
+    abort();
+  }
+  return *dev;
+}
+}  // namespace
+
+// Definitions for the MOCK_MMIO-mode declarations in |mmio.h|. A region holds
+// its address, so that regions from `mmio_region_from_addr()` and
+// `Device::region()` are interchangeable.
+extern "C" {
+mmio_region_t mmio_region_from_addr(uintptr_t address) {
+  return {reinterpret_cast<void *>(address)};
+}
+
+uint8_t mmio_region_read8(mmio_region_t base, ptrdiff_t offset) {
+  ptrdiff_t dev_offset;
+  Device &dev = DeviceAt(base, offset, &dev_offset);
+  return dev.Read8(dev_offset);
+}
+
+uint32_t mmio_region_read32(mmio_region_t base, ptrdiff_t offset) {
+  ptrdiff_t dev_offset;
+  Device &dev = DeviceAt(base, offset, &dev_offset);
+  return dev.Read32(dev_offset);
+}
+
+void mmio_region_write8(mmio_region_t base, ptrdiff_t offset, uint8_t value) {
+  ptrdiff_t dev_offset;
+  Device &dev = DeviceAt(base, offset, &dev_offset);
+  dev.Write8(dev_offset, value);
+}
+
+void mmio_region_write32(mmio_region_t base, ptrdiff_t offset, uint32_t value) {
+  ptrdiff_t dev_offset;
+  Device &dev = DeviceAt(base, offset, &dev_offset);
+  dev.Write32(dev_offset, value);
+}
+}  // extern "C"
+}  // namespace reg_model
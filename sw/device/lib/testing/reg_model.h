@@ -0,0 +1,223 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef OPENTITAN_SW_DEVICE_LIB_TESTING_REG_MODEL_H_
+#define OPENTITAN_SW_DEVICE_LIB_TESTING_REG_MODEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "sw/device/lib/base/mmio.h"
+
+/**
+ * @file
+ * @brief Behavioral register models for running device code on the host.
+ *
+ * A `reg_model::Device` models the registers of one IP block, as described by
+ * a `reg_model::DeviceInfo`. Those are generated by `regtool.py --regmodel`
+ * from the IP's hjson file, as `<ip>_regmodel.h`.
+ *
+ * Devices are mapped at a base address. When linked with this library, the
+ * `mmio.h` functions (in `-DMOCK_MMIO` mode) access the device mapped at the
+ * address of the region, so that unmodified DIFs and tests can run natively:
+ *
+ *   reg_model::Device uart(reg_model::UartDeviceInfo(),
+ *                          TOP_EARLGREY_UART_BASE_ADDR);
+ *   mmio_region_t base = mmio_region_from_addr(TOP_EARLGREY_UART_BASE_ADDR);
+ *
+ * The model implements the software view of each register: reset values and
+ * the `swaccess` semantics of each field (RW, RO, RC, W1C, W1S, W0C, WO),
+ * write-enable registers (`regwen`) and `INTR_TEST`. Register windows are
+ * modeled as plain memory.
+ *
+ * Anything the hardware does is up to the test. It can change register values
+ * from the hardware side with `Peek()` and `Poke()`, and register hooks that
+ * run on software reads and writes. FIFO data registers are modeled as queues:
+ * software writes to write-only registers with `hwqe` are appended to the
+ * register's `Fifo()`, and software reads of external, read-only registers
+ * with `hwre` pop the front of the register's `Fifo()`, if it isn't empty.
+ */
+
+namespace reg_model {
+
+/**
+ * The software view of a single register. The masks give the bits of the
+ * register with each kind of access.
+ */
+struct RegInfo {
+  std::string name;
+  uint32_t offset;
+  uint32_t reset_value;
+  /** Bits that read back their value (all but WO and R0W1C bits). */
+  uint32_t read_mask;
+  /** Bits that take the written value (RW and WO bits). */
+  uint32_t write_mask;
+  /** Bits that are cleared by writing 1 (RW1C and R0W1C bits). */
+  uint32_t w1c_mask;
+  /** Bits that are set by writing 1 (RW1S bits). */
+  uint32_t w1s_mask;
+  /** Bits that are cleared by writing 0 (RW0C bits). */
+  uint32_t w0c_mask;
+  /** Bits that are cleared by reading (RC bits). */
+  uint32_t rc_mask;
+  /** Software writes are appended to the register's FIFO. */
+  bool write_fifo;
+  /** Software reads pop the front of the register's FIFO, if any. */
+  bool read_fifo;
+  /**
+   * The name of the register whose bit 0 enables writes to this register, or
+   * an empty string if writes are always enabled.
+   */
+  std::string regwen;
+};
+
+/**
+ * A register window, which is modeled as memory.
+ */
+struct WindowInfo {
+  std::string name;
+  uint32_t offset;
+  uint32_t size_bytes;
+};
+
+/**
+ * The registers and windows of an IP block.
+ */
+struct DeviceInfo {
+  std::string name;
+  std::vector<RegInfo> regs;
+  std::vector<WindowInfo> windows;
+};
+
+/**
+ * The model of an IP block, mapped at a base address.
+ *
+ * Accesses to offsets that are neither a register nor in a window abort the
+ * program, since they would be bus errors on the real hardware.
+ */
+class Device {
+ public:
+  /** Called after a software write, with the value that was written. */
+  using WriteHook = std::function<void(Device &device, uint32_t value)>;
+  /** Called before a software read, to update the register value. */
+  using ReadHook = std::function<void(Device &device)>;
+
+  /**
+   * Creates a device in its reset state and maps it at `base_addr`.
+   *
+   * The range of addresses must not overlap those of other devices.
+   */
+  Device(const DeviceInfo &info, uintptr_t base_addr);
+  ~Device();
+
+  Device(const Device &) = delete;
+  Device &operator=(const Device &) = delete;
+  Device(Device &&) = delete;
+  Device &operator=(Device &&) = delete;
+
+  /**
+   * Returns a `mmio_region_t` for this device, for use with `mmio.h`.
+   */
+  mmio_region_t region() const {
+    return {reinterpret_cast<void *>(base_addr_)};
+  }
+
+  uintptr_t base_addr() const { return base_addr_; }
+  const DeviceInfo &info() const { return info_; }
+
+  /**
+   * Returns the size of the device's address range in bytes.
+   */
+  uint32_t size_bytes() const {
+    return static_cast<uint32_t>(reg_index_.size() * sizeof(uint32_t));
+  }
+
+  /**
+   * Resets all registers and windows, and empties all FIFOs. Hooks are kept.
+   */
+  void Reset();
+
+  /**
+   * Software accesses, with the semantics of the register at `offset`. These
+   * are what the `mmio.h` functions call.
+   */
+  uint32_t Read32(ptrdiff_t offset);
+  void Write32(ptrdiff_t offset, uint32_t value);
+  uint8_t Read8(ptrdiff_t offset);
+  void Write8(ptrdiff_t offset, uint8_t value);
+
+  /**
+   * Hardware accesses: read or replace the value of the register (or window
+   * word) at `offset` without any side effects.
+   */
+  uint32_t Peek(ptrdiff_t offset) const;
+  void Poke(ptrdiff_t offset, uint32_t value);
+
+  /**
+   * Returns the FIFO of the register at `offset`. Tests pop the values that
+   * software wrote, or push values for software to read.
+   */
+  std::deque<uint32_t> &Fifo(ptrdiff_t offset);
+
+  /**
+   * Registers a hook for software writes to (or reads from) the register at
+   * `offset`. This replaces the previous hook, if any.
+   */
+  void OnWrite(ptrdiff_t offset, WriteHook hook);
+  void OnRead(ptrdiff_t offset, ReadHook hook);
+
+  /**
+   * Returns the offset of the register called `name`. Aborts if there is no
+   * such register.
+   */
+  uint32_t RegOffset(const std::string &name) const;
+
+  /**
+   * Returns the device mapped at `addr`, and sets `*offset` to the offset of
+   * `addr` in it. Returns nullptr if no device is mapped at `addr`.
+   */
+  static Device *FromAddr(uintptr_t addr, ptrdiff_t *offset);
+
+ private:
+  struct RegState {
+    const RegInfo *info;
+    uint32_t value;
+    // Index in regs_ of the register that enables writes, or -1.
+    int regwen;
+    std::deque<uint32_t> fifo;
+    WriteHook write_hook;
+    ReadHook read_hook;
+  };
+
+  /**
+   * Returns the register at `offset`, or nullptr if `offset` is in a window.
+   * Aborts if there is nothing at `offset`.
+   */
+  RegState *Lookup(ptrdiff_t offset, const char *access);
+  const RegState *Lookup(ptrdiff_t offset, const char *access) const;
+
+  /** Writes the bits of `value` in `byte_mask` to the register at `offset`. */
+  void Write(ptrdiff_t offset, uint32_t value, uint32_t byte_mask);
+
+  const DeviceInfo &info_;
+  uintptr_t base_addr_;
+  std::vector<RegState> regs_;
+  // The value of each word of the address range (used by windows).
+  std::vector<uint32_t> window_words_;
+  // For each word in the address range, the index in regs_ of the register at
+  // that offset, kWindow, or kUnmapped.
+  std::vector<int> reg_index_;
+  // The INTR_STATE register, or -1, and the INTR_TEST register, or -1.
+  int intr_state_;
+  int intr_test_;
+};
+
+}  // namespace reg_model
+
+#endif  // OPENTITAN_SW_DEVICE_LIB_TESTING_REG_MODEL_H_
@@ -0,0 +1,195 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "sw/device/lib/testing/reg_model.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "hw/top_earlgrey/sw/autogen/top_earlgrey.h"
+#include "sw/device/lib/base/mmio.h"
+#include "sw/device/lib/dif/dif_uart.h"
+
+#include "uart_regmodel.h"  // Generated.
+#include "uart_regs.h"      // Generated.
+
+namespace {
+using ::reg_model::Device;
+using ::reg_model::DeviceInfo;
+using ::testing::ElementsAre;
+using ::testing::Test;
+
+// A device with one register of each kind.
+const DeviceInfo &TestDeviceInfo() {
+  static const DeviceInfo *info = new DeviceInfo{
+      "test",
+      {
+          {"RW", 0x0u, 0x5au, 0xffu, 0xffu, 0u, 0u, 0u, 0u, false, false, ""},
+          {"W1C", 0x4u, 0xffu, 0xffu, 0u, 0xffu, 0u, 0u, 0u, false, false, ""},
+          {"W1S", 0x8u, 0x0u, 0xffu, 0u, 0u, 0xffu, 0u, 0u, false, false, ""},
+          {"REGWEN", 0xcu, 0x1u, 0x1u, 0u, 0u, 0u, 0x1u, 0u, false, false, ""},
+          {"LOCKED", 0x10u, 0x0u, 0xffu, 0xffu, 0u, 0u, 0u, 0u, false, false,
+           "REGWEN"},
+          {"RC", 0x14u, 0x0u, 0xffu, 0u, 0u, 0u, 0u, 0xffu, false, false, ""},
+          {"WDATA", 0x18u, 0x0u, 0u, 0xffu, 0u, 0u, 0u, 0u, true, false, ""},
+          {"RDATA", 0x1cu, 0x0u, 0xffu, 0u, 0u, 0u, 0u, 0u, false, true, ""},
+      },
+      {
+          {"MEM", 0x40u, 0x10u},
+      },
+  };
+  return *info;
+}
+
+class RegModelTest : public Test {
+ protected:
+  Device dev_{TestDeviceInfo(), 0x1000};
+  mmio_region_t base_ = mmio_region_from_addr(0x1000);
+};
+
+TEST_F(RegModelTest, ResetValues) {
+  EXPECT_EQ(mmio_region_read32(base_, 0x0), 0x5au);
+  EXPECT_EQ(mmio_region_read32(base_, 0x4), 0xffu);
+
+  mmio_region_write32(base_, 0x0, 0x12u);
+  dev_.Fifo(0x18).push_back(1u);
+  dev_.Reset();
+  EXPECT_EQ(mmio_region_read32(base_, 0x0), 0x5au);
+  EXPECT_TRUE(dev_.Fifo(0x18).empty());
+}
+
+TEST_F(RegModelTest, AccessTypes) {
+  mmio_region_write32(base_, 0x0, 0xa5u);
+  EXPECT_EQ(mmio_region_read32(base_, 0x0), 0xa5u);
+
+  mmio_region_write32(base_, 0x4, 0x0fu);
+  EXPECT_EQ(mmio_region_read32(base_, 0x4), 0xf0u);
+
+  mmio_region_write32(base_, 0x8, 0x03u);
+  mmio_region_write32(base_, 0x8, 0x30u);
+  EXPECT_EQ(mmio_region_read32(base_, 0x8), 0x33u);
+
+  dev_.Poke(0x14, 0x42u);
+  EXPECT_EQ(mmio_region_read32(base_, 0x14), 0x42u);
+  EXPECT_EQ(mmio_region_read32(base_, 0x14), 0x0u);
+
+  // Write-only bits read as zero.
+  mmio_region_write32(base_, 0x18, 0x77u);
+  EXPECT_EQ(mmio_region_read32(base_, 0x18), 0x0u);
+  EXPECT_EQ(dev_.Peek(0x18), 0x77u);
+}
+
+TEST_F(RegModelTest, ByteAccess) {
+  mmio_region_write8(base_, 0x1, 0xcdu);
+  EXPECT_EQ(mmio_region_read32(base_, 0x0), 0x5au);
+  mmio_region_write8(base_, 0x0, 0xcdu);
+  EXPECT_EQ(mmio_region_read8(base_, 0x0), 0xcdu);
+
+  // Writing one byte of a W1C register doesn't clear bits in other bytes.
+  dev_.Poke(0x4, 0xffffffffu);
+  mmio_region_write8(base_, 0x4, 0x01u);
+  EXPECT_EQ(dev_.Peek(0x4), 0xfffffffeu);
+}
+
+TEST_F(RegModelTest, Regwen) {
+  mmio_region_write32(base_, 0x10, 0x1u);
+  EXPECT_EQ(mmio_region_read32(base_, 0x10), 0x1u);
+
+  mmio_region_write32(base_, 0xc, 0x0u);
+  mmio_region_write32(base_, 0x10, 0x2u);
+  EXPECT_EQ(mmio_region_read32(base_, 0x10), 0x1u);
+}
+
+TEST_F(RegModelTest, Fifos) {
+  mmio_region_write32(base_, 0x18, 0x1u);
+  mmio_region_write32(base_, 0x18, 0x2u);
+  EXPECT_THAT(dev_.Fifo(0x18), ElementsAre(0x1u, 0x2u));
+
+  dev_.Fifo(0x1c).push_back(0x3u);
+  dev_.Fifo(0x1c).push_back(0x4u);
+  EXPECT_EQ(mmio_region_read32(base_, 0x1c), 0x3u);
+  EXPECT_EQ(mmio_region_read32(base_, 0x1c), 0x4u);
+  // An empty FIFO returns the last value again.
+  EXPECT_EQ(mmio_region_read32(base_, 0x1c), 0x4u);
+}
+
+TEST_F(RegModelTest, Window) {
+  mmio_region_write32(base_, 0x4c, 0xdeadbeefu);
+  EXPECT_EQ(mmio_region_read32(base_, 0x4c), 0xdeadbeefu);
+  EXPECT_EQ(mmio_region_read8(mmio_region_from_addr(0x1040), 0xf), 0xdeu);
+}
+
+TEST_F(RegModelTest, Hooks) {
+  dev_.OnWrite(0x0, [](Device &dev, uint32_t value) {
+    dev.Fifo(0x1c).push_back(value + 1u);
+  });
+  dev_.OnRead(0x14, [](Device &dev) { dev.Poke(0x14, 0x99u); });
+
+  mmio_region_write32(base_, 0x0, 0x10u);
+  EXPECT_EQ(mmio_region_read32(base_, 0x1c), 0x11u);
+  EXPECT_EQ(mmio_region_read32(base_, 0x14), 0x99u);
+}
+
+TEST_F(RegModelTest, UnmappedAccess) {
+  EXPECT_DEATH(EXPECT_EQ(mmio_region_read32(base_, 0x20), 0u), "Unmapped read");
+  EXPECT_DEATH(mmio_region_write32(base_, 0x2, 0u), "Unmapped write");
+  EXPECT_DEATH(
+      EXPECT_EQ(mmio_region_read32(mmio_region_from_addr(0x2000), 0x0), 0u),
+      "No device");
+}
+
+/**
+ * A UART model with loopback: bytes written to WDATA are received in RDATA,
+ * and STATUS reports the RX FIFO state.
+ */
+class UartModelTest : public Test {
+ protected:
+  UartModelTest() {
+    uart_.OnWrite(UART_WDATA_REG_OFFSET, [](Device &dev, uint32_t value) {
+      dev.Fifo(UART_RDATA_REG_OFFSET).push_back(value);
+    });
+    uart_.OnRead(UART_STATUS_REG_OFFSET, [](Device &dev) {
+      uint32_t status = dev.Peek(UART_STATUS_REG_OFFSET);
+      status = bitfield_bit32_write(
+          status, UART_STATUS_RXEMPTY_BIT,
+          dev.Fifo(UART_RDATA_REG_OFFSET).empty());
+      dev.Poke(UART_STATUS_REG_OFFSET, status);
+    });
+  }
+
+  Device uart_{reg_model::UartDeviceInfo(), TOP_EARLGREY_UART_BASE_ADDR};
+};
+
+TEST_F(UartModelTest, Loopback) {
+  dif_uart_t uart;
+  mmio_region_t base = mmio_region_from_addr(TOP_EARLGREY_UART_BASE_ADDR);
+  ASSERT_EQ(dif_uart_init({.base_addr = base}, &uart), kDifUartOk);
+  ASSERT_EQ(dif_uart_configure(&uart,
+                               {
+                                   .baudrate = 115200,
+                                   .clk_freq_hz = 50000000,
+                                   .parity_enable = kDifUartToggleDisabled,
+                                   .parity = kDifUartParityEven,
+                               }),
+            kDifUartConfigOk);
+  EXPECT_TRUE(bitfield_bit32_read(uart_.Peek(UART_CTRL_REG_OFFSET),
+                                  UART_CTRL_TX_BIT));
+
+  for (uint8_t byte : {'o', 'k'}) {
+    EXPECT_EQ(dif_uart_byte_send_polled(&uart, byte), kDifUartOk);
+    uint8_t received;
+    EXPECT_EQ(dif_uart_byte_receive_polled(&uart, &received), kDifUartOk);
+    EXPECT_EQ(received, byte);
+  }
+
+  EXPECT_EQ(dif_uart_irq_force(&uart, kDifUartIrqTxEmpty), kDifUartOk);
+  bool is_pending;
+  EXPECT_EQ(dif_uart_irq_is_pending(&uart, kDifUartIrqTxEmpty, &is_pending),
+            kDifUartOk);
+  EXPECT_TRUE(is_pending);
+  EXPECT_EQ(dif_uart_irq_acknowledge(&uart, kDifUartIrqTxEmpty), kDifUartOk);
+  EXPECT_EQ(dif_uart_irq_is_pending(&uart, kDifUartIrqTxEmpty, &is_pending),
+            kDifUartOk);
+  EXPECT_FALSE(is_pending);
+}
+}  // namespace
@@ -26,12 +26,14 @@ void test_status_set(test_status_t test_status) {
   switch (test_status) {
     case kTestStatusPassed: {
       LOG_INFO("PASS!");
+      base_log_flush();
       test_status_device_write(test_status);
       abort();
       break;
     }
     case kTestStatusFailed: {
       LOG_INFO("FAIL!");
+      base_log_flush();
       test_status_device_write(test_status);
       abort();
       break;
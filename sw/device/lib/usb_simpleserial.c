@@ -8,6 +8,10 @@
 
 #define MAX_GATHER 16
 
+// Largest packet sent by usb_simpleserial_send_bulk, matches the wMaxPacketSize
+// of the bulk endpoints in the configuration descriptors that use this
+#define MAX_PACKET 32
+
 static void ss_rx(void *ssctx_v, usbbufid_t buf, int size, int setup) {
   usb_ss_ctx_t *ssctx = (usb_ss_ctx_t *)ssctx_v;
   void *ctx = ssctx->ctx;
@@ -22,6 +26,15 @@ static void ss_rx(void *ssctx_v, usbbufid_t buf, int size, int setup) {
   }
 }
 
+// Queue the gathered buffer for sending
+static void ss_send(usb_ss_ctx_t *ssctx) {
+  size_t size = ssctx->cur_cpos;
+  if (usbdev_sendbufs_byid(ssctx->ctx, &ssctx->cur_buf, &size, 1, ssctx->ep) ==
+      1) {
+    ssctx->cur_buf = -1;  // given it to usbdev
+  }
+}
+
 // Called periodically by the main loop to ensure characters don't
 // stick around too long
 static void ss_flush(void *ssctx_v) {
@@ -37,8 +50,7 @@ static void ss_flush(void *ssctx_v) {
     // no -1 here because cpos is in the word we are writing
     bp_w[(ssctx->cur_cpos / 4)] = ssctx->chold.data_w;
   }
-  usbdev_sendbuf_byid(ctx, ssctx->cur_buf, ssctx->cur_cpos, ssctx->ep);
-  ssctx->cur_buf = -1;  // given it to the hardware
+  ss_send(ssctx);
 }
 
 // Simple send byte will gather data for a while and send
@@ -52,6 +64,11 @@ void usb_simpleserial_send_byte(usb_ss_ctx_t *ssctx, uint8_t c) {
   if (ssctx->cur_buf < 0) {
     return;
   }
+  // Drop if the buffer is full because the endpoint queue is full, and
+  // nothing can be sent until a queued packet is sent
+  if (ssctx->cur_cpos >= BUF_LENGTH) {
+    return;
+  }
   ssctx->chold.data_b[ssctx->cur_cpos++ & 0x3] = c;
   if ((ssctx->cur_cpos & 0x3) == 0) {
     // just wrote last byte in word
@@ -59,11 +76,42 @@ void usb_simpleserial_send_byte(usb_ss_ctx_t *ssctx, uint8_t c) {
     // -1 here because cpos already incremented to next word
     bp_w[(ssctx->cur_cpos / 4) - 1] = ssctx->chold.data_w;
     if (ssctx->cur_cpos >= MAX_GATHER) {
-      usbdev_sendbuf_byid(ssctx->ctx, ssctx->cur_buf, ssctx->cur_cpos,
-                          ssctx->ep);
-      ssctx->cur_buf = -1;  // given it to the hardware
+      ss_send(ssctx);
+    }
+  }
+}
+
+size_t usb_simpleserial_send_bulk(usb_ss_ctx_t *ssctx, const uint8_t *data,
+                                  size_t len) {
+  usbbufid_t bufs[USBDEV_TXQ_DEPTH];
+  size_t sizes[USBDEV_TXQ_DEPTH];
+  size_t sent = 0;
+
+  // Keep ordering with anything gathered by usb_simpleserial_send_byte
+  ss_flush(ssctx);
+  if (ssctx->cur_buf != -1) {
+    return 0;
+  }
+
+  int space = usbdev_send_queue_space(ssctx->ctx, ssctx->ep);
+  int npkts = usbdev_buf_allocate_bulk(ssctx->ctx, bufs, space);
+  int filled = 0;
+  while ((filled < npkts) && (sent < len)) {
+    size_t size = len - sent;
+    if (size > MAX_PACKET) {
+      size = MAX_PACKET;
     }
+    // Fill in place, the buffer can only be written with 32-bit words
+    usbdev_buf_copyto_byid(ssctx->ctx, bufs[filled], data + sent, size);
+    sizes[filled++] = size;
+    sent += size;
+  }
+  // Return any buffers that were not needed
+  for (int i = filled; i < npkts; i++) {
+    usbdev_buf_free_byid(ssctx->ctx, bufs[i]);
   }
+  usbdev_sendbufs_byid(ssctx->ctx, bufs, sizes, filled, ssctx->ep);
+  return sent;
 }
 
 void usb_simpleserial_init(usb_ss_ctx_t *ssctx, usbdev_ctx_t *ctx, int ep,
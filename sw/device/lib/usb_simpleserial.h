@@ -31,6 +31,22 @@ typedef struct usb_ss_ctx {
  */
 void usb_simpleserial_send_byte(usb_ss_ctx_t *ssctx, uint8_t c);
 
+/**
+ * Send a block of data on a simpleserial endpoint
+ *
+ * Data is written directly into packet buffers and several packets are
+ * queued at once, so this is much faster than sending byte by byte. It may
+ * accept only part of the data if the endpoint queue or buffer pool is full;
+ * call usbdev_poll and retry with the remainder.
+ *
+ * @param ssctx instance context
+ * @param data bytes to send, no alignment requirement
+ * @param len number of bytes in @p data
+ * @return number of bytes accepted
+ */
+size_t usb_simpleserial_send_bulk(usb_ss_ctx_t *ssctx, const uint8_t *data,
+                                  size_t len);
+
 /**
  * Initialize a simpleserial endpoint
  *
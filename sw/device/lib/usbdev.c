@@ -17,6 +17,9 @@
 
 #define REG32(add) *((volatile uint32_t *)(add))
 
+// Depth of the hardware Available Buffer FIFO
+#define AV_FIFO_DEPTH 4
+
 // Free buffer pool is held on a simple stack
 // Initalize to all buffer IDs are free
 static void buf_init(usbdev_ctx_t *ctx) {
@@ -34,6 +37,14 @@ usbbufid_t usbdev_buf_allocate_byid(usbdev_ctx_t *ctx) {
   return ctx->freebuf[--ctx->nfree];
 }
 
+int usbdev_buf_allocate_bulk(usbdev_ctx_t *ctx, usbbufid_t *bufs, int n) {
+  int count = 0;
+  while ((count < n) && (ctx->nfree > 0)) {
+    bufs[count++] = ctx->freebuf[--ctx->nfree];
+  }
+  return count;
+}
+
 // Freeing a buffer just pushes the ID back on the stack
 int usbdev_buf_free_byid(usbdev_ctx_t *ctx, usbbufid_t buf) {
   if ((ctx->nfree >= NUM_BUFS) || (buf >= NUM_BUFS)) {
@@ -50,25 +61,43 @@ uint32_t *usbdev_buf_idtoaddr(usbdev_ctx_t *ctx, usbbufid_t buf) {
 
 void usbdev_buf_copyto_byid(usbdev_ctx_t *ctx, usbbufid_t buf, const void *from,
                             size_t len_bytes) {
-  int32_t *from_word = (int32_t *)from;
-  int len_words;
   volatile uint32_t *bp = usbdev_buf_idtoaddr(ctx, buf);
 
   if (len_bytes > BUF_LENGTH) {
     len_bytes = BUF_LENGTH;
   }
+  // The buffer can only be written with 32-bit words
   // This will round up if len_bytes is not on a multiple of int32_t
   // Always ok to fill the extra bytes since the buffers are aligned
-  len_words = (len_bytes + sizeof(int32_t) - 1) / sizeof(int32_t);
-  for (int i = 0; i < len_words; i++) {
-    bp[i] = from_word[i];
+  int len_words = (len_bytes + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+  if (((uintptr_t)from & 0x3) == 0) {
+    const uint32_t *from_word = (const uint32_t *)from;
+    for (int i = 0; i < len_words; i++) {
+      bp[i] = from_word[i];
+    }
+  } else {
+    // Gather unaligned source bytes into words (little endian)
+    const uint8_t *from_byte = (const uint8_t *)from;
+    for (int i = 0; i < len_words; i++) {
+      uint32_t word = 0;
+      for (size_t j = 0; (j < sizeof(uint32_t)) && (len_bytes > 0); j++) {
+        word |= (uint32_t)*from_byte++ << (8 * j);
+        len_bytes--;
+      }
+      bp[i] = word;
+    }
   }
 }
 
 // Supply as many buffers to the receive available fifo as possible
+// The free space is read once and the fifo is then refilled in one batch
 inline static void fill_av_fifo(usbdev_ctx_t *ctx) {
-  while (!(REG32(USBDEV_BASE_ADDR + USBDEV_USBSTAT_REG_OFFSET) &
-           (1 << USBDEV_USBSTAT_AV_FULL_BIT))) {
+  uint32_t usbstat = REG32(USBDEV_BASE_ADDR + USBDEV_USBSTAT_REG_OFFSET);
+  if (usbstat & (1 << USBDEV_USBSTAT_AV_FULL_BIT)) {
+    return;
+  }
+  int space = AV_FIFO_DEPTH - EXTRACT(usbstat, USBSTAT_AV_DEPTH);
+  while (space-- > 0) {
     usbbufid_t buf = usbdev_buf_allocate_byid(ctx);
     if (buf < 0) {
       // no more free buffers, can't fill AV FIFO
@@ -78,11 +107,46 @@ inline static void fill_av_fifo(usbdev_ctx_t *ctx) {
   }
 }
 
-void usbdev_sendbuf_byid(usbdev_ctx_t *ctx, usbbufid_t buf, size_t size,
-                         int endpoint) {
+// Hand a buffer to the hardware for the next IN on an endpoint
+inline static void configin_write(int endpoint, usbbufid_t buf, size_t size) {
+  REG32(USBDEV_BASE_ADDR + USBDEV_CONFIGIN_0_REG_OFFSET + (4 * endpoint)) =
+      ((buf << USBDEV_CONFIGIN_0_BUFFER_0_OFFSET) |
+       (size << USBDEV_CONFIGIN_0_SIZE_0_OFFSET) |
+       (1 << USBDEV_CONFIGIN_0_RDY_0_BIT));
+}
+
+// If the endpoint is idle, give the next queued buffer to the hardware
+static void txq_start(usbdev_ctx_t *ctx, int endpoint) {
+  usbdev_txq_t *txq = &ctx->txq[endpoint];
+  if (txq->busy || (txq->count == 0)) {
+    return;
+  }
+  configin_write(endpoint, txq->buf[txq->head], txq->size[txq->head]);
+  txq->head = (txq->head + 1) & (USBDEV_TXQ_DEPTH - 1);
+  txq->count--;
+  txq->busy = 1;
+}
+
+// Drop everything queued on an endpoint, e.g. after a link reset
+// The hardware has already cancelled any packet it held and set pend
+static void txq_flush(usbdev_ctx_t *ctx, int endpoint) {
+  usbdev_txq_t *txq = &ctx->txq[endpoint];
   uint32_t configin =
       USBDEV_BASE_ADDR + USBDEV_CONFIGIN_0_REG_OFFSET + (4 * endpoint);
+  if (txq->busy) {
+    usbdev_buf_free_byid(ctx, EXTRACT(REG32(configin), CONFIGIN_0_BUFFER_0));
+    REG32(configin) = (1 << USBDEV_CONFIGIN_0_PEND_0_BIT);
+    txq->busy = 0;
+  }
+  while (txq->count) {
+    usbdev_buf_free_byid(ctx, txq->buf[txq->head]);
+    txq->head = (txq->head + 1) & (USBDEV_TXQ_DEPTH - 1);
+    txq->count--;
+  }
+}
 
+void usbdev_sendbuf_byid(usbdev_ctx_t *ctx, usbbufid_t buf, size_t size,
+                         int endpoint) {
   if ((endpoint >= NUM_ENDPOINTS) || (buf >= NUM_BUFS)) {
     return;
   }
@@ -91,11 +155,37 @@ void usbdev_sendbuf_byid(usbdev_ctx_t *ctx, usbbufid_t buf, size_t size,
     size = BUF_LENGTH;
   }
 
-  REG32(configin) = ((buf << USBDEV_CONFIGIN_0_BUFFER_0_OFFSET) |
-                     (size << USBDEV_CONFIGIN_0_SIZE_0_OFFSET) |
-                     (1 << USBDEV_CONFIGIN_0_RDY_0_BIT));
+  configin_write(endpoint, buf, size);
 }
 
+int usbdev_sendbufs_byid(usbdev_ctx_t *ctx, const usbbufid_t *bufs,
+                         const size_t *sizes, int count, int endpoint) {
+  if (endpoint >= NUM_ENDPOINTS) {
+    return 0;
+  }
+
+  usbdev_txq_t *txq = &ctx->txq[endpoint];
+  int queued = 0;
+  while ((queued < count) && (txq->count < USBDEV_TXQ_DEPTH)) {
+    if ((bufs[queued] < 0) || (bufs[queued] >= NUM_BUFS)) {
+      break;
+    }
+    int tail = (txq->head + txq->count) & (USBDEV_TXQ_DEPTH - 1);
+    txq->buf[tail] = bufs[queued];
+    txq->size[tail] = (sizes[queued] > BUF_LENGTH) ? BUF_LENGTH : sizes[queued];
+    txq->count++;
+    queued++;
+  }
+  txq_start(ctx, endpoint);
+  return queued;
+}
+
+int usbdev_send_queue_space(usbdev_ctx_t *ctx, int endpoint) {
+  return USBDEV_TXQ_DEPTH - ctx->txq[endpoint].count;
+}
+
+void usbdev_buf_keep_rx(usbdev_ctx_t *ctx) { ctx->rx_keep = 1; }
+
 void usbdev_poll(usbdev_ctx_t *ctx) {
   uint32_t istate = REG32(USBDEV_BASE_ADDR + USBDEV_INTR_STATE_REG_OFFSET);
 
@@ -110,9 +200,11 @@ void usbdev_poll(usbdev_ctx_t *ctx) {
     TRC_C('a' + sentep);
     for (int ep = 0; ep < NUM_ENDPOINTS; ep++) {
       if (sentep & (1 << ep)) {
-        // Free up the buffer and optionally callback
+        // Free up the buffer, start any queued one and optionally callback
         int32_t cfgin = REG32(configin + (4 * ep));
         usbdev_buf_free_byid(ctx, EXTRACT(cfgin, CONFIGIN_0_BUFFER_0));
+        ctx->txq[ep].busy = 0;
+        txq_start(ctx, ep);
         if (ctx->tx_done_callback[ep]) {
           ctx->tx_done_callback[ep](ctx->ep_ctx[ep]);
         }
@@ -134,13 +226,16 @@ void usbdev_poll(usbdev_ctx_t *ctx) {
       int endpoint = EXTRACT(rxinfo, RXFIFO_EP);
       int setup = (rxinfo >> USBDEV_RXFIFO_SETUP_BIT) & 1;
 
+      ctx->rx_keep = 0;
       if (ctx->rx_callback[endpoint]) {
         ctx->rx_callback[endpoint](ctx->ep_ctx[endpoint], buf, size, setup);
       } else {
         TRC_S("USB: unexpected RX ");
         TRC_I(rxinfo, 24);
       }
-      usbdev_buf_free_byid(ctx, buf);
+      if (!ctx->rx_keep) {
+        usbdev_buf_free_byid(ctx, buf);
+      }
     }
     // Clear the interupt
     REG32(USBDEV_BASE_ADDR + USBDEV_INTR_STATE_REG_OFFSET) =
@@ -157,6 +252,7 @@ void usbdev_poll(usbdev_ctx_t *ctx) {
     if (istate & (1 << USBDEV_INTR_ENABLE_LINK_RESET_BIT)) {
       // Link reset
       for (int ep = 0; ep < NUM_ENDPOINTS; ep++) {
+        txq_flush(ctx, ep);
         if (ctx->reset[ep]) {
           ctx->reset[ep](ctx->ep_ctx[ep]);
         }
@@ -274,8 +370,10 @@ void usbdev_init(usbdev_ctx_t *ctx, bool pinflip, bool diff_rx, bool diff_tx) {
   // setup context
   for (int i = 0; i < NUM_ENDPOINTS; i++) {
     usbdev_endpoint_setup(ctx, i, 0, NULL, NULL, NULL, NULL, NULL);
+    ctx->txq[i] = (usbdev_txq_t){0};
   }
   ctx->halted = 0;
+  ctx->rx_keep = 0;
   ctx->can_wake = 0;
   buf_init(ctx);
 
@@ -14,12 +14,25 @@
 #define BUF_LENGTH 64
 #define NUM_ENDPOINTS 12
 
+// Depth of the per-endpoint queue of IN packets (power of 2)
+#define USBDEV_TXQ_DEPTH 8
+
 // USB buffers are held in the SRAM in the interface, referenced by ID
 // Buffer IDs are 0 to NUM_BUFS
 // Use negative buffer ID for error
 typedef int usbbufid_t;
 typedef struct usbdev_ctx usbdev_ctx_t;
 
+// IN packets queued on an endpoint by usbdev_sendbufs_byid
+// The hardware holds one packet per endpoint, the rest wait here
+typedef struct usbdev_txq {
+  uint8_t buf[USBDEV_TXQ_DEPTH];
+  uint8_t size[USBDEV_TXQ_DEPTH];
+  uint8_t head;
+  uint8_t count;  // waiting, not including the one held by the hardware
+  uint8_t busy;   // a queued packet is held by the hardware
+} usbdev_txq_t;
+
 // Note: this is only needed here because the caller of init needs it
 struct usbdev_ctx {
   // TODO: base_addr goes here once header files support using it
@@ -28,6 +41,8 @@ struct usbdev_ctx {
   uint32_t halted;  // bit vector per endpoint
   int nfree;
   int flushed;
+  int rx_keep;  // set by usbdev_buf_keep_rx during an rx callback
+  usbdev_txq_t txq[NUM_ENDPOINTS];
   usbdev_ctx_t *ep_ctx[NUM_ENDPOINTS];
   void (*tx_done_callback[NUM_ENDPOINTS])(void *);
   void (*rx_callback[NUM_ENDPOINTS])(void *, usbbufid_t, int, int);
@@ -43,6 +58,16 @@ struct usbdev_ctx {
  */
 usbbufid_t usbdev_buf_allocate_byid(usbdev_ctx_t *ctx);
 
+/**
+ * Allocate several buffers for the caller to use
+ *
+ * @param ctx usbdev context pointer
+ * @param bufs array to receive the buffer IDs
+ * @param n maximum number of buffers to allocate
+ * @return number of buffers allocated, may be less than @p n
+ */
+int usbdev_buf_allocate_bulk(usbdev_ctx_t *ctx, usbbufid_t *bufs, int n);
+
 /**
  * Free a buffer when caller no longer needs it
  *
@@ -67,8 +92,8 @@ uint32_t *usbdev_buf_idtoaddr(usbdev_ctx_t *ctx, usbbufid_t buf);
 /**
  * Copy from memory into a buffer, referencing by buffer ID
  *
- * Implementation restriction: from must be 4-byte aligned
- * TODO remove restriction
+ * For bulk data prefer filling buffers in place through
+ * usbdev_buf_idtoaddr, which avoids the copy
  *
  * @param ctx usbdev context pointer
  * @param buf buffer ID to copy to
@@ -92,6 +117,49 @@ void usbdev_buf_copyto_byid(usbdev_ctx_t *ctx, usbbufid_t buf, const void *from,
 void usbdev_sendbuf_byid(usbdev_ctx_t *ctx, usbbufid_t buf, size_t size,
                          int endpoint);
 
+/**
+ * Queue several buffers for transmission on an endpoint
+ *
+ * Buffers are filled in place by the caller (see usbdev_buf_idtoaddr) and
+ * handed over together. The first is given to the hardware immediately if the
+ * endpoint is idle, the rest are given to it from usbdev_poll as each
+ * preceding packet is Acked. Once queued the buffers are owned by usbdev and
+ * are freed after they have been sent.
+ *
+ * Do not mix with usbdev_sendbuf_byid on the same endpoint
+ *
+ * @param ctx usbdev context pointer
+ * @param bufs buffer IDs to send, in order
+ * @param sizes length in bytes of data to send from each buffer
+ * @param count number of buffers in @p bufs
+ * @param endpoint endpoint to send from
+ * @return number of buffers queued, may be less than @p count if the queue
+ *         is full; the caller keeps ownership of any that were not queued
+ */
+int usbdev_sendbufs_byid(usbdev_ctx_t *ctx, const usbbufid_t *bufs,
+                         const size_t *sizes, int count, int endpoint);
+
+/**
+ * Get the number of buffers that can be queued on an endpoint
+ *
+ * @param ctx usbdev context pointer
+ * @param endpoint endpoint number
+ * @return free entries in the endpoint's IN queue
+ */
+int usbdev_send_queue_space(usbdev_ctx_t *ctx, int endpoint);
+
+/**
+ * Keep the buffer passed to the current rx callback
+ *
+ * Only valid from inside an rx callback. By default the buffer is returned to
+ * the free pool when the callback returns; after this call it is owned by the
+ * caller, who can consume it in place and must later return it with
+ * usbdev_buf_free_byid.
+ *
+ * @param ctx usbdev context pointer
+ */
+void usbdev_buf_keep_rx(usbdev_ctx_t *ctx);
+
 /**
  * Call regularly to poll the usbdev interface
  *
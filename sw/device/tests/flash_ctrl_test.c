@@ -4,12 +4,19 @@
 
 #include "sw/device/lib/flash_ctrl.h"
 
+#include "sw/device/lib/arch/device.h"
 #include "sw/device/lib/base/memory.h"
 #include "sw/device/lib/base/mmio.h"
+#include "sw/device/lib/dif/dif_plic.h"
+#include "sw/device/lib/handler.h"
+#include "sw/device/lib/irq.h"
+#include "sw/device/lib/runtime/ibex.h"
 #include "sw/device/lib/runtime/log.h"
 #include "sw/device/lib/testing/check.h"
 #include "sw/device/lib/testing/test_main.h"
 
+#include "hw/top_earlgrey/sw/autogen/top_earlgrey.h"
+
 #define CHECK_ARRAYS_EQ(xs, ys, len) \
   do {                               \
     uint32_t *xs_ = (xs);            \
@@ -188,6 +195,178 @@ static void test_memory_protection(void) {
   }
 }
 
+static uint64_t t_start;
+
+/**
+ * Starts a throughput measurement.
+ */
+static void profile_start(void) { t_start = ibex_mcycle_read(); }
+
+/**
+ * Ends a throughput measurement and logs the rate in MB/s.
+ *
+ * @param msg Name of the operation (for logging purposes).
+ * @param bytes Number of bytes processed since `profile_start()`.
+ */
+static void profile_end(const char *msg, uint32_t bytes) {
+  uint32_t cycles = ibex_mcycle_read() - t_start;
+  // Thousandths of a MB/s, i.e. kB/s with 1 MB = 10^6 B.
+  uint32_t rate = ((uint64_t)bytes * kClockFreqCpuHz) /
+                  ((uint64_t)(cycles ? cycles : 1) * 1000);
+  LOG_INFO("%s: %u bytes in %u cycles, %u.%03u MB/s", msg, bytes, cycles,
+           rate / 1000, rate % 1000);
+}
+
+/*
+ * Compares the queued program / mapped read paths against the blocking ones,
+ * and reports the throughput of each.
+ */
+static void test_throughput(void) {
+  flash_default_region_access(/*rd_en=*/true, /*prog_en=*/true,
+                              /*erase_en=*/true);
+
+  uintptr_t flash_bank_1_addr = FLASH_MEM_BASE_ADDR + FLASH_BANK_SZ;
+  uint32_t page_bytes = FLASH_WORDS_PER_PAGE * sizeof(uint32_t);
+
+  uint32_t input_page[FLASH_WORDS_PER_PAGE];
+  uint32_t output_page[FLASH_WORDS_PER_PAGE];
+  for (int i = 0; i < FLASH_WORDS_PER_PAGE; ++i) {
+    input_page[i] = 0x5a5a0000 ^ (i * 0x01010101);
+  }
+
+  profile_start();
+  CHECK_EQZ(flash_page_erase(flash_bank_1_addr, kDataPartition));
+  profile_end("erase", page_bytes);
+
+  profile_start();
+  CHECK_EQZ(flash_write(flash_bank_1_addr, kDataPartition, input_page,
+                        FLASH_WORDS_PER_PAGE));
+  profile_end("program", page_bytes);
+
+  profile_start();
+  CHECK_EQZ(flash_read(flash_bank_1_addr, kDataPartition, FLASH_WORDS_PER_PAGE,
+                       output_page));
+  profile_end("fifo read", page_bytes);
+  CHECK_ARRAYS_EQ(output_page, input_page, FLASH_WORDS_PER_PAGE);
+
+  memset(output_page, 0, sizeof(output_page));
+  profile_start();
+  flash_read_mapped(flash_bank_1_addr, FLASH_WORDS_PER_PAGE, output_page);
+  profile_end("mapped read", page_bytes);
+  CHECK_ARRAYS_EQ(output_page, input_page, FLASH_WORDS_PER_PAGE);
+
+  // Queue an erase and a program of the same page back to back; the program
+  // starts as soon as the erase completes, without the CPU waiting on either.
+  for (int i = 0; i < FLASH_WORDS_PER_PAGE; ++i) {
+    input_page[i] = ~input_page[i];
+  }
+  flash_queue_irq_ctrl(/*en=*/false);
+  profile_start();
+  CHECK_EQZ(flash_queue_page_erase(flash_bank_1_addr, kDataPartition));
+  CHECK_EQZ(flash_queue_write(flash_bank_1_addr, kDataPartition, input_page,
+                              FLASH_WORDS_PER_PAGE));
+  CHECK_EQZ(flash_queue_wait());
+  profile_end("queued erase + program", page_bytes);
+
+  flash_read_mapped(flash_bank_1_addr, FLASH_WORDS_PER_PAGE, output_page);
+  CHECK_ARRAYS_EQ(output_page, input_page, FLASH_WORDS_PER_PAGE);
+}
+
+static dif_plic_t plic;
+static volatile uint32_t flash_irqs;
+
+static const dif_plic_irq_id_t kFlashQueueIrqs[] = {
+    kTopEarlgreyPlicIrqIdFlashCtrlProgEmpty,
+    kTopEarlgreyPlicIrqIdFlashCtrlProgLvl,
+    kTopEarlgreyPlicIrqIdFlashCtrlOpDone,
+    kTopEarlgreyPlicIrqIdFlashCtrlOpError,
+};
+
+/**
+ * Provides external irq handling for this test.
+ *
+ * This function overrides the default external irq handler in
+ * `sw/device/lib/handler.h`.
+ */
+void handler_irq_external(void) {
+  dif_plic_irq_id_t plic_irq_id;
+  CHECK(dif_plic_irq_claim(&plic, kTopEarlgreyPlicTargetIbex0, &plic_irq_id) ==
+            kDifPlicOk,
+        "dif_plic_irq_claim failed");
+  CHECK(plic_irq_id >= kTopEarlgreyPlicIrqIdFlashCtrlProgEmpty &&
+            plic_irq_id <= kTopEarlgreyPlicIrqIdFlashCtrlOpError,
+        "Unexpected interrupt (at PLIC): %d", plic_irq_id);
+
+  flash_queue_service();
+  ++flash_irqs;
+
+  CHECK(dif_plic_irq_complete(&plic, kTopEarlgreyPlicTargetIbex0,
+                              &plic_irq_id) == kDifPlicOk,
+        "dif_plic_irq_complete failed");
+}
+
+/**
+ * Routes the flash queue interrupts to the Ibex.
+ */
+static void plic_init_with_irqs(void) {
+  CHECK(dif_plic_init(
+            (dif_plic_params_t){
+                .base_addr =
+                    mmio_region_from_addr(TOP_EARLGREY_RV_PLIC_BASE_ADDR),
+            },
+            &plic) == kDifPlicOk,
+        "dif_plic_init failed");
+  for (int i = 0; i < ARRAYSIZE(kFlashQueueIrqs); ++i) {
+    CHECK(dif_plic_irq_set_priority(&plic, kFlashQueueIrqs[i], 0x1) ==
+              kDifPlicOk,
+          "dif_plic_irq_set_priority failed");
+    CHECK(dif_plic_irq_set_enabled(&plic, kFlashQueueIrqs[i],
+                                   kTopEarlgreyPlicTargetIbex0,
+                                   kDifPlicToggleEnabled) == kDifPlicOk,
+          "dif_plic_irq_set_enabled failed");
+  }
+  CHECK(dif_plic_target_set_threshold(&plic, kTopEarlgreyPlicTargetIbex0,
+                                      0x0) == kDifPlicOk,
+        "dif_plic_target_set_threshold failed");
+}
+
+/**
+ * Runs the flash queue from its interrupts: programs two pages back to back,
+ * with the CPU only waiting at the end.
+ */
+static void test_queue_irq(void) {
+  uintptr_t flash_bank_1_addr = FLASH_MEM_BASE_ADDR + FLASH_BANK_SZ;
+  uint32_t num_words = FLASH_WORDS_PER_PAGE * 2;
+  uint32_t input_page[num_words];
+  uint32_t output_page[num_words];
+
+  for (int i = 0; i < num_words; ++i) {
+    input_page[i] = 0x5a5a0000 + i;
+  }
+
+  plic_init_with_irqs();
+  flash_queue_irq_ctrl(/*en=*/true);
+  irq_global_ctrl(true);
+  irq_external_ctrl(true);
+
+  for (int page = 0; page < 2; ++page) {
+    uint32_t addr = flash_bank_1_addr + page * FLASH_PAGE_SZ;
+    CHECK_EQZ(flash_queue_page_erase(addr, kDataPartition));
+    CHECK_EQZ(flash_queue_write(addr, kDataPartition,
+                                &input_page[page * FLASH_WORDS_PER_PAGE],
+                                FLASH_WORDS_PER_PAGE));
+  }
+  CHECK_EQZ(flash_queue_wait());
+
+  irq_external_ctrl(false);
+  irq_global_ctrl(false);
+  flash_queue_irq_ctrl(/*en=*/false);
+
+  CHECK(flash_irqs > 0, "Flash queue interrupts never fired");
+  flash_read_mapped(flash_bank_1_addr, num_words, output_page);
+  CHECK_ARRAYS_EQ(output_page, input_page, num_words);
+}
+
 const test_config_t kTestConfig;
 
 bool test_main(void) {
@@ -200,6 +379,8 @@ bool test_main(void) {
 
   test_basic_io();
   test_memory_protection();
+  test_throughput();
+  test_queue_irq();
 
   flash_cfg_bank_erase(FLASH_BANK_0, /*erase_en=*/false);
   flash_cfg_bank_erase(FLASH_BANK_1, /*erase_en=*/false);
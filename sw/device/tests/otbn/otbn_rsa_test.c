@@ -40,16 +40,17 @@
 /**
  * Performs encrypt and decrypt operations. (Otherwise, only encrypt is done.)
  *
- * Encryption is reasonably fast in RSA, taking between 50 thousand instructions
- * for RSA 512, up to 17 million instructions for RSA 4096.
+ * Encryption is reasonably fast in RSA, taking between 7 thousand OTBN cycles
+ * for RSA 512, up to 0.3 million cycles for RSA 4096, after a key load of
+ * between 35 thousand and 1.3 million cycles.
  * Assuming a typical Verilator-based simulation of Earl Grey at 5 kHz, this
- * results in simulation times between a couple of seconds and an hour for RSA
- * encrypt.
+ * results in simulation times between a couple of seconds and several minutes
+ * for RSA encrypt.
  *
  * Decryption, on the other hand, is much more computationally expensive.
- * Decryption takes around 0.5 million instructions for RSA 512, up to
- * 128 million instructions for RSA 4096. Assuming the same simulation at 5 kHz,
- * this translates to a RSA 512 decode taking around two minutes to execute,
+ * Decryption takes around 0.26 million cycles for RSA 512, up to
+ * 127 million cycles for RSA 4096. Assuming the same simulation at 5 kHz,
+ * this translates to a RSA 512 decode taking around one minute to execute,
  * and a RSA 4096 decode taking over seven hours.
  */
 static const bool kTestDecrypt = true;
@@ -65,8 +66,10 @@ static const bool kTestDecrypt = true;
 static const bool kTestRsaGreater1k = false;
 
 OTBN_DECLARE_APP_SYMBOLS(rsa);
-OTBN_DECLARE_PTR_SYMBOL(rsa, rsa_encrypt);
-OTBN_DECLARE_PTR_SYMBOL(rsa, rsa_decrypt);
+OTBN_DECLARE_PTR_SYMBOL(rsa, rsa_modload);
+OTBN_DECLARE_PTR_SYMBOL(rsa, rsa_encrypt_cached);
+OTBN_DECLARE_PTR_SYMBOL(rsa, rsa_decrypt_cached);
+OTBN_DECLARE_PTR_SYMBOL(rsa, window_bits);
 OTBN_DECLARE_PTR_SYMBOL(rsa, n_limbs);
 OTBN_DECLARE_PTR_SYMBOL(rsa, in);
 OTBN_DECLARE_PTR_SYMBOL(rsa, out);
@@ -74,10 +77,14 @@ OTBN_DECLARE_PTR_SYMBOL(rsa, modulus);
 OTBN_DECLARE_PTR_SYMBOL(rsa, exp);
 
 static const otbn_app_t kOtbnAppRsa = OTBN_APP_T_INIT(rsa);
+static const otbn_ptr_t kOtbnFuncRsaRsaModload =
+    OTBN_PTR_T_INIT(rsa, rsa_modload);
 static const otbn_ptr_t kOtbnFuncRsaRsaEncrypt =
-    OTBN_PTR_T_INIT(rsa, rsa_encrypt);
+    OTBN_PTR_T_INIT(rsa, rsa_encrypt_cached);
 static const otbn_ptr_t kOtbnFuncRsaRsaDecrypt =
-    OTBN_PTR_T_INIT(rsa, rsa_decrypt);
+    OTBN_PTR_T_INIT(rsa, rsa_decrypt_cached);
+static const otbn_ptr_t kOtbnVarRsaWindowBits =
+    OTBN_PTR_T_INIT(rsa, window_bits);
 static const otbn_ptr_t kOtbnVarRsaNLimbs = OTBN_PTR_T_INIT(rsa, n_limbs);
 static const otbn_ptr_t kOtbnVarRsaIn = OTBN_PTR_T_INIT(rsa, in);
 static const otbn_ptr_t kOtbnVarRsaOut = OTBN_PTR_T_INIT(rsa, out);
@@ -92,34 +99,69 @@ enum {
   kRsa4096SizeBytes = 4096 / 8,
 };
 
+enum {
+  /**
+   * Size of the `in` buffer in rsa.s, which also holds the window table for
+   * decryption.
+   */
+  kOtbnRsaInBufferBytes = 1984,
+  /**
+   * Largest window width supported by `modexp_window`.
+   */
+  kOtbnRsaMaxWindowBits = 5,
+};
+
 const test_config_t kTestConfig = {
     .can_clobber_uart = false,
 };
 
 /**
- * Encrypts a message with RSA.
+ * Loads an RSA key into OTBN.
+ *
+ * Writes the modulus and computes the Montgomery constants m0' and RR, which
+ * stay in OTBN DMEM for all following `rsa_encrypt()` and `rsa_decrypt()`
+ * calls with this key.
  *
  * @param otbn_ctx The OTBN context object.
  * @param modulus The modulus (n).
- * @param in The plaintext message.
- * @param out The encrypted message.
- * @param size_bytes The size of all buffers in bytes, i.e. the key/modulus
- *                   length (i.e. 128 for RSA 1024). Valid range: 32..512 in
- *                   32 byte-steps (i.e. RSA 256 to RSA 4096).
+ * @param size_bytes The size of the modulus in bytes, i.e. the key length
+ *                   (i.e. 128 for RSA 1024). Valid range: 64..512 in
+ *                   32 byte-steps (i.e. RSA 512 to RSA 4096).
  */
-static void rsa_encrypt(otbn_t *otbn_ctx, const uint8_t *modulus,
-                        const uint8_t *in, uint8_t *out, size_t size_bytes) {
+static void rsa_load_key(otbn_t *otbn_ctx, const uint8_t *modulus,
+                         size_t size_bytes) {
   CHECK(otbn_ctx != NULL);
   CHECK(size_bytes % 32 == 0);
 
+  // Limbs are 256b words.
   uint32_t n_limbs = size_bytes / 32;
-  CHECK(n_limbs != 0 && n_limbs <= 16);
+  CHECK(n_limbs > 1 && n_limbs <= 16);
 
   // Write input arguments.
   CHECK(otbn_copy_data_to_otbn(otbn_ctx, sizeof(n_limbs), &n_limbs,
                                kOtbnVarRsaNLimbs) == kOtbnOk);
   CHECK(otbn_copy_data_to_otbn(otbn_ctx, size_bytes, modulus,
                                kOtbnVarRsaModulus) == kOtbnOk);
+
+  // Call OTBN to compute m0' and RR, and wait for it to complete.
+  CHECK(otbn_call_function(otbn_ctx, kOtbnFuncRsaRsaModload) == kOtbnOk);
+  CHECK(otbn_busy_wait_for_done(otbn_ctx) == kOtbnOk);
+}
+
+/**
+ * Encrypts a message with RSA, using the key loaded by `rsa_load_key()`.
+ *
+ * @param otbn_ctx The OTBN context object.
+ * @param in The plaintext message.
+ * @param out The encrypted message.
+ * @param size_bytes The size of all buffers in bytes, i.e. the key/modulus
+ *                   length, as passed to `rsa_load_key()`.
+ */
+static void rsa_encrypt(otbn_t *otbn_ctx, const uint8_t *in, uint8_t *out,
+                        size_t size_bytes) {
+  CHECK(otbn_ctx != NULL);
+
+  // Write input arguments.
   CHECK(otbn_copy_data_to_otbn(otbn_ctx, size_bytes, in, kOtbnVarRsaIn) ==
         kOtbnOk);
 
@@ -133,32 +175,43 @@ static void rsa_encrypt(otbn_t *otbn_ctx, const uint8_t *modulus,
 }
 
 /**
- * Decrypts a message with RSA.
+ * Returns the widest window for the decryption of `size_bytes` messages.
+ *
+ * The window table of 2^k bignums needs to fit into the `in` buffer, which
+ * limits the window width to 4 bits for RSA 512, 3 bits for RSA 1024, 2 bits
+ * for RSA 2048 and 3072, and 1 bit for RSA 4096.
+ *
+ * @param size_bytes The key/modulus length in bytes.
+ * @return The window width in bits.
+ */
+static uint32_t rsa_window_bits(size_t size_bytes) {
+  uint32_t window_bits = 1;
+  while (window_bits < kOtbnRsaMaxWindowBits &&
+         (size_bytes << (window_bits + 1)) <= kOtbnRsaInBufferBytes) {
+    ++window_bits;
+  }
+  return window_bits;
+}
+
+/**
+ * Decrypts a message with RSA, using the key loaded by `rsa_load_key()`.
  *
  * @param otbn_ctx The OTBN context object.
- * @param modulus The modulus (n).
  * @param private_exponent The private exponent (d).
  * @param in The encrypted message.
  * @param out The decrypted (plaintext) message.
  * @param size_bytes The size of all buffers in bytes, i.e. the key/modulus
- *                   length (i.e. 128 for RSA 1024). Valid range: 32..512 in
- *                   32 byte-steps (i.e. RSA 256 to RSA 4096).
+ *                   length, as passed to `rsa_load_key()`.
  */
-static void rsa_decrypt(otbn_t *otbn_ctx, const uint8_t *modulus,
-                        const uint8_t *private_exponent, const uint8_t *in,
-                        uint8_t *out, size_t size_bytes) {
+static void rsa_decrypt(otbn_t *otbn_ctx, const uint8_t *private_exponent,
+                        const uint8_t *in, uint8_t *out, size_t size_bytes) {
   CHECK(otbn_ctx != NULL);
-  CHECK(size_bytes % 32 == 0);
 
-  // Limbs are 256b words.
-  uint32_t n_limbs = size_bytes / 32;
-  CHECK(n_limbs != 0 && n_limbs <= 16);
+  uint32_t window_bits = rsa_window_bits(size_bytes);
 
   // Write input arguments.
-  CHECK(otbn_copy_data_to_otbn(otbn_ctx, sizeof(n_limbs), &n_limbs,
-                               kOtbnVarRsaNLimbs) == kOtbnOk);
-  CHECK(otbn_copy_data_to_otbn(otbn_ctx, size_bytes, modulus,
-                               kOtbnVarRsaModulus) == kOtbnOk);
+  CHECK(otbn_copy_data_to_otbn(otbn_ctx, sizeof(window_bits), &window_bits,
+                               kOtbnVarRsaWindowBits) == kOtbnOk);
   CHECK(otbn_copy_data_to_otbn(otbn_ctx, size_bytes, private_exponent,
                                kOtbnVarRsaExp) == kOtbnOk);
   CHECK(otbn_copy_data_to_otbn(otbn_ctx, size_bytes, in, kOtbnVarRsaIn) ==
@@ -220,8 +273,9 @@ static void profile_end(const char *msg) {
 /**
  * Performs a RSA roundtrip test.
  *
- * A roundtrip consists of three steps:
+ * A roundtrip consists of four steps:
  * - Initialize OTBN.
+ * - Load the key, i.e. the modulus and the derived Montgomery constants.
  * - Encrypt data. Check that the OTBN-produced data matches
  *   `encrypted_expected`.
  * - If `kTestDecrypt` is set: Decrypt the encrypted data. Check that the OTBN-
@@ -251,10 +305,15 @@ static void rsa_roundtrip(uint32_t size_bytes, const uint8_t *modulus,
   CHECK(otbn_load_app(&otbn_ctx, kOtbnAppRsa) == kOtbnOk);
   profile_end("Initialization");
 
+  // Load key
+  profile_start();
+  rsa_load_key(&otbn_ctx, modulus, size_bytes);
+  profile_end("Key load");
+
   // Encrypt
   LOG_INFO("Encrypting");
   profile_start();
-  rsa_encrypt(&otbn_ctx, modulus, in, out_encrypted, size_bytes);
+  rsa_encrypt(&otbn_ctx, in, out_encrypted, size_bytes);
   check_data(out_encrypted, encrypted_expected, size_bytes);
   profile_end("Encryption");
 
@@ -262,7 +321,7 @@ static void rsa_roundtrip(uint32_t size_bytes, const uint8_t *modulus,
     // Decrypt
     LOG_INFO("Decrypting");
     profile_start();
-    rsa_decrypt(&otbn_ctx, modulus, private_exponent, encrypted_expected,
+    rsa_decrypt(&otbn_ctx, private_exponent, encrypted_expected,
                 out_decrypted, size_bytes);
     check_data(out_decrypted, in, size_bytes);
     profile_end("Decryption");
@@ -0,0 +1,72 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "sw/device/lib/arch/device.h"
+#include "sw/device/lib/runtime/ibex.h"
+#include "sw/device/lib/runtime/log.h"
+#include "sw/device/lib/runtime/print.h"
+#include "sw/device/lib/testing/check.h"
+#include "sw/device/lib/testing/test_main.h"
+
+/**
+ * printf benchmark
+ *
+ * Reports the average number of cycles spent formatting a few representative
+ * format strings into a RAM buffer, which excludes the cost of the UART.
+ */
+
+#define NUM_ITERATIONS 16
+
+static char buf[128];
+
+static uint32_t sink_calls;
+
+/**
+ * Sink that discards its input, counting the number of calls.
+ */
+static size_t null_sink(void *data, const char *bytes, size_t len) {
+  ++sink_calls;
+  return len;
+}
+
+/**
+ * Logs the average cycles per call for `expr`, and the number of sink calls
+ * it made.
+ */
+#define BENCHMARK(name_, expr_)                                               \
+  do {                                                                        \
+    sink_calls = 0;                                                           \
+    uint64_t start = ibex_mcycle_read();                                      \
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {                                \
+      expr_;                                                                  \
+    }                                                                         \
+    uint32_t cycles =                                                         \
+        (uint32_t)((ibex_mcycle_read() - start) / NUM_ITERATIONS);            \
+    LOG_INFO("%s: %u cycles/call, %u sink calls/call", name_, cycles,         \
+             sink_calls / NUM_ITERATIONS);                                    \
+  } while (false)
+
+const test_config_t kTestConfig;
+
+bool test_main(void) {
+  buffer_sink_t null_out = {.data = NULL, .sink = &null_sink};
+
+  BENCHMARK("literal", base_snprintf(buf, sizeof(buf), "Hello, World!\r\n"));
+  BENCHMARK("hex", base_snprintf(buf, sizeof(buf), "0x%x", 0xdeadbeef));
+  BENCHMARK("hex_width", base_snprintf(buf, sizeof(buf), "0x%08x", 0x1234));
+  BENCHMARK("decimal", base_snprintf(buf, sizeof(buf), "%d", -1234567890));
+  BENCHMARK("unsigned", base_snprintf(buf, sizeof(buf), "%u", 4294967295u));
+  BENCHMARK("binary", base_snprintf(buf, sizeof(buf), "%32b", 0xa5a5a5a5));
+  BENCHMARK("string", base_snprintf(buf, sizeof(buf), "%s",
+                                    "a moderately long string argument"));
+  BENCHMARK("log_line",
+            base_fprintf(null_out, "%s%5d %s:%d] Log line %d of %d, 0x%08x\r\n",
+                         "I", 42, "print_benchmark_test.c", 123, 7, 8,
+                         0xdeadbeef));
+
+  CHECK(base_snprintf(buf, sizeof(buf), "%d/%u/0x%08x", -42, 42u, 0xbeef) ==
+            17,
+        "Unexpected length");
+  return true;
+}
@@ -0,0 +1,192 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+extern "C" {
+#include "sw/device/lib/irq.h"
+#include "sw/device/lib/runtime/buffered_uart.h"
+}  // extern "C"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "sw/device/lib/dif/dif_uart.h"
+
+namespace buffered_uart_unittest {
+namespace {
+
+// A fake UART TX FIFO, which accepts up to `fifo_room` bytes.
+std::string fifo;
+size_t fifo_room;
+
+// A fake `mstatus.MIE`.
+bool irqs_enabled;
+
+}  // namespace
+}  // namespace buffered_uart_unittest
+
+// NOTE: These are only present so that buffered_uart.c can link without
+// pulling in dif_uart.c, irq.c and log.c.
+extern "C" {
+const uint32_t kDifUartFifoSizeBytes = 32;
+
+dif_uart_result_t dif_uart_bytes_send(const dif_uart_t *, const uint8_t *data,
+                                      size_t bytes_requested,
+                                      size_t *bytes_written) {
+  EXPECT_FALSE(buffered_uart_unittest::irqs_enabled);
+  size_t len = std::min(bytes_requested, buffered_uart_unittest::fifo_room);
+  buffered_uart_unittest::fifo.append(reinterpret_cast<const char *>(data),
+                                      len);
+  buffered_uart_unittest::fifo_room -= len;
+  *bytes_written = len;
+  return kDifUartOk;
+}
+
+dif_uart_result_t dif_uart_byte_send_polled(const dif_uart_t *, uint8_t byte) {
+  buffered_uart_unittest::fifo.push_back(static_cast<char>(byte));
+  return kDifUartOk;
+}
+
+dif_uart_result_t dif_uart_tx_bytes_available(const dif_uart_t *,
+                                              size_t *num_bytes) {
+  *num_bytes = kDifUartFifoSizeBytes;
+  return kDifUartOk;
+}
+
+dif_uart_result_t dif_uart_watermark_tx_set(const dif_uart_t *,
+                                            dif_uart_watermark_t) {
+  return kDifUartOk;
+}
+
+dif_uart_result_t dif_uart_irq_set_enabled(const dif_uart_t *, dif_uart_irq_t,
+                                           dif_uart_toggle_t) {
+  return kDifUartOk;
+}
+
+dif_uart_result_t dif_uart_irq_acknowledge(const dif_uart_t *,
+                                           dif_uart_irq_t) {
+  return kDifUartOk;
+}
+
+bool irq_global_disable(void) {
+  bool was_enabled = buffered_uart_unittest::irqs_enabled;
+  buffered_uart_unittest::irqs_enabled = false;
+  return was_enabled;
+}
+
+void irq_global_ctrl(bool en) { buffered_uart_unittest::irqs_enabled = en; }
+
+void base_log_set_flush_hook(void (*)(void *), void *) {}
+}  // extern "C"
+
+namespace buffered_uart_unittest {
+namespace {
+
+class BufferedUartTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    fifo.clear();
+    // The TX FIFO starts out full, so that nothing leaves the ring until a
+    // test makes room.
+    fifo_room = 0;
+    irqs_enabled = true;
+  }
+
+  void Init(buffered_uart_overflow_t overflow) {
+    ASSERT_TRUE(buffered_uart_init(&uart_, ring_, sizeof(ring_), overflow,
+                                   &buffered_uart_));
+  }
+
+  size_t Write(const std::string &str) {
+    buffer_sink_t sink = buffered_uart_sink(&buffered_uart_);
+    size_t written = sink.sink(sink.data, str.data(), str.size());
+    EXPECT_TRUE(irqs_enabled);
+    return written;
+  }
+
+  // Makes room in the TX FIFO and runs the TX watermark handler, which runs
+  // with interrupts masked like on trap entry.
+  std::string Drain() {
+    fifo_room = sizeof(ring_);
+    irqs_enabled = false;
+    buffered_uart_irq_service(&buffered_uart_);
+    irqs_enabled = true;
+    return fifo;
+  }
+
+  dif_uart_t uart_ = {};
+  char ring_[16];
+  buffered_uart_t buffered_uart_;
+};
+
+TEST_F(BufferedUartTest, InitRejectsBadSize) {
+  EXPECT_FALSE(buffered_uart_init(&uart_, ring_, 12, kBufferedUartOverflowDrop,
+                                  &buffered_uart_));
+  EXPECT_FALSE(buffered_uart_init(&uart_, ring_, 0, kBufferedUartOverflowDrop,
+                                  &buffered_uart_));
+}
+
+TEST_F(BufferedUartTest, PrimesFifo) {
+  Init(kBufferedUartOverflowDrop);
+  fifo_room = 4;
+  EXPECT_EQ(Write("0123456789"), 10);
+  EXPECT_EQ(fifo, "0123");
+  EXPECT_EQ(Drain(), "0123456789");
+}
+
+TEST_F(BufferedUartTest, Block) {
+  Init(kBufferedUartOverflowBlock);
+  fifo_room = 4;
+  EXPECT_EQ(Write("0123456789abcdefghij"), 20);
+  EXPECT_EQ(fifo, "0123");
+  EXPECT_EQ(buffered_uart_.dropped, 0);
+  EXPECT_EQ(Drain(), "0123456789abcdefghij");
+}
+
+TEST_F(BufferedUartTest, Drop) {
+  Init(kBufferedUartOverflowDrop);
+  EXPECT_EQ(Write("0123456789"), 10);
+  EXPECT_EQ(Write("abcdefghij"), 6);
+  EXPECT_EQ(buffered_uart_.dropped, 4);
+
+  // The ring is full, so nothing more gets in.
+  EXPECT_EQ(Write("klm"), 0);
+  EXPECT_EQ(buffered_uart_.dropped, 7);
+
+  EXPECT_EQ(Drain(), "0123456789abcdef");
+}
+
+TEST_F(BufferedUartTest, DropOldest) {
+  Init(kBufferedUartOverflowDropOldest);
+  EXPECT_EQ(Write("0123456789"), 10);
+  EXPECT_EQ(Write("abcdefghij"), 10);
+  EXPECT_EQ(buffered_uart_.dropped, 4);
+  EXPECT_EQ(Drain(), "456789abcdefghij");
+}
+
+TEST_F(BufferedUartTest, DropOldestLongWrite) {
+  Init(kBufferedUartOverflowDropOldest);
+  EXPECT_EQ(Write("0123"), 4);
+
+  // Only the end of a write longer than the ring survives.
+  EXPECT_EQ(Write("0123456789abcdefghij"), 20);
+  EXPECT_EQ(buffered_uart_.dropped, 8);
+  EXPECT_EQ(Drain(), "456789abcdefghij");
+}
+
+TEST_F(BufferedUartTest, Flush) {
+  Init(kBufferedUartOverflowDrop);
+  EXPECT_EQ(Write("0123456789"), 10);
+  // The last byte is sent polled, regardless of room in the FIFO.
+  fifo_room = 9;
+  buffered_uart_flush(&buffered_uart_);
+  EXPECT_TRUE(irqs_enabled);
+  EXPECT_EQ(fifo, "0123456789");
+  EXPECT_EQ(buffered_uart_.head, buffered_uart_.tail);
+}
+
+}  // namespace
+}  // namespace buffered_uart_unittest
@@ -0,0 +1,83 @@
+// Copyright lowRISC contributors.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Host-side throughput benchmark for `base_vfprintf()`.
+//
+// Reports the time per call and the number of sink calls per call for a few
+// representative format strings. The sink call count is what dominates on the
+// device, where every sink call is a UART write.
+
+extern "C" {
+#include "sw/device/lib/runtime/print.h"
+}  // extern "C"
+
+#include <stdint.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "sw/device/lib/dif/dif_uart.h"
+
+// NOTE: This is only present so that print.c can link without pulling in
+// dif_uart.c.
+extern "C" dif_uart_result_t dif_uart_byte_send_polled(const dif_uart *,
+                                                       uint8_t) {
+  return kDifUartOk;
+}
+
+namespace base {
+namespace {
+
+constexpr int kIterations = 1000000;
+
+struct CountingSink {
+  size_t calls = 0;
+  size_t bytes = 0;
+};
+
+size_t CountingSinkWrite(void *data, const char *buf, size_t len) {
+  auto *sink = static_cast<CountingSink *>(data);
+  ++sink->calls;
+  sink->bytes += len;
+  return len;
+}
+
+template <typename... Args>
+void Benchmark(const std::string &name, const char *format, Args... args) {
+  CountingSink counts;
+  buffer_sink_t out = {/*data=*/&counts, /*sink=*/&CountingSinkWrite};
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; ++i) {
+    base_fprintf(out, format, args...);
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  double ns =
+      std::chrono::duration<double, std::nano>(end - start).count() /
+      kIterations;
+  std::cout << name << ": " << ns << " ns/call, "
+            << static_cast<double>(counts.calls) / kIterations
+            << " sink calls/call, "
+            << static_cast<double>(counts.bytes) / kIterations
+            << " bytes/call" << std::endl;
+}
+
+}  // namespace
+}  // namespace base
+
+int main(int argc, char **argv) {
+  base::Benchmark("literal", "Hello, World!\r\n");
+  base::Benchmark("hex", "0x%x", 0xdeadbeef);
+  base::Benchmark("hex_width", "0x%08x", 0x1234);
+  base::Benchmark("decimal", "%d", -1234567890);
+  base::Benchmark("unsigned", "%u", 4294967295u);
+  base::Benchmark("binary", "%32b", 0xa5a5a5a5);
+  base::Benchmark("string", "%s", "a moderately long string argument");
+  base::Benchmark("log_line",
+                  "%s%5d %s:%d] Log line %d of %d, value 0x%08x\r\n", "I", 42,
+                  "print_benchmark.cc", 123, 7, 8, 0xdeadbeef);
+  return 0;
+}
@@ -0,0 +1,507 @@
+/* Copyright lowRISC contributors. */
+/* Licensed under the Apache License, Version 2.0, see LICENSE for details. */
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Karatsuba multiplication and squaring of 512 and 1024 bit bignums
+ *
+ * A product of two 2n bit numbers a = a1*2^n + a0 and b = b1*2^n + b0 is
+ * computed from the three n bit products
+ *   L = a0*b0, H = a1*b1, M = (a0+a1)*(b0+b1)
+ * as a*b = H*2^(2n) + (M-L-H)*2^n + L. The sums a0+a1 and b0+b1 have n+1 bits;
+ * their carry bits are handled by a constant-time correction of M, so that
+ * the n bit products can be computed with the same kernel. A square needs the
+ * products a0*a0, a1*a1 and a0*a1 only, and doubles the latter.
+ *
+ * The 256x256 bit base case is the bn.mulqacc schoolbook multiplication of
+ * mul256.s, inlined into the 512 bit kernels. All routines run in constant
+ * time.
+ */
+
+.text
+.globl mul512
+.globl sqr512
+.globl mul1024
+.globl sqr1024
+
+/**
+ * 512x512 bit Karatsuba multiplication in registers
+ *
+ * Returns: [w21, w20, w19, w18] = [w15, w14] * [w17, w16]
+ *
+ * Flags: The state of FG0 depends on the operands and is not usable after
+ *        return.
+ *
+ * @param[in]  [w15, w14]: a = a1*2^256 + a0
+ * @param[in]  [w17, w16]: b = b1*2^256 + b0
+ * @param[in]  w31: all-zero
+ * @param[out] [w21, w20, w19, w18]: a*b
+ *
+ * clobbered registers: w10 to w13, w18 to w26
+ * clobbered Flag Groups: FG0
+ */
+mul512_kara:
+  /* L = a0*b0: [w19, w18] = w14*w16 */
+  bn.mulqacc.z          w14.0, w16.0,  0
+  bn.mulqacc            w14.1, w16.0, 64
+  bn.mulqacc.so  w18.L, w14.0, w16.1, 64
+  bn.mulqacc            w14.2, w16.0,  0
+  bn.mulqacc            w14.1, w16.1,  0
+  bn.mulqacc            w14.0, w16.2,  0
+  bn.mulqacc            w14.3, w16.0, 64
+  bn.mulqacc            w14.2, w16.1, 64
+  bn.mulqacc            w14.1, w16.2, 64
+  bn.mulqacc.so  w18.U, w14.0, w16.3, 64
+  bn.mulqacc            w14.3, w16.1,  0
+  bn.mulqacc            w14.2, w16.2,  0
+  bn.mulqacc            w14.1, w16.3,  0
+  bn.mulqacc            w14.3, w16.2, 64
+  bn.mulqacc.so  w19.L, w14.2, w16.3, 64
+  bn.mulqacc.so  w19.U, w14.3, w16.3,  0
+
+  /* H = a1*b1: [w21, w20] = w15*w17 */
+  bn.mulqacc.z          w15.0, w17.0,  0
+  bn.mulqacc            w15.1, w17.0, 64
+  bn.mulqacc.so  w20.L, w15.0, w17.1, 64
+  bn.mulqacc            w15.2, w17.0,  0
+  bn.mulqacc            w15.1, w17.1,  0
+  bn.mulqacc            w15.0, w17.2,  0
+  bn.mulqacc            w15.3, w17.0, 64
+  bn.mulqacc            w15.2, w17.1, 64
+  bn.mulqacc            w15.1, w17.2, 64
+  bn.mulqacc.so  w20.U, w15.0, w17.3, 64
+  bn.mulqacc            w15.3, w17.1,  0
+  bn.mulqacc            w15.2, w17.2,  0
+  bn.mulqacc            w15.1, w17.3,  0
+  bn.mulqacc            w15.3, w17.2, 64
+  bn.mulqacc.so  w21.L, w15.2, w17.3, 64
+  bn.mulqacc.so  w21.U, w15.3, w17.3,  0
+
+  /* [w22, w10] = a0+a1, [w23, w11] = b0+b1 */
+  bn.add    w10, w14, w15
+  bn.addc   w22, w31, w31
+  bn.add    w11, w16, w17
+  bn.addc   w23, w31, w31
+
+  /* corrections for the carry bits of the sums:
+     w24 = carry(a0+a1) ? (b0+b1) mod 2^256 : 0
+     w25 = carry(b0+b1) ? (a0+a1) mod 2^256 : 0
+     w26 = carry(a0+a1) & carry(b0+b1) */
+  bn.sub    w24, w31, w22
+  bn.and    w24, w24, w11
+  bn.sub    w25, w31, w23
+  bn.and    w25, w25, w10
+  bn.and    w26, w22, w23
+
+  /* M = (a0+a1)*(b0+b1):
+     [w26, w13, w12] = w10*w11 + (w24+w25)*2^256 + w26*2^512 */
+  bn.mulqacc.z          w10.0, w11.0,  0
+  bn.mulqacc            w10.1, w11.0, 64
+  bn.mulqacc.so  w12.L, w10.0, w11.1, 64
+  bn.mulqacc            w10.2, w11.0,  0
+  bn.mulqacc            w10.1, w11.1,  0
+  bn.mulqacc            w10.0, w11.2,  0
+  bn.mulqacc            w10.3, w11.0, 64
+  bn.mulqacc            w10.2, w11.1, 64
+  bn.mulqacc            w10.1, w11.2, 64
+  bn.mulqacc.so  w12.U, w10.0, w11.3, 64
+  bn.mulqacc            w10.3, w11.1,  0
+  bn.mulqacc            w10.2, w11.2,  0
+  bn.mulqacc            w10.1, w11.3,  0
+  bn.mulqacc            w10.3, w11.2, 64
+  bn.mulqacc.so  w13.L, w10.2, w11.3, 64
+  bn.mulqacc.so  w13.U, w10.3, w11.3,  0
+  bn.add    w13, w13, w24
+  bn.addc   w26, w26, w31
+  bn.add    w13, w13, w25
+  bn.addc   w26, w26, w31
+
+  /* [w26, w13, w12] = M-L-H = a0*b1 + a1*b0 */
+  bn.sub    w12, w12, w18
+  bn.subb   w13, w13, w19
+  bn.subb   w26, w26, w31
+  bn.sub    w12, w12, w20
+  bn.subb   w13, w13, w21
+  bn.subb   w26, w26, w31
+
+  /* a*b = H*2^512 + (M-L-H)*2^256 + L */
+  bn.add    w19, w19, w12
+  bn.addc   w20, w20, w13
+  bn.addc   w21, w21, w26
+
+  ret
+
+
+/**
+ * 512 bit squaring in registers
+ *
+ * Returns: [w21, w20, w19, w18] = [w15, w14]^2
+ *
+ * Flags: The state of FG0 depends on the operand and is not usable after
+ *        return.
+ *
+ * @param[in]  [w15, w14]: a = a1*2^256 + a0
+ * @param[in]  w31: all-zero
+ * @param[out] [w21, w20, w19, w18]: a^2
+ *
+ * clobbered registers: w12, w13, w18 to w22
+ * clobbered Flag Groups: FG0
+ */
+sqr512_kara:
+  /* L = a0^2: [w19, w18] = w14*w14 */
+  bn.mulqacc.z          w14.0, w14.0,  0
+  bn.mulqacc            w14.1, w14.0, 64
+  bn.mulqacc.so  w18.L, w14.0, w14.1, 64
+  bn.mulqacc            w14.2, w14.0,  0
+  bn.mulqacc            w14.1, w14.1,  0
+  bn.mulqacc            w14.0, w14.2,  0
+  bn.mulqacc            w14.3, w14.0, 64
+  bn.mulqacc            w14.2, w14.1, 64
+  bn.mulqacc            w14.1, w14.2, 64
+  bn.mulqacc.so  w18.U, w14.0, w14.3, 64
+  bn.mulqacc            w14.3, w14.1,  0
+  bn.mulqacc            w14.2, w14.2,  0
+  bn.mulqacc            w14.1, w14.3,  0
+  bn.mulqacc            w14.3, w14.2, 64
+  bn.mulqacc.so  w19.L, w14.2, w14.3, 64
+  bn.mulqacc.so  w19.U, w14.3, w14.3,  0
+
+  /* H = a1^2: [w21, w20] = w15*w15 */
+  bn.mulqacc.z          w15.0, w15.0,  0
+  bn.mulqacc            w15.1, w15.0, 64
+  bn.mulqacc.so  w20.L, w15.0, w15.1, 64
+  bn.mulqacc            w15.2, w15.0,  0
+  bn.mulqacc            w15.1, w15.1,  0
+  bn.mulqacc            w15.0, w15.2,  0
+  bn.mulqacc            w15.3, w15.0, 64
+  bn.mulqacc            w15.2, w15.1, 64
+  bn.mulqacc            w15.1, w15.2, 64
+  bn.mulqacc.so  w20.U, w15.0, w15.3, 64
+  bn.mulqacc            w15.3, w15.1,  0
+  bn.mulqacc            w15.2, w15.2,  0
+  bn.mulqacc            w15.1, w15.3,  0
+  bn.mulqacc            w15.3, w15.2, 64
+  bn.mulqacc.so  w21.L, w15.2, w15.3, 64
+  bn.mulqacc.so  w21.U, w15.3, w15.3,  0
+
+  /* [w22, w13, w12] = 2*a0*a1 */
+  bn.mulqacc.z          w14.0, w15.0,  0
+  bn.mulqacc            w14.1, w15.0, 64
+  bn.mulqacc.so  w12.L, w14.0, w15.1, 64
+  bn.mulqacc            w14.2, w15.0,  0
+  bn.mulqacc            w14.1, w15.1,  0
+  bn.mulqacc            w14.0, w15.2,  0
+  bn.mulqacc            w14.3, w15.0, 64
+  bn.mulqacc            w14.2, w15.1, 64
+  bn.mulqacc            w14.1, w15.2, 64
+  bn.mulqacc.so  w12.U, w14.0, w15.3, 64
+  bn.mulqacc            w14.3, w15.1,  0
+  bn.mulqacc            w14.2, w15.2,  0
+  bn.mulqacc            w14.1, w15.3,  0
+  bn.mulqacc            w14.3, w15.2, 64
+  bn.mulqacc.so  w13.L, w14.2, w15.3, 64
+  bn.mulqacc.so  w13.U, w14.3, w15.3,  0
+  bn.add    w12, w12, w12
+  bn.addc   w13, w13, w13
+  bn.addc   w22, w31, w31
+
+  /* a^2 = H*2^512 + 2*a0*a1*2^256 + L */
+  bn.add    w19, w19, w12
+  bn.addc   w20, w20, w13
+  bn.addc   w21, w21, w22
+
+  ret
+
+
+/**
+ * 512x512 bit multiplication
+ *
+ * Returns: R = A * B
+ *
+ * One level of Karatsuba over 256x256 bit bn.mulqacc multiplications.
+ *
+ * Flags: The state of FG0 depends on the operands and is not usable after
+ *        return.
+ *
+ * @param[in]  x10: dptr_a, dmem pointer to first limb of A (2 limbs)
+ * @param[in]  x11: dptr_b, dmem pointer to first limb of B (2 limbs)
+ * @param[in]  x12: dptr_r, dmem pointer to first limb of R (4 limbs)
+ * @param[out] [dmem[x12+127]:dmem[x12]]: R
+ *
+ * clobbered registers: x2, w10 to w26, w31
+ * clobbered Flag Groups: FG0
+ */
+mul512:
+  /* prepare all-zero reg */
+  bn.xor    w31, w31, w31
+
+  /* load operands to [w15, w14] and [w17, w16] */
+  li        x2, 14
+  bn.lid    x2++, 0(x10)
+  bn.lid    x2++, 32(x10)
+  bn.lid    x2++, 0(x11)
+  bn.lid    x2, 32(x11)
+
+  jal       x1, mul512_kara
+
+  /* store result from [w21, w20, w19, w18] */
+  li        x2, 18
+  bn.sid    x2++, 0(x12)
+  bn.sid    x2++, 32(x12)
+  bn.sid    x2++, 64(x12)
+  bn.sid    x2, 96(x12)
+
+  ret
+
+
+/**
+ * 512 bit squaring
+ *
+ * Returns: R = A^2
+ *
+ * Flags: The state of FG0 depends on the operand and is not usable after
+ *        return.
+ *
+ * @param[in]  x10: dptr_a, dmem pointer to first limb of A (2 limbs)
+ * @param[in]  x12: dptr_r, dmem pointer to first limb of R (4 limbs)
+ * @param[out] [dmem[x12+127]:dmem[x12]]: R
+ *
+ * clobbered registers: x2, w12 to w22, w31
+ * clobbered Flag Groups: FG0
+ */
+sqr512:
+  /* prepare all-zero reg */
+  bn.xor    w31, w31, w31
+
+  /* load operand to [w15, w14] */
+  li        x2, 14
+  bn.lid    x2++, 0(x10)
+  bn.lid    x2, 32(x10)
+
+  jal       x1, sqr512_kara
+
+  /* store result from [w21, w20, w19, w18] */
+  li        x2, 18
+  bn.sid    x2++, 0(x12)
+  bn.sid    x2++, 32(x12)
+  bn.sid    x2++, 64(x12)
+  bn.sid    x2, 96(x12)
+
+  ret
+
+
+/**
+ * 1024x1024 bit multiplication
+ *
+ * Returns: R = A * B
+ *
+ * One level of Karatsuba over the 512x512 bit Karatsuba multiplication, i.e.
+ * 9 instead of 16 256x256 bit multiplications. The lower and upper products
+ * are written to R directly, the middle term is added in place.
+ *
+ * Flags: The state of FG0 depends on the operands and is not usable after
+ *        return.
+ *
+ * @param[in]  x10: dptr_a, dmem pointer to first limb of A (4 limbs)
+ * @param[in]  x11: dptr_b, dmem pointer to first limb of B (4 limbs)
+ * @param[in]  x12: dptr_r, dmem pointer to first limb of R (8 limbs)
+ * @param[out] [dmem[x12+255]:dmem[x12]]: R
+ *
+ * clobbered registers: x2, w10 to w31
+ * clobbered Flag Groups: FG0
+ */
+mul1024:
+  /* prepare all-zero reg */
+  bn.xor    w31, w31, w31
+
+  /* L = A0*B0, store to R[3:0] */
+  li        x2, 14
+  bn.lid    x2++, 0(x10)
+  bn.lid    x2++, 32(x10)
+  bn.lid    x2++, 0(x11)
+  bn.lid    x2, 32(x11)
+  jal       x1, mul512_kara
+  li        x2, 18
+  bn.sid    x2++, 0(x12)
+  bn.sid    x2++, 32(x12)
+  bn.sid    x2++, 64(x12)
+  bn.sid    x2, 96(x12)
+
+  /* H = A1*B1, store to R[7:4] */
+  li        x2, 14
+  bn.lid    x2++, 64(x10)
+  bn.lid    x2++, 96(x10)
+  bn.lid    x2++, 64(x11)
+  bn.lid    x2, 96(x11)
+  jal       x1, mul512_kara
+  li        x2, 18
+  bn.sid    x2++, 128(x12)
+  bn.sid    x2++, 160(x12)
+  bn.sid    x2++, 192(x12)
+  bn.sid    x2, 224(x12)
+
+  /* [w27, w15, w14] = A0+A1, [w28, w17, w16] = B0+B1 */
+  li        x2, 10
+  bn.lid    x2++, 64(x10)
+  bn.lid    x2++, 96(x10)
+  bn.lid    x2++, 64(x11)
+  bn.lid    x2++, 96(x11)
+  bn.lid    x2++, 0(x10)
+  bn.lid    x2++, 32(x10)
+  bn.lid    x2++, 0(x11)
+  bn.lid    x2, 32(x11)
+  bn.add    w14, w14, w10
+  bn.addc   w15, w15, w11
+  bn.addc   w27, w31, w31
+  bn.add    w16, w16, w12
+  bn.addc   w17, w17, w13
+  bn.addc   w28, w31, w31
+
+  /* M = (A0+A1)*(B0+B1), in [w26, w21, w20, w19, w18] */
+  jal       x1, mul512_kara
+  bn.and    w26, w27, w28
+
+  /* add carry(A0+A1) ? (B0+B1) mod 2^512 : 0 to the upper half of M */
+  bn.sub    w29, w31, w27
+  bn.and    w10, w29, w16
+  bn.and    w11, w29, w17
+  bn.add    w20, w20, w10
+  bn.addc   w21, w21, w11
+  bn.addc   w26, w26, w31
+
+  /* add carry(B0+B1) ? (A0+A1) mod 2^512 : 0 to the upper half of M */
+  bn.sub    w30, w31, w28
+  bn.and    w10, w30, w14
+  bn.and    w11, w30, w15
+  bn.add    w20, w20, w10
+  bn.addc   w21, w21, w11
+  bn.addc   w26, w26, w31
+
+  /* M = M-L-H = A0*B1 + A1*B0 */
+  li        x2, 10
+  bn.lid    x2, 0(x12)
+  bn.sub    w18, w18, w10
+  bn.lid    x2, 32(x12)
+  bn.subb   w19, w19, w10
+  bn.lid    x2, 64(x12)
+  bn.subb   w20, w20, w10
+  bn.lid    x2, 96(x12)
+  bn.subb   w21, w21, w10
+  bn.subb   w26, w26, w31
+  bn.lid    x2, 128(x12)
+  bn.sub    w18, w18, w10
+  bn.lid    x2, 160(x12)
+  bn.subb   w19, w19, w10
+  bn.lid    x2, 192(x12)
+  bn.subb   w20, w20, w10
+  bn.lid    x2, 224(x12)
+  bn.subb   w21, w21, w10
+  bn.subb   w26, w26, w31
+
+  /* R = R + M*2^512 */
+  jal       x1, add_mid1024
+
+  ret
+
+
+/**
+ * 1024 bit squaring
+ *
+ * Returns: R = A^2
+ *
+ * Squares the halves of A with sqr512_kara and computes the doubled cross
+ * product with mul512_kara, i.e. 9 instead of 16 256x256 bit multiplications.
+ *
+ * Flags: The state of FG0 depends on the operand and is not usable after
+ *        return.
+ *
+ * @param[in]  x10: dptr_a, dmem pointer to first limb of A (4 limbs)
+ * @param[in]  x12: dptr_r, dmem pointer to first limb of R (8 limbs)
+ * @param[out] [dmem[x12+255]:dmem[x12]]: R
+ *
+ * clobbered registers: x2, w10 to w26, w31
+ * clobbered Flag Groups: FG0
+ */
+sqr1024:
+  /* prepare all-zero reg */
+  bn.xor    w31, w31, w31
+
+  /* L = A0^2, store to R[3:0] */
+  li        x2, 14
+  bn.lid    x2++, 0(x10)
+  bn.lid    x2, 32(x10)
+  jal       x1, sqr512_kara
+  li        x2, 18
+  bn.sid    x2++, 0(x12)
+  bn.sid    x2++, 32(x12)
+  bn.sid    x2++, 64(x12)
+  bn.sid    x2, 96(x12)
+
+  /* H = A1^2, store to R[7:4] */
+  li        x2, 14
+  bn.lid    x2++, 64(x10)
+  bn.lid    x2, 96(x10)
+  jal       x1, sqr512_kara
+  li        x2, 18
+  bn.sid    x2++, 128(x12)
+  bn.sid    x2++, 160(x12)
+  bn.sid    x2++, 192(x12)
+  bn.sid    x2, 224(x12)
+
+  /* 2*A0*A1, in [w26, w21, w20, w19, w18] */
+  li        x2, 14
+  bn.lid    x2++, 0(x10)
+  bn.lid    x2++, 32(x10)
+  bn.lid    x2++, 64(x10)
+  bn.lid    x2, 96(x10)
+  jal       x1, mul512_kara
+  bn.add    w18, w18, w18
+  bn.addc   w19, w19, w19
+  bn.addc   w20, w20, w20
+  bn.addc   w21, w21, w21
+  bn.addc   w26, w31, w31
+
+  /* R = R + 2*A0*A1*2^512 */
+  jal       x1, add_mid1024
+
+  ret
+
+
+/**
+ * Add the middle term of a 1024 bit Karatsuba product
+ *
+ * Returns: R = R + M*2^512
+ *
+ * Flags: The state of FG0 depends on the operands and is not usable after
+ *        return.
+ *
+ * @param[in]  x12: dptr_r, dmem pointer to first limb of R (8 limbs)
+ * @param[in]  [w26, w21, w20, w19, w18]: M
+ * @param[in]  w31: all-zero
+ * @param[out] [dmem[x12+255]:dmem[x12]]: R
+ *
+ * clobbered registers: x2, w10
+ * clobbered Flag Groups: FG0
+ */
+add_mid1024:
+  li        x2, 10
+  bn.lid    x2, 64(x12)
+  bn.add    w10, w10, w18
+  bn.sid    x2, 64(x12)
+  bn.lid    x2, 96(x12)
+  bn.addc   w10, w10, w19
+  bn.sid    x2, 96(x12)
+  bn.lid    x2, 128(x12)
+  bn.addc   w10, w10, w20
+  bn.sid    x2, 128(x12)
+  bn.lid    x2, 160(x12)
+  bn.addc   w10, w10, w21
+  bn.sid    x2, 160(x12)
+  bn.lid    x2, 192(x12)
+  bn.addc   w10, w10, w26
+  bn.sid    x2, 192(x12)
+  bn.lid    x2, 224(x12)
+  bn.addc   w10, w10, w31
+  bn.sid    x2, 224(x12)
+
+  ret
@@ -11,6 +11,7 @@
 .text
 .globl modexp_65537
 .globl modexp
+.globl modexp_window
 .globl modload
 
 /**
@@ -945,6 +946,314 @@ modexp:
   ret
 
 
+/**
+ * Constant-time table lookup for fixed-window exponentiation
+ *
+ * Returns: S = T[idx], with T[0] = -M (i.e. 1 in the Montgomery domain)
+ *
+ * Every table entry is loaded and passed through bn.sel, such that the
+ * memory access pattern and the instruction trace do not depend on idx.
+ * T[0] is not stored in the table but written to the selection buffer before
+ * the table scan.
+ *
+ * Flags: The state of FG0 depends on idx and is not usable after return.
+ *
+ * @param[in]  x16: dptr_M, dmem pointer to first limb of modulus M
+ * @param[in]  x14: dptr_s, dmem pointer to first limb of selection buffer S
+ * @param[in]  x23: number of stored table entries, 2^k-1
+ * @param[in]  dmem[20] dptr_in: pointer to table entry T[1], followed by the
+ *                               entries T[2] to T[2^k-1]
+ * @param[in]  w21: idx, table index
+ * @param[in]  w31: all-zero
+ * @param[in]  x30: N, number of limbs
+ * @param[in]  x9: pointer to temp reg, must be set to 3
+ * @param[in]  x11: pointer to temp reg, must be set to 2
+ * @param[out] [dmem[x14+N*32-1]:dmem[x14]]: selected table entry S
+ *
+ * clobbered registers: x20, x21, w2, w3, w22
+ * clobbered Flag Groups: FG0
+ */
+sel_window_entry:
+  /* zeroize w2 and reset flags */
+  bn.sub    w2, w2, w2
+
+  /* initialize the selection buffer with T[0] = -M */
+  addi      x20, x16, 0
+  addi      x21, x14, 0
+  loop      x30, 3
+    bn.lid    x11, 0(x20++)
+    bn.subb   w2, w31, w2
+    bn.sid    x11, 0(x21++)
+
+  /* w22 = 1, index of the current table entry */
+  bn.xor    w22, w22, w22
+  bn.addi   w22, w22, 1
+
+  /* iterate over all stored table entries, the entries are contiguous, so
+     x20 is only incremented */
+  lw        x20, 20(x0)
+  loop      x23, 8
+    /* FG0.Z = (idx == current index) */
+    bn.cmp    w21, w22
+
+    addi      x21, x14, 0
+    loop      x30, 4
+      /* load limb of table entry to w3 and limb of selection buffer to w2 */
+      bn.lid    x9, 0(x20++)
+      bn.lid    x11, 0(x21)
+
+      /* conditional select: w2 = FG0.Z?T[j][i]:S[i] */
+      bn.sel    w2, w3, w2, Z
+
+      bn.sid    x11, 0(x21++)
+
+    bn.addi   w22, w22, 1
+
+  ret
+
+
+/**
+ * Process one window of the exponent
+ *
+ * Returns: C = C^(2^b) * T[idx] mod M, with idx the b most significant bits
+ *          of the exponent buffer.
+ *
+ * The window bits are shifted out of the exponent buffer, one bit at a time,
+ * into w21. The same number of squarings and one multiplication are carried
+ * out independent of the window bits.
+ *
+ * Flags: The states of both FG0 and FG1 depend on intermediate values and are
+ *        not usable after return.
+ *
+ * @param[in]  x15: b, number of bits in this window
+ * @param[in]  x14: dptr_s, dmem pointer to the selection buffer
+ * @param[in]  x23: number of stored table entries, 2^k-1
+ * @param[in]  x16: dptr_M, dmem pointer to first limb of modulus M
+ * @param[in]  x17: dptr_m0d, dmem pointer to Montgomery Constant m0'
+ * @param[in]  dmem[20] dptr_in: pointer to the window table
+ * @param[in]  dmem[24] dptr_exp: pointer to exp buffer
+ * @param[in]  dmem[28] dptr_out: pointer to output/result buffer C
+ * @param[in]  w31: all-zero
+ * @param[in]  x30: N, number of limbs
+ * @param[in]  x31: N-1, number of limbs minus one
+ * @param[in]  x9: pointer to temp reg, must be set to 3
+ * @param[in]  x10: pointer to temp reg, must be set to 4
+ * @param[in]  x11: pointer to temp reg, must be set to 2
+ *
+ * clobbered registers: x5 to x8, x10, x12, x13, x19 to x22
+ *                      w2, w3, w21, w22, w24 to w30, w4 to w[4+N-1]
+ * clobbered Flag Groups: FG0, FG1
+ */
+sqr_and_mul_window:
+  /* square b times: out = montmul(out,out) */
+  loop      x15, 8
+    lw        x19, 28(x0)
+    lw        x20, 28(x0)
+    lw        x21, 28(x0)
+    jal       x1, montmul
+    /* Store result in dmem starting at dmem[dptr_c] */
+    loop      x30, 2
+      bn.sid    x8, 0(x21++)
+      addi      x8, x8, 1
+    nop
+
+  /* shift the b most significant exponent bits into w21 */
+  bn.xor    w21, w21, w21
+  loop      x15, 7
+    /* zeroize w2 and reset flags */
+    bn.sub    w2, w2, w2
+
+    /* 1-bit left shift of the exponent, the MSB moves to FG0.C */
+    lw        x20, 24(x0)
+    loop      x30, 3
+      bn.lid    x11, 0(x20)
+      bn.addc   w2, w2, w2
+      bn.sid    x11, 0(x20++)
+
+    /* w21 <= w21 << 1 | FG0.C */
+    bn.addc   w21, w21, w21
+
+  /* S = T[idx] */
+  jal       x1, sel_window_entry
+
+  /* multiply: out = montmul(S,out) */
+  addi      x19, x14, 0
+  lw        x20, 28(x0)
+  lw        x21, 28(x0)
+  jal       x1, montmul
+  /* Store result in dmem starting at dmem[dptr_c] */
+  loop      x30, 2
+    bn.sid    x8, 0(x21++)
+    addi      x8, x8, 1
+
+  ret
+
+
+/**
+ * Constant-time bigint modular exponentiation with a fixed window
+ *
+ * Returns: C = modexp(A,E) = A^E mod M
+ *
+ * This implements left-to-right fixed-window exponentiation with a window
+ * width of k bits. The table T[i] = A^i*R mod M (i = 1 to 2^k-1) is computed
+ * once, afterwards each window of the exponent costs k squarings and one
+ * multiplication with a table entry, instead of k squarings and k
+ * multiplications for modexp. Each table lookup scans the full table (see
+ * sel_window_entry), and a window of all zeros is multiplied with T[0], so
+ * the instruction trace and the memory access pattern only depend on N and k.
+ * If k does not divide the bit length of the exponent, the first window is
+ * shorter.
+ *
+ * Computation is carried out in the Montgomery domain, by using the montmul
+ * primitive. The squared Montgomery modulus RR and the Montgomery constant
+ * m0' have to be precomputed and provided at the appropriate locations in
+ * dmem.
+ *
+ * The table is stored in place of the input buffer, which needs to provide
+ * space for 2^k bignums: The entries T[1] to T[2^k-1] followed by a buffer
+ * for the selected entry.
+ *
+ * Flags: The states of both FG0 and FG1 depend on intermediate values and are
+ *        not usable after return.
+ *
+ * The base bignum A is expected in the input buffer, the exponent E in the
+ * exp buffer, the result C is written to the output buffer.
+ * Note, that the content of both, the input buffer and the exp buffer is
+ * modified during execution.
+ *
+ * @param[in]  dmem[0] k: window width in bits, 1 to 5
+ * @param[in]  dmem[4] N: Number of limbs per bignum
+ * @param[in]  dmem[8] dptr_m0d: pointer to m0' in dmem
+ * @param[in]  dmem[12] dptr_rr: pointer to RR in dmem
+ * @param[in]  dmem[16] dptr_m: pointer to first limb of modulus in dmem
+ * @param[in]  dmem[20] dptr_in: pointer to input/base buffer of 2^k*N limbs
+ * @param[in]  dmem[24] dptr_exp: pointer to exp buffer
+ * @param[in]  dmem[28] dptr_out: pointer to output/result buffer
+ *
+ * clobbered registers: x2 to x8, x10 to x24, x30, x31
+ *                      w2, w3, w21, w22, w24 to w30
+ *                      w4 to w[4+N-1]
+ * clobbered Flag Groups: FG0, FG1
+ */
+modexp_window:
+  /* prepare pointers to temp regs */
+  li         x8, 4
+  li         x9, 3
+  li        x10, 4
+  li        x11, 2
+
+  /* load pointer to modulus */
+  lw        x16, 16(x0)
+
+  /* load pointer to m0' */
+  lw        x17, 8(x0)
+
+  /* load number of limbs */
+  lw        x30, 4(x0)
+  addi      x31, x30, -1
+
+  /* load window width k and compute number of stored table entries:
+     x23 = 2^k-1 */
+  lw         x2, 0(x0)
+  li        x23, 1
+  sll       x23, x23, x2
+  addi      x23, x23, -1
+
+  /* size of a bignum in bytes: x4 = N*32 */
+  slli       x4, x30, 5
+
+  /* pointer to the selection buffer behind the table:
+     x14 = dptr_in + (2^k-1)*N*32 */
+  sll       x14, x4, x2
+  sub       x14, x14, x4
+  lw        x13, 20(x0)
+  add       x14, x14, x13
+
+  /* convert to montgomery domain montmul(A,RR)
+  T[1] = in = montmul(A,RR) = A*R mod M */
+  lw        x19, 20(x0)
+  lw        x20, 12(x0)
+  lw        x21, 20(x0)
+  jal       x1, montmul
+  /* Store result in dmem starting at dmem[dptr_c] */
+  loop      x30, 2
+    bn.sid    x8, 0(x21++)
+    addi      x8, x8, 1
+
+  /* compute T[j] = montmul(T[j-1],T[1]) for j = 2 to 2^k-1, after the
+     store loop x21 points to T[j] */
+  addi       x3, x23, -1
+  beq        x3, x0, modexp_window_table_done
+  lw        x24, 20(x0)
+  loop       x3, 8
+    addi      x20, x24, 0
+    lw        x19, 20(x0)
+    jal       x1, montmul
+    /* x24 = pointer to T[j] */
+    addi      x24, x21, 0
+    loop      x30, 2
+      bn.sid    x8, 0(x21++)
+      addi      x8, x8, 1
+    nop
+
+modexp_window_table_done:
+  /* zeroize w2 and reset flags */
+  bn.sub    w2, w2, w2
+
+  /* initialize the output buffer with -M */
+  lw        x16, 16(x0)
+  lw        x21, 28(x0)
+  loop      x30, 3
+    /* load limb from modulus */
+    bn.lid    x11, 0(x16++)
+
+    /* subtract limb from 0 */
+    bn.subb   w2, w31, w2
+
+    /* store limb in dmem */
+    bn.sid    x11, 0(x21++)
+
+  /* reload pointer to modulus */
+  lw        x16, 16(x0)
+
+  /* split the exponent bit length N*256 into windows, such that only the
+     first window can be shorter than k bits:
+     x3 = N*256 mod k, x4 = N*256 div k */
+  slli      x24, x30, 8
+  li         x3, 0
+  li         x4, 0
+  loop      x24, 5
+    addi       x3, x3, 1
+    bne        x3, x2, modexp_window_count_next
+    li         x3, 0
+    addi       x4, x4, 1
+modexp_window_count_next:
+    nop
+
+  /* x15 = width of the first window, x4 = number of remaining windows */
+  addi      x15, x3, 0
+  bne       x15, x0, modexp_window_first
+  addi      x15, x2, 0
+  addi       x4, x4, -1
+
+modexp_window_first:
+  jal       x1, sqr_and_mul_window
+
+  /* iterate over all remaining windows */
+  addi      x15, x2, 0
+  loop       x4, 2
+    jal       x1, sqr_and_mul_window
+    nop
+
+  /* convert back from montgomery domain */
+  /* out = montmul(out,1) = out/R mod M  */
+  lw        x19, 28(x0)
+  lw        x21, 28(x0)
+  jal       x1, montmul_mul1
+
+  ret
+
+
 /**
  * Bigint modular exponentiation with fixed exponent of 65537
  *
@@ -19,6 +19,36 @@ rsa_decrypt:
   jal      x1, modexp
   ecall
 
+/**
+ * Computation of the Montgomery constants m0' and RR for the modulus
+ *
+ * Only needs to be run once per key, as long as m0d and RR are not
+ * overwritten. The *_cached entry points below expect the results.
+ */
+.globl rsa_modload
+rsa_modload:
+  jal      x1, modload
+  ecall
+
+/**
+ * RSA encryption with precomputed m0' and RR
+ */
+.globl rsa_encrypt_cached
+rsa_encrypt_cached:
+  jal      x1, modexp_65537
+  ecall
+
+/**
+ * RSA decryption with precomputed m0' and RR
+ *
+ * Uses fixed-window exponentiation, the window width is taken from
+ * window_bits. The input buffer must hold 2^window_bits bignums.
+ */
+.globl rsa_decrypt_cached
+rsa_decrypt_cached:
+  jal      x1, modexp_window
+  ecall
+
 
 .data
 
@@ -27,8 +57,10 @@ The structure of the 256b below are mandated by the calling convention of the
 RSA library.
 */
 
-/* reserved */
-.word 0x00000000
+/* Window width in bits for rsa_decrypt_cached */
+.globl window_bits
+window_bits:
+  .word 0x00000001
 
 /* Key/modulus size in 256b limbs (i.e. for RSA-1024: N = 4) */
 .globl n_limbs
@@ -63,10 +95,14 @@ dptr_out:
 
 /* Freely available DMEM space. */
 
+/* Montgomery constant m0' */
+.globl m0d
 m0d:
   /* filled by modload */
-  .zero 512
+  .zero 32
 
+/* Squared Montgomery modulus RR */
+.globl RR
 RR:
   /* filled by modload */
   .zero 512
@@ -81,12 +117,14 @@ modulus:
 exp:
   .zero 512
 
-/* input data */
-.globl in
-in:
-  .zero 512
-
 /* output data */
 .globl out
 out:
   .zero 512
+
+/* input data, followed by the window table of rsa_decrypt_cached, which
+   occupies 2^window_bits bignums including the input. Extends to the end of
+   DMEM. */
+.globl in
+in:
+  .zero 1984
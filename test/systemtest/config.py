@@ -72,6 +72,10 @@ TEST_APPS_SELFCHECKING = [
         "name": "usbdev_test",
         "targets": ["sim_verilator"],
     },
+    {
+        "name": "usbdev_stream_test",
+        "targets": ["sim_verilator"],
+    },
     # Cannot run on sim_verilator due to the differences in the top level.
     {
         "name": "dif_gpio_smoketest",
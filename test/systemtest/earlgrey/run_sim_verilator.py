@@ -0,0 +1,403 @@
+#!/usr/bin/env python3
+# Copyright lowRISC contributors.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Run the self-checking system tests on Verilator simulations in parallel
+
+This runs the same tests as test_apps_selfchecking in test_sim_verilator.py,
+but runs several simulations at once: by default, as many as there are CPUs,
+limited by the memory available for them (see --mem-per-sim).
+
+Each test gets its own simulator process and work directory. The UART output
+of the device is sent to the simulator's STDOUT, which is read as it is
+written, so a test finishes as soon as its PASSED or FAILED message appears.
+A test fails if it runs out of simulated cycles (--max-cycles) or wallclock
+time (--timeout) first.
+
+The results can be written as a JUnit XML file (for CI systems) or a JSON file,
+both of which include the simulation speed of each test.
+"""
+
+import argparse
+import json
+import logging
+import os
+import re
+import selectors
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+import xml.etree.ElementTree as ET
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+import config  # noqa: E402
+
+log = logging.getLogger(__name__)
+
+# Seconds to wait for a simulation to shut down after a SIGINT before killing
+# it. Shutting down includes writing the statistics file.
+SHUTDOWN_TIMEOUT = 10
+
+# The status messages from the sw_test_status interface. These come after a
+# prefix with the simulation time and source location (and, for failures, the
+# "%Error" prefix of $error), so search for them anywhere in a line.
+RESULT_RE = re.compile(r'==== SW TEST (PASSED|FAILED) ====$')
+# Printed by VerilatorSimCtrl when it reaches --term-after-cycles
+CYCLE_LIMIT_RE = re.compile(r'^Simulation timeout of \d+ cycles reached')
+
+
+def selfchecking_tests(bin_dir):
+    """Return the self-checking tests to run on Verilator
+
+    Returns a list of (name, elf_path, extra_sim_args) tuples.
+    """
+    tests = []
+    for app_config in config.TEST_APPS_SELFCHECKING:
+        if 'sim_verilator' not in app_config.get('targets', ['sim_verilator']):
+            continue
+
+        name = app_config['name']
+        binary_name = app_config.get('binary_name', name)
+        elf_path = (bin_dir / 'sw/device/tests' /
+                    (binary_name + '_sim_verilator.elf'))
+        tests.append((name, elf_path,
+                      app_config.get('verilator_extra_args', [])))
+    return tests
+
+
+def mem_available():
+    """Return the available memory in bytes, or None if not known"""
+    try:
+        with open('/proc/meminfo') as meminfo:
+            for line in meminfo:
+                if line.startswith('MemAvailable:'):
+                    return int(line.split()[1]) * 1024
+    except OSError:
+        pass
+    return None
+
+
+def default_jobs(mem_per_sim):
+    """Return how many simulations to run at once"""
+    jobs = os.cpu_count() or 1
+    mem = mem_available()
+    if mem is not None:
+        jobs = min(jobs, mem // mem_per_sim)
+    return max(jobs, 1)
+
+
+class SimRun:
+    """A test running on a simulator process"""
+
+    def __init__(self, name, cmd, work_dir, timeout):
+        self.name = name
+        self.work_dir = work_dir
+        self.stats_path = work_dir / 'stats.json'
+
+        self.result = None
+        self.message = ''
+        self.cycles = None
+        self.cycles_per_second = None
+
+        self._deadline = time.monotonic() + timeout
+        self._timeout = timeout
+        self._stop_requested = False
+        self._kill_at = None
+        self._cycle_limit_reached = False
+        self._partial_line = ''
+        self._log = open(str(work_dir / 'sim.log'), 'w')
+
+        # Force line-buffered output, as in utils.Process.
+        cmd = ['stdbuf', '-oL'] + cmd + ['--stats-json=' + str(self.stats_path)]
+        log.debug("%s: running %s", name, ' '.join(cmd))
+        self.start_time = time.monotonic()
+        self.proc = subprocess.Popen(cmd,
+                                     cwd=str(work_dir),
+                                     stdin=subprocess.DEVNULL,
+                                     stdout=subprocess.PIPE,
+                                     stderr=subprocess.STDOUT)
+        os.set_blocking(self.proc.stdout.fileno(), False)
+
+    def on_output(self):
+        """Process the output available from the simulation
+
+        Returns False once the simulation has closed its output.
+        """
+        data = self.proc.stdout.read()
+        if data is None:
+            # Nothing to read after all
+            return True
+        if not data:
+            return False
+
+        text = data.decode('utf-8', errors='backslashreplace')
+        self._log.write(text)
+
+        lines = (self._partial_line + text).split('\n')
+        self._partial_line = lines.pop()
+        for line in lines:
+            self._on_line(line.rstrip('\r'))
+        return True
+
+    def _on_line(self, line):
+        if CYCLE_LIMIT_RE.match(line):
+            self._cycle_limit_reached = True
+
+        if self.result is not None:
+            return
+        m = RESULT_RE.search(line)
+        if m is None:
+            return
+
+        self.result = m.group(1)
+        log.debug("%s: %s", self.name, self.result)
+        self._request_stop()
+
+    def _request_stop(self):
+        # The simulation keeps running after the test finishes. Stop it
+        # gracefully so it writes its statistics.
+        if self._stop_requested:
+            return
+        self._stop_requested = True
+        self._kill_at = time.monotonic() + SHUTDOWN_TIMEOUT
+        try:
+            self.proc.send_signal(signal.SIGINT)
+        except ProcessLookupError:
+            pass
+
+    def check_time(self, now):
+        """Enforce the wallclock time limit"""
+        if self.result is None and now >= self._deadline:
+            self.result = 'TIMEOUT'
+            self.message = ('Wallclock time limit of {}s reached.'
+                            .format(self._timeout))
+            self._request_stop()
+        if self._kill_at is not None and now >= self._kill_at:
+            log.warning("%s: simulation did not stop, killing it.", self.name)
+            self.proc.kill()
+            self._kill_at = None
+
+    def next_deadline(self):
+        if self._kill_at is not None:
+            return self._kill_at
+        return self._deadline if self.result is None else None
+
+    def finish(self):
+        """Wait for the simulation to exit and collect its results"""
+        returncode = self.proc.wait()
+        self.duration = time.monotonic() - self.start_time
+        if self._partial_line:
+            self._on_line(self._partial_line)
+        self.proc.stdout.close()
+        self._log.close()
+
+        if self.result is None:
+            if self._cycle_limit_reached:
+                self.result = 'TIMEOUT'
+                self.message = 'Simulated cycle limit reached.'
+            else:
+                self.result = 'ERROR'
+                self.message = ('Simulation exited with code {} before the '
+                                'test finished.'.format(returncode))
+
+        try:
+            with open(str(self.stats_path)) as stats_file:
+                stats = json.load(stats_file)
+            self.cycles = stats['cycles']
+            self.cycles_per_second = stats['cycles_per_second']
+        except (OSError, ValueError, KeyError):
+            log.debug("%s: no simulation statistics found.", self.name)
+
+        log.info("%-32s %-8s %s", self.name, self.result, self.message)
+
+    def summary(self):
+        return {
+            'name': self.name,
+            'result': self.result,
+            'message': self.message,
+            'wallclock_seconds': round(self.duration, 3),
+            'cycles': self.cycles,
+            'cycles_per_second': self.cycles_per_second,
+            'work_dir': str(self.work_dir),
+        }
+
+
+def run_tests(sim_cmd, tests, work_dir, jobs, timeout):
+    """Run the tests, with at most |jobs| simulations at once
+
+    Returns a list of finished SimRun objects, in the order of |tests|.
+    """
+    pending = list(tests)
+    running = {}
+    finished = {}
+    sel = selectors.DefaultSelector()
+
+    while pending or running:
+        while pending and len(running) < jobs:
+            name, elf_path, extra_args = pending.pop(0)
+            test_dir = work_dir / name
+            test_dir.mkdir(parents=True, exist_ok=True)
+            cmd = sim_cmd + ['--meminit=flash,' + str(elf_path)] + extra_args
+            run = SimRun(name, cmd, test_dir, timeout)
+            running[run.proc.stdout.fileno()] = run
+            sel.register(run.proc.stdout, selectors.EVENT_READ, run)
+
+        deadlines = [d for d in (r.next_deadline() for r in running.values())
+                     if d is not None]
+        wait = None
+        if deadlines:
+            wait = max(min(deadlines) - time.monotonic(), 0)
+
+        for key, _ in sel.select(wait):
+            run = key.data
+            if not run.on_output():
+                sel.unregister(key.fileobj)
+                del running[key.fd]
+                run.finish()
+                finished[run.name] = run
+
+        now = time.monotonic()
+        for run in running.values():
+            run.check_time(now)
+
+    sel.close()
+    return [finished[name] for name, _, _ in tests]
+
+
+def write_junit(path, runs):
+    suite = ET.Element('testsuite',
+                       name='sim_verilator',
+                       tests=str(len(runs)),
+                       failures=str(sum(r.result != 'PASSED' for r in runs)))
+    for run in runs:
+        case = ET.SubElement(suite,
+                             'testcase',
+                             classname='sim_verilator',
+                             name=run.name,
+                             time='{:.3f}'.format(run.duration))
+        props = ET.SubElement(case, 'properties')
+        for prop in ['cycles', 'cycles_per_second']:
+            if getattr(run, prop) is not None:
+                ET.SubElement(props, 'property', name=prop,
+                              value=str(getattr(run, prop)))
+        if run.result != 'PASSED':
+            failure = ET.SubElement(case, 'failure', type=run.result,
+                                    message=run.message or run.result)
+            failure.text = 'See {}'.format(run.work_dir / 'sim.log')
+    ET.ElementTree(suite).write(str(path), encoding='utf-8',
+                                xml_declaration=True)
+
+
+def write_json(path, runs):
+    with open(str(path), 'w') as json_file:
+        json.dump({'tests': [run.summary() for run in runs]},
+                  json_file, indent=2)
+        json_file.write('\n')
+
+
+def parse_shard(arg):
+    m = re.match(r'^(\d+)/(\d+)$', arg)
+    if m is None or not int(m.group(1)) < int(m.group(2)):
+        raise argparse.ArgumentTypeError(
+            'expected I/N with 0 <= I < N, got {!r}'.format(arg))
+    return (int(m.group(1)), int(m.group(2)))
+
+
+def main() -> int:
+    topsrcdir = Path(__file__).resolve().parents[3]
+    default_bin_dir = Path(os.environ.get('BIN_DIR', topsrcdir / 'build-bin'))
+
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--bin-dir', type=Path, default=default_bin_dir,
+                        help='Build outputs to test (default: $BIN_DIR or '
+                             '$REPO_TOP/build-bin)')
+    parser.add_argument('--sim', type=Path,
+                        help='Verilated Earl Grey model to run (default: '
+                             'hw/top_earlgrey/Vtop_earlgrey_verilator in '
+                             'the bin dir)')
+    parser.add_argument('--work-dir', type=Path,
+                        help='Directory for the logs of each test (default: '
+                             'a new temporary directory)')
+    parser.add_argument('-j', '--jobs', type=int,
+                        help='Number of simulations to run at once (default: '
+                             'the number of CPUs, limited by --mem-per-sim)')
+    parser.add_argument('--mem-per-sim', type=int, default=1024,
+                        help='Memory to allow for each simulation, in MiB '
+                             '(default: %(default)s)')
+    parser.add_argument('--shard', type=parse_shard, default=(0, 1),
+                        metavar='I/N',
+                        help='Only run every Nth test, starting with test I '
+                             '(to split the tests between machines)')
+    parser.add_argument('-k', '--filter', metavar='REGEX',
+                        help='Only run tests with names matching REGEX')
+    parser.add_argument('--max-cycles', type=int,
+                        help='Fail tests that run for more than this many '
+                             'simulated cycles')
+    parser.add_argument('--timeout', type=float, default=600,
+                        help='Fail tests that run for more than this many '
+                             'seconds (default: %(default)s)')
+    parser.add_argument('--junit', type=Path,
+                        help='Write the results to this JUnit XML file')
+    parser.add_argument('--json', type=Path,
+                        help='Write the results to this JSON file')
+    parser.add_argument('-v', '--verbose', action='store_true')
+    args = parser.parse_args()
+
+    logging.basicConfig(format='%(message)s',
+                        level=logging.DEBUG if args.verbose else logging.INFO)
+
+    # The simulations run in their own work directories, so make all paths
+    # absolute.
+    bin_dir = args.bin_dir.resolve()
+    sim_path = (args.sim or
+                bin_dir / 'hw/top_earlgrey/Vtop_earlgrey_verilator').resolve()
+    rom_elf_path = bin_dir / 'sw/device/boot_rom/boot_rom_sim_verilator.elf'
+    for path in [sim_path, rom_elf_path]:
+        if not path.is_file():
+            log.error("%s not found.", path)
+            return 1
+
+    tests = selfchecking_tests(bin_dir)
+    if args.filter is not None:
+        tests = [t for t in tests if re.search(args.filter, t[0])]
+    shard_index, shard_count = args.shard
+    tests = tests[shard_index::shard_count]
+    for name, elf_path, _ in tests:
+        if not elf_path.is_file():
+            log.error("%s not found (needed by %s).", elf_path, name)
+            return 1
+
+    work_dir = (args.work_dir or
+                Path(tempfile.mkdtemp(prefix='systemtest-'))).resolve()
+    jobs = args.jobs or default_jobs(args.mem_per_sim * 1024 * 1024)
+    log.info("Running %d tests, %d at a time. Logs are in %s.", len(tests),
+             jobs, work_dir)
+
+    # UART output goes to STDOUT, where we look for the test result.
+    sim_cmd = [str(sim_path), '--meminit=rom,' + str(rom_elf_path),
+               '+UARTDPI_LOG_uart0=-']
+    if args.max_cycles is not None:
+        sim_cmd.append('--term-after-cycles={}'.format(args.max_cycles))
+
+    runs = run_tests(sim_cmd, tests, work_dir, jobs, args.timeout)
+
+    if args.junit is not None:
+        write_junit(args.junit, runs)
+    if args.json is not None:
+        write_json(args.json, runs)
+
+    failed = [run.name for run in runs if run.result != 'PASSED']
+    log.info("%d of %d tests passed.", len(runs) - len(failed), len(runs))
+    if failed:
+        log.info("Failed: %s", ', '.join(failed))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
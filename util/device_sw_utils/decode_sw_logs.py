@@ -0,0 +1,265 @@
+#!/usr/bin/env python3
+# Copyright lowRISC contributors.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+"""Decoder for tokenized device software logs.
+
+When a device is switched to tokenized logging (see `kLogModeTokenized` in
+sw/device/lib/runtime/log.h), each log line is written to the UART as a binary
+record instead of formatted text:
+
+  <marker: 0xa5> <log ID: varint> <arg 0: varint> ... <arg N-1: varint>
+
+where the log ID is the offset of the line's `log_fields_t` in the
+`.logs.fields` section, and all varints are unsigned LEB128. The number of
+arguments is not transmitted, since it is known from the log fields.
+
+This script reads the log fields and constant strings from the ELF file, the
+same way as extract_sw_logs.py does for DV, and turns a captured UART stream
+back into the text `base_log_internal_core()` would have printed. Bytes outside
+of records are passed through unchanged, so plain `base_printf()` output mixed
+into the stream is preserved.
+"""
+
+import argparse
+import collections
+import re
+import struct
+import sys
+
+from elftools.elf import elffile
+
+from extract_sw_logs import (LOGS_FIELDS_SECTION, LOGS_FIELDS_SIZE,
+                             RODATA_SECTION, get_addr_strings,
+                             get_str_at_addr)
+
+# Must match LOG_TOKENIZED_MARKER in sw/device/lib/runtime/log.h.
+LOG_TOKENIZED_MARKER = 0xa5
+
+SEVERITIES = ['I', 'W', 'E', 'F']
+
+LogFields = collections.namedtuple('LogFields',
+                                   ['severity', 'file', 'line', 'nargs',
+                                    'format'])
+
+# Format specifiers supported by base_printf(); see sw/device/lib/runtime/print.h.
+FORMAT_SPEC_RE = re.compile(r'%(\d*)(.?)')
+
+
+def load_log_fields(elf_file, logs_fields_section, ro_sections):
+    '''Reads the log fields from an ELF file.
+
+    Returns a tuple of a {log ID: LogFields} dict and the {addr: string} dict
+    of the read-only sections, for resolving %s arguments.'''
+    with open(elf_file, 'rb') as f:
+        elf = elffile.ELFFile(f)
+        ro_contents = []
+        for ro_section in ro_sections:
+            section = elf.get_section_by_name(name=ro_section)
+            if section is None:
+                raise KeyError("{} section not found in {}".format(
+                    ro_section, elf_file))
+            ro_contents.append((int(section.header['sh_addr']),
+                                int(section.header['sh_size']),
+                                section.data()))
+        addr_strings = get_addr_strings(ro_contents)
+
+        section = elf.get_section_by_name(name=logs_fields_section)
+        if section is None:
+            raise KeyError("{} section not found in {}".format(
+                logs_fields_section, elf_file))
+        logs_data = section.data()
+
+    log_fields = {}
+    for start in range(0, len(logs_data) - LOGS_FIELDS_SIZE + 1,
+                       LOGS_FIELDS_SIZE):
+        severity, file_addr, line, nargs, format_addr = struct.unpack(
+            'IIIII', logs_data[start:start + LOGS_FIELDS_SIZE])
+        file_name = get_str_at_addr(file_addr, addr_strings)
+        log_fields[start] = LogFields(severity=severity,
+                                      file=file_name.split('/')[-1],
+                                      line=line,
+                                      nargs=nargs,
+                                      format=get_str_at_addr(
+                                          format_addr, addr_strings))
+    return log_fields, addr_strings
+
+
+def lookup_string(addr, addr_strings, length=None):
+    '''Returns the constant string at `addr`, or a placeholder.'''
+    try:
+        string = get_str_at_addr(addr, addr_strings)
+    except KeyError:
+        return '<str@{:#010x}>'.format(addr)
+    return string if length is None else string[:length]
+
+
+def format_log(fmt, args, addr_strings):
+    '''Formats `args` according to `fmt`, like base_printf() would.'''
+    args = list(args)
+    out = []
+    pos = 0
+    while True:
+        percent = fmt.find('%', pos)
+        if percent == -1:
+            out.append(fmt[pos:])
+            break
+        out.append(fmt[pos:percent])
+        m = FORMAT_SPEC_RE.match(fmt, percent)
+        width = int(m.group(1)) if m.group(1) else 0
+        spec = m.group(2)
+        pos = m.end()
+        if spec == '':
+            out.append('%<unexpected nul>')
+            break
+        if (m.group(1) and width == 0) or width > 32:
+            out.append('%<bad width>')
+            break
+        if spec == '%':
+            out.append('%')
+            continue
+
+        value = args.pop(0) if args else 0
+        if spec == 'c':
+            out.append(chr(value & 0xff))
+        elif spec == 's':
+            out.append(lookup_string(value, addr_strings))
+        elif spec == 'z':
+            ptr = args.pop(0) if args else 0
+            out.append(lookup_string(ptr, addr_strings, value))
+        elif spec in 'di':
+            if value & 0x80000000:
+                out.append('-')
+                value = (-value) & 0xffffffff
+            out.append('{:0{}d}'.format(value, width))
+        elif spec == 'u':
+            out.append('{:0{}d}'.format(value, width))
+        elif spec == 'o':
+            out.append('{:0{}o}'.format(value, width))
+        elif spec in 'xh':
+            out.append('{:0{}x}'.format(value, width))
+        elif spec in 'XH':
+            out.append('{:0{}X}'.format(value, width))
+        elif spec == 'b':
+            out.append('{:0{}b}'.format(value, width))
+        elif spec == 'p':
+            out.append('0x{:08x}'.format(value))
+        else:
+            out.append('%<unknown spec>')
+    return ''.join(out)
+
+
+class LogDecoder:
+    '''Incremental decoder for a UART byte stream.'''
+    def __init__(self, log_fields, addr_strings):
+        self.log_fields = log_fields
+        self.addr_strings = addr_strings
+        self.counter = 0
+        self.pending = bytearray()
+
+    def _read_varint(self, pos):
+        '''Returns (value, next pos), or None if the varint is incomplete.'''
+        value = 0
+        shift = 0
+        while pos < len(self.pending):
+            byte = self.pending[pos]
+            value |= (byte & 0x7f) << shift
+            pos += 1
+            if not byte & 0x80:
+                return value & 0xffffffff, pos
+            shift += 7
+        return None
+
+    def _decode_record(self):
+        '''Decodes a record at the start of the pending bytes.
+
+        Returns (text, record length), or None if the record is incomplete.'''
+        res = self._read_varint(1)
+        if res is None:
+            return None
+        log_id, pos = res
+        fields = self.log_fields.get(log_id)
+        if fields is None:
+            # Not a record after all; pass the marker byte through.
+            return chr(LOG_TOKENIZED_MARKER), 1
+
+        args = []
+        for _ in range(fields.nargs):
+            res = self._read_varint(pos)
+            if res is None:
+                return None
+            value, pos = res
+            args.append(value)
+
+        severity = (SEVERITIES[fields.severity]
+                    if fields.severity < len(SEVERITIES) else '?')
+        text = '{}{:05d} {}:{}] {}\r\n'.format(
+            severity, self.counter & 0xffff, fields.file, fields.line,
+            format_log(fields.format, args, self.addr_strings))
+        self.counter += 1
+        return text, pos
+
+    def feed(self, data):
+        '''Consumes `data`, and returns the text decoded so far.'''
+        self.pending.extend(data)
+        out = []
+        while self.pending:
+            marker = self.pending.find(LOG_TOKENIZED_MARKER)
+            if marker != 0:
+                end = len(self.pending) if marker == -1 else marker
+                out.append(self.pending[:end].decode('utf-8',
+                                                     errors='replace'))
+                del self.pending[:end]
+                continue
+            res = self._decode_record()
+            if res is None:
+                break
+            text, length = res
+            out.append(text)
+            del self.pending[:length]
+        return ''.join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--elf-file', '-e', required=True, help="Elf file")
+    parser.add_argument('--logs-fields-section',
+                        '-f',
+                        default=LOGS_FIELDS_SECTION,
+                        help="Elf section where log fields are written.")
+    parser.add_argument('--rodata-sections',
+                        '-r',
+                        nargs="+",
+                        action="append",
+                        help="Elf sections with rodata.")
+    parser.add_argument('input',
+                        nargs='?',
+                        type=argparse.FileType('rb'),
+                        default=sys.stdin.buffer,
+                        help="Captured UART output, or a serial device "
+                        "(default: stdin).")
+    args = parser.parse_args()
+
+    if args.rodata_sections is None:
+        ro_sections = [RODATA_SECTION]
+    else:
+        ro_sections = list(
+            set([section for lst in args.rodata_sections for section in lst]))
+
+    log_fields, addr_strings = load_log_fields(args.elf_file,
+                                               args.logs_fields_section,
+                                               ro_sections)
+    decoder = LogDecoder(log_fields, addr_strings)
+    while True:
+        # read1() returns as soon as some data is available, which keeps the
+        # output live when reading from a serial device.
+        read = getattr(args.input, 'read1', args.input.read)
+        data = read(4096)
+        if not data:
+            break
+        sys.stdout.write(decoder.feed(data))
+        sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
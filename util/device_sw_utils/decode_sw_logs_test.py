@@ -0,0 +1,127 @@
+# Copyright lowRISC contributors.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+
+'''pytest-based testing for functions in decode_sw_logs.py'''
+
+import os
+import sys
+
+# decode_sw_logs.py is a script, and imports extract_sw_logs.py as a top-level
+# module.
+sys.path.append(os.path.dirname(__file__))
+
+from decode_sw_logs import (LOG_TOKENIZED_MARKER, LogDecoder,  # noqa: E402
+                            LogFields, format_log)
+from extract_sw_logs import get_addr_strings  # noqa: E402
+
+# A fake .rodata section at 0x1000, with strings at 0x1000 and 0x1006.
+RODATA = (0x1000, 12, b'hello\0world\0')
+ADDR_STRINGS = get_addr_strings([RODATA])
+
+
+def varint(value):
+    '''Encodes `value` as unsigned LEB128, like the device does.'''
+    out = bytearray()
+    while True:
+        byte = value & 0x7f
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def record(log_id, *args):
+    '''Encodes a tokenized log record.'''
+    return (bytes([LOG_TOKENIZED_MARKER]) + varint(log_id) +
+            b''.join(varint(arg) for arg in args))
+
+
+def test_format_log_integers():
+    '''Pytest-compatible test for integer specifiers in format_log.'''
+    assert format_log('no args', [], ADDR_STRINGS) == 'no args'
+    assert format_log('%d, %i', [42, 7], ADDR_STRINGS) == '42, 7'
+    # Arguments are sent as unsigned 32-bit values.
+    assert format_log('%d', [0xffffffd6], ADDR_STRINGS) == '-42'
+    assert format_log('%u', [0xffffffd6], ADDR_STRINGS) == '4294967254'
+    assert format_log('%x %X %h %H', [0xab] * 4, ADDR_STRINGS) == 'ab AB ab AB'
+    assert format_log('%o %b', [8, 5], ADDR_STRINGS) == '10 101'
+    assert format_log('%p', [0x1234], ADDR_STRINGS) == '0x00001234'
+    assert format_log('%c%%', [ord('A')], ADDR_STRINGS) == 'A%'
+
+
+def test_format_log_widths():
+    '''Pytest-compatible test for zero-padded widths in format_log.'''
+    assert format_log('%08x', [0xbeef], ADDR_STRINGS) == '0000beef'
+    assert format_log('%4d', [7], ADDR_STRINGS) == '0007'
+    assert format_log('%3b', [1], ADDR_STRINGS) == '001'
+    assert format_log('%0x', [1], ADDR_STRINGS) == '%<bad width>'
+    assert format_log('%33x', [1], ADDR_STRINGS) == '%<bad width>'
+
+
+def test_format_log_strings():
+    '''Pytest-compatible test for string specifiers in format_log.'''
+    assert format_log('%s, %s!', [0x1000, 0x1006],
+                      ADDR_STRINGS) == 'hello, world!'
+    # Pointers into the middle of a string.
+    assert format_log('%s', [0x1002], ADDR_STRINGS) == 'llo'
+    # %z takes a length, then a pointer.
+    assert format_log('%z', [3, 0x1006], ADDR_STRINGS) == 'wor'
+    # Strings that aren't constants can't be recovered.
+    assert format_log('%s', [0x2000], ADDR_STRINGS) == '<str@0x00002000>'
+
+
+def test_format_log_errors():
+    '''Pytest-compatible test for malformed format strings in format_log.'''
+    # Missing arguments read as zero.
+    assert format_log('%d %x', [1], ADDR_STRINGS) == '1 0'
+    assert format_log('%q', [1], ADDR_STRINGS) == '%<unknown spec>'
+    assert format_log('trailing %', [], ADDR_STRINGS) == \
+        'trailing %<unexpected nul>'
+
+
+def make_decoder():
+    log_fields = {
+        0: LogFields(severity=0, file='a.c', line=10, nargs=0,
+                     format='boot'),
+        20: LogFields(severity=2, file='b.c', line=300, nargs=2,
+                      format='%s: 0x%08x'),
+        # A log ID that needs a two-byte varint.
+        200: LogFields(severity=3, file='c.c', line=1, nargs=1,
+                       format='code %d'),
+    }
+    return LogDecoder(log_fields, ADDR_STRINGS)
+
+
+def test_decoder_records():
+    '''Pytest-compatible test for LogDecoder record decoding.'''
+    decoder = make_decoder()
+    assert decoder.feed(record(0)) == 'I00000 a.c:10] boot\r\n'
+    assert (decoder.feed(record(20, 0x1000, 0xdeadbeef)) ==
+            'E00001 b.c:300] hello: 0xdeadbeef\r\n')
+    assert (decoder.feed(record(200, 0xfffffffe)) ==
+            'F00002 c.c:1] code -2\r\n')
+
+
+def test_decoder_passthrough():
+    '''Pytest-compatible test for text mixed with records.'''
+    decoder = make_decoder()
+    assert (decoder.feed(b'text\r\n' + record(0) + b'more') ==
+            'text\r\nI00000 a.c:10] boot\r\nmore')
+
+    # A marker byte that isn't followed by a known log ID is passed through.
+    assert decoder.feed(bytes([LOG_TOKENIZED_MARKER, 5]) + b'x') == \
+        chr(LOG_TOKENIZED_MARKER) + '\x05x'
+
+
+def test_decoder_split_records():
+    '''Pytest-compatible test for records split across reads.'''
+    decoder = make_decoder()
+    data = record(20, 0x1006, 0x12345678) + record(200, 300)
+    out = ''
+    for i in range(len(data)):
+        out += decoder.feed(data[i:i + 1])
+    assert out == ('E00000 b.c:300] world: 0x12345678\r\n'
+                   'F00001 c.c:1] code 300\r\n')
@@ -13,6 +13,8 @@ import sys
 import time
 from collections import OrderedDict
 
+from scheduler import (BuildCache, JobHistory, Resources, build_hash,
+                       order_by_expected_runtime)
 from sim_utils import get_cov_summary_table
 from tabulate import tabulate
 from utils import VERBOSE, find_and_substitute_wildcards, run_cmd
@@ -39,6 +41,19 @@ class Deploy():
     # Max jobs dispatched in one go.
     slot_limit = 20
 
+    # CPUs and memory (in MiB) available to jobs running on this machine. None
+    # means there is no limit. Jobs are weighted by their resource usage in
+    # earlier invocations, from job_history.
+    max_cpus = None
+    max_mem_mb = None
+    job_history = JobHistory()
+
+    # Skip builds with the same inputs as the last successful build in the same
+    # build directory, or as a successful build of another build mode in
+    # build_cache.
+    reuse_builds = False
+    build_cache = BuildCache()
+
     # List of variable names that are to be treated as "list of commands".
     # This tells `construct_cmd` that these vars are lists that need to
     # be joined with '&&' instead of a space.
@@ -90,6 +105,12 @@ class Deploy():
         self.log_fd = None
         self.status = None
 
+        # Scheduling: the start time, the resource usage (from os.wait4) once
+        # finished and the (cpus, mem_mb) weights reserved while running.
+        self.start_time = None
+        self.rusage = None
+        self.weights = (0, 0)
+
         # These are mandatory class attributes that need to be extracted and
         # set from the sim_cfg object. These are explicitly used to construct
         # the command for deployment.
@@ -250,6 +271,30 @@ class Deploy():
                 item.name, self.name)
         return True
 
+    def history_key(self):
+        '''Returns the key of this job in the job history.
+
+        The key identifies equivalent jobs across invocations of dvsim.
+        '''
+        return self.identifier
+
+    def is_local(self):
+        '''Returns True if the job runs on this machine.'''
+        return self.sim_cfg.job_prefix == ""
+
+    def expected_weights(self):
+        '''Returns the (cpus, mem_mb) that this job is expected to use.
+
+        Jobs without a history are assumed to use one CPU. Jobs running
+        elsewhere (with a --job-prefix such as bsub) don't use local resources.
+        '''
+        if not self.is_local():
+            return (0, 0)
+        job = Deploy.job_history.get(self.history_key())
+        if job is None:
+            return (1, 0)
+        return (job['cpus'], job['mem_mb'])
+
     def dispatch_cmd(self):
         # Update the shell's env vars with self.exports. Values in exports must
         # replace the values in the shell's env vars if the keys match.
@@ -283,6 +328,7 @@ class Deploy():
             f = open(self.log, "w", encoding="UTF-8", errors="surrogateescape")
             f.write("[Executing]:\n{}\n\n".format(self.cmd))
             f.flush()
+            self.start_time = time.time()
             self.process = subprocess.Popen(args,
                                             bufsize=4096,
                                             universal_newlines=True,
@@ -414,12 +460,46 @@ class Deploy():
             if os.system(cmd):
                 log.error("Cmd \"%s\" could not be run", cmd)
 
+    def poll(self):
+        '''Like self.process.poll(), but also collects the resource usage of
+        the process in self.rusage when it has finished.
+        '''
+        if self.process.returncode is None:
+            try:
+                pid, wstatus, rusage = os.wait4(self.process.pid, os.WNOHANG)
+            except ChildProcessError:
+                return self.process.poll()
+            if pid == 0:
+                return None
+            self.rusage = rusage
+            if os.WIFSIGNALED(wstatus):
+                self.process.returncode = -os.WTERMSIG(wstatus)
+            else:
+                self.process.returncode = os.WEXITSTATUS(wstatus)
+        return self.process.returncode
+
+    def record_history(self):
+        '''Adds this job to the job history, if it passed.'''
+        if self.dry_run or self.status != "P" or self.start_time is None:
+            return
+
+        runtime = time.time() - self.start_time
+        cpus, mem_mb = self.expected_weights()
+        if self.is_local() and self.rusage is not None and runtime > 0:
+            cpus = (self.rusage.ru_utime + self.rusage.ru_stime) / runtime
+            # ru_maxrss is in KiB on Linux, but in bytes on macOS.
+            mem_mb = self.rusage.ru_maxrss / 1024
+            if sys.platform == 'darwin':
+                mem_mb /= 1024
+        Deploy.job_history.record(self.history_key(), runtime, cpus, mem_mb)
+
     def get_status(self):
         if self.status != "D":
             return
-        if self.process.poll() is not None:
+        if self.poll() is not None:
             self.log_fd.close()
             self.set_status()
+            self.record_history()
 
             log.debug("Item %s has completed execution: %s", self.name,
                       self.status)
@@ -491,6 +571,10 @@ class Deploy():
         dispatched_items = []
         queued_items = []
 
+        # Items that are running and the resources they have reserved.
+        running_items = []
+        resources = Resources(Deploy.max_cpus, Deploy.max_mem_mb)
+
         # Print timer val in hh:mm:ss.
         def get_timer_val():
             return "%02i:%02i:%02i" % (Deploy.hh, Deploy.mm, Deploy.ss)
@@ -607,21 +691,49 @@ class Deploy():
                             add_status_target_queued(status, sub_item)
                     update_status_target_stats(status, item)
 
-            # Dispatch items from the queue as slots free up.
+            # Release the resources of items that have finished.
+            for item in running_items:
+                if item.status != "D":
+                    resources.release(*item.weights)
+            running_items = [
+                item for item in running_items if item.status == "D"
+            ]
+
+            # Dispatch items from the queue as slots and resources free up,
+            # starting with the items expected to take longest. Stop at the
+            # first item that doesn't fit, so that large items aren't starved
+            # by smaller ones.
             all_done = (len(queued_items) == 0)
             if not all_done:
                 num_slots = Deploy.max_parallel - Deploy.dispatch_counter
                 if num_slots > Deploy.slot_limit:
                     num_slots = Deploy.slot_limit
                 if num_slots > 0:
-                    if len(queued_items) > num_slots:
-                        dispatch_items(queued_items[0:num_slots])
-                        dispatched_items.extend(queued_items[0:num_slots])
-                        queued_items = queued_items[num_slots:]
-                    else:
-                        dispatch_items(queued_items)
-                        dispatched_items.extend(queued_items)
-                        queued_items = []
+                    queued_items = order_by_expected_runtime(
+                        queued_items, Deploy.job_history)
+                    num_items = 0
+                    for item in queued_items:
+                        if num_items == num_slots:
+                            break
+                        # Items that won't be run (e.g. because their parent
+                        # failed) don't need any resources.
+                        if item.status is None:
+                            weights = item.expected_weights()
+                            if not resources.fits(*weights):
+                                break
+                            item.weights = weights
+                            resources.acquire(*weights)
+                        num_items += 1
+
+                    new_items = queued_items[0:num_items]
+                    dispatch_items(new_items)
+                    dispatched_items.extend(new_items)
+                    queued_items = queued_items[num_items:]
+                    for item in new_items:
+                        if item.status == "D":
+                            running_items.append(item)
+                        else:
+                            resources.release(*item.weights)
 
             # Check if we are done and print the status periodically.
             all_done &= check_if_done_and_print_status(status,
@@ -633,6 +745,8 @@ class Deploy():
                 Deploy.increment_timer()
                 print_status_flag = has_print_interval_reached()
 
+        Deploy.job_history.save()
+
 
 class CompileSim(Deploy):
     """
@@ -689,14 +803,89 @@ class CompileSim(Deploy):
         log_sub_path = self.log.replace(self.sim_cfg.scratch_path + '/', '')
         self.fail_msg += "**LOG:** $scratch_path/{}<br>\n".format(log_sub_path)
 
+        # A hash of the build inputs, used to skip the build if a build
+        # directory already holds a successful build with the same inputs.
+        # The build mode's name (which is also in the build directory) is
+        # taken out, like in is_equivalent_job(), so that equivalent build
+        # modes can share a build. dvsim's own outputs aren't sources.
+        # Coverage builds are never reused, since dispatch_cmd() clears the
+        # coverage database.
+        self.build_hash = None
+        self.build_hash_file = os.path.join(self.odir, BuildCache.HASH_FILE)
+        if Deploy.reuse_builds and not self.sim_cfg.cov and not self.dry_run:
+            exclude = [self.sim_cfg.scratch_root]
+            for path in [Deploy.job_history.path, Deploy.build_cache.path]:
+                if path is not None:
+                    exclude.append(path)
+            exports = {
+                key: (val.replace(self.name, "{build_mode}")
+                      if type(val) is str else val)
+                for key, val in self.exports.items()
+            }
+            self.build_hash = build_hash(
+                self.cmd.replace(self.name, "{build_mode}"), exports,
+                self.proj_root, exclude)
+
         CompileSim.items.append(self)
 
+    def history_key(self):
+        return "{}:build:{}".format(self.sim_cfg.name, self.name)
+
+    def is_reusable(self):
+        '''Returns True if the build directory holds an identical build.'''
+        if self.build_hash is None:
+            return False
+        return BuildCache.read_hash(self.odir) == self.build_hash
+
+    def share_build(self):
+        '''Points the build directory at an identical build elsewhere.
+
+        Returns True if the build cache has a build of another build mode with
+        the same hash. Any earlier build in this build directory is backed up
+        first.
+        '''
+        if self.build_hash is None:
+            return False
+        shared_dir = Deploy.build_cache.lookup(self.build_hash)
+        if shared_dir is None or shared_dir == os.path.realpath(self.odir):
+            return False
+
+        if os.path.islink(self.odir):
+            os.remove(self.odir)
+        elif os.path.exists(self.odir):
+            self.odir_limiter(odir=self.odir)
+        os.symlink(shared_dir, self.odir)
+        return True
+
     def dispatch_cmd(self):
+        if self.is_reusable() or self.share_build():
+            log.log(VERBOSE, "[%s]: Reusing the existing build in %s",
+                    self.identifier, os.path.realpath(self.odir))
+            self.status = "P"
+            os.system("ln -s " + self.odir + " " + self.sim_cfg.links['P'] +
+                      '/' + self.odir_ln)
+            return
+
+        # The build directory is about to change, so it no longer matches any
+        # earlier hash. If it's shared with another build mode, build in a
+        # directory of its own instead of overwriting the other build.
+        if os.path.islink(self.odir):
+            os.remove(self.odir)
+        elif os.path.exists(self.build_hash_file):
+            os.remove(self.build_hash_file)
+
         # Delete previous cov_db_dir if it exists before dispatching new build.
         if os.path.exists(self.cov_db_dir):
             os.system("rm -rf " + self.cov_db_dir)
         super().dispatch_cmd()
 
+    def set_status(self):
+        super().set_status()
+        if self.status == "P" and self.build_hash is not None:
+            with open(self.build_hash_file, "w") as f:
+                f.write(self.build_hash + "\n")
+            Deploy.build_cache.add(self.build_hash, self.odir)
+
 
 class CompileOneShot(Deploy):
     """
@@ -824,6 +1013,11 @@ class RunTest(Deploy):
         # Set identifier.
         self.identifier = self.sim_cfg.name + ":" + self.run_dir_name
 
+    def history_key(self):
+        # Leave out the seed, which changes from run to run.
+        return "{}:{}:{}".format(self.sim_cfg.name, self.build_mode,
+                                 self.test)
+
     def get_status(self):
         '''Override base class get_status implementation for additional post-status
         actions.'''
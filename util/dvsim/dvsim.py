@@ -31,6 +31,7 @@ import textwrap
 from signal import SIGINT, signal
 
 import Deploy
+import scheduler
 import utils
 from CfgFactory import make_cfg
 
@@ -115,6 +116,20 @@ def resolve_max_parallel(arg):
     return 16
 
 
+def read_positive(arg, conv, opt_name):
+    '''Convert arg with conv, requiring a positive result'''
+    try:
+        val = conv(arg)
+        if val <= 0:
+            raise ValueError('bad value')
+        return val
+
+    except ValueError:
+        raise argparse.ArgumentTypeError(
+            'Bad argument for {} ({!r}): must be a positive '
+            'number.'.format(opt_name, arg))
+
+
 def resolve_branch(branch):
     '''Choose a branch name for output files
 
@@ -324,6 +339,41 @@ def parse_args():
                             'environment variable is set, in which case that '
                             'is used.'))
 
+    disg.add_argument("--max-cpus",
+                      type=lambda arg: read_positive(arg, int, '--max-cpus'),
+                      metavar="N",
+                      help=('Only start a local job if the CPUs it used in '
+                            'earlier invocations fit in N CPUs, together '
+                            'with the jobs that are already running. '
+                            'Defaults to the number of CPUs of this '
+                            'machine.'))
+
+    disg.add_argument("--max-mem",
+                      type=lambda arg: read_positive(arg, float, '--max-mem'),
+                      metavar="GB",
+                      help=('Like --max-cpus, but for the peak memory use of '
+                            'jobs, in GiB. Defaults to the memory available '
+                            'when dvsim starts.'))
+
+    disg.add_argument("--job-history",
+                      metavar="PATH",
+                      help=('JSON file with the runtimes and resource use of '
+                            'earlier jobs, used to schedule the longest jobs '
+                            'first and to weight jobs by their resource use. '
+                            'Defaults to dvsim_job_history.json in the '
+                            'scratch root.'))
+
+    disg.add_argument("--reuse-builds",
+                      action='store_true',
+                      help=('Skip a build if its build directory, or the '
+                            'build directory of another build mode, holds a '
+                            'successful build with the same command, '
+                            'environment and source tree (the git commit, '
+                            'uncommitted changes and untracked files outside '
+                            'the scratch root). Changes outside the '
+                            'repository, such as a new tool version behind '
+                            'the same path, are not detected.'))
+
     pathg = parser.add_argument_group('File management')
 
     pathg.add_argument("--scratch-root",
@@ -639,6 +689,17 @@ def main():
     Deploy.Deploy.print_interval = args.print_interval
     Deploy.Deploy.max_parallel = args.max_parallel
     Deploy.Deploy.max_odirs = args.max_odirs
+    Deploy.Deploy.max_cpus = args.max_cpus or os.cpu_count()
+    if args.max_mem is not None:
+        Deploy.Deploy.max_mem_mb = args.max_mem * 1024
+    else:
+        Deploy.Deploy.max_mem_mb = scheduler.available_mem_mb()
+    Deploy.Deploy.job_history = scheduler.JobHistory(
+        args.job_history or
+        os.path.join(args.scratch_root, "dvsim_job_history.json"))
+    Deploy.Deploy.reuse_builds = args.reuse_builds
+    Deploy.Deploy.build_cache = scheduler.BuildCache(
+        os.path.join(args.scratch_root, "dvsim_build_cache"))
 
     # Build infrastructure from hjson file and create the list of items to
     # be deployed.
@@ -0,0 +1,284 @@
+# Copyright lowRISC contributors.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+"""
+Helpers for scheduling jobs: resource accounting, job history, build
+hashing and the build cache. These are used by Deploy.deploy().
+"""
+
+import hashlib
+import json
+import logging as log
+import os
+import subprocess
+
+
+def available_mem_mb():
+    '''Return the memory available for new jobs in MiB, or None if unknown.'''
+    try:
+        with open('/proc/meminfo') as meminfo:
+            for line in meminfo:
+                if line.startswith('MemAvailable:'):
+                    return int(line.split()[1]) // 1024
+    except OSError:
+        pass
+    return None
+
+
+class Resources():
+    '''Tracks the CPUs and memory used by the jobs that are running.
+
+    A limit of None means that resource is not limited.
+    '''
+    def __init__(self, cpus=None, mem_mb=None):
+        self.cpus = cpus
+        self.mem_mb = mem_mb
+        self.used_cpus = 0
+        self.used_mem_mb = 0
+        self.num_jobs = 0
+
+    def fits(self, cpus, mem_mb):
+        '''Returns True if a job with the given weights can start now.
+
+        A job always fits if nothing else is running, so that jobs that are
+        larger than the machine still run (on their own).
+        '''
+        if self.num_jobs == 0:
+            return True
+        if self.cpus is not None and self.used_cpus + cpus > self.cpus:
+            return False
+        if self.mem_mb is not None and self.used_mem_mb + mem_mb > self.mem_mb:
+            return False
+        return True
+
+    def acquire(self, cpus, mem_mb):
+        self.used_cpus += cpus
+        self.used_mem_mb += mem_mb
+        self.num_jobs += 1
+
+    def release(self, cpus, mem_mb):
+        self.used_cpus -= cpus
+        self.used_mem_mb -= mem_mb
+        self.num_jobs -= 1
+
+
+class JobHistory():
+    '''Runtimes and resource usage of jobs in earlier invocations.
+
+    Jobs are identified by a key that stays the same between invocations (such
+    as the config, build mode and test name, but not the seed). For each key,
+    we keep a moving average of the wallclock runtime in seconds, the average
+    number of CPUs in use and the peak memory use in MiB. The history is
+    stored in a JSON file.
+    '''
+
+    # Weight of the newest sample in the moving averages
+    alpha = 0.5
+
+    def __init__(self, path=None):
+        self.path = path
+        self.jobs = {}
+        if path is None or not os.path.exists(path):
+            return
+        try:
+            with open(path) as history_file:
+                self.jobs = json.load(history_file)
+        except (OSError, ValueError) as e:
+            log.warning("Ignoring job history in %s: %s", path, e)
+
+    def get(self, key):
+        '''Returns the history for a job, or None if there isn't any.
+
+        The history is a dict with keys "runtime", "cpus" and "mem_mb".
+        '''
+        return self.jobs.get(key)
+
+    def expected_runtime(self, key):
+        '''Returns the expected runtime of a job, or None if unknown.'''
+        job = self.jobs.get(key)
+        return None if job is None else job['runtime']
+
+    def record(self, key, runtime, cpus, mem_mb):
+        '''Adds a finished job to the history.'''
+        new = {'runtime': runtime, 'cpus': cpus, 'mem_mb': mem_mb}
+        old = self.jobs.get(key)
+        if old is not None:
+            new = {
+                k: self.alpha * new[k] + (1 - self.alpha) * old.get(k, new[k])
+                for k in new
+            }
+        self.jobs[key] = {k: round(v, 3) for k, v in new.items()}
+
+    def save(self):
+        if self.path is None:
+            return
+        tmp_path = self.path + '.tmp'
+        try:
+            with open(tmp_path, 'w') as history_file:
+                json.dump(self.jobs, history_file, indent=2, sort_keys=True)
+            os.replace(tmp_path, self.path)
+        except OSError as e:
+            log.warning("Failed to save job history to %s: %s", self.path, e)
+
+
+def order_by_expected_runtime(items, history):
+    '''Sorts jobs longest-expected-first.
+
+    Jobs without a history go first: they might be long, and running them
+    early gives us a history for the next invocation. The sort is stable, so
+    jobs with equal expectations keep their order.
+    '''
+    def sort_key(item):
+        runtime = history.expected_runtime(item.history_key())
+        return (runtime is not None, -(runtime or 0))
+
+    return sorted(items, key=sort_key)
+
+
+_source_state_cache = {}
+
+# Size of the chunks that files and diffs are hashed in.
+_HASH_CHUNK_BYTES = 1 << 20
+
+
+def _hash_stream(digest, stream):
+    '''Adds everything read from stream to digest, a chunk at a time.'''
+    for chunk in iter(lambda: stream.read(_HASH_CHUNK_BYTES), b''):
+        digest.update(chunk)
+
+
+def source_state_hash(proj_root, exclude=()):
+    '''Returns a hash of the sources in the git repository at proj_root.
+
+    This covers the checked out commit, uncommitted changes and the contents
+    of untracked files that git doesn't ignore. Untracked files under the
+    paths in exclude are skipped: these are for dvsim's own outputs, such as
+    the scratch root and the job history, which change on every run. Returns
+    None if proj_root isn't a git repository.
+    '''
+    key = (proj_root, tuple(sorted(exclude)))
+    if key in _source_state_cache:
+        return _source_state_cache[key]
+
+    git_cmd = ['git', '-C', proj_root]
+
+    # Pathspecs for the excluded paths that are inside the repository.
+    pathspecs = ['.']
+    real_root = os.path.realpath(proj_root)
+    for path in exclude:
+        rel_path = os.path.relpath(os.path.realpath(path), real_root)
+        if rel_path != '.' and not rel_path.startswith('..'):
+            pathspecs.append(':(exclude)' + rel_path)
+
+    digest = hashlib.sha256()
+    try:
+        head = subprocess.run(git_cmd + ['rev-parse', 'HEAD'],
+                              stdout=subprocess.PIPE,
+                              stderr=subprocess.DEVNULL,
+                              check=True).stdout
+        digest.update(head)
+
+        # The diff can be large (it includes binary files), so hash it as it
+        # is produced.
+        with subprocess.Popen(git_cmd + ['diff', 'HEAD', '--binary'],
+                              stdout=subprocess.PIPE,
+                              stderr=subprocess.DEVNULL) as proc:
+            _hash_stream(digest, proc.stdout)
+        if proc.returncode != 0:
+            raise subprocess.CalledProcessError(proc.returncode, proc.args)
+
+        ls_cmd = git_cmd + ['ls-files', '-z', '--others',
+                            '--exclude-standard', '--'] + pathspecs
+        untracked = subprocess.run(ls_cmd,
+                                   stdout=subprocess.PIPE,
+                                   stderr=subprocess.DEVNULL,
+                                   check=True).stdout
+        for path in sorted(untracked.split(b'\0')):
+            if not path:
+                continue
+            digest.update(path + b'\0')
+            full_path = os.path.join(proj_root.encode(), path)
+            file_digest = hashlib.sha256()
+            try:
+                with open(full_path, 'rb') as untracked_file:
+                    _hash_stream(file_digest, untracked_file)
+            except OSError:
+                pass
+            digest.update(file_digest.digest())
+        result = digest.hexdigest()
+    except (OSError, subprocess.CalledProcessError):
+        result = None
+
+    _source_state_cache[key] = result
+    return result
+
+
+def build_hash(cmd, exports, proj_root, exclude=()):
+    '''Returns a hash of everything that goes into a build.
+
+    The build is identified by its command line (which includes the tool and
+    all options), the exported environment variables and the state of the
+    sources. Untracked files under the paths in exclude don't count as
+    sources. Returns None if the state of the sources is unknown.
+    '''
+    source_hash = source_state_hash(proj_root, exclude)
+    if source_hash is None:
+        return None
+
+    digest = hashlib.sha256()
+    digest.update(cmd.encode())
+    for key in sorted(exports):
+        digest.update('\0{}={}'.format(key, exports[key]).encode())
+    digest.update(source_hash.encode())
+    return digest.hexdigest()
+
+
+class BuildCache():
+    '''Successful builds, indexed by their build_hash().
+
+    This lets a build reuse an identical build in another build directory,
+    such as one from another build mode that only differs in its name. Each
+    entry is a symlink in the cache directory, named after the hash and
+    pointing at the build directory. Build directories hold the hash of their
+    last successful build in BuildCache.HASH_FILE, which is checked on lookup
+    since a directory may have been rebuilt or removed since it was added.
+    '''
+
+    HASH_FILE = '.dvsim_build_hash'
+
+    def __init__(self, path=None):
+        self.path = path
+
+    @staticmethod
+    def read_hash(build_dir):
+        '''Returns the hash of the last successful build in build_dir.'''
+        try:
+            with open(os.path.join(build_dir, BuildCache.HASH_FILE)) as f:
+                return f.read().strip()
+        except OSError:
+            return None
+
+    def lookup(self, build_hash):
+        '''Returns a build directory holding build_hash, or None.'''
+        if self.path is None:
+            return None
+        build_dir = os.path.realpath(os.path.join(self.path, build_hash))
+        if BuildCache.read_hash(build_dir) != build_hash:
+            return None
+        return build_dir
+
+    def add(self, build_hash, build_dir):
+        '''Records a successful build of build_hash in build_dir.'''
+        if self.path is None:
+            return
+        link = os.path.join(self.path, build_hash)
+        tmp_link = link + '.tmp'
+        try:
+            os.makedirs(self.path, exist_ok=True)
+            if os.path.lexists(tmp_link):
+                os.remove(tmp_link)
+            os.symlink(os.path.realpath(build_dir), tmp_link)
+            os.replace(tmp_link, link)
+        except OSError as e:
+            log.warning("Failed to add %s to the build cache in %s: %s",
+                        build_dir, self.path, e)
@@ -0,0 +1,151 @@
+# Copyright lowRISC contributors.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+
+'''pytest-based testing for functions in scheduler.py'''
+
+import os
+import subprocess
+
+from .scheduler import (BuildCache, JobHistory, Resources,
+                        order_by_expected_runtime, source_state_hash)
+
+
+class FakeItem:
+    def __init__(self, key):
+        self.key = key
+
+    def history_key(self):
+        return self.key
+
+
+def test_resources():
+    '''Pytest-compatible test for the Resources class.'''
+    res = Resources(cpus=4, mem_mb=1000)
+
+    # A job that's too big still runs if nothing else is running.
+    assert res.fits(8, 2000)
+
+    res.acquire(2, 600)
+    assert res.fits(2, 400)
+    assert not res.fits(3, 0)
+    assert not res.fits(1, 500)
+
+    res.release(2, 600)
+    assert res.fits(8, 2000)
+
+    # No limits
+    res = Resources()
+    res.acquire(100, 100000)
+    assert res.fits(100, 100000)
+
+
+def test_job_history(tmpdir):
+    '''Pytest-compatible test for the JobHistory class.'''
+    path = os.path.join(str(tmpdir), 'history.json')
+
+    # A missing file gives an empty history.
+    history = JobHistory(path)
+    assert history.get('a') is None
+    assert history.expected_runtime('a') is None
+
+    history.record('a', 10, 1, 100)
+    assert history.get('a') == {'runtime': 10, 'cpus': 1, 'mem_mb': 100}
+
+    # Later samples are averaged with the earlier ones.
+    history.record('a', 20, 3, 200)
+    assert history.get('a') == {'runtime': 15, 'cpus': 2, 'mem_mb': 150}
+
+    history.save()
+    assert JobHistory(path).get('a') == history.get('a')
+
+    # A corrupt file is ignored.
+    with open(path, 'w') as f:
+        f.write('{')
+    assert JobHistory(path).get('a') is None
+
+
+def test_order_by_expected_runtime():
+    '''Pytest-compatible test for the order_by_expected_runtime function.'''
+    history = JobHistory()
+    history.record('short', 1, 1, 0)
+    history.record('long', 100, 1, 0)
+
+    items = [FakeItem(key) for key in ['short', 'new0', 'long', 'new1']]
+    ordered = order_by_expected_runtime(items, history)
+    assert [item.key for item in ordered] == ['new0', 'new1', 'long', 'short']
+
+
+def write_file(path, contents):
+    with open(path, 'w') as f:
+        f.write(contents)
+
+
+def test_source_state_hash(tmpdir):
+    '''Pytest-compatible test for the source_state_hash function.'''
+    root = str(tmpdir)
+    assert source_state_hash(root) is None
+
+    def git(*args):
+        subprocess.run(['git', '-C', root, '-c', 'user.name=test',
+                        '-c', 'user.email=test@example.com'] + list(args),
+                       stdout=subprocess.DEVNULL,
+                       check=True)
+
+    git('init')
+    write_file(os.path.join(root, 'tracked.sv'), 'module a;')
+    git('add', 'tracked.sv')
+    git('commit', '-m', 'test')
+
+    scratch = os.path.join(root, 'scratch')
+    history = os.path.join(root, 'history.json')
+    exclude = [scratch, history]
+
+    # The hash is cached, so each check uses a different exclude list.
+    def hash_sources(*extra):
+        return source_state_hash(root, exclude + list(extra))
+
+    clean = hash_sources()
+    assert clean is not None
+    assert hash_sources('a') == clean
+
+    # dvsim's outputs don't change the hash.
+    os.mkdir(scratch)
+    write_file(os.path.join(scratch, 'build.log'), 'log')
+    write_file(history, '{}')
+    assert hash_sources('b') == clean
+
+    # Untracked sources and uncommitted changes do.
+    write_file(os.path.join(root, 'new.sv'), 'module b;')
+    untracked = hash_sources('c')
+    assert untracked != clean
+    write_file(os.path.join(root, 'new.sv'), 'module c;')
+    assert hash_sources('d') not in [clean, untracked]
+
+    os.remove(os.path.join(root, 'new.sv'))
+    write_file(os.path.join(root, 'tracked.sv'), 'module d;')
+    assert hash_sources('e') not in [clean, untracked]
+
+
+def test_build_cache(tmpdir):
+    '''Pytest-compatible test for the BuildCache class.'''
+    build_dir = os.path.join(str(tmpdir), 'build')
+    os.mkdir(build_dir)
+
+    # Without a path, nothing is cached.
+    cache = BuildCache()
+    cache.add('1234', build_dir)
+    assert cache.lookup('1234') is None
+
+    cache = BuildCache(os.path.join(str(tmpdir), 'cache'))
+    assert cache.lookup('1234') is None
+    write_file(os.path.join(build_dir, BuildCache.HASH_FILE), '1234\n')
+    cache.add('1234', build_dir)
+    assert cache.lookup('1234') == os.path.realpath(build_dir)
+    assert cache.lookup('5678') is None
+
+    # The build directory has since been rebuilt with other inputs.
+    write_file(os.path.join(build_dir, BuildCache.HASH_FILE), '5678\n')
+    assert cache.lookup('1234') is None
+    cache.add('5678', build_dir)
+    assert cache.lookup('5678') == os.path.realpath(build_dir)
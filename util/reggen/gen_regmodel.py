@@ -0,0 +1,156 @@
+# Copyright lowRISC contributors.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+"""
+Generate a C++ register model description from validated register JSON tree
+
+The output is a header that defines a reg_model::DeviceInfo for the IP, for use
+with sw/device/lib/testing/reg_model.h.
+"""
+
+import logging as log
+
+from .gen_cheader import as_define, genout
+
+
+def as_camel_case(s):
+    return ''.join(part.capitalize() for part in as_define(s).split('_'))
+
+
+def reg_masks(reg):
+    '''Returns a dict with the masks of a register, by software access type'''
+    masks = {
+        'read': 0,
+        'write': 0,
+        'w1c': 0,
+        'w1s': 0,
+        'w0c': 0,
+        'rc': 0,
+    }
+    for field in reg['fields']:
+        mask = field['bitinfo'][0]
+        swaccess = field['swaccess']
+        if swaccess not in ['wo', 'r0w1c']:
+            masks['read'] |= mask
+        if swaccess in ['rw', 'wo']:
+            masks['write'] |= mask
+        elif swaccess in ['rw1c', 'r0w1c']:
+            masks['w1c'] |= mask
+        elif swaccess == 'rw1s':
+            masks['w1s'] |= mask
+        elif swaccess == 'rw0c':
+            masks['w0c'] |= mask
+        elif swaccess == 'rc':
+            masks['rc'] |= mask
+    return masks
+
+
+def is_write_fifo(reg):
+    '''A write-only register that hardware pops on each write (e.g. WDATA)'''
+    return (reg['hwqe'] == 'true' and reg['hwext'] == 'false' and
+            all(field['swaccess'] == 'wo' for field in reg['fields']))
+
+
+def is_read_fifo(reg):
+    '''A read-only register that hardware pops on each read (e.g. RDATA)
+
+    Status registers that hardware also sees reads of (e.g. UART STATUS) have
+    several fields, so a FIFO must have a single data field.
+    '''
+    return (reg['hwre'] == 'true' and reg['hwext'] == 'true' and
+            len(reg['fields']) == 1 and reg['fields'][0]['swaccess'] == 'ro')
+
+
+def resolve_regwen(reg, rnames):
+    '''Returns the name of the register that enables writes to reg, or ""'''
+    regwen = reg['regwen']
+    if regwen == '':
+        return ''
+    if regwen.lower() in rnames:
+        return regwen.upper()
+    log.warning("{}: can't model regwen {}, ignoring it".format(
+        reg['name'], regwen))
+    return ''
+
+
+def gen_reg(outstr, reg, rnames):
+    masks = reg_masks(reg)
+    genout(
+        outstr, '      {{"{name}", {offset:#x}, {resval:#x},\n'
+        '       /*read_mask=*/{read:#x}, /*write_mask=*/{write:#x},\n'
+        '       /*w1c_mask=*/{w1c:#x}, /*w1s_mask=*/{w1s:#x},\n'
+        '       /*w0c_mask=*/{w0c:#x}, /*rc_mask=*/{rc:#x},\n'
+        '       /*write_fifo=*/{write_fifo}, /*read_fifo=*/{read_fifo},\n'
+        '       /*regwen=*/"{regwen}"}},\n'.format(
+            name=reg['name'].upper(),
+            offset=reg['genoffset'],
+            resval=reg['genresval'],
+            write_fifo='true' if is_write_fifo(reg) else 'false',
+            read_fifo='true' if is_read_fifo(reg) else 'false',
+            regwen=resolve_regwen(reg, rnames),
+            **masks))
+
+
+# Must have called validate, so should have no errors
+def gen_regmodel(regs, outfile, src_lic, src_copy):
+    component = regs['name']
+    rnames = regs['genrnames']
+    regwidth = int(regs.get('regwidth', '32'), 0)
+    if regwidth != 32:
+        log.error('Register models only support 32-bit registers.')
+        return 1
+
+    reg_list = []
+    windows = []
+    for x in regs['registers']:
+        if 'sameaddr' in x:
+            reg_list.extend(x['sameaddr'])
+        elif 'window' in x:
+            windows.append(x['window'])
+        elif 'multireg' in x:
+            reg_list.extend(x['multireg']['genregs'])
+        elif 'reserved' not in x and 'skipto' not in x:
+            reg_list.append(x)
+
+    genout(outfile, '// Generated register model for ' + component + '\n\n')
+    if src_copy != '':
+        genout(outfile, '// Copyright information found in source file:\n')
+        genout(outfile, '// ' + src_copy + '\n\n')
+    if src_lic is not None:
+        genout(outfile, '// Licensing information found in source file:\n')
+        for line in src_lic.splitlines():
+            genout(outfile, '// ' + line + '\n')
+        genout(outfile, '\n')
+
+    guard = '_' + as_define(component) + '_REG_MODEL_'
+    genout(outfile, '#ifndef ' + guard + '\n')
+    genout(outfile, '#define ' + guard + '\n\n')
+    genout(outfile, '#include "sw/device/lib/testing/reg_model.h"\n\n')
+    genout(outfile, 'namespace reg_model {\n\n')
+
+    genout(outfile, '// clang-format off\n')
+    genout(outfile,
+           'inline const DeviceInfo &{}DeviceInfo() {{\n'.format(
+               as_camel_case(component)))
+    genout(outfile, '  static const DeviceInfo *info = new DeviceInfo{\n')
+    genout(outfile, '    "{}",\n'.format(component))
+    genout(outfile, '    {\n')
+    for reg in reg_list:
+        gen_reg(outfile, reg, rnames)
+    genout(outfile, '    },\n')
+    genout(outfile, '    {\n')
+    for win in windows:
+        genout(
+            outfile, '      {{"{}", {:#x}, {:#x}}},\n'.format(
+                win['name'].upper(), win['genoffset'],
+                int(win['items']) * (regwidth // 8)))
+    genout(outfile, '    },\n')
+    genout(outfile, '  };\n')
+    genout(outfile, '  return *info;\n')
+    genout(outfile, '}\n')
+    genout(outfile, '// clang-format on\n\n')
+
+    genout(outfile, '}  // namespace reg_model\n\n')
+    genout(outfile, '#endif  // ' + guard + '\n')
+    genout(outfile, '// End generated register model for ' + component)
+    return 0
@@ -14,7 +14,8 @@ from pathlib import PurePath
 import hjson
 
 from reggen import (gen_cheader, gen_ctheader, gen_dv, gen_fpv, gen_html,
-                    gen_json, gen_rtl, gen_selfdoc, validate, version)
+                    gen_json, gen_regmodel, gen_rtl, gen_selfdoc, validate,
+                    version)
 
 DESC = """regtool, generate register info from Hjson source"""
 
@@ -51,6 +52,10 @@ def main():
                         '-T',
                         action='store_true',
                         help='Output C defines header (Titan style)')
+    parser.add_argument('--regmodel',
+                        action='store_true',
+                        help='Output C++ register model header, for host '
+                        'tests with sw/device/lib/testing/reg_model.h')
     parser.add_argument('--doc',
                         action='store_true',
                         help='Output source file documentation (gfm)')
@@ -123,7 +128,8 @@ def main():
                      ('d', ('html', None)), ('doc', ('doc', None)),
                      ('r', ('rtl', 'rtl')), ('s', ('dv', 'dv')),
                      ('f', ('fpv', 'fpv/vip')), ('cdefines', ('cdh', None)),
-                     ('ctdefines', ('cth', None))]
+                     ('ctdefines', ('cth', None)),
+                     ('regmodel', ('regmodel', None))]
     format = None
     dirspec = None
     for arg_name, spec in arg_to_format:
@@ -229,6 +235,9 @@ def main():
                 gen_cheader.gen_cdefines(obj, outfile, src_lic, src_copy)
             elif format == 'cth':
                 gen_ctheader.gen_cdefines(obj, outfile, src_lic, src_copy)
+            elif format == 'regmodel':
+                if gen_regmodel.gen_regmodel(obj, outfile, src_lic, src_copy):
+                    sys.exit(1)
             else:
                 gen_json.gen_json(obj, outfile, format)
 